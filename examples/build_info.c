@@ -47,6 +47,7 @@ int main(int argc, char* argv[]) {
     DESC(backend_alsa);
     DESC(backend_cocoa);
     DESC(backend_emscripten);
+    DESC(backend_headless);
     DESC(backend_mme);
     DESC(backend_win32);
     DESC(backend_x11);
@@ -56,6 +57,7 @@ int main(int argc, char* argv[]) {
     DESC(checks_log);     // Failed checks are logged
     DESC(fastmath);       // Fast math optimizations enabled
     DESC(log_color);      // Colored log output enabled
+    DESC(memory_stats);   // Allocation statistics collected
     DESC(pedantic);       // Extra runtime checks enabled
 
     return 0;
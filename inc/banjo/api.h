@@ -228,13 +228,16 @@ struct bj_build_info {
     bj_bool     backend_alsa;        ///< Built with ALSA audio.
     bj_bool     backend_cocoa;       ///< Built with Cocoa/macOS support.
     bj_bool     backend_emscripten;  ///< Built with Emscripten support.
+    bj_bool     backend_headless;    ///< Built with the offscreen video layer.
     bj_bool     backend_mme;         ///< Built with Windows MME audio.
+    bj_bool     backend_null_audio;  ///< Built with the null audio layer.
     bj_bool     backend_win32;       ///< Built with Win32 window support.
     bj_bool     backend_x11;         ///< Built with X11 window support.
     bj_bool     checks_abort;        ///< Checks abort execution on failure.
     bj_bool     checks_log;          ///< Checks log failures.
     bj_bool     fastmath;            ///< Built with fast-math optimizations.
     bj_bool     log_color;           ///< Colored log output enabled.
+    bj_bool     memory_stats;        ///< Allocation statistics collected.
     bj_bool     pedantic;            ///< Extra runtime checks enabled.
 };
 
@@ -262,12 +265,16 @@ BANJO_EXPORT const struct bj_build_info* bj_build_information(void);
 #ifndef BJ_NO_TYPEDEF
 
 typedef struct bj_angular_2d bj_angular_2d;
+typedef struct bj_arena bj_arena;
 typedef struct bj_cli bj_cli;
 typedef struct bj_cli_argument bj_cli_argument;
 typedef struct bj_audio_device bj_audio_device;
 typedef struct bj_audio_play_note_data bj_audio_play_note_data;
 typedef struct bj_audio_properties bj_audio_properties;
+typedef struct bj_audio_ring bj_audio_ring;
 typedef struct bj_bitmap bj_bitmap;
+typedef struct bj_bitmap_load bj_bitmap_load;
+typedef struct bj_bitmap_loader bj_bitmap_loader;
 typedef struct bj_build_info bj_build_info;
 typedef struct bj_button_event bj_button_event;
 typedef struct bj_cursor_event bj_cursor_event;
@@ -281,18 +288,27 @@ typedef struct bj_mat3x3 bj_mat3x3;
 typedef struct bj_mat4x3 bj_mat4x3;
 typedef struct bj_mat4x4 bj_mat4;
 typedef struct bj_mat4x4 bj_mat4x4;
+typedef struct bj_memory_call_site bj_memory_call_site;
 typedef struct bj_memory_callbacks bj_memory_callbacks;
+typedef struct bj_memory_stats bj_memory_stats;
+typedef struct bj_mixer bj_mixer;
+typedef struct bj_mixer_sound bj_mixer_sound;
+typedef struct bj_oscillator bj_oscillator;
 typedef struct bj_particle_2d bj_particle_2d;
 typedef struct bj_pcg32 bj_pcg32;
+typedef struct bj_present_stats bj_present_stats;
 typedef struct bj_rect bj_rect;
 typedef struct bj_renderer bj_renderer;
+typedef struct bj_resampler bj_resampler;
 typedef struct bj_rigid_body_2d bj_rigid_body_2d;
+typedef struct bj_shader_span bj_shader_span;
 typedef struct bj_stopwatch bj_stopwatch;
 typedef struct bj_stream bj_stream;
 typedef struct bj_vec2 bj_vec2;
 typedef struct bj_vec3 bj_vec3;
 typedef struct bj_vec4 bj_quat;
 typedef struct bj_vec4 bj_vec4;
+typedef struct bj_wav bj_wav;
 typedef struct bj_window bj_window;
 
 #endif /* BJ_NO_TYPEDEF */
@@ -13,7 +13,6 @@
 /// Banjo supports audio manipulation for Windows, GNU/Linux and WebAssembly.
 ///
 /// \todo Add support for audio push-based API
-/// \todo Add support for audio WAVE format
 /// \todo Add support for audio MIDI format
 ///
 /// \{
@@ -35,6 +34,8 @@
 /// \see bj_close_audio_device
 ////////////////////////////////////////////////////////////////////////////////
 struct bj_audio_device;
+struct bj_audio_ring;
+struct bj_resampler;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Audio sample format descriptor.
@@ -97,6 +98,24 @@ typedef enum bj_audio_format bj_audio_format;
 ////////////////////////////////////////////////////////////////////////////////
 #define BJ_AUDIO_FORMAT_SIGNED(x)        ((x) & (1u<<15))
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Sample rate conversion quality.
+///
+/// When the hardware does not support the requested sample rate, the device
+/// opens at the nearest rate and converts the callback output to it with
+/// the selected quality.
+///
+/// \see bj_create_resampler
+////////////////////////////////////////////////////////////////////////////////
+enum bj_resample_quality {
+    BJ_RESAMPLE_SINC   = 0, ///< Windowed-sinc polyphase filter (default).
+    BJ_RESAMPLE_LINEAR = 1, ///< Linear interpolation, cheaper but duller.
+    BJ_RESAMPLE_NONE   = 2, ///< No conversion: the callback runs at the device rate.
+};
+#ifndef BJ_NO_TYPEDEF
+typedef enum bj_resample_quality bj_resample_quality;
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Describe properties of an audio device.
 ///
@@ -110,6 +129,9 @@ struct bj_audio_properties {
     int16_t         amplitude;   ///< Maximum amplitude of the output samples.
     unsigned int    channels;    ///< Number of channels (currently always 1).
     unsigned int    sample_rate; ///< Number of samples per second (Hz).
+    enum bj_resample_quality resample; ///< Conversion used if the device rate differs.
+    unsigned int    period_frames; ///< Frames produced per callback, 0 for the backend default.
+    unsigned int    period_count;  ///< Periods queued ahead of playback, 0 for the backend default.
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -244,6 +266,55 @@ BANJO_EXPORT bj_bool bj_audio_playing(
     const struct bj_audio_device* device
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the properties the device was actually opened with.
+///
+/// The sample rate, channel count and period sizes may differ from the
+/// ones requested in bj_open_audio_device, as backends round them to
+/// what the hardware supports.
+///
+/// \param device Pointer to the audio device.
+/// \return The device properties, or NULL if `device` is NULL.
+///
+/// \see bj_audio_latency
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT const struct bj_audio_properties* bj_audio_device_properties(
+    const struct bj_audio_device* device
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the output latency of a device.
+///
+/// The latency is the time covered by the queued periods: a sample
+/// produced by the callback is heard at most this long after it was
+/// generated.
+///
+/// \param device Pointer to the audio device.
+/// \return The latency in seconds, or 0 if `device` is NULL.
+///
+/// \see bj_audio_device_properties
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT double bj_audio_latency(
+    const struct bj_audio_device* device
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Count the underruns of a device since it was opened.
+///
+/// An underrun (or xrun) happens when the callback does not produce a
+/// period before the hardware needs it, which is heard as a click. The
+/// backend recovers on its own; this counter lets the application check
+/// whether its period size is too small for its callback.
+///
+/// Only backends which can detect underruns (ALSA and MME) count them.
+///
+/// \param device Pointer to the audio device.
+/// \return The number of underruns, or 0 if `device` is NULL.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT uint32_t bj_audio_underruns(
+    const struct bj_audio_device* device
+);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Define parameters for generating simple waveforms.
 ///
@@ -266,6 +337,8 @@ struct bj_audio_play_note_data {
 /// \brief Generate a basic waveform tone using a built-in callback.
 ///
 /// Can be used as a bj_audio_callback_fn and uses struct bj_audio_play_note_data.
+/// The same tone is written to every channel. For several notes at once,
+/// play oscillators through a mixer instead.
 ///
 /// \param buffer            Output buffer to write samples into.
 /// \param frames            Number of frames to generate.
@@ -275,6 +348,7 @@ struct bj_audio_play_note_data {
 ///
 /// \see struct bj_audio_play_note_data
 /// \see bj_audio_callback_fn
+/// \see bj_oscillator_generator
 ////////////////////////////////////////////////////////////////////////////////
 BANJO_EXPORT void bj_play_audio_note(
     void*                      buffer,
@@ -284,5 +358,193 @@ BANJO_EXPORT void bj_play_audio_note(
     uint64_t                   base_sample_index
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Create a ring buffer to push PCM frames to an audio device.
+///
+/// The ring lets the application produce audio from its own thread (push
+/// model) instead of inside the audio callback: the application writes
+/// frames with \ref bj_audio_ring_write and the device reads them through
+/// \ref bj_audio_ring_callback.
+///
+/// The ring is lock-free for exactly one writing thread and one reading
+/// thread.
+///
+/// \param properties Format and channel count of the frames, which must
+///                   match the device the ring is played on.
+/// \param frames     Minimum capacity in frames. The actual capacity is
+///                   rounded up to a power of two.
+///
+/// \return A new ring, or *0* on allocation failure or invalid properties.
+///
+/// \see bj_destroy_audio_ring, bj_audio_ring_callback
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_audio_ring* bj_create_audio_ring(
+    const struct bj_audio_properties* properties,
+    size_t                            frames
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Destroy a ring created with \ref bj_create_audio_ring.
+///
+/// The device reading the ring must be closed first.
+///
+/// \param ring Ring to destroy.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_destroy_audio_ring(
+    struct bj_audio_ring* ring
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Append interleaved frames to the ring.
+///
+/// Must only be called from the producer thread. Frames that do not fit
+/// are not written.
+///
+/// \param ring   The ring.
+/// \param frames Interleaved samples in the ring format.
+/// \param count  Number of frames to write.
+///
+/// \return The number of frames written.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_audio_ring_write(
+    struct bj_audio_ring* ring,
+    const void*           frames,
+    size_t                count
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Take the oldest frames out of the ring.
+///
+/// Must only be called from the consumer thread, which usually is the audio
+/// thread through \ref bj_audio_ring_callback.
+///
+/// \param ring   The ring.
+/// \param frames Receives the interleaved samples.
+/// \param count  Maximum number of frames to read.
+///
+/// \return The number of frames read.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_audio_ring_read(
+    struct bj_audio_ring* ring,
+    void*                 frames,
+    size_t                count
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Number of frames that can currently be read from the ring.
+///
+/// \param ring The ring.
+/// \return Readable frames. More may become available concurrently.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_audio_ring_readable(
+    const struct bj_audio_ring* ring
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Number of frames that can currently be written to the ring.
+///
+/// \param ring The ring.
+/// \return Writable frames. More may become available concurrently.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_audio_ring_writable(
+    const struct bj_audio_ring* ring
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Audio callback playing the content of a ring.
+///
+/// Can be used as a bj_audio_callback_fn with a struct bj_audio_ring as user
+/// data. Missing frames are played as silence, and the whole buffer is
+/// silent if the device format differs from the ring format.
+///
+/// \param buffer            Output buffer to write samples into.
+/// \param frames            Number of frames to generate.
+/// \param audio             Audio device properties.
+/// \param user_data         Pointer to a struct bj_audio_ring.
+/// \param base_sample_index Unused.
+///
+/// \see bj_create_audio_ring
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_audio_ring_callback(
+    void*                             buffer,
+    unsigned                          frames,
+    const struct bj_audio_properties* audio,
+    void*                             user_data,
+    uint64_t                          base_sample_index
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Create a sample rate converter.
+///
+/// A resampler converts a stream of interleaved float frames from one rate
+/// to another. Its filter tables are computed here, once for the pair of
+/// rates.
+///
+/// Audio devices use one automatically when the hardware rate differs from
+/// the requested rate, see \ref bj_audio_properties.resample.
+///
+/// \param channels    Number of interleaved channels.
+/// \param input_rate  Rate of the input frames (Hz).
+/// \param output_rate Rate of the output frames (Hz).
+/// \param quality     \ref BJ_RESAMPLE_SINC or \ref BJ_RESAMPLE_LINEAR.
+///
+/// \return A new resampler, or *0* on invalid parameters or allocation
+///         failure.
+///
+/// \see bj_resample, bj_destroy_resampler
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_resampler* bj_create_resampler(
+    unsigned int             channels,
+    unsigned int             input_rate,
+    unsigned int             output_rate,
+    enum bj_resample_quality quality
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Destroy a resampler created with \ref bj_create_resampler.
+///
+/// \param resampler Resampler to destroy.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_destroy_resampler(
+    struct bj_resampler* resampler
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Convert frames to the output rate.
+///
+/// Consumes input frames and produces output frames until either the input
+/// is used up or the output is full. The resampler keeps the few input
+/// frames the filter still needs, so a stream can be converted in chunks of
+/// any size with the same result as in one call.
+///
+/// The sinc filter delays the output by half its length, a few frames.
+///
+/// \param resampler     The resampler.
+/// \param input         Interleaved input frames.
+/// \param input_frames  Number of frames in `input`.
+/// \param consumed      Receives the number of input frames used.
+/// \param output        Receives interleaved output frames.
+/// \param output_frames Capacity of `output`, in frames.
+///
+/// \return Number of frames written to `output`.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_resample(
+    struct bj_resampler* resampler,
+    const float*         input,
+    size_t               input_frames,
+    size_t*              consumed,
+    float*               output,
+    size_t               output_frames
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Forget buffered frames, as if the resampler was just created.
+///
+/// \param resampler The resampler.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_reset_resampler(
+    struct bj_resampler* resampler
+);
+
 #endif /* BJ_AUDIO_H */
 /// \} // end of audio group
@@ -14,16 +14,15 @@
 /// Typical usage:
 /// - Create with \ref bj_create_bitmap or \ref bj_create_bitmap_from_file.
 /// - Query size and mode, or access raw pixels.
-/// - Draw: \ref bj_blit, \ref bj_blit_stretched, \ref bj_blit_mask,
+/// - Draw: \ref bj_blit, \ref bj_blit_stretched,
+///   \ref bj_blit_stretched_filtered, \ref bj_blit_transformed, \ref bj_blit_mask,
 ///   \ref bj_blit_mask_stretched, \ref bj_draw_text, \ref bj_blit_text.
+/// - Save with \ref bj_write_bitmap_to_file or \ref bj_write_bitmap_to_stream.
 /// - Destroy with \ref bj_destroy_bitmap.
 ///
 /// \note Public APIs use destination-native packed colors unless stated
 ///       otherwise. Use \ref bj_make_bitmap_pixel to pack values.
 ///
-/// \todo Add support for writing bitmaps to disk (e.g., BMP/PNG) with a
-///       `bj_write_bitmap_*` API.
-///
 ///
 /// \{
 ////////////////////////////////////////////////////////////////////////////////
@@ -31,6 +30,7 @@
 #define BJ_BITMAP_H
 #include <banjo/api.h>
 #include <banjo/error.h>
+#include <banjo/mat.h>
 #include <banjo/pixel.h>
 #include <banjo/rect.h>
 #include <banjo/stream.h>
@@ -45,6 +45,16 @@
 /// \note For mismatched pixel formats, colors are combined in linear integer
 /// RGB (8-bit per channel) after conversion from/to native formats.
 ///
+/// \par Alpha Compositing
+///
+/// `BJ_BLIT_OP_SRC_OVER` and `BJ_BLIT_OP_PREMUL_OVER` read the per-pixel alpha
+/// of \ref BJ_PIXEL_MODE_ARGB8888 and \ref BJ_PIXEL_MODE_ARGB8888_PREMUL
+/// sources. Use `SRC_OVER` with straight alpha sources and `PREMUL_OVER` with
+/// premultiplied ones. Sources without alpha are opaque and simply copied.
+/// Destination colors are combined as stored, which is exact for opaque and
+/// premultiplied destinations; destination alpha, if any, becomes
+/// `a + da * (1 - a)`.
+///
 enum bj_blit_op {
     BJ_BLIT_OP_COPY = 0,  //!< Copy source to destination (fast path when formats match)
     BJ_BLIT_OP_XOR,       //!< Bitwise XOR (channel-wise for >8bpp)
@@ -52,11 +62,34 @@ enum bj_blit_op {
     BJ_BLIT_OP_AND,       //!< Bitwise AND
     BJ_BLIT_OP_ADD_SAT,   //!< Per-channel saturated add (clamped to 255)
     BJ_BLIT_OP_SUB_SAT,   //!< Per-channel saturated subtract (clamped to 0)
+    BJ_BLIT_OP_SRC_OVER,  //!< Straight alpha blend: `s * a + d * (1 - a)`
+    BJ_BLIT_OP_PREMUL_OVER, //!< Premultiplied alpha blend: `s + d * (1 - a)`
 };
 #ifndef BJ_NO_TYPEDEF
 typedef enum bj_blit_op bj_blit_op;
 #endif
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Sampling filter for \ref bj_blit_stretched_filtered.
+///
+/// - `BJ_BLIT_FILTER_NEAREST`: Picks the closest source pixel. Fastest, but
+///   aliases when downscaling and looks blocky when upscaling.
+/// - `BJ_BLIT_FILTER_BILINEAR`: Interpolates the 2x2 source pixels around
+///   each destination pixel center. Best suited to upscaling and to mild
+///   downscaling (down to half size).
+/// - `BJ_BLIT_FILTER_BOX`: Averages every source pixel covered by the
+///   destination pixel, weighted by coverage (area averaging). Best suited to
+///   downscaling by large factors.
+///
+enum bj_blit_filter {
+    BJ_BLIT_FILTER_NEAREST = 0, //!< Nearest neighbor (same as \ref bj_blit_stretched)
+    BJ_BLIT_FILTER_BILINEAR,    //!< Bilinear interpolation
+    BJ_BLIT_FILTER_BOX,         //!< Area averaging
+};
+#ifndef BJ_NO_TYPEDEF
+typedef enum bj_blit_filter bj_blit_filter;
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Color roles for bitmaps.
 ///
@@ -193,6 +226,87 @@ BANJO_EXPORT struct bj_bitmap* bj_create_bitmap_from_file(
 );
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Writes a bitmap to a stream in the BMP format.
+///
+/// \param bitmap The bitmap to write.
+/// \param stream A stream opened for writing, see \ref bj_open_stream_write
+///               and \ref bj_open_stream_file_write.
+/// \param error  Optional error object.
+/// \return \ref BJ_TRUE on success.
+///
+/// The encoding depends on the pixel mode of `bitmap`:
+///
+/// - 24 and 32bpp modes are written uncompressed and top-down, rows copied
+///   as they are in memory. Alpha values of 32bpp modes are kept in the
+///   unused byte of each pixel. If the rows of the bitmap have no padding
+///   beyond the 4 bytes alignment of BMP rows, the whole buffer is written
+///   at once.
+/// - 16bpp modes are converted to 24bpp row by row.
+/// - Indexed modes are written RLE8 compressed. Bitmaps do not hold a
+///   palette, so a grayscale palette with one entry per index is written.
+///
+/// The stream must support seeking back for indexed bitmaps: the size of
+/// the compressed raster is written in the header once known.
+///
+/// The output is read back by \ref bj_create_bitmap_from_file.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_write_bitmap_to_stream(
+    const struct bj_bitmap* bitmap,
+    struct bj_stream*       stream,
+    struct bj_error**       error
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes a bitmap to a BMP file.
+///
+/// \param bitmap The bitmap to write.
+/// \param path   Path of the file to create or overwrite.
+/// \param error  Optional error object.
+/// \return \ref BJ_TRUE on success.
+///
+/// \see bj_write_bitmap_to_stream for the encodings used.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_write_bitmap_to_file(
+    const struct bj_bitmap* bitmap,
+    const char*             path,
+    struct bj_error**       error
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// Default alignment of \ref bj_create_aligned_bitmap, in bytes.
+///
+/// This is the size of a cache line, and a multiple of the widest vector
+/// registers, so that vectorized loops never split a load across rows.
+////////////////////////////////////////////////////////////////////////////////
+#define BJ_BITMAP_ALIGNMENT 64
+
+////////////////////////////////////////////////////////////////////////////////
+/// Creates a new struct bj_bitmap with an aligned pixel buffer.
+///
+/// Works like \ref bj_create_bitmap with an automatic stride, except that
+/// the buffer address and the stride are both multiples of `alignment`.
+/// Every row thus starts on an aligned boundary.
+///
+/// \param width     Width of the bitmap.
+/// \param height    Height of the bitmap.
+/// \param mode      The pixel mode.
+/// \param alignment Alignment in bytes, a power of two, or _0_ for
+///                  \ref BJ_BITMAP_ALIGNMENT.
+/// \return A new instance of  bj_bitmap, or _0_ on failure.
+///
+/// Copies made with \ref bj_copy_bitmap keep the alignment.
+/// The caller is responsible for releasing the bitmap using \ref bj_destroy_bitmap.
+///
+/// \see bj_bitmap_alignment
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_bitmap* bj_create_aligned_bitmap(
+    size_t             width,
+    size_t             height,
+    enum bj_pixel_mode mode,
+    size_t             alignment
+);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Creates a new struct bj_bitmap with the specified width and height.
 ///
@@ -386,6 +500,20 @@ BANJO_EXPORT size_t bj_bitmap_stride(
     struct bj_bitmap* bitmap
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// Get the alignment guaranteed for every row of the bitmap.
+///
+/// The result is the largest power of two dividing both the address of the
+/// pixel data and the stride. Code processing rows with wide loads can rely
+/// on it, whatever the way the bitmap was created.
+///
+/// \param bitmap The bitmap object.
+/// \return The alignment in bytes, or _0_ if the bitmap has no pixel data.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_bitmap_alignment(
+    const struct bj_bitmap* bitmap
+);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Gets the RGB value of a pixel given its 32-bits representation.
 ///
@@ -599,12 +727,109 @@ BANJO_EXPORT bj_bool bj_blit(
 ///
 /// Color keying on the *source* bitmap is honored (see \ref bj_set_bitmap_color).
 ///
+/// \see bj_blit_stretched_filtered for bilinear and area-averaging filters.
+///
 ////////////////////////////////////////////////////////////////////////////////
 BANJO_EXPORT bj_bool bj_blit_stretched(
     const struct bj_bitmap* src, const struct bj_rect* src_area,
     struct bj_bitmap* dst, const struct bj_rect* dst_area,
     enum bj_blit_op op);
 
+////////////////////////////////////////////////////////////////////////////////
+/// Stretched bitmap blitting with a sampling filter.
+///
+/// \param src        The source bitmap.
+/// \param src_area   Optional area to copy from in the source bitmap (0 = full source).
+/// \param dst        The destination bitmap.
+/// \param dst_area   Optional area to copy to in the destination bitmap (0 = full destination).
+/// \param op         The raster operation to apply (see  bj_blit_op).
+/// \param filter     The sampling filter (see \ref bj_blit_filter).
+/// \return           *BJ_TRUE* if a blit actually happened, *BJ_FALSE* otherwise.
+///
+/// Areas and clipping behave as in \ref bj_blit_stretched. With
+/// `BJ_BLIT_FILTER_NEAREST`, or when both areas have the same size, this
+/// function is equivalent to \ref bj_blit_stretched.
+///
+/// \par Filtering
+///
+/// Filtering is separable: source rows are resampled horizontally once and
+/// cached, then blended vertically. Channels are interpolated in 8-bit fixed
+/// point. Source pixels outside of the source area are never read; edges are
+/// clamped.
+///
+/// \par Color Key and Alpha
+///
+/// Keyed source pixels are treated as fully transparent: their neighbors fade
+/// out smoothly instead of bleeding the key color. A keyed source is therefore
+/// composited onto the destination, for `BJ_BLIT_OP_COPY` as well.
+/// Sources with alpha are filtered premultiplied when the result is
+/// composited or stored with alpha.
+///
+/// \par Limitations
+///
+/// Filters apply to 16, 24 and 32bpp sources. Indexed sources, and keyed
+/// sources used with a raster operation other than copy or alpha
+/// compositing, fall back to nearest neighbor sampling.
+///
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_blit_stretched_filtered(
+    const struct bj_bitmap* src, const struct bj_rect* src_area,
+    struct bj_bitmap* dst, const struct bj_rect* dst_area,
+    enum bj_blit_op op, enum bj_blit_filter filter);
+
+////////////////////////////////////////////////////////////////////////////////
+/// Affine bitmap blitting (rotation, scaling, shearing, translation).
+///
+/// \param src        The source bitmap.
+/// \param src_area   Optional area to copy from in the source bitmap (0 = full source).
+/// \param dst        The destination bitmap.
+/// \param transform  Maps source area coordinates to destination coordinates.
+/// \param op         The raster operation to apply (see  bj_blit_op).
+/// \param filter     The sampling filter (see \ref bj_blit_filter).
+/// \return           *BJ_TRUE* if a blit actually happened, *BJ_FALSE* otherwise.
+///
+/// Source coordinates are relative to the top-left corner of `src_area`, in
+/// pixels. A destination pixel is drawn when its center, mapped back through
+/// the inverse of `transform`, falls inside the source area. For example,
+/// to rotate a sprite around its center and place it at (x, y):
+///
+/// \code
+/// struct bj_mat3x2 to_center, rotation, placement, tmp, transform;
+/// bj_mat3x2_set_translation(&to_center, -w / 2, -h / 2);
+/// bj_mat3x2_set_rotation_z(&rotation, angle);
+/// bj_mat3x2_set_translation(&placement, x, y);
+/// bj_mat3x2_mul(&tmp, &rotation, &to_center);
+/// bj_mat3x2_mul(&transform, &placement, &tmp);
+/// bj_blit_transformed(sprite, 0, framebuffer, &transform, BJ_BLIT_OP_COPY, BJ_BLIT_FILTER_BILINEAR);
+/// \endcode
+///
+/// \par Clipping
+///
+/// Rows and spans are clipped exactly against the destination bounds and the
+/// source area: no pixel outside of `src_area` is ever read.
+///
+/// \par Sampling
+///
+/// `BJ_BLIT_FILTER_NEAREST` picks the source pixel under the mapped center.
+/// `BJ_BLIT_FILTER_BILINEAR` interpolates the four nearest source pixels,
+/// clamped at the edges of the source area. `BJ_BLIT_FILTER_BOX` is not
+/// supported for transforms and samples bilinearly. Texture coordinates are
+/// stepped in 16.16 fixed point.
+///
+/// \par Color Key and Alpha
+///
+/// With nearest sampling, color keying and raster operations behave as in
+/// \ref bj_blit. With bilinear sampling, the rules of
+/// \ref bj_blit_stretched_filtered apply.
+///
+/// A singular transform (zero determinant) draws nothing.
+///
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_blit_transformed(
+    const struct bj_bitmap* src, const struct bj_rect* src_area,
+    struct bj_bitmap* dst, const struct bj_mat3x2* transform,
+    enum bj_blit_op op, enum bj_blit_filter filter);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Mask background mode for masked blits (glyph/text rendering).
 ///
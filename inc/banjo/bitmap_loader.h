@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file bitmap_loader.h
+/// \brief Background loading of bitmap files
+////////////////////////////////////////////////////////////////////////////////
+/// \defgroup bitmap_loader Bitmap Loader
+/// \ingroup bitmap
+///
+/// Loads bitmap files on worker threads while the main loop keeps running.
+///
+/// Each load opens the file, decodes it like \ref bj_create_bitmap_from_file
+/// and optionally converts it to a given pixel mode, typically the one of the
+/// window framebuffer. Results are collected without blocking by polling the
+/// loader, usually once per frame.
+///
+/// Decoded bitmaps count against a memory budget until they are polled:
+/// workers wait before decoding a file that would exceed it. This bounds the
+/// memory held by loads in flight when the main loop falls behind.
+///
+/// Typical usage:
+/// - Create a loader with \ref bj_create_bitmap_loader.
+/// - Submit files with \ref bj_submit_bitmap_load.
+/// - Each frame, call \ref bj_poll_bitmap_loader until it returns
+///   \ref BJ_FALSE and take ownership of the loaded bitmaps.
+/// - Destroy the loader with \ref bj_destroy_bitmap_loader.
+///
+/// \{
+////////////////////////////////////////////////////////////////////////////////
+#ifndef BJ_BITMAP_LOADER_H
+#define BJ_BITMAP_LOADER_H
+
+#include <banjo/api.h>
+#include <banjo/bitmap.h>
+#include <banjo/error.h>
+#include <banjo/pixel.h>
+
+/// Opaque loader handle.
+struct bj_bitmap_loader;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Default memory budget of a loader, in bytes.
+///
+#define BJ_BITMAP_LOADER_BUDGET (64 * 1024 * 1024)
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief State of a bitmap load.
+///
+enum bj_bitmap_load_status {
+    BJ_BITMAP_LOAD_UNKNOWN   = 0x00, //!< Unknown identifier, or already polled
+    BJ_BITMAP_LOAD_QUEUED    = 0x01, //!< Waiting for a worker
+    BJ_BITMAP_LOAD_LOADING   = 0x02, //!< Being read and decoded by a worker
+    BJ_BITMAP_LOAD_DONE      = 0x03, //!< Loaded, waiting to be polled
+    BJ_BITMAP_LOAD_FAILED    = 0x04, //!< Failed, waiting to be polled
+    BJ_BITMAP_LOAD_CANCELLED = 0x05, //!< Cancelled, waiting to be polled
+};
+#ifndef BJ_NO_TYPEDEF
+typedef enum bj_bitmap_load_status bj_bitmap_load_status;
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Outcome of a bitmap load, returned by \ref bj_poll_bitmap_loader.
+///
+struct bj_bitmap_load {
+    uint32_t                   id;        ///< Identifier returned on submission.
+    enum bj_bitmap_load_status status;    ///< DONE, FAILED or CANCELLED.
+    struct bj_bitmap*          bitmap;    ///< Loaded bitmap when DONE, 0 otherwise.
+    struct bj_error*           error;     ///< Reason of the failure when FAILED, 0 otherwise.
+    void*                      user_data; ///< Pointer given on submission.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Create a bitmap loader and start its worker threads.
+///
+/// \param threads       Number of worker threads, or 0 for one less than the
+///                      number of hardware threads, between 1 and 4.
+/// \param memory_budget Bytes of decoded bitmaps allowed in flight, or 0 for
+///                      \ref BJ_BITMAP_LOADER_BUDGET.
+///
+/// \return A new loader, or *0* on failure.
+///
+/// On platforms without threads, the loader still works: each call to
+/// \ref bj_poll_bitmap_loader then loads one file on the calling thread.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_bitmap_loader* bj_create_bitmap_loader(
+    size_t threads,
+    size_t memory_budget
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Destroy a loader.
+///
+/// Queued loads are dropped and loads in progress are cancelled, then the
+/// worker threads are joined. Bitmaps not polled yet are destroyed.
+///
+/// \param loader The loader, or 0.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_destroy_bitmap_loader(
+    struct bj_bitmap_loader* loader
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Queue a bitmap file for loading.
+///
+/// \param loader    The loader.
+/// \param path      Path of the file. The string is copied.
+/// \param mode      Pixel mode to convert the bitmap to, or
+///                  \ref BJ_PIXEL_MODE_UNKNOWN to keep the decoded mode.
+/// \param user_data Pointer given back in the \ref bj_bitmap_load.
+///
+/// \return An identifier for the load, or 0 on failure. Identifiers are
+///         never reused by a loader.
+///
+/// Files are loaded in submission order, several at a time with more than
+/// one worker thread.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT uint32_t bj_submit_bitmap_load(
+    struct bj_bitmap_loader* loader,
+    const char*              path,
+    enum bj_pixel_mode       mode,
+    void*                    user_data
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Query the state of a load.
+///
+/// \param loader The loader.
+/// \param id     Identifier returned by \ref bj_submit_bitmap_load.
+///
+/// \return The state of the load, \ref BJ_BITMAP_LOAD_UNKNOWN once it has
+///         been polled.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT enum bj_bitmap_load_status bj_get_bitmap_load_status(
+    struct bj_bitmap_loader* loader,
+    uint32_t                 id
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Cancel a load.
+///
+/// A queued load is cancelled immediately. A load in progress is cancelled
+/// when its worker reaches the next step, and its bitmap is discarded.
+/// Either way, the load is still reported by \ref bj_poll_bitmap_loader, with
+/// the \ref BJ_BITMAP_LOAD_CANCELLED status.
+///
+/// \param loader The loader.
+/// \param id     Identifier returned by \ref bj_submit_bitmap_load.
+///
+/// \return \ref BJ_TRUE if the load was queued or in progress.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_cancel_bitmap_load(
+    struct bj_bitmap_loader* loader,
+    uint32_t                 id
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Take the next finished load, without waiting.
+///
+/// \param loader The loader.
+/// \param load   Receives the outcome of the load. The caller owns
+///               `load->bitmap` and `load->error`.
+///
+/// \return \ref BJ_TRUE if a load was taken, \ref BJ_FALSE if none has
+///         finished.
+///
+/// Loads are returned in the order they finish. Polling a bitmap gives its
+/// memory back to the budget of the loader.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_poll_bitmap_loader(
+    struct bj_bitmap_loader* loader,
+    struct bj_bitmap_load*   load
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Bytes currently charged to the memory budget of a loader.
+///
+/// \param loader The loader.
+///
+/// \return The memory held by loads being decoded and by loaded bitmaps not
+///         polled yet.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_bitmap_loader_memory(
+    struct bj_bitmap_loader* loader
+);
+
+#endif
+/// \} // End of bitmap_loader group
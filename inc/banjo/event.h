@@ -485,13 +485,14 @@ BANJO_EXPORT void bj_close_on_escape(
 /// \brief Push a custom event to the internal event queue.
 ///
 /// Typically used by the platform backend to post low-level events
-/// into the event processing system.
+/// into the event processing system, or by a headless event injector
+/// (see \ref bj_headless_event_fn) to simulate input.
 ///
 /// \param e Pointer to the event to push.
 ///
 /// \note The event is copied internally and queued for later dispatch.
 ///
-void bj_push_event(const struct bj_event* e);
+BANJO_EXPORT void bj_push_event(const struct bj_event* e);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Push a keyboard event into the event system.
@@ -503,7 +504,7 @@ void bj_push_event(const struct bj_event* e);
 /// \param action   The key event action (press, release, repeat).
 /// \param key      The key code that triggered the event.
 /// \param scancode The platform-specific scancode of the key.
-void bj_push_key_event(struct bj_window* window, enum bj_event_action action, enum bj_key key, int scancode);
+BANJO_EXPORT void bj_push_key_event(struct bj_window* window, enum bj_event_action action, enum bj_key key, int scancode);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Push a cursor movement event.
@@ -513,7 +514,7 @@ void bj_push_key_event(struct bj_window* window, enum bj_event_action action, en
 /// \param window Pointer to the window receiving the event.
 /// \param x        The new x-coordinate of the cursor.
 /// \param y        The new y-coordinate of the cursor.
-void bj_push_cursor_event(struct bj_window* window, int x, int y);
+BANJO_EXPORT void bj_push_cursor_event(struct bj_window* window, int x, int y);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Push a mouse button event.
@@ -525,7 +526,7 @@ void bj_push_cursor_event(struct bj_window* window, int x, int y);
 /// \param action   The action performed (press or release).
 /// \param x        The x-coordinate of the cursor at the event.
 /// \param y        The y-coordinate of the cursor at the event.
-void bj_push_button_event(struct bj_window* window, int button, enum bj_event_action action, int x, int y);
+BANJO_EXPORT void bj_push_button_event(struct bj_window* window, int button, enum bj_event_action action, int x, int y);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Push an enter or leave window event.
@@ -536,7 +537,7 @@ void bj_push_button_event(struct bj_window* window, int button, enum bj_event_ac
 /// \param enter    `BJ_TRUE` if cursor entered the window, `BJ_FALSE` if left.
 /// \param x        The x-coordinate of the cursor at the event.
 /// \param y        The y-coordinate of the cursor at the event.
-void bj_push_enter_event(struct bj_window* window, bj_bool enter, int x, int y);
+BANJO_EXPORT void bj_push_enter_event(struct bj_window* window, bj_bool enter, int x, int y);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Poll and dispatch all pending events.
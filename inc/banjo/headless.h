@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file headless.h
+/// \brief Offscreen video layer for benchmarks and automated tests
+////////////////////////////////////////////////////////////////////////////////
+/// \defgroup headless Headless Video
+/// \ingroup renderer
+///
+/// Video layer without any display.
+///
+/// The headless layer provides windows and renderers backed by plain
+/// bitmaps, so that full frame pipelines (drawing, \ref bj_present, event
+/// dispatch) run on machines without a display server.
+///
+/// It is selected automatically when no other video layer can start, or
+/// explicitly with `bj_set_video_layer("headless")` before \ref bj_begin.
+/// Input comes from a user-provided injector called once per frame,
+/// and presented frames can be written to disk.
+///
+/// The functions below only store settings: they can be called at any time,
+/// and have no effect when another video layer is active.
+///
+/// \{
+////////////////////////////////////////////////////////////////////////////////
+#ifndef BJ_HEADLESS_H
+#define BJ_HEADLESS_H
+
+#include <banjo/api.h>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Function type for synthetic event injection.
+///
+/// Called by the headless layer on the first event poll of each frame,
+/// typically from \ref bj_dispatch_events. The function queues events with
+/// \ref bj_push_key_event, \ref bj_push_cursor_event,
+/// \ref bj_push_button_event or \ref bj_push_enter_event, which are then
+/// dispatched as if they came from a real window system.
+///
+/// \param frame_index Number of frames presented since the layer started,
+///                    which lets a test script its input frame by frame.
+/// \param user_data   Pointer given to \ref bj_set_headless_event_injector.
+////////////////////////////////////////////////////////////////////////////////
+typedef void (*bj_headless_event_fn)(uint64_t frame_index, void* user_data);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Set the function injecting events into the headless layer.
+///
+/// \param injector  Function called once per frame, or *0* to inject
+///                  nothing.
+/// \param user_data Pointer passed back to `injector`.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_set_headless_event_injector(
+    bj_headless_event_fn injector,
+    void*                user_data
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Write every frame presented by the headless layer to disk.
+///
+/// Each \ref bj_present writes the whole framebuffer as a binary PPM file
+/// named `<path_prefix><index>.ppm`, where `index` is a six digit frame
+/// counter restarting at 0 on each call to this function.
+///
+/// \param path_prefix Prefix of the written files, including any directory,
+///                    or *0* to stop writing frames. The string is copied.
+///
+/// The setting is cleared when the headless layer ends, in \ref bj_end.
+///
+/// \note Writing frames is slow and meant for regression tests, not for
+///       benchmarks.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_set_headless_frame_dump(
+    const char* path_prefix
+);
+
+#endif
+/// \} // End of headless group
@@ -125,6 +125,33 @@ BANJO_EXPORT void bj_free(
     void* memory
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Allocate `size` bytes aligned on `alignment` bytes.
+///
+/// The memory comes from \ref bj_malloc, over-allocated to place the block
+/// on the requested boundary.
+///
+/// \param[in] size      Number of bytes to allocate.
+/// \param[in] alignment Alignment in bytes. Must be a power of two.
+///
+/// \return Pointer to the aligned memory block, or 0 on failure.
+///
+/// \note The block must be released with \ref bj_aligned_free.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void* bj_aligned_malloc(
+    size_t size,
+    size_t alignment
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Free a memory block allocated by \ref bj_aligned_malloc.
+///
+/// \param[in] memory Pointer to memory to free, or 0.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_aligned_free(
+    void* memory
+);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Set the global default memory allocators.
 ///
@@ -143,6 +170,294 @@ BANJO_EXPORT void bj_set_memory_defaults(
 ////////////////////////////////////////////////////////////////////////////////
 BANJO_EXPORT void bj_unset_memory_defaults(void);
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the global default memory allocators.
+///
+/// \param[out] allocator Receives the callbacks used by \ref bj_malloc.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_get_memory_defaults(
+    struct bj_memory_callbacks* allocator
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Linear allocator releasing all its allocations at once.
+///
+/// An arena hands out memory by moving an offset forward in large blocks,
+/// so allocating costs a few additions and individual allocations are
+/// never freed. Instead, the arena is rewound to a previous mark, or reset
+/// entirely, in constant time. Blocks are kept for reuse after a reset:
+/// an arena reaching its working size does not touch the heap anymore.
+///
+/// Arenas are not thread-safe. Each thread can use its own frame arena,
+/// see \ref bj_frame_allocate.
+///
+/// \see bj_create_arena
+////////////////////////////////////////////////////////////////////////////////
+struct bj_arena;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Create an arena.
+///
+/// The blocks of the arena are allocated with the default allocators set
+/// when the arena is created.
+///
+/// \param[in] block_size Size of the blocks of the arena in bytes, or 0
+///                       for a default size. Larger allocations get a
+///                       block of their own.
+///
+/// \return A new arena, or 0 on allocation failure.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_arena* bj_create_arena(
+    size_t block_size
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Destroy an arena and release all its memory.
+///
+/// \param[in] arena Arena to destroy, or 0.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_destroy_arena(
+    struct bj_arena* arena
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Allocate `size` bytes from an arena.
+///
+/// The memory is aligned for any type and lives until the arena is rewound
+/// before it, reset or destroyed.
+///
+/// \param[in] arena Arena to allocate from.
+/// \param[in] size  Number of bytes to allocate.
+///
+/// \return Pointer to the allocated memory, or 0 on allocation failure.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void* bj_arena_allocate(
+    struct bj_arena* arena,
+    size_t           size
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the current position of an arena.
+///
+/// \param[in] arena The arena.
+///
+/// \return A mark to give to \ref bj_rewind_arena.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_arena_mark(
+    const struct bj_arena* arena
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Release every allocation made after a mark.
+///
+/// \param[in] arena The arena.
+/// \param[in] mark  Position returned by \ref bj_arena_mark.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_rewind_arena(
+    struct bj_arena* arena,
+    size_t           mark
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Release every allocation of an arena.
+///
+/// The blocks are kept for the next allocations.
+///
+/// \param[in] arena The arena.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_reset_arena(
+    struct bj_arena* arena
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get memory callbacks allocating from an arena.
+///
+/// The callbacks can be given to \ref bj_set_memory_defaults, so that
+/// everything allocated by the library goes to the arena, for example while
+/// building temporary objects. Freeing memory only gives it back when it is
+/// the last allocation of the arena; reallocating the last allocation grows
+/// it in place.
+///
+/// \param[in]  arena     The arena.
+/// \param[out] callbacks Receives the callbacks.
+///
+/// \warning Objects allocated through these callbacks do not outlive a
+///          reset of the arena.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_arena_callbacks(
+    struct bj_arena*            arena,
+    struct bj_memory_callbacks* callbacks
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the frame arena of the calling thread.
+///
+/// Each thread has its own frame arena, created on first use. It holds
+/// scratch memory that only lives for the current frame.
+///
+/// \return The frame arena, or 0 on allocation failure.
+///
+/// \see bj_frame_allocate
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_arena* bj_frame_arena(void);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Allocate scratch memory for the current frame.
+///
+/// The memory comes from the frame arena of the calling thread and is
+/// released by the next \ref bj_reset_frame_memory on that thread.
+/// Nothing needs to be freed individually.
+///
+/// \param[in] size Number of bytes to allocate.
+///
+/// \return Pointer to the allocated memory, or 0 on allocation failure.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void* bj_frame_allocate(
+    size_t size
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Release the frame memory of the calling thread.
+///
+/// With \ref bj_call_main_callbacks, this is done after each call to the
+/// iterate callback. Other loops call it once per frame.
+///
+/// This also ends the current frame of the allocation statistics, see
+/// \ref bj_memory_stats.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_reset_frame_memory(void);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Destroy the frame arena of the calling thread.
+///
+/// Threads using \ref bj_frame_allocate call this before they end.
+/// \ref bj_end does it for the thread it runs on.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_release_frame_memory(void);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Allocation statistics.
+///
+/// Statistics are only collected by builds configured with
+/// `BANJO_CONFIG_MEMORY_STATS`. They cover the memory obtained through
+/// \ref bj_malloc, \ref bj_calloc and \ref bj_realloc, and the slabs the
+/// library allocates for its own small objects.
+///
+/// A frame ends with each call to \ref bj_reset_frame_memory.
+///
+/// \see bj_get_memory_stats
+////////////////////////////////////////////////////////////////////////////////
+struct bj_memory_stats {
+    bj_bool  enabled;                ///< Statistics are collected by this build.
+    size_t   live_bytes;             ///< Bytes currently allocated.
+    size_t   live_allocations;       ///< Blocks currently allocated.
+    size_t   peak_bytes;             ///< Highest value of `live_bytes`.
+    uint64_t allocations;            ///< Allocations since the start of the program.
+    size_t   frame_allocations;      ///< Allocations during the current frame.
+    size_t   frame_bytes;            ///< Bytes allocated during the current frame.
+    size_t   last_frame_allocations; ///< Allocations during the previous frame.
+    size_t   last_frame_bytes;       ///< Bytes allocated during the previous frame.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Allocation statistics of one call site.
+///
+/// Call sites are recorded when the caller is compiled with
+/// `BJ_CONFIG_MEMORY_STATS` defined, which turns \ref bj_malloc,
+/// \ref bj_calloc and \ref bj_realloc into macros capturing the file and
+/// line. Other calls are gathered under a site with a null `file`.
+////////////////////////////////////////////////////////////////////////////////
+struct bj_memory_call_site {
+    const char* file;        ///< Source file of the call, or 0 if unknown.
+    int         line;        ///< Line of the call.
+    uint64_t    allocations; ///< Allocations made at this site.
+    uint64_t    bytes;       ///< Bytes allocated at this site.
+    size_t      live_bytes;  ///< Bytes from this site still allocated.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the allocation statistics.
+///
+/// \param[out] stats Receives the statistics. Only `enabled` is set,
+///                   to \ref BJ_FALSE, when the build collects none.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_get_memory_stats(
+    struct bj_memory_stats* stats
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the call sites allocating the most bytes.
+///
+/// \param[out] sites    Receives the call sites, by decreasing total bytes.
+/// \param[in]  capacity Number of entries in `sites`.
+///
+/// \return The number of entries written.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_get_memory_call_sites(
+    struct bj_memory_call_site* sites,
+    size_t                      capacity
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Log the allocation statistics and the busiest call sites.
+///
+/// Messages are written with the info level.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_dump_memory_stats(void);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief \ref bj_malloc recording the call site.
+///
+/// \param[in] size Number of bytes to allocate.
+/// \param[in] file Source file of the call.
+/// \param[in] line Line of the call.
+///
+/// \return Pointer to newly allocated memory block.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void* bj_malloc_at(
+    size_t      size,
+    const char* file,
+    int         line
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief \ref bj_calloc recording the call site.
+///
+/// \param[in] size Number of bytes to allocate.
+/// \param[in] file Source file of the call.
+/// \param[in] line Line of the call.
+///
+/// \return Pointer to newly allocated zeroed memory block.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void* bj_calloc_at(
+    size_t      size,
+    const char* file,
+    int         line
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief \ref bj_realloc recording the call site.
+///
+/// \param[in] memory Pointer to previously allocated memory.
+/// \param[in] size   Number of bytes to allocate.
+/// \param[in] file   Source file of the call.
+/// \param[in] line   Line of the call.
+///
+/// \return Pointer to newly reallocated memory block.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void* bj_realloc_at(
+    void*       memory,
+    size_t      size,
+    const char* file,
+    int         line
+);
+
+#ifdef BJ_CONFIG_MEMORY_STATS
+#   define bj_malloc(size)          bj_malloc_at((size), __FILE__, __LINE__)
+#   define bj_calloc(size)          bj_calloc_at((size), __FILE__, __LINE__)
+#   define bj_realloc(memory, size) bj_realloc_at((memory), (size), __FILE__, __LINE__)
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Copy `mem_size` bytes from `src` to `dest`.
 ///
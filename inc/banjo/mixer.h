@@ -0,0 +1,271 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file mixer.h
+/// \brief Multi-voice software audio mixer
+////////////////////////////////////////////////////////////////////////////////
+/// \defgroup mixer Mixer
+/// \ingroup audio
+///
+/// Software mixer playing many sounds on a single audio device.
+///
+/// A mixer owns a fixed pool of voices. Each voice plays either a PCM sound
+/// or a generator function, with its own gain, stereo pan and pitch. Voices
+/// are summed in floating point and converted once to the device format.
+///
+/// Typical usage:
+/// - Create a mixer with \ref bj_create_mixer.
+/// - Open a device with \ref bj_mixer_callback as callback and the mixer
+///   as user data.
+/// - Start voices with \ref bj_mixer_play_sound or
+///   \ref bj_mixer_play_generator and control them from any thread.
+/// - Close the device, then call \ref bj_destroy_mixer.
+///
+/// \{
+////////////////////////////////////////////////////////////////////////////////
+#ifndef BJ_MIXER_H
+#define BJ_MIXER_H
+
+#include <banjo/api.h>
+#include <banjo/audio.h>
+
+/// Opaque mixer handle.
+struct bj_mixer;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief PCM data played by a mixer voice.
+///
+/// The samples are not copied and must stay valid while a voice plays them.
+///
+/// A sound loops when `loop_end` is greater than `loop_start`: playback
+/// starts at frame 0 and jumps back to `loop_start` each time it reaches
+/// `loop_end`. Otherwise the voice stops after the last frame.
+////////////////////////////////////////////////////////////////////////////////
+struct bj_mixer_sound {
+    const void*          samples;     ///< Interleaved samples.
+    size_t               frames;      ///< Number of frames in `samples`.
+    enum bj_audio_format format;      ///< BJ_AUDIO_FORMAT_INT16 or BJ_AUDIO_FORMAT_F32.
+    unsigned int         channels;    ///< 1 (mono) or 2 (stereo).
+    unsigned int         sample_rate; ///< Rate the sound was authored at (Hz).
+    size_t               loop_start;  ///< First frame of the loop.
+    size_t               loop_end;    ///< Frame after the loop, 0 to play once.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Function generating samples for a mixer voice.
+///
+/// Called from the audio thread while the mixer is locked: it must be fast
+/// and must not call other mixer functions.
+///
+/// \param samples     Receives `frames` mono samples in [-1, 1].
+/// \param frames      Number of frames to generate.
+/// \param sample_rate Output sample rate (Hz).
+/// \param user_data   Pointer given to \ref bj_mixer_play_generator.
+///
+/// \return BJ_TRUE to keep playing, BJ_FALSE to stop the voice after these
+///         samples.
+////////////////////////////////////////////////////////////////////////////////
+typedef bj_bool (*bj_mixer_generator_fn)(
+    float*       samples,
+    unsigned     frames,
+    unsigned int sample_rate,
+    void*        user_data
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Create a mixer.
+///
+/// \param voice_count Maximum number of simultaneous voices, up to 65535.
+///
+/// \return A new mixer, or *0* on failure.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_mixer* bj_create_mixer(
+    size_t voice_count
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Destroy a mixer.
+///
+/// The device using the mixer must be closed first.
+///
+/// \param mixer Mixer to destroy.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_destroy_mixer(
+    struct bj_mixer* mixer
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Mix all playing voices into an output buffer.
+///
+/// Advances every voice by `frames`. Mono and stereo INT16 and F32 outputs
+/// are supported. Other outputs are filled with silence.
+///
+/// \param mixer  The mixer.
+/// \param buffer Receives `frames` interleaved frames in the output format.
+/// \param frames Number of frames to mix.
+/// \param audio  Output format, channel count and sample rate.
+///
+/// \see bj_mixer_callback
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_mix(
+    struct bj_mixer*                  mixer,
+    void*                             buffer,
+    unsigned                          frames,
+    const struct bj_audio_properties* audio
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Audio callback running a mixer.
+///
+/// Can be used as a bj_audio_callback_fn with a struct bj_mixer as user data.
+///
+/// \param buffer            Output buffer to write samples into.
+/// \param frames            Number of frames to generate.
+/// \param audio             Audio device properties.
+/// \param user_data         Pointer to a struct bj_mixer.
+/// \param base_sample_index Unused.
+///
+/// \see bj_mix
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_mixer_callback(
+    void*                             buffer,
+    unsigned                          frames,
+    const struct bj_audio_properties* audio,
+    void*                             user_data,
+    uint64_t                          base_sample_index
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Start playing a sound on a free voice.
+///
+/// \param mixer The mixer.
+/// \param sound Sound to play. The structure is copied, the samples are not.
+/// \param gain  Linear gain, 1 for the original level.
+/// \param pan   Stereo position, from -1 (left) to 1 (right).
+///
+/// \return A voice handle, or 0 if the sound is invalid or all voices are
+///         busy.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT uint32_t bj_mixer_play_sound(
+    struct bj_mixer*             mixer,
+    const struct bj_mixer_sound* sound,
+    float                        gain,
+    float                        pan
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Start playing a generator on a free voice.
+///
+/// Generators produce samples at the output rate: the voice pitch does not
+/// apply to them.
+///
+/// \param mixer     The mixer.
+/// \param generator Function producing the samples.
+/// \param user_data Pointer passed to `generator`.
+/// \param gain      Linear gain, 1 for the original level.
+/// \param pan       Stereo position, from -1 (left) to 1 (right).
+///
+/// \return A voice handle, or 0 if all voices are busy.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT uint32_t bj_mixer_play_generator(
+    struct bj_mixer*      mixer,
+    bj_mixer_generator_fn generator,
+    void*                 user_data,
+    float                 gain,
+    float                 pan
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Stop a voice.
+///
+/// Handles of voices that already stopped are ignored, even if the voice
+/// slot has been reused since.
+///
+/// \param mixer The mixer.
+/// \param voice Handle returned when the voice started.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_mixer_stop(
+    struct bj_mixer* mixer,
+    uint32_t         voice
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Stop all voices.
+///
+/// \param mixer The mixer.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_mixer_stop_all(
+    struct bj_mixer* mixer
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Query whether a voice is still playing.
+///
+/// \param mixer The mixer.
+/// \param voice Handle returned when the voice started.
+///
+/// \return BJ_TRUE while the voice plays, BJ_FALSE once it stopped.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_mixer_voice_playing(
+    struct bj_mixer* mixer,
+    uint32_t         voice
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Change the gain of a playing voice.
+///
+/// \param mixer The mixer.
+/// \param voice Handle returned when the voice started.
+/// \param gain  Linear gain, 1 for the original level.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_mixer_set_gain(
+    struct bj_mixer* mixer,
+    uint32_t         voice,
+    float            gain
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Change the stereo position of a playing voice.
+///
+/// Panning keeps a constant power: a centered voice plays at about 0.707
+/// on each side. On mono outputs, the pan is ignored.
+///
+/// \param mixer The mixer.
+/// \param voice Handle returned when the voice started.
+/// \param pan   Stereo position, from -1 (left) to 1 (right).
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_mixer_set_pan(
+    struct bj_mixer* mixer,
+    uint32_t         voice,
+    float            pan
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Change the playback speed of a sound voice.
+///
+/// Samples between source frames are linearly interpolated.
+///
+/// \param mixer The mixer.
+/// \param voice Handle returned when the voice started.
+/// \param pitch Speed factor, 1 for the original pitch, 2 for one octave up.
+///              Clamped to [1/256, 256].
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_mixer_set_pitch(
+    struct bj_mixer* mixer,
+    uint32_t         voice,
+    float            pitch
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Change the gain applied to the sum of all voices.
+///
+/// The mixed signal is clipped to the output range after this gain.
+///
+/// \param mixer The mixer.
+/// \param gain  Linear gain, 1 by default.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_mixer_set_master_gain(
+    struct bj_mixer* mixer,
+    float            gain
+);
+
+#endif
+/// \} // End of mixer group
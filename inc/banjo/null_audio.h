@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file null_audio.h
+/// \brief Audio layer without sound output, for benchmarks and tests
+////////////////////////////////////////////////////////////////////////////////
+/// \defgroup null_audio Null Audio
+/// \ingroup audio
+///
+/// Audio layer without any sound card.
+///
+/// The null layer runs the device callback from its own thread like any
+/// other backend, so that audio code (callbacks, mixers, synthesizers)
+/// runs on machines without audio hardware. The produced samples are
+/// discarded, or written to a WAVE file.
+///
+/// It is selected automatically when no other audio layer can start, or
+/// explicitly with `bj_set_audio_layer("null")` before \ref bj_begin.
+/// Devices open with exactly the requested properties.
+///
+/// The functions below only store settings used by the next call to
+/// \ref bj_open_audio_device: they can be called at any time, and have no
+/// effect when another audio layer is active.
+///
+/// \{
+////////////////////////////////////////////////////////////////////////////////
+#ifndef BJ_NULL_AUDIO_H
+#define BJ_NULL_AUDIO_H
+
+#include <banjo/api.h>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Speed at which the null layer calls the device callback.
+////////////////////////////////////////////////////////////////////////////////
+enum bj_null_audio_pacing {
+    BJ_NULL_AUDIO_REALTIME, ///< As a sound card would, at the sample rate (default).
+    BJ_NULL_AUDIO_OFFLINE,  ///< As fast as possible, to render or benchmark.
+};
+#ifndef BJ_NO_TYPEDEF
+typedef enum bj_null_audio_pacing bj_null_audio_pacing;
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Set the pacing of the devices opened by the null layer.
+///
+/// In offline mode, the callback runs back to back with no wait between
+/// periods, which measures how many frames per second it can produce.
+///
+/// \param pacing      Real-time or offline pacing.
+/// \param frame_limit Number of frames after which the device pauses
+///                    itself, or *0* to play until paused or closed.
+///                    \ref bj_audio_playing returns BJ_FALSE once the limit
+///                    is reached.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_set_null_audio_pacing(
+    enum bj_null_audio_pacing pacing,
+    uint64_t                  frame_limit
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Write the output of the null layer devices to a WAVE file.
+///
+/// The file is created when the device opens and completed when it closes.
+/// Only the frames produced while the device plays are written, so that
+/// the content does not depend on when the device was started.
+///
+/// \param path Path of the written file, or *0* to discard the output.
+///             The string is copied.
+///
+/// The setting is cleared when the null audio layer ends, in \ref bj_end.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_set_null_audio_output(
+    const char* path
+);
+
+#endif
+/// \} // End of null_audio group
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file oscillator.h
+/// \brief Band-limited audio oscillators
+////////////////////////////////////////////////////////////////////////////////
+/// \defgroup oscillator Oscillators
+/// \ingroup audio
+///
+/// Periodic waveform generators rendering blocks of float samples.
+///
+/// An oscillator is a small value type holding a fixed-point phase
+/// accumulator: generating a sample costs a few arithmetic operations, with
+/// no trigonometry or division in the loop. Square and sawtooth waves are
+/// band-limited with PolyBLEP corrections, which removes most of the
+/// aliasing heard on high notes.
+///
+/// Oscillators can be played by a \ref mixer through
+/// \ref bj_oscillator_generator, one voice per note.
+///
+/// \{
+////////////////////////////////////////////////////////////////////////////////
+#ifndef BJ_OSCILLATOR_H
+#define BJ_OSCILLATOR_H
+
+#include <banjo/api.h>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Waveform produced by an oscillator.
+////////////////////////////////////////////////////////////////////////////////
+enum bj_oscillator_shape {
+    BJ_OSCILLATOR_SINE,     ///< Sine wave.
+    BJ_OSCILLATOR_SQUARE,   ///< Square wave, high on the first half period.
+    BJ_OSCILLATOR_TRIANGLE, ///< Triangle wave.
+    BJ_OSCILLATOR_SAWTOOTH, ///< Rising sawtooth wave.
+};
+#ifndef BJ_NO_TYPEDEF
+typedef enum bj_oscillator_shape bj_oscillator_shape;
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief State of an oscillator.
+///
+/// Initialize with \ref bj_init_oscillator. Fields can be read freely;
+/// change the frequency with \ref bj_set_oscillator_frequency.
+////////////////////////////////////////////////////////////////////////////////
+struct bj_oscillator {
+    enum bj_oscillator_shape shape;       ///< Waveform.
+    uint32_t                 phase;       ///< Position in the period, 2^32 for a full period.
+    uint32_t                 increment;   ///< Phase advance per sample.
+    float                    frequency;   ///< Frequency (Hz).
+    float                    amplitude;   ///< Peak value of the output.
+    unsigned int             sample_rate; ///< Rate `increment` is computed for (Hz).
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Initialize an oscillator at the start of its period.
+///
+/// \param oscillator  Oscillator to initialize.
+/// \param shape       Waveform.
+/// \param frequency   Frequency (Hz), below half the sample rate.
+/// \param amplitude   Peak value of the output.
+/// \param sample_rate Output sample rate (Hz).
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_init_oscillator(
+    struct bj_oscillator*    oscillator,
+    enum bj_oscillator_shape shape,
+    float                    frequency,
+    float                    amplitude,
+    unsigned int             sample_rate
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Change the frequency of an oscillator.
+///
+/// The phase is kept, so the waveform stays continuous.
+///
+/// \param oscillator The oscillator.
+/// \param frequency  New frequency (Hz).
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_set_oscillator_frequency(
+    struct bj_oscillator* oscillator,
+    float                 frequency
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Generate the next samples of an oscillator.
+///
+/// \param oscillator The oscillator, advanced by `frames` samples.
+/// \param samples    Receives `frames` mono samples.
+/// \param frames     Number of samples to generate.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_render_oscillator(
+    struct bj_oscillator* oscillator,
+    float*                samples,
+    size_t                frames
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Mixer generator playing an oscillator.
+///
+/// Can be used as a bj_mixer_generator_fn with a struct bj_oscillator as
+/// user data. The oscillator follows the mixer output rate.
+///
+/// \param samples     Receives `frames` mono samples.
+/// \param frames      Number of samples to generate.
+/// \param sample_rate Output sample rate (Hz).
+/// \param user_data   Pointer to a struct bj_oscillator.
+///
+/// \return Always BJ_TRUE: the voice plays until stopped.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_oscillator_generator(
+    float*       samples,
+    unsigned     frames,
+    unsigned int sample_rate,
+    void*        user_data
+);
+
+#endif
+/// \} // End of oscillator group
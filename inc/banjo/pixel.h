@@ -22,6 +22,8 @@ enum bj_pixel_mode {
     BJ_PIXEL_MODE_XRGB1555  = 0x01000210u, //!< 16bpp 555-RGB
     BJ_PIXEL_MODE_RGB565    = 0x01020210u, //!< 16bpp 565-RGB
     BJ_PIXEL_MODE_XRGB8888  = 0x01010220u, //!< 32bpp RGB
+    BJ_PIXEL_MODE_ARGB8888  = 0x05010220u, //!< 32bpp RGB with straight alpha
+    BJ_PIXEL_MODE_ARGB8888_PREMUL = 0x09010220u, //!< 32bpp RGB with premultiplied alpha
 
     BJ_PIXEL_MODE_BGR24     = 0x02000318u, //!< 24bpp BGR
 };
@@ -56,6 +58,8 @@ BANJO_EXPORT void bj_make_pixel_rgb(
 /// \param blue     The blue component of the color
 /// \return         An opaque `uint32_t` value.
 ///
+/// For modes with an alpha channel, the returned pixel is fully opaque.
+///
 ////////////////////////////////////////////////////////////////////////////////
 BANJO_EXPORT uint32_t bj_get_pixel_value(
     enum bj_pixel_mode mode, 
@@ -64,6 +68,53 @@ BANJO_EXPORT uint32_t bj_get_pixel_value(
     uint8_t blue
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// Gets the RGBA value of a pixel given its 32-bits representation.
+///
+/// \param mode  The pixel mode
+/// \param value The opaque pixel value
+/// \param red   A location to the red component
+/// \param green A location to the green component
+/// \param blue  A location to the blue component
+/// \param alpha A location to the alpha component
+///
+/// Modes without an alpha channel report an alpha of 255.
+/// For \ref BJ_PIXEL_MODE_ARGB8888_PREMUL, color components are returned as
+/// stored, that is premultiplied by alpha.
+///
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_make_pixel_rgba(
+    enum bj_pixel_mode mode,
+    uint32_t      value,
+    uint8_t*      red,
+    uint8_t*      green,
+    uint8_t*      blue,
+    uint8_t*      alpha
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns an opaque value representing a pixel color, given its RGBA composition.
+///
+/// \param mode     The pixel mode
+/// \param red      The red component of the color
+/// \param green    The green component of the color
+/// \param blue     The blue component of the color
+/// \param alpha    The alpha component of the color
+/// \return         An opaque `uint32_t` value.
+///
+/// `alpha` is ignored by modes without an alpha channel.
+/// For \ref BJ_PIXEL_MODE_ARGB8888_PREMUL, color components are stored as
+/// given: the caller provides premultiplied values.
+///
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT uint32_t bj_get_pixel_value_rgba(
+    enum bj_pixel_mode mode,
+    uint8_t red,
+    uint8_t green,
+    uint8_t blue,
+    uint8_t alpha
+);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Determine the most suitable bj_pixel_mode from a set of masks.
 ///
@@ -134,6 +185,8 @@ BANJO_EXPORT size_t bj_compute_bitmap_stride(
 #define BJ_PIXEL_ORDER_RGBA 0x07
 /// Pixel order: Blue-Green-Red-Alpha (BGRA).
 #define BJ_PIXEL_ORDER_BGRA 0x08
+/// Pixel order: Same as BJ_PIXEL_ORDER_ARGB with color premultiplied by alpha.
+#define BJ_PIXEL_ORDER_ARGB_PREMUL 0x09
 
 /// Pixel layout: 16-bit with 1-bit alpha, 5-bit red, green, and blue (1555).
 #define BJ_PIXEL_LAYOUT_1555 0x00
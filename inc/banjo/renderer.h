@@ -15,6 +15,7 @@
 /// - Configure it for a window using \ref bj_renderer_configure.
 /// - Access the framebuffer with \ref bj_get_framebuffer.
 /// - Draw to the framebuffer using bitmap operations.
+/// - Optionally mark the changed areas with \ref bj_renderer_mark_dirty.
 /// - Present the result with \ref bj_present.
 /// - Clean up with \ref bj_destroy_renderer.
 ///
@@ -25,6 +26,7 @@
 
 #include <banjo/api.h>
 #include <banjo/error.h>
+#include <banjo/rect.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Renderer backend type.
@@ -38,6 +40,20 @@ enum bj_renderer_type {
 typedef enum bj_renderer_type bj_renderer_type;
 #endif
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Presentation counters of a renderer.
+///
+/// Filled by \ref bj_get_present_stats. Byte counts are the framebuffer
+/// bytes actually pushed to the window, so frames presented through
+/// \ref bj_renderer_mark_dirty count only their dirty rectangles.
+////////////////////////////////////////////////////////////////////////////////
+struct bj_present_stats {
+    uint64_t frame_count;     ///< Frames presented since creation or reset.
+    uint64_t total_bytes;     ///< Bytes presented over these frames.
+    size_t   last_bytes;      ///< Bytes presented by the last frame.
+    size_t   last_rect_count; ///< Rectangles presented by the last frame.
+};
+
 /// Opaque renderer handle.
 struct bj_bitmap;
 /// Opaque renderer handle.
@@ -145,13 +161,72 @@ BANJO_EXPORT struct bj_bitmap* bj_get_framebuffer(
 /// This function should be called after all drawing operations are complete
 /// to display the final result on the window.
 ///
-/// \see bj_get_framebuffer
+/// The copy may complete asynchronously when the framebuffer is shared with
+/// the display server (MIT-SHM on X11). In that case, \ref bj_get_framebuffer
+/// and \ref bj_dispatch_events wait until the server is done with the
+/// previous frame, so drawing should start after either of them.
+///
+/// When areas were marked with \ref bj_renderer_mark_dirty since the last
+/// call, only these areas are presented on backends that support it (X11).
+/// Otherwise the whole framebuffer is presented.
+///
+/// \see bj_get_framebuffer, bj_renderer_mark_dirty
 ////////////////////////////////////////////////////////////////////////////////
 BANJO_EXPORT void bj_present(
     struct bj_renderer* renderer,
     struct bj_window*   window
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Mark a framebuffer area as changed for the next present.
+///
+/// Marked areas accumulate until the next call to \ref bj_present, which
+/// then only pushes these areas to the window. Overlapping or touching areas
+/// are merged, and the set is kept to a few rectangles by folding the
+/// closest ones together, so the presented area may be slightly larger
+/// than what was marked.
+///
+/// \param renderer Pointer to the renderer.
+/// \param area     Changed area in framebuffer pixels, clipped to the
+///                 framebuffer. Pass *0* to mark the whole framebuffer.
+///
+/// \par Behavior
+///
+/// If nothing is marked between two presents, the whole framebuffer is
+/// presented, so code unaware of dirty tracking keeps working.
+/// Reconfiguring the renderer discards the marked areas.
+///
+/// \see bj_present, bj_get_present_stats
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_renderer_mark_dirty(
+    struct bj_renderer*   renderer,
+    const struct bj_rect* area
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Retrieve the presentation counters of a renderer.
+///
+/// \param renderer Pointer to the renderer.
+/// \param stats    Receives the counters.
+///
+/// \see bj_reset_present_stats
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_get_present_stats(
+    const struct bj_renderer* renderer,
+    struct bj_present_stats*  stats
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Reset the presentation counters of a renderer to zero.
+///
+/// \param renderer Pointer to the renderer.
+///
+/// \see bj_get_present_stats
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_reset_present_stats(
+    struct bj_renderer* renderer
+);
+
 
 #endif
 /// \} // End of renderer group
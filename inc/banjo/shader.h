@@ -15,6 +15,11 @@
 /// Such function is passed to \ref bj_shader_bitmap which calls the
 /// shader fonction on every pixel of the bitmap.
 ///
+/// For heavier effects, \ref bj_shader_bitmap_span calls a
+/// \ref bj_bitmap_span_shading_fn once per row with arrays of coordinates
+/// and colors, which avoids one call per pixel and lets the compiler
+/// vectorize the shader.
+///
 /// Useful math-related functions can be found in \ref math.h.
 ///
 /// \{
@@ -41,6 +46,39 @@
 ////////////////////////////////////////////////////////////////////////////////
 typedef int (*bj_bitmap_shading_fn)(struct bj_vec3* out_color, const struct bj_vec2 pixel_coord, void* user_data);
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief One row of pixels passed to a span shader.
+///
+/// Colors are stored as separate arrays (structure of arrays), so a shader
+/// can process them with plain loops that the compiler is able to vectorize.
+///
+/// On entry, `red`, `green` and `blue` hold the current pixel colors in the
+/// _[0.0, 1.0]_ range. The shader overwrites them with the output colors.
+/// Pixel `i` of the row is at coordinates (`x[i]`, `y`), transformed by the
+/// same \ref bj_shader_flag as for \ref bj_shader_bitmap.
+////////////////////////////////////////////////////////////////////////////////
+struct bj_shader_span {
+    size_t         count; ///< Number of pixels in the row.
+    bj_real        y;     ///< Y coordinate shared by all pixels of the row.
+    const bj_real* x;     ///< X coordinate of each pixel.
+    bj_real*       red;   ///< Red component of each pixel.
+    bj_real*       green; ///< Green component of each pixel.
+    bj_real*       blue;  ///< Blue component of each pixel.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Function type for a row-at-a-time shading operation.
+///
+/// A span shader is provided to \ref bj_shader_bitmap_span and is called
+/// once for each row of the bitmap.
+///
+/// \param span      The row to shade.
+/// \param user_data Optional user data passed through from
+///                  \ref bj_shader_bitmap_span.
+/// \return _1_ to write the row back, _0_ to leave it unchanged.
+////////////////////////////////////////////////////////////////////////////////
+typedef int (*bj_bitmap_span_shading_fn)(struct bj_shader_span* span, void* user_data);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Shader input control flags
 ///
@@ -127,6 +165,19 @@ enum bj_shader_flag {
     ////////////////////////////////////////////////////////////////////////////////
     BJ_SHADER_CENTER_COORDS    = 0x10,
 
+    ////////////////////////////////////////////////////////////////////////////////
+    /// \brief Run the shader on several threads.
+    ///
+    /// The bitmap is split into bands of rows, which are shaded concurrently
+    /// by a pool of worker threads and the calling thread.
+    /// The number of threads is set by \ref bj_set_shader_thread_count.
+    ///
+    /// With this flag, the shader function is called from several threads at
+    /// once and in no particular order. It must not modify shared state
+    /// (including `user_data`) without synchronization.
+    ////////////////////////////////////////////////////////////////////////////////
+    BJ_SHADER_PARALLEL         = 0x20,
+
 };
 #ifndef BJ_NO_TYPEDEF
 typedef enum bj_shader_flag bj_shader_flag;
@@ -164,5 +215,55 @@ BANJO_EXPORT void bj_shader_bitmap(
     uint8_t                flags
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Applies a span shader to every row of a bitmap.
+///
+/// This is the batch counterpart of \ref bj_shader_bitmap: instead of one
+/// call per pixel, the shader receives a whole row at once (see
+/// \ref bj_shader_span). Coordinates are precomputed according to `flags`,
+/// which have the same meaning as for \ref bj_shader_bitmap, including
+/// \ref BJ_SHADER_PARALLEL.
+///
+/// \param bitmap Pointer to the target bitmap to be modified.
+/// \param shader A pointer to the span shader to call per row.
+/// \param data User-defined data passed to each shader call.
+/// \param flags Combination of  bj_shader_flag controlling coordinate
+///        and color behavior.
+/// \return \ref BJ_TRUE once every row went through the shader,
+///         \ref BJ_FALSE if the row buffers could not be allocated. Some
+///         rows, or all of them, are then left unchanged.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_shader_bitmap_span(
+    struct bj_bitmap*         bitmap,
+    bj_bitmap_span_shading_fn shader,
+    void*                     data,
+    uint8_t                   flags
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Sets the number of threads used by parallel shading.
+///
+/// This applies to \ref bj_shader_bitmap and \ref bj_shader_bitmap_span
+/// calls using \ref BJ_SHADER_PARALLEL.
+/// The count includes the calling thread, so _1_ disables threading.
+/// _0_ (the default) uses one thread per hardware thread.
+///
+/// Worker threads are started on the first parallel call after the count
+/// changed, and are stopped by \ref bj_end.
+///
+/// \param count Number of threads, or _0_ for the hardware thread count.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_set_shader_thread_count(
+    size_t count
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Returns the number of threads used by parallel shading.
+///
+/// \return The count set with \ref bj_set_shader_thread_count, or the number
+///         of hardware threads when it is _0_.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_shader_thread_count(void);
+
 #endif
 /// \} // End of bitmap group
@@ -61,13 +61,103 @@ BANJO_EXPORT struct bj_stream* bj_open_stream_read(
 /// \param error Optional error object
 /// \return A pointer to an error object
 ///
-/// The file memory is entirely copied to internal memory buffer.
+/// On POSIX systems and Windows, regular files are mapped read-only in
+/// memory: pages are loaded from the page cache on first access and no copy
+/// is made. Other files are entirely copied to an internal memory buffer.
+/// Either way, the content is available through \ref bj_get_stream_data.
+///
+/// \see bj_open_stream_file_buffered to read large files by chunks.
 ////////////////////////////////////////////////////////////////////////////////
 BANJO_EXPORT struct bj_stream* bj_open_stream_file(
     const char*       path,
     struct bj_error**        error
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Default read-ahead size of \ref bj_open_stream_file_buffered.
+///
+#define BJ_STREAM_BUFFER_SIZE (64 * 1024)
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Creates a new struct bj_stream reading a file by chunks.
+///
+/// \param path        The file path to open
+/// \param buffer_size Size of the read-ahead buffer, in bytes, or 0 for
+///                    \ref BJ_STREAM_BUFFER_SIZE
+/// \param error       Optional error object
+/// \return A pointer to the newly created struct bj_stream object, or 0 on
+///         failure.
+///
+/// Only the size of the file is queried when opening: content is read on
+/// demand, `buffer_size` bytes at a time, when the stream is read or peeked.
+/// Seeking only moves the position. The memory cost of the stream is its
+/// buffer, whatever the size of the file, which suits large asset packs and
+/// audio streamed from disk.
+///
+/// Reads larger than the buffer go straight to the destination. Peeks larger
+/// than the buffer grow it to the requested size.
+///
+/// The content is not held in memory as a whole: \ref bj_get_stream_data
+/// returns 0 for such a stream.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_stream* bj_open_stream_file_buffered(
+    const char*       path,
+    size_t            buffer_size,
+    struct bj_error** error
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Creates a new struct bj_stream for writing to memory.
+///
+/// \param data     Buffer receiving the written bytes, or 0 to let the stream
+///                 allocate and grow its own buffer.
+/// \param capacity Size of `data` in bytes, or the initial size of the
+///                 buffer of the stream if `data` is 0.
+/// \return A pointer to the newly created struct bj_stream object.
+///
+/// Writes past the end of a provided buffer are truncated. An owned buffer
+/// grows as needed instead.
+///
+/// The length of the stream is the end of the furthest write. The written
+/// bytes are available through \ref bj_get_stream_data and can be read back
+/// with \ref bj_read_stream after seeking.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_stream* bj_open_stream_write(
+    void*  data,
+    size_t capacity
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Creates a new struct bj_stream writing to a file.
+///
+/// \param path  The file path to create or truncate
+/// \param error Optional error object
+/// \return A pointer to the newly created struct bj_stream object, or 0 on
+///         failure.
+///
+/// Writes are buffered by \ref BJ_STREAM_BUFFER_SIZE bytes and the file is
+/// complete once the stream is flushed or closed. Errors such as a full disk
+/// may only show up then: call \ref bj_flush_stream before closing to
+/// detect them. The stream cannot be read or peeked,
+/// and \ref bj_get_stream_data returns 0.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_stream* bj_open_stream_file_write(
+    const char*       path,
+    struct bj_error** error
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the memory holding the content of a stream.
+///
+/// \param stream Pointer to the struct bj_stream object.
+/// \return A pointer to the first byte of the stream, or 0 for an empty
+///         stream or a stream opened with \ref bj_open_stream_file_buffered.
+///         The memory is read-only and valid until the stream is closed.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT const void* bj_get_stream_data(
+    const struct bj_stream* stream
+);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Deletes a struct bj_stream object and releases associated memory.
 ///
@@ -100,6 +190,76 @@ BANJO_EXPORT size_t bj_read_stream(
     size_t count
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Writes data from a source buffer to the stream.
+///
+/// \param stream Pointer to the stream instance.
+/// \param src    Pointer to the bytes to write.
+/// \param count  Number of bytes to write.
+/// \return Number of bytes actually written.
+///
+/// Bytes are written at the current position, overwriting what is there,
+/// and the position advances past them. Fewer than `count` bytes are written
+/// when a provided buffer is full, on I/O errors and always 0 on streams not
+/// opened for writing.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_write_stream(
+    struct bj_stream* stream,
+    const void*       src,
+    size_t            count
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Writes buffered bytes of a stream to its file.
+///
+/// \param stream Pointer to the stream instance.
+/// \return \ref BJ_FALSE if bytes written to a file stream could not all be
+///         stored, \ref BJ_TRUE otherwise.
+///
+/// Only streams opened with \ref bj_open_stream_file_write buffer writes.
+/// On other streams, the function does nothing and returns \ref BJ_TRUE.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT bj_bool bj_flush_stream(
+    struct bj_stream* stream
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Borrows the next bytes of the stream without copying them.
+///
+/// \param stream Pointer to the stream instance.
+/// \param count  Number of bytes wanted.
+/// \param data   Receives a pointer to the bytes at the current position.
+/// \return Number of bytes available at `*data`, less than `count` only at
+///         the end of the stream.
+///
+/// The position is not changed: call \ref bj_consume_stream once the bytes
+/// are used. The pointer is read-only and stays valid until the next
+/// operation on the stream.
+///
+/// Parsers use this instead of \ref bj_read_stream to decode directly from
+/// the memory of the stream, without an intermediate copy.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_peek_stream(
+    struct bj_stream* stream,
+    size_t            count,
+    const void**      data
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Advances the stream position past borrowed bytes.
+///
+/// \param stream Pointer to the stream instance.
+/// \param count  Number of bytes to skip.
+/// \return Number of bytes actually skipped, less than `count` only at the
+///         end of the stream.
+///
+/// \see bj_peek_stream
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_consume_stream(
+    struct bj_stream* stream,
+    size_t            count
+);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Get the size of the stream.
 ///
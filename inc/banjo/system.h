@@ -84,6 +84,42 @@ BANJO_EXPORT void bj_end_system(
     struct bj_error** error
 );
 
+////////////////////////////////////////////////////////////////////////////////
+/// Restricts the video layer chosen by the next video initialization.
+///
+/// \param name Name of the video layer to use (for example "x11", "win32" or
+///             "headless"), or _0_ to try every available layer in order.
+///
+/// By default, \ref bj_begin tries each layer compiled in and keeps the first
+/// that starts, the headless layer coming last. With a name set, only the
+/// matching layer is tried and the initialization fails if it is not
+/// available. The setting does not affect an already running video system.
+///
+/// The string is not copied and must outlive the next initialization.
+///
+/// \see bj_begin, bj_begin_system
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_set_video_layer(
+    const char* name
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// Restricts the audio layer chosen by the next audio initialization.
+///
+/// \param name Name of the audio layer to use (for example "alsa", "mme" or
+///             "null"), or _0_ to try every available layer in order.
+///
+/// Works as \ref bj_set_video_layer does for video: the null layer comes
+/// last, and with a name set only the matching layer is tried.
+///
+/// The string is not copied and must outlive the next initialization.
+///
+/// \see bj_begin, bj_begin_system
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_set_audio_layer(
+    const char* name
+);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Load the provided dynamic library and returns and opaque handle to it.
 ///
@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file wav.h
+/// \brief Streaming WAVE file decoder
+////////////////////////////////////////////////////////////////////////////////
+/// \defgroup wav WAVE Decoder
+/// \ingroup audio
+///
+/// Incremental decoding of WAVE audio from a \ref bj_stream.
+///
+/// The decoder reads the stream a few kilobytes at a time, so its memory use
+/// does not depend on the length of the track. Supported encodings are
+/// 16-bit PCM, 32-bit float and IMA ADPCM, with any number of channels.
+/// PCM and ADPCM data decode to \ref BJ_AUDIO_FORMAT_INT16, float data to
+/// \ref BJ_AUDIO_FORMAT_F32.
+///
+/// Typical usage for background music:
+/// - Open the file with \ref bj_open_stream_file and \ref bj_open_wav.
+/// - Create an audio ring with \ref bj_wav_properties and open the device
+///   with \ref bj_audio_ring_callback.
+/// - Call \ref bj_read_wav_to_ring once per frame to keep the ring full.
+///
+/// \{
+////////////////////////////////////////////////////////////////////////////////
+#ifndef BJ_WAV_H
+#define BJ_WAV_H
+
+#include <banjo/api.h>
+#include <banjo/audio.h>
+#include <banjo/error.h>
+#include <banjo/stream.h>
+
+/// Opaque WAVE decoder.
+struct bj_wav;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Open a WAVE decoder on a stream.
+///
+/// Parses the RIFF header and leaves the stream at the first audio frame.
+/// The decoder reads from `stream` until it is closed, so the stream must
+/// stay open and must not be read from elsewhere meanwhile.
+///
+/// \param stream Stream containing a WAVE file.
+/// \param error  Optional error object.
+///
+/// \return A new decoder, or *0* if the data is invalid or unsupported.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT struct bj_wav* bj_open_wav(
+    struct bj_stream* stream,
+    struct bj_error** error
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Close a WAVE decoder.
+///
+/// The stream given to \ref bj_open_wav is not closed.
+///
+/// \param wav Decoder to close.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT void bj_close_wav(
+    struct bj_wav* wav
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the format of the decoded frames.
+///
+/// \param wav The decoder.
+///
+/// \return Format, channel count and sample rate of \ref bj_read_wav output.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT const struct bj_audio_properties* bj_wav_properties(
+    const struct bj_wav* wav
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the length of the track.
+///
+/// \param wav The decoder.
+///
+/// \return Number of frames in the file.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_wav_frames(
+    const struct bj_wav* wav
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Decode the next frames.
+///
+/// \param wav    The decoder.
+/// \param buffer Receives up to `frames` interleaved frames in the format
+///               given by \ref bj_wav_properties.
+/// \param frames Maximum number of frames to decode.
+///
+/// \return Number of frames decoded, less than `frames` only at the end of
+///         the track.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_read_wav(
+    struct bj_wav* wav,
+    void*          buffer,
+    size_t         frames
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Move to a frame of the track.
+///
+/// For IMA ADPCM files, the block containing `frame` is decoded again.
+///
+/// \param wav   The decoder.
+/// \param frame Index of the next frame to decode, clamped to the length.
+///
+/// \return The new position, in frames.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_seek_wav(
+    struct bj_wav* wav,
+    size_t         frame
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the position of the decoder.
+///
+/// \param wav The decoder.
+///
+/// \return Index of the next frame \ref bj_read_wav returns.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_tell_wav(
+    const struct bj_wav* wav
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Decode frames into an audio ring until it is full.
+///
+/// Meant to be called regularly from the thread owning the decoder while
+/// the audio device reads the ring through \ref bj_audio_ring_callback.
+/// The ring acts as the buffer between decoding and playback: its capacity
+/// sets both the memory used and how long playback survives without a call.
+///
+/// The ring must have been created with the properties returned by
+/// \ref bj_wav_properties.
+///
+/// \param wav  The decoder.
+/// \param ring Ring to fill.
+/// \param loop BJ_TRUE to restart from the first frame at the end of the
+///             track.
+///
+/// \return Number of frames written to the ring.
+////////////////////////////////////////////////////////////////////////////////
+BANJO_EXPORT size_t bj_read_wav_to_ring(
+    struct bj_wav*        wav,
+    struct bj_audio_ring* ring,
+    bj_bool               loop
+);
+
+#endif
+/// \} // End of wav group
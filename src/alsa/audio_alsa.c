@@ -13,6 +13,7 @@
 #include <banjo/system.h>
 #include <banjo/time.h>
 
+#include <atomic.h>
 #include <audio.h>
 #include <check.h>
 #include <audio_layer.h>
@@ -30,6 +31,8 @@ struct alsa_device {
 };
 
 typedef int(*pfn_snd_pcm_hw_params_any)(snd_pcm_t*, snd_pcm_hw_params_t*);
+typedef int(*pfn_snd_pcm_hw_params_get_buffer_size)(const snd_pcm_hw_params_t*, snd_pcm_uframes_t*);
+typedef int(*pfn_snd_pcm_hw_params_get_period_size)(const snd_pcm_hw_params_t*, snd_pcm_uframes_t*, int*);
 typedef int(*pfn_snd_pcm_hw_params_malloc)(snd_pcm_hw_params_t**);
 typedef int(*pfn_snd_pcm_hw_params)(snd_pcm_t*, snd_pcm_hw_params_t*);
 typedef int(*pfn_snd_pcm_hw_params_set_access)(snd_pcm_t*, snd_pcm_hw_params_t*, snd_pcm_access_t);
@@ -45,6 +48,7 @@ typedef int(*pfn_snd_pcm_drain)(snd_pcm_t*);
 typedef snd_pcm_sframes_t(*pfn_snd_pcm_avail_update)(snd_pcm_t*);
 typedef int(*pfn_snd_pcm_prepare)(snd_pcm_t*);
 typedef snd_pcm_sframes_t(*pfn_snd_pcm_writei)(snd_pcm_t*, const void*, snd_pcm_uframes_t);
+typedef int(*pfn_snd_pcm_wait)(snd_pcm_t*, int);
 typedef const char*(*pfn_snd_strerror)(int);
 typedef uint16_t(*pfn_snd_pcm_format_silence_16)(snd_pcm_format_t);
 typedef uint32_t(*pfn_snd_pcm_format_silence_32)(snd_pcm_format_t);
@@ -55,6 +59,8 @@ static struct alsa_lib_t {
     pfn_snd_pcm_hw_params                      snd_pcm_hw_params;
     pfn_snd_pcm_hw_params_any                  snd_pcm_hw_params_any;
     pfn_snd_pcm_hw_params_free                 snd_pcm_hw_params_free;
+    pfn_snd_pcm_hw_params_get_buffer_size      snd_pcm_hw_params_get_buffer_size;
+    pfn_snd_pcm_hw_params_get_period_size      snd_pcm_hw_params_get_period_size;
     pfn_snd_pcm_hw_params_malloc               snd_pcm_hw_params_malloc;
     pfn_snd_pcm_hw_params_set_access           snd_pcm_hw_params_set_access;
     pfn_snd_pcm_hw_params_set_buffer_size_near snd_pcm_hw_params_set_buffer_size_near;
@@ -68,6 +74,7 @@ static struct alsa_lib_t {
     pfn_snd_pcm_prepare                        snd_pcm_prepare;
     pfn_snd_pcm_avail_update                   snd_pcm_avail_update;
     pfn_snd_pcm_writei                         snd_pcm_writei;
+    pfn_snd_pcm_wait                           snd_pcm_wait;
     pfn_snd_strerror                           snd_strerror;
     pfn_snd_pcm_format_silence_16              snd_pcm_format_silence_16;
     pfn_snd_pcm_format_silence_32              snd_pcm_format_silence_32;
@@ -117,6 +124,8 @@ static bj_bool alsa_load_library(struct bj_error** p_error) {
     ALSA_BIND(snd_pcm_hw_params)
     ALSA_BIND(snd_pcm_hw_params_any)
     ALSA_BIND(snd_pcm_hw_params_free)
+    ALSA_BIND(snd_pcm_hw_params_get_buffer_size)
+    ALSA_BIND(snd_pcm_hw_params_get_period_size)
     ALSA_BIND(snd_pcm_hw_params_malloc)
     ALSA_BIND(snd_pcm_hw_params_set_access)
     ALSA_BIND(snd_pcm_hw_params_set_buffer_size_near)
@@ -126,6 +135,7 @@ static bj_bool alsa_load_library(struct bj_error** p_error) {
     ALSA_BIND(snd_pcm_hw_params_set_rate_near)
     ALSA_BIND(snd_pcm_open)
     ALSA_BIND(snd_pcm_prepare)
+    ALSA_BIND(snd_pcm_wait)
     ALSA_BIND(snd_pcm_writei)
     ALSA_BIND(snd_strerror)
 #undef ALSA_BIND
@@ -134,6 +144,10 @@ static bj_bool alsa_load_library(struct bj_error** p_error) {
 }
 
 
+// Upper bound of a wait for free space, which is also the longest time
+// bj_close_audio_device() waits for the thread to notice the request
+#define ALSA_WAIT_TIMEOUT_MS 100
+
 static void* playback_thread(void* p_data) {
     struct alsa_device* p_device        = (struct alsa_device*)p_data;
     snd_pcm_t* pcm_handle               = p_device->p_handle;
@@ -142,18 +156,17 @@ static void* playback_thread(void* p_data) {
 
     uint64_t global_sample_index = 0;
 
-    while (p_device->common.should_close == BJ_FALSE) {
+    while (bj_atomic_load_u32(&p_device->common.should_close) == BJ_FALSE) {
 
-        if(p_device->common.should_reset == BJ_TRUE) {
+        if(bj_atomic_exchange_u32(&p_device->common.should_reset, BJ_FALSE) == BJ_TRUE) {
             global_sample_index = 0;
-            p_device->common.should_reset = BJ_FALSE;
         }
 
         snd_pcm_sframes_t avail = ALSA.snd_pcm_avail_update(pcm_handle);
 
         if (avail < 0) {
             if (avail == -EPIPE) {
-                bj_err("underrun!");
+                bj_atomic_add_u32(&p_device->common.underruns, 1);
                 ALSA.snd_pcm_prepare(pcm_handle);
                 continue;
             } else {
@@ -162,39 +175,47 @@ static void* playback_thread(void* p_data) {
             }
         }
 
-        if ((snd_pcm_uframes_t)avail >= frames_per_period) {
-            if (p_device->common.playing == BJ_TRUE) {
-                // Generate audio normally
-                p_device->common.callback(
-                    buffer,
-                    (unsigned)frames_per_period,
-                    &p_device->common.properties,
-                    p_device->common.callback_user_data,
-                    global_sample_index
-                );
-            } else {
-                const size_t bytes_per_sample =
-                    BJ_AUDIO_FORMAT_WIDTH(p_device->common.properties.format) / 8; // <-- divide by 8
-
-                for (size_t s = 0; s < frames_per_period * p_device->common.properties.channels; ++s) {
-                    bj_memcpy(buffer + s * bytes_per_sample, &p_device->common.silence, bytes_per_sample);
+        if ((snd_pcm_uframes_t)avail < frames_per_period) {
+            // Sleeps until a period is free instead of polling
+            const int ready = ALSA.snd_pcm_wait(pcm_handle, ALSA_WAIT_TIMEOUT_MS);
+            if (ready < 0) {
+                if (ready == -EPIPE) {
+                    bj_atomic_add_u32(&p_device->common.underruns, 1);
                 }
-            }
-
-            snd_pcm_sframes_t err = ALSA.snd_pcm_writei(pcm_handle, buffer, frames_per_period);
-            if (err == -EPIPE) {
-                bj_err("write underrun!");
                 ALSA.snd_pcm_prepare(pcm_handle);
-            } else if (err < 0) {
-                bj_err("write error: %s", ALSA.snd_strerror((int)err));
-                break;
             }
+            continue;
+        }
 
-            if (p_device->common.playing) {
-                global_sample_index += frames_per_period;
-            }
+        const bj_bool playing = bj_atomic_load_u32(&p_device->common.playing);
+        if (playing == BJ_TRUE) {
+            // Generate audio normally
+            bj_audio_device_fill(
+                &p_device->common,
+                buffer,
+                (unsigned)frames_per_period,
+                global_sample_index
+            );
         } else {
-            usleep(100); // Small sleep to avoid busy-looping
+            const size_t bytes_per_sample =
+                BJ_AUDIO_FORMAT_WIDTH(p_device->common.properties.format) / 8; // <-- divide by 8
+
+            for (size_t s = 0; s < frames_per_period * p_device->common.properties.channels; ++s) {
+                bj_memcpy(buffer + s * bytes_per_sample, &p_device->common.silence, bytes_per_sample);
+            }
+        }
+
+        snd_pcm_sframes_t err = ALSA.snd_pcm_writei(pcm_handle, buffer, frames_per_period);
+        if (err == -EPIPE) {
+            bj_atomic_add_u32(&p_device->common.underruns, 1);
+            ALSA.snd_pcm_prepare(pcm_handle);
+        } else if (err < 0) {
+            bj_err("write error: %s", ALSA.snd_strerror((int)err));
+            break;
+        }
+
+        if (playing == BJ_TRUE) {
+            global_sample_index += frames_per_period;
         }
     }
 
@@ -249,9 +270,13 @@ static struct bj_audio_device* alsa_open_device(
     alsa_dev->common.properties.channels    = p_properties ? p_properties->channels : 1;
     alsa_dev->common.properties.sample_rate = p_properties ? p_properties->sample_rate : BJ_AUDIO_SAMPLE_RATE;
     
-    alsa_dev->frames_per_period      = 512;
+    const unsigned int period_frames = p_properties && p_properties->period_frames
+        ? p_properties->period_frames : BJ_AUDIO_PERIOD_FRAMES;
+    const unsigned int period_count = p_properties && p_properties->period_count >= 2
+        ? p_properties->period_count : BJ_AUDIO_PERIOD_COUNT;
 
-    snd_pcm_uframes_t total_frames = alsa_dev->frames_per_period * 4;
+    alsa_dev->frames_per_period    = period_frames;
+    snd_pcm_uframes_t total_frames = (snd_pcm_uframes_t)period_frames * period_count;
 
     int alsa_err = ALSA.snd_pcm_open(&alsa_dev->p_handle, "default", SND_PCM_STREAM_PLAYBACK, 0);
     if(alsa_err < 0) {
@@ -281,12 +306,21 @@ static struct bj_audio_device* alsa_open_device(
         alsa_close_device((struct bj_audio_device*)alsa_dev);
         return 0;
     }
+
+    // The hardware rounds the sizes to what it supports
+    ALSA.snd_pcm_hw_params_get_period_size(params, &alsa_dev->frames_per_period, 0);
+    ALSA.snd_pcm_hw_params_get_buffer_size(params, &total_frames);
     ALSA.snd_pcm_hw_params_free(params);
 
+    alsa_dev->common.properties.period_frames = (unsigned int)alsa_dev->frames_per_period;
+    alsa_dev->common.properties.period_count  = alsa_dev->frames_per_period > 0
+        ? (unsigned int)(total_frames / alsa_dev->frames_per_period) : 0;
+
     bj_info("format: %d", alsa_dev->common.properties.format);
     bj_info("amplitude: %d", alsa_dev->common.properties.amplitude);
     bj_info("channels: %d", alsa_dev->common.properties.channels);
     bj_info("sample_rate: %d", alsa_dev->common.properties.sample_rate);
+    bj_info("period: %u frames x %u", alsa_dev->common.properties.period_frames, alsa_dev->common.properties.period_count);
 
     ssize_t format_byte_size_s = ALSA.snd_pcm_format_size(alsa_format, 1);
     bj_assert(format_byte_size_s > 0);
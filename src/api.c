@@ -34,12 +34,24 @@
 #   define BJ_HAS_COCOA_BACKEND 0
 #endif
 
+#ifdef BJ_CONFIG_HEADLESS_BACKEND
+#   define BJ_HAS_HEADLESS_BACKEND 1
+#else
+#   define BJ_HAS_HEADLESS_BACKEND 0
+#endif
+
 #ifdef BJ_CONFIG_MME_BACKEND
 #   define BJ_HAS_MME_BACKEND 1
 #else
 #   define BJ_HAS_MME_BACKEND 0
 #endif
 
+#ifdef BJ_CONFIG_NULL_AUDIO_BACKEND
+#   define BJ_HAS_NULL_AUDIO_BACKEND 1
+#else
+#   define BJ_HAS_NULL_AUDIO_BACKEND 0
+#endif
+
 #ifdef BJ_CONFIG_ALSA_BACKEND
 #   define BJ_HAS_ALSA_BACKEND 1
 #else
@@ -64,6 +76,12 @@
 #   define BJ_HAS_LOG_COLOR 0
 #endif
 
+#ifdef BJ_CONFIG_MEMORY_STATS
+#   define BJ_HAS_MEMORY_STATS 1
+#else
+#   define BJ_HAS_MEMORY_STATS 0
+#endif
+
 #ifdef BJ_CONFIG_PEDANTIC
 #   define BJ_HAS_PEDANTIC 1
 #else
@@ -90,7 +108,9 @@ const struct bj_build_info* bj_build_information(void) {
         .backend_alsa       = BJ_HAS_ALSA_BACKEND,
         .backend_cocoa      = BJ_HAS_COCOA_BACKEND,
         .backend_emscripten = BJ_HAS_EMSCRIPTEN_BACKEND,
+        .backend_headless   = BJ_HAS_HEADLESS_BACKEND,
         .backend_mme        = BJ_HAS_MME_BACKEND,
+        .backend_null_audio = BJ_HAS_NULL_AUDIO_BACKEND,
         .backend_win32      = BJ_HAS_WIN32_BACKEND,
         .backend_x11        = BJ_HAS_X11_BACKEND,
 
@@ -99,6 +119,7 @@ const struct bj_build_info* bj_build_information(void) {
         .checks_log   = BJ_HAS_CHECKS_LOG,
         .fastmath     = BJ_HAS_FASTMATH,
         .log_color    = BJ_HAS_LOG_COLOR,
+        .memory_stats = BJ_HAS_MEMORY_STATS,
         .pedantic     = BJ_HAS_PEDANTIC,
     };
 
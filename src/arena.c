@@ -0,0 +1,268 @@
+// arena.c - Linear allocators.
+//
+// An arena is a chain of blocks. Allocations move the offset of the last
+// block forward; when it is full, a new block is chained after it.
+// Positions (marks) count bytes since the start of the arena: each block
+// starts at the position where the previous one ends, so a mark identifies
+// both a block and an offset in it.
+//
+// Rewinding moves the blocks after the mark to a spare list, from which
+// later blocks are taken before allocating new ones.
+
+#include <banjo/memory.h>
+
+#include <check.h>
+#include <memory_stats.h>
+#include <thread.h>
+
+#define ARENA_ALIGNMENT    16
+#define ARENA_BLOCK_SIZE   (64 * 1024)
+#define ARENA_ROUND(size)  (((size) + (ARENA_ALIGNMENT - 1)) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+struct arena_block {
+    struct arena_block* previous;
+    size_t              base;     // Position of the first byte of the block
+    size_t              capacity;
+    size_t              used;
+    size_t              site;     // Call site in the statistics
+};
+
+#define ARENA_HEADER ARENA_ROUND(sizeof(struct arena_block))
+
+// Largest request whose rounded size, block header and callback header
+// (arena_malloc) do not overflow size_t
+#define ARENA_MAX_SIZE (SIZE_MAX - ARENA_HEADER - 2 * ARENA_ALIGNMENT)
+
+struct bj_arena {
+    struct bj_memory_callbacks allocator; // Source of the blocks
+    struct arena_block*        current;
+    struct arena_block*        spare;
+    size_t                     block_size;
+    size_t                     site;      // Call site in the statistics
+};
+
+static unsigned char* block_data(struct arena_block* block) {
+    return (unsigned char*)block + ARENA_HEADER;
+}
+
+struct bj_arena* bj_create_arena(
+    size_t block_size
+) {
+    struct bj_memory_callbacks allocator;
+    bj_get_memory_defaults(&allocator);
+
+    struct bj_arena* arena = allocator.fn_allocation(allocator.user_data, sizeof(struct bj_arena));
+    if (arena == 0) {
+        return 0;
+    }
+    arena->site       = bj_stats_allocated(__FILE__, __LINE__, sizeof(struct bj_arena));
+    arena->allocator  = allocator;
+    arena->current    = 0;
+    arena->spare      = 0;
+    arena->block_size = ARENA_ROUND(block_size > 0 ? block_size : ARENA_BLOCK_SIZE);
+    return arena;
+}
+
+static void free_blocks(struct bj_arena* arena, struct arena_block* block) {
+    while (block != 0) {
+        struct arena_block* previous = block->previous;
+        bj_stats_freed(block->site, ARENA_HEADER + block->capacity);
+        arena->allocator.fn_free(arena->allocator.user_data, block);
+        block = previous;
+    }
+}
+
+void bj_destroy_arena(
+    struct bj_arena* arena
+) {
+    if (arena == 0) {
+        return;
+    }
+    free_blocks(arena, arena->current);
+    free_blocks(arena, arena->spare);
+    bj_stats_freed(arena->site, sizeof(struct bj_arena));
+    arena->allocator.fn_free(arena->allocator.user_data, arena);
+}
+
+// Chains a block of at least `size` bytes after the current one, reusing
+// a spare block when one is large enough
+static struct arena_block* push_block(struct bj_arena* arena, size_t size) {
+    struct arena_block** link  = &arena->spare;
+    struct arena_block*  block = arena->spare;
+    while (block != 0 && block->capacity < size) {
+        link  = &block->previous;
+        block = block->previous;
+    }
+
+    if (block != 0) {
+        *link = block->previous;
+    } else {
+        const size_t capacity = size > arena->block_size ? size : arena->block_size;
+        block = arena->allocator.fn_allocation(arena->allocator.user_data, ARENA_HEADER + capacity);
+        if (block == 0) {
+            return 0;
+        }
+        block->capacity = capacity;
+        block->site     = bj_stats_allocated(__FILE__, __LINE__, ARENA_HEADER + capacity);
+    }
+
+    block->base     = arena->current ? arena->current->base + arena->current->capacity : 0;
+    block->used     = 0;
+    block->previous = arena->current;
+    arena->current  = block;
+    return block;
+}
+
+void* bj_arena_allocate(
+    struct bj_arena* arena,
+    size_t           size
+) {
+    bj_check_or_0(arena);
+    if (size > ARENA_MAX_SIZE) {
+        return 0;
+    }
+    size = ARENA_ROUND(size);
+
+    struct arena_block* block = arena->current;
+    if (block == 0 || block->capacity - block->used < size) {
+        block = push_block(arena, size);
+        if (block == 0) {
+            return 0;
+        }
+    }
+
+    void* memory = block_data(block) + block->used;
+    block->used += size;
+    return memory;
+}
+
+size_t bj_arena_mark(
+    const struct bj_arena* arena
+) {
+    bj_check_or_0(arena);
+    return arena->current ? arena->current->base + arena->current->used : 0;
+}
+
+void bj_rewind_arena(
+    struct bj_arena* arena,
+    size_t           mark
+) {
+    bj_check(arena);
+    while (arena->current != 0 && arena->current->base > mark) {
+        struct arena_block* block = arena->current;
+        arena->current  = block->previous;
+        block->previous = arena->spare;
+        arena->spare    = block;
+    }
+    if (arena->current != 0 && mark - arena->current->base < arena->current->used) {
+        arena->current->used = mark - arena->current->base;
+    }
+}
+
+void bj_reset_arena(
+    struct bj_arena* arena
+) {
+    bj_rewind_arena(arena, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Memory callbacks
+//
+// Each allocation is preceded by its size, which reallocations need.
+
+static void* arena_malloc(void* user_data, size_t size) {
+    if (size > ARENA_MAX_SIZE - ARENA_ALIGNMENT) {
+        return 0;
+    }
+    size_t* header = bj_arena_allocate((struct bj_arena*)user_data, ARENA_ALIGNMENT + size);
+    if (header == 0) {
+        return 0;
+    }
+    *header = size;
+    return (unsigned char*)header + ARENA_ALIGNMENT;
+}
+
+// Whether `memory` is the last allocation of the arena
+static bj_bool is_last(struct bj_arena* arena, void* memory) {
+    struct arena_block* block = arena->current;
+    const size_t size = *(size_t*)((unsigned char*)memory - ARENA_ALIGNMENT);
+    return block != 0 && (unsigned char*)memory + ARENA_ROUND(size) == block_data(block) + block->used;
+}
+
+static void* arena_realloc(void* user_data, void* original, size_t size) {
+    struct bj_arena* arena = (struct bj_arena*)user_data;
+    if (original == 0) {
+        return arena_malloc(arena, size);
+    }
+
+    if (size > ARENA_MAX_SIZE - ARENA_ALIGNMENT) {
+        return 0;
+    }
+
+    size_t* header = (size_t*)((unsigned char*)original - ARENA_ALIGNMENT);
+    if (is_last(arena, original)) {
+        struct arena_block* block = arena->current;
+        const size_t start = (size_t)((unsigned char*)original - block_data(block));
+        if (start + ARENA_ROUND(size) <= block->capacity) {
+            block->used = start + ARENA_ROUND(size);
+            *header     = size;
+            return original;
+        }
+    }
+
+    void* memory = arena_malloc(arena, size);
+    if (memory != 0) {
+        bj_memcpy(memory, original, *header < size ? *header : size);
+    }
+    return memory;
+}
+
+static void arena_free(void* user_data, void* memory) {
+    struct bj_arena* arena = (struct bj_arena*)user_data;
+    if (memory != 0 && is_last(arena, memory)) {
+        arena->current->used = (size_t)((unsigned char*)memory - ARENA_ALIGNMENT - block_data(arena->current));
+    }
+}
+
+void bj_arena_callbacks(
+    struct bj_arena*            arena,
+    struct bj_memory_callbacks* callbacks
+) {
+    bj_check(arena);
+    bj_check(callbacks);
+    callbacks->user_data       = arena;
+    callbacks->fn_allocation   = arena_malloc;
+    callbacks->fn_reallocation = arena_realloc;
+    callbacks->fn_free         = arena_free;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Frame memory
+
+static BJ_THREAD_LOCAL struct bj_arena* s_frame_arena = 0;
+
+struct bj_arena* bj_frame_arena(void) {
+    if (s_frame_arena == 0) {
+        s_frame_arena = bj_create_arena(0);
+    }
+    return s_frame_arena;
+}
+
+void* bj_frame_allocate(
+    size_t size
+) {
+    struct bj_arena* arena = bj_frame_arena();
+    return arena ? bj_arena_allocate(arena, size) : 0;
+}
+
+void bj_reset_frame_memory(void) {
+    bj_end_memory_frame();
+    if (s_frame_arena != 0) {
+        bj_reset_arena(s_frame_arena);
+    }
+}
+
+void bj_release_frame_memory(void) {
+    bj_destroy_arena(s_frame_arena);
+    s_frame_arena = 0;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <banjo/api.h>
+
+// ============================================================================
+// ATOMICS - internal
+// ============================================================================
+// Minimal C99 atomics for state shared with audio and worker threads.
+// Loads have acquire and stores have release semantics: data written before
+// a store is visible to a thread that loads the stored value.
+// GCC and Clang use their __atomic builtins, MSVC uses Interlocked intrinsics.
+// ============================================================================
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+#include <intrin.h>
+
+static inline uint32_t bj_atomic_load_u32(const volatile uint32_t* value) {
+    return (uint32_t)_InterlockedOr((volatile long*)value, 0);
+}
+
+static inline void bj_atomic_store_u32(volatile uint32_t* value, uint32_t desired) {
+    _InterlockedExchange((volatile long*)value, (long)desired);
+}
+
+static inline uint32_t bj_atomic_exchange_u32(volatile uint32_t* value, uint32_t desired) {
+    return (uint32_t)_InterlockedExchange((volatile long*)value, (long)desired);
+}
+
+static inline uint32_t bj_atomic_add_u32(volatile uint32_t* value, uint32_t delta) {
+    return (uint32_t)_InterlockedExchangeAdd((volatile long*)value, (long)delta) + delta;
+}
+
+static inline void* bj_atomic_load_ptr(void* const volatile* value) {
+    return _InterlockedCompareExchangePointer((void* volatile*)value, 0, 0);
+}
+
+static inline void bj_atomic_store_ptr(void* volatile* value, void* desired) {
+    _InterlockedExchangePointer(value, desired);
+}
+
+#if defined(_WIN64)
+static inline size_t bj_atomic_load_size(const volatile size_t* value) {
+    return (size_t)_InterlockedOr64((volatile __int64*)value, 0);
+}
+
+static inline void bj_atomic_store_size(volatile size_t* value, size_t desired) {
+    _InterlockedExchange64((volatile __int64*)value, (__int64)desired);
+}
+#else
+static inline size_t bj_atomic_load_size(const volatile size_t* value) {
+    return (size_t)_InterlockedOr((volatile long*)value, 0);
+}
+
+static inline void bj_atomic_store_size(volatile size_t* value, size_t desired) {
+    _InterlockedExchange((volatile long*)value, (long)desired);
+}
+#endif
+
+#else
+
+static inline uint32_t bj_atomic_load_u32(const volatile uint32_t* value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void bj_atomic_store_u32(volatile uint32_t* value, uint32_t desired) {
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t bj_atomic_exchange_u32(volatile uint32_t* value, uint32_t desired) {
+    return __atomic_exchange_n(value, desired, __ATOMIC_ACQ_REL);
+}
+
+static inline uint32_t bj_atomic_add_u32(volatile uint32_t* value, uint32_t delta) {
+    return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+}
+
+static inline void* bj_atomic_load_ptr(void* const volatile* value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void bj_atomic_store_ptr(void* volatile* value, void* desired) {
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+static inline size_t bj_atomic_load_size(const volatile size_t* value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void bj_atomic_store_size(volatile size_t* value, size_t desired) {
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+#endif
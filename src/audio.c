@@ -1,7 +1,13 @@
 #include <banjo/assert.h>
+#include <banjo/log.h>
 #include <banjo/math.h>
+#include <banjo/memory.h>
+#include <banjo/oscillator.h>
+#include <banjo/string.h>
+#include <banjo/system.h>
 
 #include "audio_layer.h"
+#include <atomic.h>
 #include <audio.h>
 
 #include <check.h>
@@ -10,6 +16,15 @@ extern struct bj_audio_layer_create_info alsa_audio_layer_info;
 extern struct bj_audio_layer_create_info mme_audio_layer_info;
 extern struct bj_audio_layer_create_info emscripten_audio_layer_info;
 extern struct bj_audio_layer_create_info coreaudio_audio_layer_info;
+extern struct bj_audio_layer_create_info null_audio_layer_info;
+
+static const char* s_audio_layer_name = 0;
+
+void bj_set_audio_layer(
+    const char* name
+) {
+    s_audio_layer_name = name;
+}
 
 bj_bool bj_begin_audio(
     struct bj_audio_layer* vt,
@@ -27,6 +42,9 @@ bj_bool bj_begin_audio(
 #endif
 #ifdef BJ_CONFIG_ALSA_BACKEND
         &alsa_audio_layer_info,
+#endif
+#ifdef BJ_CONFIG_NULL_AUDIO_BACKEND
+        &null_audio_layer_info,
 #endif
     };
 
@@ -36,6 +54,10 @@ bj_bool bj_begin_audio(
         struct bj_error* sub_err = 0;
 
         const struct bj_audio_layer_create_info* p_create_info = layer_infos[b];
+        if (s_audio_layer_name != 0 && bj_strcmp(s_audio_layer_name, p_create_info->name) != 0) {
+            continue;
+        }
+
         const bj_bool success = p_create_info->create(vt, &sub_err);
 
         // s_audio = p_create_info->create(&sub_err);
@@ -62,25 +84,191 @@ bj_bool bj_begin_audio(
 
 extern struct bj_audio_layer s_audio;
 
+// Frames requested from the user callback at once when converting rates
+#define RATE_CONVERTER_CHUNK 256
+
+// Sits between the backend and the user callback when the device opened at
+// another rate than requested. The user callback generates chunks at the
+// requested rate, which are resampled to the device rate.
+struct audio_rate_converter {
+    struct bj_resampler*       resampler;
+    struct bj_audio_properties properties;   // Seen by the user callback
+    bj_audio_callback_fn       callback;
+    void*                      user_data;
+    uint64_t                   sample_index; // At the requested rate
+    size_t                     staged;       // Frames in `input`
+    size_t                     offset;       // Frames of `input` already resampled
+    void*                      generated;    // Chunk in the device format
+    float*                     input;        // Chunk converted to float
+    float*                     output;       // Resampled chunk
+};
+
+static void destroy_rate_converter(struct audio_rate_converter* converter) {
+    if (converter == 0) {
+        return;
+    }
+    bj_destroy_resampler(converter->resampler);
+    if (converter->generated != converter->input) {
+        bj_free(converter->generated);
+    }
+    bj_free(converter->input);
+    bj_free(converter->output);
+    bj_free(converter);
+}
+
+static void generate_chunk(struct audio_rate_converter* converter) {
+    const size_t samples = RATE_CONVERTER_CHUNK * converter->properties.channels;
+    converter->callback(
+        converter->generated,
+        RATE_CONVERTER_CHUNK,
+        &converter->properties,
+        converter->user_data,
+        converter->sample_index
+    );
+    converter->sample_index += RATE_CONVERTER_CHUNK;
+
+    if (converter->properties.format == BJ_AUDIO_FORMAT_INT16) {
+        const int16_t* generated = converter->generated;
+        for (size_t s = 0; s < samples; ++s) {
+            converter->input[s] = (float)generated[s] * (1.0f / 32768.0f);
+        }
+    }
+    converter->staged = RATE_CONVERTER_CHUNK;
+    converter->offset = 0;
+}
+
+static void store_samples(enum bj_audio_format format, void* buffer, size_t at, const float* samples, size_t count) {
+    if (format == BJ_AUDIO_FORMAT_INT16) {
+        int16_t* dst = (int16_t*)buffer + at;
+        for (size_t s = 0; s < count; ++s) {
+            float value = samples[s] * 32768.0f;
+            value = value > 32767.0f ? 32767.0f : (value < -32768.0f ? -32768.0f : value);
+            dst[s] = (int16_t)bj_roundf(value);
+        }
+    } else {
+        bj_memcpy((float*)buffer + at, samples, count * sizeof(float));
+    }
+}
+
+static void run_rate_converter(
+    struct audio_rate_converter*      converter,
+    void*                             buffer,
+    unsigned                          frames,
+    const struct bj_audio_properties* audio,
+    uint64_t                          base_sample_index
+) {
+    const size_t channels = audio->channels;
+
+    if (base_sample_index == 0) {
+        // First period, or the device was reset
+        converter->sample_index = 0;
+        converter->staged       = 0;
+        converter->offset       = 0;
+        bj_reset_resampler(converter->resampler);
+    }
+
+    size_t done = 0;
+    while (done < frames) {
+        if (converter->offset == converter->staged) {
+            generate_chunk(converter);
+        }
+        const size_t wanted = frames - done < RATE_CONVERTER_CHUNK ? frames - done : RATE_CONVERTER_CHUNK;
+        size_t used = 0;
+        const size_t produced = bj_resample(
+            converter->resampler,
+            converter->input + converter->offset * channels,
+            converter->staged - converter->offset,
+            &used,
+            converter->output,
+            wanted
+        );
+        converter->offset += used;
+        store_samples(audio->format, buffer, done * channels, converter->output, produced * channels);
+        done += produced;
+    }
+}
+
+// Routes the device callback through a resampler if the backend could not
+// open the requested rate. The device keeps working unconverted on failure.
+static void install_rate_converter(
+    struct bj_audio_device*           device,
+    const struct bj_audio_properties* requested
+) {
+    const struct bj_audio_properties* actual = &device->properties;
+    if (requested->resample == BJ_RESAMPLE_NONE || requested->sample_rate == 0
+        || requested->sample_rate == actual->sample_rate
+        || (actual->format != BJ_AUDIO_FORMAT_INT16 && actual->format != BJ_AUDIO_FORMAT_F32)) {
+        return;
+    }
+
+    struct audio_rate_converter* converter = bj_calloc(sizeof(struct audio_rate_converter));
+    if (converter == 0) {
+        return;
+    }
+    const size_t samples = RATE_CONVERTER_CHUNK * actual->channels;
+    converter->resampler   = bj_create_resampler(actual->channels, requested->sample_rate, actual->sample_rate, requested->resample);
+    converter->properties  = *actual;
+    converter->properties.sample_rate = requested->sample_rate;
+    converter->properties.resample    = requested->resample;
+    converter->callback    = device->callback;
+    converter->user_data   = device->callback_user_data;
+    converter->input       = bj_malloc(samples * sizeof(float));
+    converter->output      = bj_malloc(samples * sizeof(float));
+    converter->generated   = actual->format == BJ_AUDIO_FORMAT_F32
+        ? (void*)converter->input
+        : bj_malloc(samples * sizeof(int16_t));
+
+    if (converter->resampler == 0 || converter->input == 0 || converter->output == 0 || converter->generated == 0) {
+        bj_warn("cannot convert audio from %u Hz to %u Hz", requested->sample_rate, actual->sample_rate);
+        destroy_rate_converter(converter);
+        return;
+    }
+
+    // The audio thread may already run: publishing the converter is enough
+    // for its next period to go through it.
+    bj_atomic_store_ptr(&device->rate_converter, converter);
+    bj_info("audio converted from %u Hz to %u Hz", requested->sample_rate, actual->sample_rate);
+}
+
+void bj_audio_device_fill(
+    struct bj_audio_device* device,
+    void*                   buffer,
+    unsigned                frames,
+    uint64_t                sample_index
+) {
+    struct audio_rate_converter* converter = bj_atomic_load_ptr(&device->rate_converter);
+    if (converter != 0) {
+        run_rate_converter(converter, buffer, frames, &device->properties, sample_index);
+    } else {
+        device->callback(buffer, frames, &device->properties, device->callback_user_data, sample_index);
+    }
+}
+
 struct bj_audio_device* bj_open_audio_device(
     const struct bj_audio_properties* p_properties,
     bj_audio_callback_fn              p_callback,
     void*                             p_callback_user_data,
     struct bj_error**                 p_error
 ) {
-    return s_audio.open_device(
+    struct bj_audio_device* p_device = s_audio.open_device(
         p_properties,
         p_callback,
         p_callback_user_data,
         p_error
     );
+    if (p_device != 0 && p_properties != 0) {
+        install_rate_converter(p_device, p_properties);
+    }
+    return p_device;
 }
 
 void bj_close_audio_device(
     struct bj_audio_device* p_device
 ) {
-    p_device->should_close = BJ_TRUE;
+    struct audio_rate_converter* converter = bj_atomic_load_ptr(&p_device->rate_converter);
+    bj_atomic_store_u32(&p_device->should_close, BJ_TRUE);
     s_audio.close_device(p_device);
+    destroy_rate_converter(converter);
 }
 
 
@@ -88,27 +276,53 @@ void bj_play_audio_device(
     struct bj_audio_device* p_device
 ) {
     bj_check(p_device);
-    p_device->playing = BJ_TRUE;
+    bj_atomic_store_u32(&p_device->playing, BJ_TRUE);
 }
 
 void bj_pause_audio_device(
     struct bj_audio_device* p_device
 ) {
     bj_check(p_device);
-    p_device->playing = BJ_FALSE;
+    bj_atomic_store_u32(&p_device->playing, BJ_FALSE);
 }
 
 bj_bool bj_audio_playing(
     const struct bj_audio_device* p_device
 ) {
-    return p_device ? p_device->playing : BJ_FALSE;
+    return p_device ? bj_atomic_load_u32(&p_device->playing) : BJ_FALSE;
+}
+
+const struct bj_audio_properties* bj_audio_device_properties(
+    const struct bj_audio_device* p_device
+) {
+    bj_check_or_0(p_device);
+    return &p_device->properties;
+}
+
+double bj_audio_latency(
+    const struct bj_audio_device* p_device
+) {
+    bj_check_or_0(p_device);
+    const struct bj_audio_properties* properties = &p_device->properties;
+    if (properties->sample_rate == 0) {
+        return 0.0;
+    }
+    return (double)properties->period_frames * (double)properties->period_count
+        / (double)properties->sample_rate;
+}
+
+uint32_t bj_audio_underruns(
+    const struct bj_audio_device* p_device
+) {
+    bj_check_or_0(p_device);
+    return bj_atomic_load_u32(&p_device->underruns);
 }
 
 void bj_reset_audio_device(
     struct bj_audio_device* p_device
 ) {
     bj_check(p_device);
-    p_device->should_reset = BJ_TRUE;
+    bj_atomic_store_u32(&p_device->should_reset, BJ_TRUE);
 }
 
 void bj_stop_audio_device(
@@ -119,40 +333,58 @@ void bj_stop_audio_device(
     bj_reset_audio_device(p_device);
 }
 
-inline static double make_note_value(
-    unsigned i,
-    int      function,
-    uint64_t base_sample_index, 
-    double   phase_step
-) {
-    const uint64_t sample_index = base_sample_index + i;
-    const double two_pi = BJ_TAU_D; // 2PI exactly in double
+// Frames generated at once by bj_play_audio_note
+#define NOTE_BLOCK 256
 
-    // Use the double variant explicitly to avoid accidental float truncation
-    // when BJ_API_FLOAT64 is off.
-    const double phase = bj_fmodd((double)sample_index * phase_step, two_pi);
-
-    switch (function) {
-        case BJ_AUDIO_PLAY_SINE:
-            return bj_sind(phase);
+static int16_t to_int16(float sample) {
+    return (int16_t)(sample > 32767.0f ? 32767.0f : (sample < -32768.0f ? -32768.0f : sample));
+}
 
-        case BJ_AUDIO_PLAY_SQUARE:
-            // Cheap sign of sine; or compare phase against PI for duty=50%.
-            return (bj_sind(phase) > 0.0) ? 0.2 : -0.2;
+// Writes mono `samples` to every channel of `buffer` from frame `at`. Each
+// format and the common channel counts get their own loop.
+static void store_mono_frames(
+    void*                             buffer,
+    size_t                            at,
+    const float*                      samples,
+    size_t                            frames,
+    const struct bj_audio_properties* audio
+) {
+    const size_t channels = audio->channels;
 
-        case BJ_AUDIO_PLAY_TRIANGLE: {
-            const double t = phase / two_pi;               // 0..1 ramp
-            return 4.0 * bj_absd(t - bj_floord(t + 0.5)) - 1.0;
+    if (audio->format == BJ_AUDIO_FORMAT_INT16) {
+        int16_t* dst = (int16_t*)buffer + at * channels;
+        if (channels == 1) {
+            for (size_t i = 0; i < frames; ++i) {
+                dst[i] = to_int16(samples[i]);
+            }
+        } else if (channels == 2) {
+            for (size_t i = 0; i < frames; ++i) {
+                dst[2 * i] = dst[2 * i + 1] = to_int16(samples[i]);
+            }
+        } else {
+            for (size_t i = 0; i < frames; ++i) {
+                for (size_t c = 0; c < channels; ++c) {
+                    dst[i * channels + c] = to_int16(samples[i]);
+                }
+            }
         }
-
-        case BJ_AUDIO_PLAY_SAWTOOTH: {
-            const double t = phase / two_pi;               // 0..1 ramp
-            return 2.0 * (t - bj_floord(t + 0.5));
+    } else if (audio->format == BJ_AUDIO_FORMAT_F32) {
+        float* dst = (float*)buffer + at * channels;
+        if (channels == 1) {
+            bj_memcpy(dst, samples, frames * sizeof(float));
+        } else if (channels == 2) {
+            for (size_t i = 0; i < frames; ++i) {
+                dst[2 * i] = dst[2 * i + 1] = samples[i];
+            }
+        } else {
+            for (size_t i = 0; i < frames; ++i) {
+                for (size_t c = 0; c < channels; ++c) {
+                    dst[i * channels + c] = samples[i];
+                }
+            }
         }
-
-        default:
-            return 0.0;
     }
+    // Unsupported formats are left untouched (silence)
 }
 
 void bj_play_audio_note(
@@ -164,39 +396,36 @@ void bj_play_audio_note(
 ) {
     struct bj_audio_play_note_data* data = (struct bj_audio_play_note_data*)p_user_data;
 
-    const double freq        = (double)data->frequency;
-    const double amplitude   = (double)p_audio->amplitude;   // scale for int16 path
-    const double sample_rate = (double)p_audio->sample_rate;
-    const double phase_step  = BJ_TAU_D * freq / sample_rate;
-    const unsigned channels  = p_audio->channels;
-
-    for (unsigned i = 0; i < frames; ++i) {
-        const double output = make_note_value(i, (int)data->function, base_sample_index, phase_step);
-
-        for (unsigned ch = 0; ch < channels; ++ch) {
-            const unsigned idx = i * channels + ch;
-
-            switch (p_audio->format) {
-            case BJ_AUDIO_FORMAT_INT16: {
-                int16_t* buf = (int16_t*)buffer;
-                // clamp to avoid wrap if amplitude drives beyond range
-                double s = output * amplitude;
-                if (s >  32767.0) s =  32767.0;
-                if (s < -32768.0) s = -32768.0;
-                buf[idx] = (int16_t)s;
-                break;
-            }
-            case BJ_AUDIO_FORMAT_F32: {
-                float* buf = (float*)buffer;
-                buf[idx] = (float)output;  // amplitude can be baked into output if desired
-                break;
-            }
-            default:
-                // unsupported -> silence
-                break;
-            }
-        }
+    static const enum bj_oscillator_shape shapes[] = {
+        [BJ_AUDIO_PLAY_SINE]     = BJ_OSCILLATOR_SINE,
+        [BJ_AUDIO_PLAY_SQUARE]   = BJ_OSCILLATOR_SQUARE,
+        [BJ_AUDIO_PLAY_TRIANGLE] = BJ_OSCILLATOR_TRIANGLE,
+        [BJ_AUDIO_PLAY_SAWTOOTH] = BJ_OSCILLATOR_SAWTOOTH,
+    };
+    if ((unsigned)data->function >= sizeof(shapes) / sizeof(shapes[0])) {
+        bj_memzero(buffer, (size_t)frames * p_audio->channels * (BJ_AUDIO_FORMAT_WIDTH(p_audio->format) / 8));
+        return;
     }
-}
 
+    // Square waves play quieter, as they always did. Int16 samples are
+    // scaled by the device amplitude.
+    float amplitude = data->function == BJ_AUDIO_PLAY_SQUARE ? 0.2f : 1.0f;
+    if (p_audio->format == BJ_AUDIO_FORMAT_INT16) {
+        amplitude *= (float)p_audio->amplitude;
+    }
+
+    struct bj_oscillator oscillator;
+    bj_init_oscillator(&oscillator, shapes[data->function], (float)data->frequency, amplitude, p_audio->sample_rate);
+
+    // The phase only depends on the sample index, so it follows device
+    // resets. It is computed once per call instead of once per sample.
+    const double cycles = (double)base_sample_index * data->frequency / (double)p_audio->sample_rate;
+    oscillator.phase = (uint32_t)((cycles - bj_floord(cycles)) * 4294967296.0);
 
+    float block[NOTE_BLOCK];
+    for (size_t done = 0; done < frames; done += NOTE_BLOCK) {
+        const size_t count = frames - done < NOTE_BLOCK ? frames - done : NOTE_BLOCK;
+        bj_render_oscillator(&oscillator, block, count);
+        store_mono_frames(buffer, done, block, count, p_audio);
+    }
+}
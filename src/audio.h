@@ -5,15 +5,33 @@
 #define BJ_AUDIO_AMPLITUDE 16000
 #define BJ_AUDIO_SAMPLE_RATE 44100
 #define BJ_AUDIO_CHANNELS 1
+#define BJ_AUDIO_PERIOD_FRAMES 512
+#define BJ_AUDIO_PERIOD_COUNT 4
 
+// `playing`, `should_reset`, `should_close`, `underruns` and `rate_converter`
+// are shared with the audio thread: access them with the functions of
+// atomic.h. Backends store the period size and count they obtained in
+// `properties`.
 struct bj_audio_device {
     struct bj_audio_properties properties;
     uint32_t                   silence;
-    bj_bool                    playing;
+    volatile bj_bool           playing;
     volatile bj_bool           should_reset;
-    bj_bool                    should_close;
+    volatile bj_bool           should_close;
+    volatile uint32_t          underruns;
     bj_audio_callback_fn       callback;
     void*                      callback_user_data;
+    void* volatile             rate_converter; // Set when the device rate differs from the request
 };
 
+// Produces `frames` frames in `buffer` with the device callback, through
+// the rate converter if one is installed. Called by the backends from their
+// audio thread while the device plays.
+void bj_audio_device_fill(
+    struct bj_audio_device* device,
+    void*                   buffer,
+    unsigned                frames,
+    uint64_t                sample_index
+);
+
 
@@ -0,0 +1,160 @@
+#include <banjo/audio.h>
+#include <banjo/memory.h>
+
+#include <atomic.h>
+#include <check.h>
+
+// Keeps the producer and consumer indices on different cache lines
+#define RING_CACHE_LINE 64
+
+// `write` and `read` count frames since creation and wrap around naturally:
+// `write - read` is the number of readable frames. Each index is only
+// stored by its own side and loaded with acquire by the other side, so the
+// frames copied before a store are visible once the new index is seen.
+struct bj_audio_ring {
+    uint8_t*        data;
+    size_t          capacity;   // Frames, power of two
+    size_t          frame_size; // Bytes
+    int             format;
+    unsigned int    channels;
+    char            pad0[RING_CACHE_LINE];
+    volatile size_t write;
+    char            pad1[RING_CACHE_LINE];
+    volatile size_t read;
+};
+
+static size_t frame_size(const struct bj_audio_properties* properties) {
+    return (size_t)(BJ_AUDIO_FORMAT_WIDTH(properties->format) / 8) * properties->channels;
+}
+
+struct bj_audio_ring* bj_create_audio_ring(
+    const struct bj_audio_properties* properties,
+    size_t                            frames
+) {
+    bj_check_or_0(properties);
+    const size_t size = frame_size(properties);
+    if (size == 0 || frames == 0 || frames > ((size_t)-1 >> 2) / size) {
+        return 0;
+    }
+
+    size_t capacity = 1;
+    while (capacity < frames) {
+        capacity <<= 1;
+    }
+
+    struct bj_audio_ring* ring = bj_calloc(sizeof(struct bj_audio_ring));
+    if (ring == 0) {
+        return 0;
+    }
+    ring->data = bj_malloc(capacity * size);
+    if (ring->data == 0) {
+        bj_free(ring);
+        return 0;
+    }
+    ring->capacity   = capacity;
+    ring->frame_size = size;
+    ring->format     = (int)properties->format;
+    ring->channels   = properties->channels;
+    return ring;
+}
+
+void bj_destroy_audio_ring(
+    struct bj_audio_ring* ring
+) {
+    if (ring != 0) {
+        bj_free(ring->data);
+        bj_free(ring);
+    }
+}
+
+// Copies `count` frames between `frames` and the ring starting at `index`,
+// in two parts when the range wraps.
+static void copy_in(struct bj_audio_ring* ring, size_t index, const uint8_t* frames, size_t count) {
+    const size_t start = index & (ring->capacity - 1);
+    const size_t first = count < ring->capacity - start ? count : ring->capacity - start;
+    bj_memcpy(ring->data + start * ring->frame_size, frames, first * ring->frame_size);
+    bj_memcpy(ring->data, frames + first * ring->frame_size, (count - first) * ring->frame_size);
+}
+
+static void copy_out(const struct bj_audio_ring* ring, size_t index, uint8_t* frames, size_t count) {
+    const size_t start = index & (ring->capacity - 1);
+    const size_t first = count < ring->capacity - start ? count : ring->capacity - start;
+    bj_memcpy(frames, ring->data + start * ring->frame_size, first * ring->frame_size);
+    bj_memcpy(frames + first * ring->frame_size, ring->data, (count - first) * ring->frame_size);
+}
+
+size_t bj_audio_ring_write(
+    struct bj_audio_ring* ring,
+    const void*           frames,
+    size_t                count
+) {
+    bj_check_or_0(ring);
+    bj_check_or_0(frames || count == 0);
+
+    const size_t write = ring->write; // Only this thread stores it
+    const size_t read  = bj_atomic_load_size(&ring->read);
+    const size_t space = ring->capacity - (write - read);
+    if (count > space) {
+        count = space;
+    }
+    if (count > 0) {
+        copy_in(ring, write, frames, count);
+        bj_atomic_store_size(&ring->write, write + count);
+    }
+    return count;
+}
+
+size_t bj_audio_ring_read(
+    struct bj_audio_ring* ring,
+    void*                 frames,
+    size_t                count
+) {
+    bj_check_or_0(ring);
+    bj_check_or_0(frames || count == 0);
+
+    const size_t read      = ring->read; // Only this thread stores it
+    const size_t write     = bj_atomic_load_size(&ring->write);
+    const size_t available = write - read;
+    if (count > available) {
+        count = available;
+    }
+    if (count > 0) {
+        copy_out(ring, read, frames, count);
+        bj_atomic_store_size(&ring->read, read + count);
+    }
+    return count;
+}
+
+size_t bj_audio_ring_readable(
+    const struct bj_audio_ring* ring
+) {
+    bj_check_or_0(ring);
+    return bj_atomic_load_size(&ring->write) - bj_atomic_load_size(&ring->read);
+}
+
+size_t bj_audio_ring_writable(
+    const struct bj_audio_ring* ring
+) {
+    bj_check_or_0(ring);
+    return ring->capacity - bj_audio_ring_readable(ring);
+}
+
+void bj_audio_ring_callback(
+    void*                             buffer,
+    unsigned                          frames,
+    const struct bj_audio_properties* audio,
+    void*                             user_data,
+    uint64_t                          base_sample_index
+) {
+    (void)base_sample_index;
+    struct bj_audio_ring* ring = (struct bj_audio_ring*)user_data;
+
+    size_t read = 0;
+    if (ring != 0 && (int)audio->format == ring->format && audio->channels == ring->channels) {
+        read = bj_audio_ring_read(ring, buffer, frames);
+    }
+
+    // Both supported formats use all-zero silence
+    const size_t size = frame_size(audio);
+    bj_memzero((uint8_t*)buffer + read * size, (frames - read) * size);
+}
@@ -4,6 +4,7 @@
 
 #include <bitmap.h>
 #include <check.h>
+#include <pool.h>
 
 #include <string.h>
 
@@ -11,21 +12,38 @@
 BANJO_EXPORT struct bj_bitmap* bj_allocate_bitmap(
     void
 ) {
-    return bj_malloc(sizeof(struct bj_bitmap));
+    return bj_calloc(sizeof(struct bj_bitmap));
 }
 
-struct bj_bitmap* bj_init_bitmap(
-    struct bj_bitmap*       bitmap,
-    void*            pixels,
-    size_t           width,
-    size_t           height,
-    enum bj_pixel_mode    mode,
-    size_t           stride
+// Bitmaps created by the library come from the pool, the ones from
+// bj_allocate_bitmap() can be released with bj_free().
+static struct bj_bitmap* new_bitmap(const struct bj_bitmap* init) {
+    struct bj_bitmap* bitmap = bj_pool_allocate(sizeof(struct bj_bitmap));
+    if (bitmap != 0) {
+        bj_memcpy(bitmap, init, sizeof(struct bj_bitmap));
+        bitmap->pooled = BJ_TRUE;
+    }
+    return bitmap;
+}
+
+// Initializes `bitmap`, allocating its buffer when `pixels` is 0. A
+// non-zero `alignment` rounds the stride up to it and aligns the buffer.
+static struct bj_bitmap* init_bitmap(
+    struct bj_bitmap*  bitmap,
+    void*              pixels,
+    size_t             width,
+    size_t             height,
+    enum bj_pixel_mode mode,
+    size_t             stride,
+    size_t             alignment
 ) {
     const size_t computed_stride = bj_compute_bitmap_stride(width, mode);
     if(stride < computed_stride) {
         stride = computed_stride;
     }
+    if(alignment > 0) {
+        stride = (stride + alignment - 1) & ~(alignment - 1);
+    }
 
     if(bitmap) {
         bj_memset(bitmap, 0, sizeof(struct bj_bitmap));
@@ -43,7 +61,8 @@ struct bj_bitmap* bj_init_bitmap(
             if (bitmap->weak) {
                 bitmap->buffer = pixels;
             } else {
-                bitmap->buffer = bj_malloc(bufsize);
+                bitmap->alignment = alignment;
+                bitmap->buffer    = alignment > 0 ? bj_aligned_malloc(bufsize, alignment) : bj_malloc(bufsize);
                 if (bitmap->buffer == 0) {
                     return 0;
                 }
@@ -55,13 +74,32 @@ struct bj_bitmap* bj_init_bitmap(
     return bitmap;
 }
 
+static void free_buffer(struct bj_bitmap* bitmap) {
+    if (bitmap->alignment > 0) {
+        bj_aligned_free(bitmap->buffer);
+    } else {
+        bj_free(bitmap->buffer);
+    }
+}
+
+struct bj_bitmap* bj_init_bitmap(
+    struct bj_bitmap*       bitmap,
+    void*            pixels,
+    size_t           width,
+    size_t           height,
+    enum bj_pixel_mode    mode,
+    size_t           stride
+) {
+    return init_bitmap(bitmap, pixels, width, height, mode, stride, 0);
+}
+
 void bj_reset_bitmap(
     struct bj_bitmap* bitmap
 ) {
     bj_check(bitmap);
 
     if(bitmap->weak == 0) {
-        bj_free(bitmap->buffer);
+        free_buffer(bitmap);
     }
     bitmap->buffer = 0;
     bj_destroy_bitmap(bitmap->charset);
@@ -77,14 +115,30 @@ struct bj_bitmap* bj_create_bitmap(
     if(bj_init_bitmap(&temp_bitmap, 0, width, height, mode, stride) == 0) {
         return 0;
     }
-    struct bj_bitmap* new = bj_allocate_bitmap();
+    struct bj_bitmap* new = new_bitmap(&temp_bitmap);
     if (new == 0) {
-        bj_free(temp_bitmap.buffer);
-        return 0;
+        free_buffer(&temp_bitmap);
     }
-    return bj_memcpy(new, &temp_bitmap, sizeof(struct bj_bitmap));
+    return new;
 }
 
+struct bj_bitmap* bj_create_aligned_bitmap(
+    size_t             width,
+    size_t             height,
+    enum bj_pixel_mode mode,
+    size_t             alignment
+) {
+    bj_check_or_0((alignment & (alignment - 1)) == 0);
+    struct bj_bitmap temp_bitmap;
+    if(init_bitmap(&temp_bitmap, 0, width, height, mode, 0, alignment > 0 ? alignment : BJ_BITMAP_ALIGNMENT) == 0) {
+        return 0;
+    }
+    struct bj_bitmap* new = new_bitmap(&temp_bitmap);
+    if (new == 0) {
+        free_buffer(&temp_bitmap);
+    }
+    return new;
+}
 
 void bj_assign_bitmap(
     struct bj_bitmap*  bitmap,
@@ -95,8 +149,24 @@ void bj_assign_bitmap(
     size_t             stride
 ) {
     bj_check(bitmap);
+    const bj_bool pooled = bitmap->pooled;
     bj_reset_bitmap(bitmap);
     bj_init_bitmap(bitmap, pixels, width, height, mode, stride);
+    bitmap->pooled = pooled;
+}
+
+void bj_assign_aligned_bitmap(
+    struct bj_bitmap*  bitmap,
+    size_t             width,
+    size_t             height,
+    enum bj_pixel_mode mode,
+    size_t             alignment
+) {
+    bj_check(bitmap);
+    const bj_bool pooled = bitmap->pooled;
+    bj_reset_bitmap(bitmap);
+    init_bitmap(bitmap, 0, width, height, mode, 0, alignment > 0 ? alignment : BJ_BITMAP_ALIGNMENT);
+    bitmap->pooled = pooled;
 }
 
 struct bj_bitmap* bj_create_bitmap_from_pixels(
@@ -111,28 +181,24 @@ struct bj_bitmap* bj_create_bitmap_from_pixels(
     if (bj_init_bitmap(&temp_bitmap, pixels, width, height, mode, stride) == 0) {
         return 0;
     }
-    struct bj_bitmap* new = bj_allocate_bitmap();
-    if (new == 0) {
-        return 0;
-    }
-    return bj_memcpy(new, &temp_bitmap, sizeof(struct bj_bitmap));
+    return new_bitmap(&temp_bitmap);
 }
 
 struct bj_bitmap* bj_copy_bitmap(
     const struct bj_bitmap* bitmap
 ) {
     bj_check_or_0(bitmap);
+    // Copies of aligned bitmaps keep the guarantee
     struct bj_bitmap temp_bitmap;
-    if (bj_init_bitmap(&temp_bitmap, 0, bitmap->width, bitmap->height, bitmap->mode, bitmap->stride) == 0) {
+    if (init_bitmap(&temp_bitmap, 0, bitmap->width, bitmap->height, bitmap->mode, bitmap->stride, bitmap->alignment) == 0) {
         return 0;
     }
     bj_memcpy(temp_bitmap.buffer, bitmap->buffer, temp_bitmap.stride * temp_bitmap.height);
-    struct bj_bitmap* new = bj_allocate_bitmap();
+    struct bj_bitmap* new = new_bitmap(&temp_bitmap);
     if (new == 0) {
-        bj_free(temp_bitmap.buffer);
-        return 0;
+        free_buffer(&temp_bitmap);
     }
-    return bj_memcpy(new, &temp_bitmap, sizeof(struct bj_bitmap));
+    return new;
 }
 
 // ============================================================================
@@ -324,9 +390,7 @@ static void convert_row_1555_to_565(const uint8_t* restrict src, uint8_t* restri
 // Row converter dispatch table
 // --------------------------------------------------------------------------
 
-typedef void (*row_converter_fn)(const uint8_t* restrict src, uint8_t* restrict dst, size_t width);
-
-static row_converter_fn get_row_converter(enum bj_pixel_mode src_mode, enum bj_pixel_mode dst_mode) {
+bj_row_converter_fn bj_get_row_converter(enum bj_pixel_mode src_mode, enum bj_pixel_mode dst_mode) {
     // 32-bit source
     if (src_mode == BJ_PIXEL_MODE_XRGB8888) {
         if (dst_mode == BJ_PIXEL_MODE_BGR24)    return convert_row_32_to_24;
@@ -435,7 +499,7 @@ struct bj_bitmap* bj_convert_bitmap(
     }
 
     // Try to get an optimized row converter
-    row_converter_fn convert_row = get_row_converter(src->mode, mode);
+    bj_row_converter_fn convert_row = bj_get_row_converter(src->mode, mode);
 
     if (convert_row) {
         // Fast path: use optimized row converter
@@ -449,19 +513,25 @@ struct bj_bitmap* bj_convert_bitmap(
         convert_bitmap_generic(src, &dst);
     }
 
-    struct bj_bitmap* result = bj_allocate_bitmap();
+    struct bj_bitmap* result = new_bitmap(&dst);
     if (result == 0) {
-        bj_free(dst.buffer);
-        return 0;
+        free_buffer(&dst);
     }
-    return bj_memcpy(result, &dst, sizeof(struct bj_bitmap));
+    return result;
 }
 
 void bj_destroy_bitmap(
     struct bj_bitmap*     bitmap
 ) {
+    if (bitmap == 0) {
+        return;
+    }
     bj_reset_bitmap(bitmap);
-    bj_free(bitmap);
+    if (bitmap->pooled) {
+        bj_pool_free(bitmap);
+    } else {
+        bj_free(bitmap);
+    }
 }
 
 size_t bj_bitmap_width(
@@ -492,6 +562,18 @@ size_t bj_bitmap_stride(
     return bitmap->stride;
 }
 
+size_t bj_bitmap_alignment(
+    const struct bj_bitmap* bitmap
+) {
+    bj_check_or_0(bitmap);
+    if (bitmap->buffer == 0) {
+        return 0;
+    }
+    // Largest power of two dividing both the buffer address and the stride
+    const uintptr_t bits = (uintptr_t)bitmap->buffer | (uintptr_t)bitmap->stride;
+    return (size_t)(bits & (~bits + 1));
+}
+
 
 void* bj_bitmap_pixels(
     struct bj_bitmap*     bitmap
@@ -620,6 +702,45 @@ struct bj_bitmap* bj_create_bitmap_from_file(
     return bitmap;
 }
 
+bj_bool bj_write_bitmap_to_stream(
+    const struct bj_bitmap* bitmap,
+    struct bj_stream*       stream,
+    struct bj_error**       error
+) {
+    bj_check_or_0(bitmap);
+    bj_check_or_0(stream);
+    return dib_write_bitmap_to_stream(bitmap, stream, error);
+}
+
+bj_bool bj_write_bitmap_to_file(
+    const struct bj_bitmap* bitmap,
+    const char*             path,
+    struct bj_error**       error
+) {
+    bj_check_or_0(bitmap);
+    struct bj_error* inner_error = 0;
+
+    struct bj_stream* stream = bj_open_stream_file_write(path, &inner_error);
+    if(inner_error) {
+        bj_propagate_prefixed_error(error, inner_error,
+            "Saving bitmap '%s': ", path);
+        return BJ_FALSE;
+    }
+
+    bj_bool written = dib_write_bitmap_to_stream(bitmap, stream, &inner_error);
+    // The last bytes may still be buffered, a full disk only fails here
+    if(written && !bj_flush_stream(stream)) {
+        bj_set_error(&inner_error, BJ_ERROR_CANNOT_WRITE, "cannot write to file");
+        written = BJ_FALSE;
+    }
+    bj_close_stream(stream);
+    if(inner_error) {
+        bj_propagate_prefixed_error(error, inner_error,
+            "Saving bitmap '%s': ", path);
+    }
+    return written;
+}
+
 void bj_clear_bitmap(struct bj_bitmap* bitmap) {
     bj_check(bitmap);
 
@@ -680,21 +801,15 @@ void bj_make_bitmap_rgb(
 // Alpha Blending (generic)
 // ----------------------------------------------------------------------------
 
-static inline uint8_t generic_mix_u8(uint16_t alpha, uint8_t src, uint8_t dst) {
-    uint32_t x = (uint32_t)dst * (255u - alpha) + (uint32_t)src * alpha;
-    x += 128u + (x >> 8);
-    return (uint8_t)(x >> 8);
-}
-
 static inline void generic_src_over_rgb(
     uint8_t alpha,
     uint8_t src_r, uint8_t src_g, uint8_t src_b,
     uint8_t dst_r, uint8_t dst_g, uint8_t dst_b,
     uint8_t* out_r, uint8_t* out_g, uint8_t* out_b
 ) {
-    *out_r = generic_mix_u8(alpha, src_r, dst_r);
-    *out_g = generic_mix_u8(alpha, src_g, dst_g);
-    *out_b = generic_mix_u8(alpha, src_b, dst_b);
+    *out_r = bj_mix_u8(alpha, src_r, dst_r);
+    *out_g = bj_mix_u8(alpha, src_g, dst_g);
+    *out_b = bj_mix_u8(alpha, src_b, dst_b);
 }
 
 // ----------------------------------------------------------------------------
@@ -744,9 +859,9 @@ void bj_blit_mask_generic(
                 } else if (alpha == 255) {
                     bj_put_pixel(dst, dx, dy, fg_native);
                 } else {
-                    uint8_t out_r = generic_mix_u8(alpha, fr, br);
-                    uint8_t out_g = generic_mix_u8(alpha, fg, bg);
-                    uint8_t out_b = generic_mix_u8(alpha, fb, bb);
+                    uint8_t out_r = bj_mix_u8(alpha, fr, br);
+                    uint8_t out_g = bj_mix_u8(alpha, fg, bg);
+                    uint8_t out_b = bj_mix_u8(alpha, fb, bb);
                     bj_put_pixel(dst, dx, dy, bj_make_bitmap_pixel(dst, out_r, out_g, out_b));
                 }
                 break;
@@ -834,9 +949,9 @@ void bj_blit_mask_stretched_generic(
                 } else if (alpha == 255) {
                     bj_put_pixel(dst, out_x, out_y, fg_native);
                 } else {
-                    uint8_t out_r = generic_mix_u8(alpha, fr, br);
-                    uint8_t out_g = generic_mix_u8(alpha, fg, bg);
-                    uint8_t out_b = generic_mix_u8(alpha, fb, bb);
+                    uint8_t out_r = bj_mix_u8(alpha, fr, br);
+                    uint8_t out_g = bj_mix_u8(alpha, fg, bg);
+                    uint8_t out_b = bj_mix_u8(alpha, fb, bb);
                     bj_put_pixel(dst, out_x, out_y, bj_make_bitmap_pixel(dst, out_r, out_g, out_b));
                 }
                 break;
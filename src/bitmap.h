@@ -16,8 +16,21 @@ struct bj_bitmap {
     bj_bool            colorkey_enabled;
     uint32_t           colorkey;
     struct bj_bitmap*  charset;
+    bj_bool            pooled;    // Allocated by the library from the pool
+    size_t             alignment; // Of the buffer from bj_aligned_malloc, 0 if from bj_malloc
 };
 
+// Reassigns `bitmap` to an owned buffer whose start and stride are multiples
+// of `alignment` (a power of two, 0 for BJ_BITMAP_ALIGNMENT), like
+// bj_assign_bitmap() with no pixels. Used for framebuffers.
+void bj_assign_aligned_bitmap(
+    struct bj_bitmap*  bitmap,
+    size_t             width,
+    size_t             height,
+    enum bj_pixel_mode mode,
+    size_t             alignment
+);
+
 // ============================================================================
 // FAST PIXEL ACCESSORS - For internal use in hot loops only!
 // ============================================================================
@@ -131,6 +144,42 @@ static inline uint32_t bj_get_pixel_by_bpp(const uint8_t* row, size_t x, size_t
     }
 }
 
+// --------------------------------------------------------------------------
+// Alpha helpers
+// --------------------------------------------------------------------------
+
+// Integer alpha blend: (d*(255-a) + s*a) / 255
+// Uses: x/255 = (x + 1 + (x >> 8)) >> 8
+// We combine rounding (+127) with +1 term -> +128
+static inline uint8_t bj_mix_u8(uint16_t alpha, uint8_t src, uint8_t dst) {
+    uint32_t x = (uint32_t)dst * (255u - alpha) + (uint32_t)src * alpha;
+    x += 128u + (x >> 8);
+    return (uint8_t)(x >> 8);
+}
+
+// Integer product of two normalized values: (a * b) / 255, same rounding.
+static inline uint8_t bj_mul_u8(uint8_t a, uint8_t b) {
+    uint32_t x = (uint32_t)a * b;
+    x += 128u + (x >> 8);
+    return (uint8_t)(x >> 8);
+}
+
+// True if the mode stores an alpha channel (ARGB8888 and its premultiplied
+// variant). The X bits of other formats are never read as alpha.
+static inline bj_bool bj_pixel_mode_has_alpha(enum bj_pixel_mode mode) {
+    return mode == BJ_PIXEL_MODE_ARGB8888 || mode == BJ_PIXEL_MODE_ARGB8888_PREMUL;
+}
+
+// a + (b - a) * f / 256 on all four channels of 0xAARRGGBB words, f in 0..255.
+// Two pairs of lanes per multiply. Monotonic in each input, so premultiplied
+// pixels stay valid.
+static inline uint32_t bj_lerp_px_32(uint32_t a, uint32_t b, uint32_t f) {
+    const uint32_t nf = 256u - f;
+    const uint32_t rb = ((a & 0x00FF00FFu) * nf + (b & 0x00FF00FFu) * f) >> 8;
+    const uint32_t ag = ((a >> 8) & 0x00FF00FFu) * nf + ((b >> 8) & 0x00FF00FFu) * f;
+    return (rb & 0x00FF00FFu) | (ag & 0xFF00FF00u);
+}
+
 // ============================================================================
 // FORMAT-SPECIFIC DISPATCH FUNCTIONS
 // ============================================================================
@@ -290,7 +339,108 @@ void bj_hline_24(struct bj_bitmap* dst, int x0, int x1, int y, uint32_t pixel);
 void bj_hline_16(struct bj_bitmap* dst, int x0, int x1, int y, uint32_t pixel);
 void bj_hline_generic(struct bj_bitmap* dst, int x0, int x1, int y, uint32_t pixel);
 
+// ============================================================================
+// Alpha Compositing
+// ============================================================================
+// Composites a row of 32bpp ARGB source pixels over a 32bpp destination row
+// (XRGB8888, ARGB8888 or ARGB8888_PREMUL). `premul` selects PREMUL_OVER over
+// SRC_OVER. XRGB8888 destinations are treated as opaque and keep a zero X
+// byte. Source pixels equal to `key` are skipped when `use_key` is set.
+
+void bj_blit_over_row_32(
+    const uint32_t* BJ_RESTRICT src,
+    uint32_t* BJ_RESTRICT       dst,
+    size_t                      pixels,
+    bj_bool                     premul,
+    bj_bool                     dst_alpha,
+    bj_bool                     use_key,
+    uint32_t                    key
+);
+
+// ============================================================================
+// Row Conversion
+// ============================================================================
+// Converts `width` pixels between two direct-color formats (XRGB8888, BGR24,
+// RGB565, XRGB1555). Returns 0 if no optimized converter exists for the pair.
+
+typedef void (*bj_row_converter_fn)(const uint8_t* BJ_RESTRICT src, uint8_t* BJ_RESTRICT dst, size_t width);
+
+bj_row_converter_fn bj_get_row_converter(enum bj_pixel_mode src_mode, enum bj_pixel_mode dst_mode);
+
+// ============================================================================
+// Vectorized Blit Row Kernels
+// ============================================================================
+// Implemented in bitmap_simd.c. Each kernel handles the longest prefix of a
+// row that fills whole vectors and returns the number of elements processed;
+// the caller finishes the row with the scalar kernel. A NULL entry means no
+// vector kernel is available and the scalar path handles the whole row.
+
+typedef size_t (*bj_blit_span_32_fn)(
+    const uint32_t* BJ_RESTRICT src, uint32_t* BJ_RESTRICT dst, size_t pixels,
+    bj_bool use_key, uint32_t key, enum bj_blit_op op, enum bj_pixel_mode mode
+);
+
+typedef size_t (*bj_blit_span_16_fn)(
+    const uint16_t* BJ_RESTRICT src, uint16_t* BJ_RESTRICT dst, size_t pixels,
+    bj_bool use_key, uint16_t key, enum bj_blit_op op, enum bj_pixel_mode mode
+);
+
+// Bytewise ROPs for 24bpp rows without colorkey; `bytes` is a byte count.
+// COPY is not vectorized here, the caller already uses bj_memcpy for it.
+typedef size_t (*bj_blit_span_bytes_fn)(
+    const uint8_t* BJ_RESTRICT src, uint8_t* BJ_RESTRICT dst, size_t bytes,
+    enum bj_blit_op op
+);
+
+struct bj_blit_kernels {
+    bj_blit_span_32_fn    span_32;
+    bj_blit_span_16_fn    span_16;
+    bj_blit_span_bytes_fn span_bytes;
+};
+
+// Returns the kernels for the running CPU, selecting them on first use.
+const struct bj_blit_kernels* bj_get_blit_kernels(void);
+
+// Selects kernels from an explicit BJ_CPU_* feature mask (see cpu.h).
+// Passing 0 forces the scalar path. Used by tests and benchmarks.
+void bj_select_blit_kernels(uint32_t cpu_features);
+
 struct bj_bitmap* dib_create_bitmap_from_stream(struct bj_stream* stream, struct bj_error** error);
+bj_bool dib_write_bitmap_to_stream(const struct bj_bitmap* bitmap, struct bj_stream* stream, struct bj_error** error);
 
+// ============================================================================
+// Filtered Sampling (bitmap_blit_filter.c)
+// ============================================================================
+// Filters work on 0xAARRGGBB words. bj_plan_filtered_blit() decides how
+// source pixels are loaded and how the filtered rows reach the destination,
+// bj_load_filter_row() then loads source pixels accordingly.
+
+#define BJ_FILTER_LOAD_KEY         0x01u // Keyed pixels load as transparent (0)
+#define BJ_FILTER_LOAD_OPAQUE      0x02u // Force alpha to 0xFF
+#define BJ_FILTER_LOAD_PREMULTIPLY 0x04u // Premultiply straight alpha
+
+struct bj_filter_plan {
+    unsigned           load_flags; // BJ_FILTER_LOAD_*
+    enum bj_pixel_mode row_mode;   // Pixel mode of filtered rows
+    enum bj_blit_op    row_op;     // Op to blit filtered rows with
+};
 
+// Returns BJ_FALSE if the source cannot be filtered for this op: indexed
+// sources, and keyed sources with ROPs other than copy and compositing.
+bj_bool bj_plan_filtered_blit(
+    const struct bj_bitmap* src,
+    const struct bj_bitmap* dst,
+    enum bj_blit_op         op,
+    struct bj_filter_plan*  plan
+);
 
+// Loads `n` source pixels from (x, y). Returns the pixels in place for
+// 32bpp sources without load flags, `scratch` otherwise.
+const uint32_t* bj_load_filter_row(
+    const struct bj_bitmap* src,
+    size_t                  x,
+    size_t                  y,
+    size_t                  n,
+    unsigned                flags,
+    uint32_t*               scratch
+);
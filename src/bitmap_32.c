@@ -2,6 +2,7 @@
 //
 // This file contains all bitmap operations optimized for 32-bit pixels.
 // Pixel format: 0x00RRGGBB (8 bits per channel, high byte unused)
+// ARGB8888 sources (0xAARRGGBB) are composited by bj_blit_over_row_32.
 //
 // Optimizations applied:
 //   - Direct 32-bit memory access (no byte unpacking)
@@ -29,15 +30,6 @@ static inline void unpack_rgb(uint32_t pixel, uint8_t* r, uint8_t* g, uint8_t* b
 // Alpha Blending - division-free
 // ----------------------------------------------------------------------------
 
-// Integer alpha blend: (d*(255-a) + s*a) / 255
-// Uses: x/255 = (x + 1 + (x >> 8)) >> 8
-// We combine rounding (+127) with +1 term -> +128
-static inline uint8_t mix_u8(uint16_t alpha, uint8_t src, uint8_t dst) {
-    uint32_t x = (uint32_t)dst * (255u - alpha) + (uint32_t)src * alpha;
-    x += 128u + (x >> 8);
-    return (uint8_t)(x >> 8);
-}
-
 // Blend source RGB over dest RGB with alpha.
 static inline uint32_t blend_over(
     uint8_t alpha,
@@ -45,12 +37,45 @@ static inline uint32_t blend_over(
     uint8_t dst_r, uint8_t dst_g, uint8_t dst_b
 ) {
     return pack_rgb(
-        mix_u8(alpha, src_r, dst_r),
-        mix_u8(alpha, src_g, dst_g),
-        mix_u8(alpha, src_b, dst_b)
+        bj_mix_u8(alpha, src_r, dst_r),
+        bj_mix_u8(alpha, src_g, dst_g),
+        bj_mix_u8(alpha, src_b, dst_b)
     );
 }
 
+// Two-lane SWAR version of bj_mix_u8: each 16-bit lane of `x` holds
+// d*(255-a) + s*a and is divided by 255 with the same rounding.
+static inline uint32_t div255_lanes(uint32_t x) {
+    x += 0x00800080u + ((x >> 8) & 0x00FF00FFu);
+    return (x >> 8) & 0x00FF00FFu;
+}
+
+// Saturates two 9-bit lanes of `x` to 0xFF.
+static inline uint32_t clamp_lanes(uint32_t x) {
+    const uint32_t carry = x & 0x01000100u;
+    return (x | (carry - (carry >> 8))) & 0x00FF00FFu;
+}
+
+// Straight-alpha source over destination, ARGB8888.
+// Color: mix(a, s, d). Alpha: mix(a, 255, da), i.e. a + da*(1-a).
+// R/B and A/G are blended as two pairs of lanes.
+static inline uint32_t over_straight(uint32_t s, uint32_t d) {
+    const uint32_t a  = s >> 24;
+    const uint32_t na = 255u - a;
+    const uint32_t rb = (s & 0x00FF00FFu) * a + (d & 0x00FF00FFu) * na;
+    const uint32_t ag = (((s >> 8) & 0xFFu) | 0x00FF0000u) * a + ((d >> 8) & 0x00FF00FFu) * na;
+    return div255_lanes(rb) | (div255_lanes(ag) << 8);
+}
+
+// Premultiplied source over destination: s + d*(1-a) on all four channels.
+// Saturates so that invalid premultiplied input (color > alpha) clamps.
+static inline uint32_t over_premul(uint32_t s, uint32_t d) {
+    const uint32_t na = 255u - (s >> 24);
+    const uint32_t rb = div255_lanes((d & 0x00FF00FFu) * na) + (s & 0x00FF00FFu);
+    const uint32_t ag = div255_lanes(((d >> 8) & 0x00FF00FFu) * na) + ((s >> 8) & 0x00FF00FFu);
+    return clamp_lanes(rb) | (clamp_lanes(ag) << 8);
+}
+
 // ----------------------------------------------------------------------------
 // Fixed-point constants for stretched blits
 // ----------------------------------------------------------------------------
@@ -261,3 +286,37 @@ void bj_hline_32(struct bj_bitmap* dst, int x0, int x1, int y, uint32_t pixel) {
         row[i] = pixel;
     }
 }
+
+// ----------------------------------------------------------------------------
+// Alpha compositing row - SRC_OVER / PREMUL_OVER
+// ----------------------------------------------------------------------------
+
+void bj_blit_over_row_32(
+    const uint32_t* BJ_RESTRICT src,
+    uint32_t* BJ_RESTRICT       dst,
+    size_t                      pixels,
+    bj_bool                     premul,
+    bj_bool                     dst_alpha,
+    bj_bool                     use_key,
+    uint32_t                    key
+) {
+    // XRGB8888 destinations are opaque: read X as 0xFF, write it back as 0
+    const uint32_t dst_fill = dst_alpha ? 0u : 0xFF000000u;
+    const uint32_t out_mask = dst_alpha ? 0xFFFFFFFFu : 0x00FFFFFFu;
+
+    if (premul) {
+        for (size_t i = 0; i < pixels; ++i) {
+            const uint32_t s = src[i];
+            if (s == 0u || (use_key && s == key)) continue;
+            dst[i] = ((s >> 24) == 0xFFu ? s : over_premul(s, dst[i] | dst_fill)) & out_mask;
+        }
+    } else {
+        for (size_t i = 0; i < pixels; ++i) {
+            const uint32_t s = src[i];
+            const uint32_t a = s >> 24;
+            // Both shortcuts are exact: mix(0, s, d) == d and mix(255, s, d) == s
+            if (a == 0u || (use_key && s == key)) continue;
+            dst[i] = (a == 0xFFu ? s : over_straight(s, dst[i] | dst_fill)) & out_mask;
+        }
+    }
+}
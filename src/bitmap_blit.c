@@ -70,7 +70,9 @@ static inline void buffer_set_pixel_bits(
 static inline void unpack_rgb_from_native(enum bj_pixel_mode mode, uint32_t native, uint8_t* r, uint8_t* g, uint8_t* b) {
     switch (mode) {
     case BJ_PIXEL_MODE_XRGB8888:
-        // 0x00RRGGBB
+    case BJ_PIXEL_MODE_ARGB8888:
+    case BJ_PIXEL_MODE_ARGB8888_PREMUL:
+        // 0xXXRRGGBB
         *r = (uint8_t)(native >> 16);
         *g = (uint8_t)(native >> 8);
         *b = (uint8_t)(native);
@@ -104,6 +106,10 @@ static inline uint32_t pack_rgb_to_native(enum bj_pixel_mode mode, uint8_t r, ui
     switch (mode) {
     case BJ_PIXEL_MODE_XRGB8888:
         return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    case BJ_PIXEL_MODE_ARGB8888:
+    case BJ_PIXEL_MODE_ARGB8888_PREMUL:
+        // Converted colors are opaque
+        return 0xFF000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
     case BJ_PIXEL_MODE_BGR24:
         return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
     case BJ_PIXEL_MODE_RGB565:
@@ -116,28 +122,118 @@ static inline uint32_t pack_rgb_to_native(enum bj_pixel_mode mode, uint8_t r, ui
     }
 }
 
+// ---------- Alpha compositing on 8-bit channels ----------
+
+static inline uint8_t alpha_from_native(enum bj_pixel_mode mode, uint32_t native) {
+    return bj_pixel_mode_has_alpha(mode) ? (uint8_t)(native >> 24) : 0xFFu;
+}
+
+static inline uint32_t pack_rgba_to_native(enum bj_pixel_mode mode, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    if (bj_pixel_mode_has_alpha(mode)) {
+        return ((uint32_t)a << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+    return pack_rgb_to_native(mode, r, g, b);
+}
+
+static inline uint8_t add_sat_u8(uint8_t a, uint8_t b) {
+    const unsigned sum = (unsigned)a + b;
+    return (uint8_t)(sum > 255u ? 255u : sum);
+}
+
+// SRC_OVER / PREMUL_OVER of one pixel, any format pair.
+// Matches bj_blit_over_row_32 for 32bpp pairs.
+static inline uint32_t composite_native(
+    enum bj_pixel_mode smode, uint32_t sval,
+    enum bj_pixel_mode dmode, uint32_t dval,
+    enum bj_blit_op op)
+{
+    uint8_t sr, sg, sb, dr, dg, db;
+    unpack_rgb_from_native(smode, sval, &sr, &sg, &sb);
+    unpack_rgb_from_native(dmode, dval, &dr, &dg, &db);
+    const uint8_t a  = alpha_from_native(smode, sval);
+    const uint8_t da = alpha_from_native(dmode, dval);
+
+    if (op == BJ_BLIT_OP_PREMUL_OVER) {
+        const uint8_t na = (uint8_t)(255u - a);
+        return pack_rgba_to_native(dmode,
+            add_sat_u8(sr, bj_mul_u8(dr, na)),
+            add_sat_u8(sg, bj_mul_u8(dg, na)),
+            add_sat_u8(sb, bj_mul_u8(db, na)),
+            add_sat_u8(a,  bj_mul_u8(da, na))
+        );
+    }
+    return pack_rgba_to_native(dmode,
+        bj_mix_u8(a, sr, dr),
+        bj_mix_u8(a, sg, dg),
+        bj_mix_u8(a, sb, db),
+        bj_mix_u8(a, 0xFFu, da)
+    );
+}
+
+// COPY between alpha formats keeps alpha and converts the color between the
+// straight and premultiplied representations.
+static inline uint32_t convert_alpha_native(enum bj_pixel_mode smode, uint32_t sval, enum bj_pixel_mode dmode) {
+    uint8_t r, g, b;
+    unpack_rgb_from_native(smode, sval, &r, &g, &b);
+    const uint8_t a = alpha_from_native(smode, sval);
+    if (smode != dmode && dmode == BJ_PIXEL_MODE_ARGB8888_PREMUL) {
+        r = bj_mul_u8(r, a);
+        g = bj_mul_u8(g, a);
+        b = bj_mul_u8(b, a);
+    } else if (smode != dmode && smode == BJ_PIXEL_MODE_ARGB8888_PREMUL && a) {
+        r = (uint8_t)(r >= a ? 255u : ((unsigned)r * 255u + a / 2u) / a);
+        g = (uint8_t)(g >= a ? 255u : ((unsigned)g * 255u + a / 2u) / a);
+        b = (uint8_t)(b >= a ? 255u : ((unsigned)b * 255u + a / 2u) / a);
+    }
+    return pack_rgba_to_native(dmode, r, g, b, a);
+}
+
+static inline bj_bool is_alpha_op(enum bj_blit_op op) {
+    return op == BJ_BLIT_OP_SRC_OVER || op == BJ_BLIT_OP_PREMUL_OVER;
+}
+
+// 32bpp destinations handled by bj_blit_over_row_32
+static inline bj_bool is_over_32_target(enum bj_pixel_mode m) {
+    return m == BJ_PIXEL_MODE_XRGB8888 || bj_pixel_mode_has_alpha(m);
+}
+
 // ---------- ROPs on packed values ----------
 
-static inline uint32_t rop_apply_u32(uint32_t dst, uint32_t src, enum bj_blit_op op) {
+// `has_alpha` saturates the top byte like the color channels instead of
+// clearing it, so that ARGB pixels keep their coverage.
+static inline uint32_t rop_apply_u32(uint32_t dst, uint32_t src, enum bj_blit_op op, bj_bool has_alpha) {
     switch (op) {
         case BJ_BLIT_OP_COPY:    return src;
         case BJ_BLIT_OP_XOR:     return dst ^ src;
         case BJ_BLIT_OP_OR:      return dst | src;
         case BJ_BLIT_OP_AND:     return dst & src;
         case BJ_BLIT_OP_ADD_SAT: {
-            // per-channel saturating add on 8:8:8 (ignore X)
+            // per-channel saturating add on 8:8:8, X cleared, A saturated.
+            // R and B share a word; each lane's carry lands in bit 8 of the
+            // lane and is turned into an all-ones mask for that lane only.
             uint32_t rb = (dst & 0x00FF00FFu) + (src & 0x00FF00FFu);
-            uint32_t g  = ((dst & 0x0000FF00u) >> 8) + ((src & 0x0000FF00u) >> 8);
-            rb = (rb & 0x01000100u) ? 0x00FF00FFu : (rb & 0x00FF00FFu);
-            g  = (g  & 0x00000100u) ? 0x000000FFu : (g  & 0x000000FFu);
-            return (rb & 0x00FF00FFu) | ((g & 0xFFu) << 8);
+            uint32_t g  = (dst & 0x0000FF00u) + (src & 0x0000FF00u);
+            const uint32_t rb_carry = rb & 0x01000100u;
+            const uint32_t g_carry  = g  & 0x00010000u;
+            rb |= rb_carry - (rb_carry >> 8);
+            g  |= g_carry  - (g_carry  >> 8);
+            uint32_t a = 0;
+            if (has_alpha) {
+                a = (dst >> 24) + (src >> 24);
+                a = (a > 255u ? 255u : a) << 24;
+            }
+            return (rb & 0x00FF00FFu) | (g & 0x0000FF00u) | a;
         }
         case BJ_BLIT_OP_SUB_SAT: {
-            uint32_t rb = (dst & 0x00FF00FFu) - (src & 0x00FF00FFu);
-            uint32_t g  = ((dst & 0x0000FF00u) >> 8) - ((src & 0x0000FF00u) >> 8);
-            rb = (rb & 0x01000100u) ? 0u : (rb & 0x00FF00FFu);
-            g  = (g  & 0x00000100u) ? 0u : (g  & 0x000000FFu);
-            return (rb & 0x00FF00FFu) | ((g & 0xFFu) << 8);
+            // per-channel saturating sub: borrow guard bits keep lanes apart,
+            // a cleared guard bit means the lane went negative and clamps to 0.
+            const uint32_t rb = ((dst & 0x00FF00FFu) | 0x01000100u) - (src & 0x00FF00FFu);
+            const uint32_t g  = ((dst & 0x0000FF00u) | 0x00010000u) - (src & 0x0000FF00u);
+            const uint32_t rb_keep = rb & 0x01000100u;
+            const uint32_t g_keep  = g  & 0x00010000u;
+            const uint32_t a = (has_alpha && (dst >> 24) > (src >> 24))
+                ? ((dst >> 24) - (src >> 24)) << 24 : 0u;
+            return (rb & (rb_keep - (rb_keep >> 8))) | (g & (g_keep - (g_keep >> 8))) | a;
         }
         default: return src;
     }
@@ -212,7 +308,8 @@ static void blit_rows_mem(const uint8_t* restrict s, size_t s_stride, uint8_t* r
 }
 
 // 32bpp same-mode ROP (XOR/OR/AND); colorkey optional
-static void blit_row_32_rop(const uint32_t* restrict src, uint32_t* restrict dst, size_t pixels, bj_bool use_key, uint32_t key, enum bj_blit_op op) {
+// ADD_SAT/SUB_SAT need the mode to know whether the top byte is alpha
+static void blit_row_32_rop(const uint32_t* restrict src, uint32_t* restrict dst, size_t pixels, bj_bool use_key, uint32_t key, enum bj_blit_op op, enum bj_pixel_mode mode) {
     if (!use_key) {
         if (op == BJ_BLIT_OP_COPY) {
             bj_memcpy(dst, src, pixels * 4u);
@@ -223,11 +320,12 @@ static void blit_row_32_rop(const uint32_t* restrict src, uint32_t* restrict dst
         if (op == BJ_BLIT_OP_AND) { for (size_t i=0;i<pixels;++i) dst[i]&=src[i]; return; }
     }
     // general 32bpp path with key and extended ops
+    const bj_bool has_alpha = bj_pixel_mode_has_alpha(mode);
     for (size_t i=0;i<pixels;++i) {
         uint32_t s = src[i];
         if (use_key && s == key) continue;
         if (op == BJ_BLIT_OP_COPY) { dst[i] = s; }
-        else { dst[i] = rop_apply_u32(dst[i], s, op); }
+        else { dst[i] = rop_apply_u32(dst[i], s, op, has_alpha); }
     }
 }
 
@@ -302,8 +400,147 @@ static void blit_row_24_fast(const uint8_t* restrict s, uint8_t* restrict d, siz
     }
 }
 
+// ---------- Cross-format row pipeline (direct-color formats) ----------
+//
+// Mismatched direct-color formats are blitted a chunk at a time: source and
+// destination runs are converted to XRGB8888 scratch rows, combined with the
+// 32bpp row kernels and converted back. Results match the per-pixel path
+// below, since both operate on the same expanded 8:8:8 channel values.
+
+#define BLIT_CHUNK_PIXELS 256
+
+static inline bj_bool is_direct_color(enum bj_pixel_mode m) {
+    return m == BJ_PIXEL_MODE_XRGB8888 || m == BJ_PIXEL_MODE_BGR24
+        || m == BJ_PIXEL_MODE_RGB565   || m == BJ_PIXEL_MODE_XRGB1555;
+}
+
+static bj_bool blit_converted_rows(
+    const struct bj_bitmap* s, const struct bj_rect* sr,
+    struct bj_bitmap* d, const struct bj_rect* dr,
+    enum bj_blit_op op)
+{
+    const enum bj_pixel_mode wide = BJ_PIXEL_MODE_XRGB8888;
+    if (s->mode == d->mode || !is_direct_color(s->mode) || !is_direct_color(d->mode)) {
+        return BJ_FALSE;
+    }
+
+    const size_t bpp_s = BJ_PIXEL_GET_BPP(s->mode);
+    const size_t bpp_d = BJ_PIXEL_GET_BPP(d->mode);
+
+    bj_bool  use_key = s->colorkey_enabled;
+    uint32_t key     = s->colorkey;
+    if (use_key) {
+        // The X bit of XRGB1555 does not survive the round trip: keyed source
+        // pixels could collide, and skipped destination pixels would lose it.
+        if (s->mode == BJ_PIXEL_MODE_XRGB1555 || d->mode == BJ_PIXEL_MODE_XRGB1555) {
+            return BJ_FALSE;
+        }
+        if (bpp_s < 32 && (key >> bpp_s) != 0) {
+            use_key = BJ_FALSE; // Can never match a source pixel
+        } else if (s->mode != wide) {
+            uint8_t r8, g8, b8;
+            unpack_rgb_from_native(s->mode, key, &r8, &g8, &b8);
+            key = pack_rgb_to_native(wide, r8, g8, b8);
+        }
+    }
+
+    // Plain conversion: one pass per row, no intermediate
+    if (op == BJ_BLIT_OP_COPY && !use_key) {
+        const bj_row_converter_fn convert = bj_get_row_converter(s->mode, d->mode);
+        for (uint16_t r = 0; r < dr->h; ++r) {
+            convert(
+                (const uint8_t*)s->buffer + ((size_t)sr->y + r) * s->stride + (size_t)sr->x * (bpp_s >> 3),
+                (uint8_t*)d->buffer + ((size_t)dr->y + r) * d->stride + (size_t)dr->x * (bpp_d >> 3),
+                dr->w
+            );
+        }
+        return BJ_TRUE;
+    }
+
+    const bj_row_converter_fn src_to_wide = (s->mode == wide) ? 0 : bj_get_row_converter(s->mode, wide);
+    const bj_row_converter_fn dst_to_wide = (d->mode == wide) ? 0 : bj_get_row_converter(d->mode, wide);
+    const bj_row_converter_fn wide_to_dst = (d->mode == wide) ? 0 : bj_get_row_converter(wide, d->mode);
+
+    // Destination values are only read by ROPs and for skipped keyed pixels
+    const bj_bool load_dst = (op != BJ_BLIT_OP_COPY) || use_key;
+    // The per-pixel path writes XRGB8888 with a zero X byte. XOR/OR in place
+    // would carry the destination X byte through, so clear it afterwards.
+    const bj_bool clear_x = (d->mode == wide) && (op == BJ_BLIT_OP_XOR || op == BJ_BLIT_OP_OR);
+
+    const struct bj_blit_kernels* kernels = bj_get_blit_kernels();
+    uint32_t src_buf[BLIT_CHUNK_PIXELS];
+    uint32_t dst_buf[BLIT_CHUNK_PIXELS];
+
+    for (uint16_t r = 0; r < dr->h; ++r) {
+        const uint8_t* srow = (const uint8_t*)s->buffer + ((size_t)sr->y + r) * s->stride + (size_t)sr->x * (bpp_s >> 3);
+        uint8_t*       drow = (uint8_t*)d->buffer + ((size_t)dr->y + r) * d->stride + (size_t)dr->x * (bpp_d >> 3);
+
+        for (size_t x = 0; x < dr->w; x += BLIT_CHUNK_PIXELS) {
+            const size_t n = (dr->w - x < BLIT_CHUNK_PIXELS) ? dr->w - x : BLIT_CHUNK_PIXELS;
+            const uint8_t* sp = srow + x * (bpp_s >> 3);
+            uint8_t*       dp = drow + x * (bpp_d >> 3);
+
+            const uint32_t* src_wide = (const uint32_t*)sp;
+            if (src_to_wide) {
+                src_to_wide(sp, (uint8_t*)src_buf, n);
+                src_wide = src_buf;
+            }
+
+            uint32_t* dst_wide = (uint32_t*)dp;
+            if (wide_to_dst) {
+                dst_wide = dst_buf;
+                if (load_dst) dst_to_wide(dp, (uint8_t*)dst_buf, n);
+            }
+
+            const size_t done = kernels->span_32
+                ? kernels->span_32(src_wide, dst_wide, n, use_key, key, op, wide) : 0;
+            blit_row_32_rop(src_wide + done, dst_wide + done, n - done, use_key, key, op, wide);
+
+            if (clear_x) {
+                for (size_t i = 0; i < n; ++i) {
+                    if (!use_key || src_wide[i] != key) dst_wide[i] &= 0x00FFFFFFu;
+                }
+            }
+
+            if (wide_to_dst) wide_to_dst((const uint8_t*)dst_buf, dp, n);
+        }
+    }
+    return BJ_TRUE;
+}
+
 // ---------- General per-pixel kernel (any format combo) ----------
 
+static inline uint32_t load_native(const struct bj_bitmap* bmp, const uint8_t* row, size_t x, size_t y, size_t bpp) {
+    return (bpp <= 8) ? buffer_get_pixel_bits(x, y, bmp->stride, bmp->buffer, bpp) : bj_get_pixel_by_bpp(row, x, bpp);
+}
+
+static inline void store_native(struct bj_bitmap* bmp, uint8_t* row, size_t x, size_t y, size_t bpp, uint32_t value) {
+    if (bpp <= 8) {
+        buffer_set_pixel_bits(x, y, bmp->stride, bmp->buffer, value, bpp);
+    } else {
+        bj_put_pixel_by_bpp(row, x, value, bpp);
+    }
+}
+
+// Alpha ops and COPY between alpha formats, which must carry alpha along.
+// Returns BJ_FALSE if the pixel is left to the regular RGB path.
+static inline bj_bool blit_alpha_pixel(
+    const struct bj_bitmap* s, uint32_t sval,
+    struct bj_bitmap* d, uint8_t* drow, size_t dx, size_t dy, size_t bpp_d,
+    enum bj_blit_op op)
+{
+    if (is_alpha_op(op)) {
+        const uint32_t dval = load_native(d, drow, dx, dy, bpp_d);
+        store_native(d, drow, dx, dy, bpp_d, composite_native(s->mode, sval, d->mode, dval, op));
+        return BJ_TRUE;
+    }
+    if (op == BJ_BLIT_OP_COPY && bj_pixel_mode_has_alpha(s->mode) && bj_pixel_mode_has_alpha(d->mode)) {
+        store_native(d, drow, dx, dy, bpp_d, convert_alpha_native(s->mode, sval, d->mode));
+        return BJ_TRUE;
+    }
+    return BJ_FALSE;
+}
+
 static void blit_general_any(
     const struct bj_bitmap* s, const struct bj_rect* sr,
     struct bj_bitmap* d, const struct bj_rect* dr,
@@ -346,12 +583,12 @@ static void blit_general_any(
                 // Same-mode, any op - use cached bpp_d
                 if (bpp_d <= 8) {
                     uint32_t dval = buffer_get_pixel_bits(dx, dy, d->stride, d->buffer, bpp_d);
-                    uint32_t res = (op == BJ_BLIT_OP_COPY) ? sval : rop_apply_u32(dval, sval, op);
+                    uint32_t res = (op == BJ_BLIT_OP_COPY) ? sval : rop_apply_u32(dval, sval, op, BJ_FALSE);
                     buffer_set_pixel_bits(dx, dy, d->stride, d->buffer, res, bpp_d);
                 } else if (bpp_d == 16) {
                     uint16_t* dp = (uint16_t*)drow + dx;
                     if (op == BJ_BLIT_OP_COPY) *dp = (uint16_t)sval;
-                    else *dp = (uint16_t)rop_apply_u32(*dp, (uint16_t)sval, op);
+                    else *dp = (uint16_t)rop_apply_u32(*dp, (uint16_t)sval, op, BJ_FALSE);
                 } else if (bpp_d == 24) {
                     uint8_t* dp = drow + dx * 3u;
                     if (op == BJ_BLIT_OP_COPY) {
@@ -383,11 +620,13 @@ static void blit_general_any(
                     }
                 } else { // 32bpp
                     uint32_t* dp = (uint32_t*)drow + dx;
-                    *dp = (op == BJ_BLIT_OP_COPY) ? sval : rop_apply_u32(*dp, sval, op);
+                    *dp = (op == BJ_BLIT_OP_COPY) ? sval : rop_apply_u32(*dp, sval, op, bj_pixel_mode_has_alpha(d->mode));
                 }
                 continue;
             }
 
+            if (blit_alpha_pixel(s, sval, d, drow, dx, dy, bpp_d, op)) continue;
+
             // Different formats: convert via RGB components
             uint8_t r8, g8, b8;
             unpack_rgb_from_native(s->mode, sval, &r8, &g8, &b8);
@@ -447,6 +686,27 @@ static void blit_general_any(
     }
 }
 
+// ---------- Alpha compositing (SRC_OVER / PREMUL_OVER) ----------
+
+static void blit_alpha(
+    const struct bj_bitmap* s, const struct bj_rect* sr,
+    struct bj_bitmap* d, const struct bj_rect* dr,
+    enum bj_blit_op op)
+{
+    if (!is_over_32_target(d->mode)) {
+        blit_general_any(s, sr, d, dr, op);
+        return;
+    }
+
+    const bj_bool premul    = (op == BJ_BLIT_OP_PREMUL_OVER);
+    const bj_bool dst_alpha = bj_pixel_mode_has_alpha(d->mode);
+    for (uint16_t r = 0; r < dr->h; ++r) {
+        const uint32_t* srow = (const uint32_t*)((const uint8_t*)s->buffer + ((size_t)sr->y + r) * s->stride) + sr->x;
+        uint32_t*       drow = (uint32_t*)((uint8_t*)d->buffer + ((size_t)dr->y + r) * d->stride) + dr->x;
+        bj_blit_over_row_32(srow, drow, dr->w, premul, dst_alpha, s->colorkey_enabled, s->colorkey);
+    }
+}
+
 // ---------- Core clipped blit dispatcher (no scaling) ----------
 
 static bj_bool do_blit_dispatch(
@@ -457,6 +717,16 @@ static bj_bool do_blit_dispatch(
     bj_check_or_0(src && dst && sr && dr);
     if (!sr->w || !sr->h || !dr->w || !dr->h) return BJ_FALSE;
 
+    // Alpha compositing: sources without alpha are opaque, hence copied
+    if (is_alpha_op(op)) {
+        if (!bj_pixel_mode_has_alpha(src->mode)) {
+            op = BJ_BLIT_OP_COPY;
+        } else {
+            blit_alpha(src, sr, dst, dr, op);
+            return BJ_TRUE;
+        }
+    }
+
     // Same format fast paths
     if (src->mode == dst->mode) {
         const size_t bpp = BJ_PIXEL_GET_BPP(src->mode);
@@ -474,33 +744,54 @@ static bj_bool do_blit_dispatch(
             // sub-byte falls through to general
         }
 
+        // Vector kernels take the bulk of each row, scalar ones finish the tail
+        const struct bj_blit_kernels* kernels = bj_get_blit_kernels();
+
         if (is_32bpp(src->mode)) {
             for (uint16_t y=0; y<dr->h; ++y) {
                 const uint32_t* srow = (const uint32_t*)(sbase + y*src->stride);
                 uint32_t*       drow = (uint32_t*)(dbase + y*dst->stride);
-                blit_row_32_rop(srow, drow, dr->w, src->colorkey_enabled, src->colorkey, op);
+                const size_t done = kernels->span_32
+                    ? kernels->span_32(srow, drow, dr->w, src->colorkey_enabled, src->colorkey, op, src->mode) : 0;
+                blit_row_32_rop(srow + done, drow + done, dr->w - done, src->colorkey_enabled, src->colorkey, op, src->mode);
             }
             return BJ_TRUE;
         } else if (is_16bpp(src->mode)) {
+            const bj_bool use_key = src->colorkey_enabled;
             uint16_t key16 = (uint16_t)src->colorkey;
             for (uint16_t y=0; y<dr->h; ++y) {
                 const uint16_t* srow = (const uint16_t*)(sbase + y*src->stride);
                 uint16_t*       drow = (uint16_t*)(dbase + y*dst->stride);
-                blit_row_16_fast(srow, drow, dr->w, src->colorkey_enabled, key16, op, src->mode);
+                const size_t done = kernels->span_16
+                    ? kernels->span_16(srow, drow, dr->w, use_key, key16, op, src->mode) : 0;
+                blit_row_16_fast(srow + done, drow + done, dr->w - done, use_key, key16, op, src->mode);
             }
             return BJ_TRUE;
         } else if (is_24bpp(src->mode)) {
             uint8_t key24[3] = { (uint8_t)src->colorkey, (uint8_t)(src->colorkey>>8), (uint8_t)(src->colorkey>>16) };
+            // Without colorkey every op is independent per byte. The kernels
+            // get whole pixels in whole vectors (48 bytes is 16 pixels, three
+            // SSE2/NEON or 1.5 AVX2 vectors) so that no pixel is split
+            // between the vector and scalar paths and processed twice.
+            const bj_bool bytewise = !src->colorkey_enabled && kernels->span_bytes;
+            const size_t  vector_bytes = rowbytes - rowbytes % 48u;
             for (uint16_t y=0; y<dr->h; ++y) {
                 const uint8_t* srow = sbase + y*src->stride;
                 uint8_t*       drow = dbase + y*dst->stride;
-                blit_row_24_fast(srow, drow, dr->w, src->colorkey_enabled, key24, op);
+                size_t done = 0;
+                if (bytewise && vector_bytes > 0) {
+                    done = kernels->span_bytes(srow, drow, vector_bytes, op) / 3u;
+                }
+                blit_row_24_fast(srow + done*3u, drow + done*3u, dr->w - done, src->colorkey_enabled, key24, op);
             }
             return BJ_TRUE;
         }
         // sub-byte or exotic layouts → fall through
     }
 
+    // Mismatched direct-color formats: chunked conversion through XRGB8888
+    if (blit_converted_rows(src, sr, dst, dr, op)) return BJ_TRUE;
+
     // General any→any path with converters (supports sub-byte, mismatched modes)
     blit_general_any(src, sr, dst, dr, op);
     return BJ_TRUE;
@@ -583,6 +874,11 @@ bj_bool bj_blit_stretched(
         return do_blit_dispatch(src, &s_adj, dst, &d_adj, op);
     }
 
+    // Sources without alpha are opaque: compositing is a copy
+    if (is_alpha_op(op) && !bj_pixel_mode_has_alpha(src->mode)) {
+        op = BJ_BLIT_OP_COPY;
+    }
+
     // Stretched: row-by-row map, using same-format fast row kernels where possible
     const size_t bpp_s = BJ_PIXEL_GET_BPP(src->mode);
     const size_t bpp_d = BJ_PIXEL_GET_BPP(dst->mode);
@@ -598,6 +894,31 @@ bj_bool bj_blit_stretched(
     const bj_bool dst_subbyte = is_subbyte(dst->mode);
     const bj_bool same_mode_copy = (src->mode == dst->mode) && (op == BJ_BLIT_OP_COPY) && !dst_subbyte;
 
+    // Alpha onto 32bpp: gather the sampled source pixels, composite as a row
+    if (is_alpha_op(op) && bj_pixel_mode_has_alpha(src->mode) && is_over_32_target(dst->mode)) {
+        const bj_bool premul    = (op == BJ_BLIT_OP_PREMUL_OVER);
+        const bj_bool dst_alpha = bj_pixel_mode_has_alpha(dst->mode);
+        uint32_t samples[BLIT_CHUNK_PIXELS];
+
+        uint32_t y_acc = 0;
+        for (uint16_t dy = 0; dy < d.h; ++dy) {
+            const uint32_t* src_row = (const uint32_t*)((const uint8_t*)src->buffer + ((size_t)s.y + (y_acc >> FRAC_BITS)) * src->stride) + s.x;
+            uint32_t*       dst_row = (uint32_t*)((uint8_t*)dst->buffer + ((size_t)d.y + dy) * dst->stride) + d.x;
+            y_acc += y_step;
+
+            uint32_t x_acc = 0;
+            for (size_t x = 0; x < d.w; x += BLIT_CHUNK_PIXELS) {
+                const size_t n = (d.w - x < BLIT_CHUNK_PIXELS) ? d.w - x : BLIT_CHUNK_PIXELS;
+                for (size_t i = 0; i < n; ++i) {
+                    samples[i] = src_row[x_acc >> FRAC_BITS];
+                    x_acc += x_step;
+                }
+                bj_blit_over_row_32(samples, dst_row + x, n, premul, dst_alpha, src->colorkey_enabled, src->colorkey);
+            }
+        }
+        return BJ_TRUE;
+    }
+
     uint32_t y_accum = 0;
 
     for (uint16_t dy = 0; dy < d.h; ++dy) {
@@ -648,6 +969,8 @@ bj_bool bj_blit_stretched(
                 continue;
             }
 
+            if (blit_alpha_pixel(src, sval, dst, dst_row, outx, outy, bpp_d, op)) continue;
+
             uint8_t r, g, b;
             unpack_rgb_from_native(src->mode, sval, &r, &g, &b);
 
@@ -0,0 +1,437 @@
+// bitmap_blit_filter.c - Filtered stretched blits (bilinear, box).
+//
+// Filtering is separable:
+//   1. Each source row the destination needs is loaded as 0xAARRGGBB words
+//      and resampled horizontally to the destination width.
+//   2. Resampled rows live in a two-slot cache, so that a row shared by
+//      consecutive destination rows is only resampled once.
+//   3. Destination rows are blended vertically from cached rows, then handed
+//      to bj_blit as a one-row bitmap, which applies the op and converts to
+//      the destination format with the regular fast paths.
+//
+// When shrinking vertically, rows are rarely shared and the order is
+// swapped: source rows are blended first, at source width, with a cheap
+// linear pass. The horizontal pass, which gathers, then runs once per
+// destination row instead of once per source row.
+//
+// Both filters use 8-bit weights and process two pairs of 8-bit lanes per
+// multiply (SWAR): bilinear lerps two pixels, box sums coverage-weighted
+// pixels whose weights add up to 256.
+
+#include <banjo/memory.h>
+
+#include <bitmap.h>
+#include <check.h>
+
+#define FILTER_FRAC_BITS 16
+#define FILTER_ONE       (1u << FILTER_FRAC_BITS)
+#define WEIGHT_ONE       256u
+
+// Sampling positions along one axis, from destination index to source taps.
+//
+// Bilinear: destination `i` blends `first[i]` and the pixel after it, with
+// weight `frac[i]` (0..255) on the latter. `frac` is 0 at the far edge, where
+// `first` is reused instead so that nothing past the edge is read.
+// Box: destination `i` covers `count[i]` source pixels from `first[i]`, with
+// weights `weights[i * taps ...]` summing to WEIGHT_ONE.
+struct filter_axis {
+    uint32_t* first;
+    uint32_t* frac;
+    uint32_t* count;
+    uint32_t* weights;
+    size_t    taps;
+};
+
+struct filter_ctx {
+    const struct bj_bitmap* src;
+    struct bj_rect          s;
+    size_t                  width;       // Destination width
+    enum bj_blit_filter     filter;
+    struct filter_axis      x_axis;
+    struct filter_axis      y_axis;
+    bj_bool                 vertical_first; // Blend source rows, then resample
+    unsigned                load_flags;  // BJ_FILTER_LOAD_*
+    uint32_t*               load[2];     // Source row scratch (s.w pixels)
+    uint32_t*               rows[2];     // Resampled row cache
+    size_t                  rows_y[2];
+    unsigned                last;
+    uint32_t*               acc;         // Box accumulators, widest row
+};
+
+#define NO_ROW ((size_t)-1)
+
+// ----------------------------------------------------------------------------
+// Axis setup
+// ----------------------------------------------------------------------------
+
+// Pixel centers are aligned: destination `i` samples source position
+// (i + 0.5) * src_len / dst_len - 0.5, clamped to the source edges.
+static void setup_bilinear_axis(struct filter_axis* axis, size_t src_len, size_t dst_len) {
+    const uint32_t step = (uint32_t)(((uint64_t)src_len << FILTER_FRAC_BITS) / dst_len);
+    int64_t pos = (int64_t)(step / 2u) - (int64_t)(FILTER_ONE / 2u);
+
+    for (size_t i = 0; i < dst_len; ++i, pos += step) {
+        const uint64_t p = pos < 0 ? 0u : (uint64_t)pos;
+        const size_t   x = (size_t)(p >> FILTER_FRAC_BITS);
+        if (x + 1u >= src_len) {
+            axis->first[i] = (uint32_t)(src_len - 1u);
+            axis->frac[i]  = 0u;
+        } else {
+            axis->first[i] = (uint32_t)x;
+            axis->frac[i]  = (uint32_t)(p >> (FILTER_FRAC_BITS - 8u)) & 0xFFu;
+        }
+    }
+}
+
+// Maximum number of source pixels overlapped by one destination pixel.
+static inline size_t box_taps(size_t src_len, size_t dst_len) {
+    return (src_len + dst_len - 1u) / dst_len + 1u;
+}
+
+// Destination `i` covers the source interval [i, i + 1) * src_len / dst_len.
+// Each overlapped pixel is weighted by its coverage. Weights are rounded from
+// the cumulated coverage, so that they sum to WEIGHT_ONE exactly and the
+// rounding error is spread instead of piling up on one pixel.
+static void setup_box_axis(struct filter_axis* axis, size_t src_len, size_t dst_len) {
+    const uint64_t scaled_len = (uint64_t)src_len << FILTER_FRAC_BITS;
+
+    for (size_t i = 0; i < dst_len; ++i) {
+        const uint64_t lo    = scaled_len * i / dst_len;
+        const uint64_t hi    = scaled_len * (i + 1u) / dst_len;
+        const uint64_t total = hi - lo;
+        const size_t   first = (size_t)(lo >> FILTER_FRAC_BITS);
+        const size_t   last  = (size_t)((hi - 1u) >> FILTER_FRAC_BITS);
+        uint32_t*      w     = axis->weights + i * axis->taps;
+
+        uint32_t before = 0;
+        for (size_t k = first; k <= last; ++k) {
+            const uint64_t k_hi    = (uint64_t)(k + 1u) << FILTER_FRAC_BITS;
+            const uint64_t covered = (k_hi < hi ? k_hi : hi) - lo;
+            const uint32_t upto    = (uint32_t)((covered * WEIGHT_ONE + total / 2u) / total);
+            w[k - first] = upto - before;
+            before = upto;
+        }
+
+        axis->first[i] = (uint32_t)first;
+        axis->count[i] = (uint32_t)(last - first + 1u);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Pixel helpers
+// ----------------------------------------------------------------------------
+
+// Box accumulators hold two pairs of 16-bit lanes: blue/red and green/alpha.
+// A lane sums at most 255 * WEIGHT_ONE, plus rounding, below 2^16.
+static inline void accumulate_px(uint32_t acc[2], uint32_t v, uint32_t w) {
+    acc[0] += (v & 0x00FF00FFu) * w;
+    acc[1] += ((v >> 8) & 0x00FF00FFu) * w;
+}
+
+static inline uint32_t pack_acc(const uint32_t acc[2]) {
+    const uint32_t rb = ((acc[0] + 0x00800080u) >> 8) & 0x00FF00FFu;
+    const uint32_t ag = (acc[1] + 0x00800080u) & 0xFF00FF00u;
+    return rb | ag;
+}
+
+// ----------------------------------------------------------------------------
+// Source rows
+// ----------------------------------------------------------------------------
+
+static inline const uint32_t* load_source_row(const struct filter_ctx* ctx, size_t y, uint32_t* scratch) {
+    return bj_load_filter_row(ctx->src, (size_t)ctx->s.x, (size_t)ctx->s.y + y, ctx->s.w, ctx->load_flags, scratch);
+}
+
+static void resample_row(const struct filter_ctx* ctx, const uint32_t* in, uint32_t* out) {
+    const size_t    n     = ctx->width;
+    const uint32_t* first = ctx->x_axis.first;
+
+    if (ctx->filter == BJ_BLIT_FILTER_BILINEAR) {
+        const uint32_t* frac = ctx->x_axis.frac;
+        for (size_t i = 0; i < n; ++i) {
+            const uint32_t* p = in + first[i];
+            const uint32_t  f = frac[i];
+            out[i] = bj_lerp_px_32(p[0], p[f != 0u], f);
+        }
+        return;
+    }
+
+    const uint32_t* count = ctx->x_axis.count;
+    const size_t    taps  = ctx->x_axis.taps;
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t* p = in + first[i];
+        const uint32_t* w = ctx->x_axis.weights + i * taps;
+        uint32_t acc[2] = {0, 0};
+        for (uint32_t k = 0; k < count[i]; ++k) {
+            accumulate_px(acc, p[k], w[k]);
+        }
+        out[i] = pack_acc(acc);
+    }
+}
+
+// Returns source row `y` resampled to the destination width. The slot that
+// was not returned last is recycled, so two rows can be held at once.
+static const uint32_t* cached_row(struct filter_ctx* ctx, size_t y) {
+    if (ctx->rows_y[ctx->last] == y) return ctx->rows[ctx->last];
+    const unsigned slot = ctx->last ^ 1u;
+    ctx->last = slot;
+    if (ctx->rows_y[slot] != y) {
+        resample_row(ctx, load_source_row(ctx, y, ctx->load[0]), ctx->rows[slot]);
+        ctx->rows_y[slot] = y;
+    }
+    return ctx->rows[slot];
+}
+
+// Returns the `k`-th row sampled vertically by a destination row, at the
+// width the vertical pass runs at.
+static inline const uint32_t* fetch_row(struct filter_ctx* ctx, size_t y, uint32_t k) {
+    return ctx->vertical_first ? load_source_row(ctx, y, ctx->load[k & 1u]) : cached_row(ctx, y);
+}
+
+// Vertical pass for destination row `dy` over `n` pixels. Returns `out`, or
+// the fetched row itself when it is the only contributor.
+static const uint32_t* blend_rows(struct filter_ctx* ctx, size_t dy, size_t n, uint32_t* out) {
+    const struct filter_axis* ax = &ctx->y_axis;
+    const uint32_t y = ax->first[dy];
+
+    if (ctx->filter == BJ_BLIT_FILTER_BILINEAR) {
+        const uint32_t  f   = ax->frac[dy];
+        const uint32_t* top = fetch_row(ctx, y, 0);
+        if (!f) return top;
+        const uint32_t* bottom = fetch_row(ctx, y + 1u, 1);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = bj_lerp_px_32(top[i], bottom[i], f);
+        }
+        return out;
+    }
+
+    const uint32_t  count = ax->count[dy];
+    const uint32_t* w     = ax->weights + dy * ax->taps;
+    if (count == 1u) return fetch_row(ctx, y, 0);
+
+    uint32_t* acc = ctx->acc;
+    bj_memzero(acc, n * 2u * sizeof(uint32_t));
+    for (uint32_t k = 0; k < count; ++k) {
+        const uint32_t* row = fetch_row(ctx, y + k, k);
+        for (size_t i = 0; i < n; ++i) {
+            accumulate_px(acc + 2u * i, row[i], w[k]);
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = pack_acc(acc + 2u * i);
+    }
+    return out;
+}
+
+// ----------------------------------------------------------------------------
+// Shared with other filtered blits
+// ----------------------------------------------------------------------------
+
+static inline bj_bool filterable_mode(enum bj_pixel_mode mode) {
+    switch (mode) {
+        case BJ_PIXEL_MODE_XRGB8888:
+        case BJ_PIXEL_MODE_ARGB8888:
+        case BJ_PIXEL_MODE_ARGB8888_PREMUL:
+        case BJ_PIXEL_MODE_BGR24:
+        case BJ_PIXEL_MODE_RGB565:
+        case BJ_PIXEL_MODE_XRGB1555:
+            return BJ_TRUE;
+        default:
+            return BJ_FALSE;
+    }
+}
+
+static inline bj_bool is_alpha_op(enum bj_blit_op op) {
+    return op == BJ_BLIT_OP_SRC_OVER || op == BJ_BLIT_OP_PREMUL_OVER;
+}
+
+static inline uint32_t premultiply_px(uint32_t v) {
+    const uint8_t a = (uint8_t)(v >> 24);
+    return ((uint32_t)a << 24)
+         | ((uint32_t)bj_mul_u8((uint8_t)(v >> 16), a) << 16)
+         | ((uint32_t)bj_mul_u8((uint8_t)(v >> 8), a) << 8)
+         | (uint32_t)bj_mul_u8((uint8_t)v, a);
+}
+
+bj_bool bj_plan_filtered_blit(
+    const struct bj_bitmap* src, const struct bj_bitmap* dst,
+    enum bj_blit_op op, struct bj_filter_plan* plan)
+{
+    // Sources without alpha are opaque: compositing is a copy
+    const bj_bool src_alpha = bj_pixel_mode_has_alpha(src->mode);
+    if (is_alpha_op(op) && !src_alpha) {
+        op = BJ_BLIT_OP_COPY;
+    }
+
+    const bj_bool use_key = src->colorkey_enabled;
+    if (!filterable_mode(src->mode) || (use_key && op != BJ_BLIT_OP_COPY && !is_alpha_op(op))) {
+        return BJ_FALSE;
+    }
+
+    // Transparency must be filtered premultiplied, or transparent neighbors
+    // bleed their color. Other blits filter the stored values as they are.
+    const bj_bool composite = use_key || is_alpha_op(op);
+    const bj_bool premul = composite
+        || (src_alpha && op == BJ_BLIT_OP_COPY && bj_pixel_mode_has_alpha(dst->mode));
+
+    plan->load_flags = (use_key ? BJ_FILTER_LOAD_KEY : 0u)
+        | (premul && !src_alpha ? BJ_FILTER_LOAD_OPAQUE : 0u)
+        | (premul && src->mode == BJ_PIXEL_MODE_ARGB8888 && op != BJ_BLIT_OP_PREMUL_OVER
+            ? BJ_FILTER_LOAD_PREMULTIPLY : 0u);
+    plan->row_mode = premul ? BJ_PIXEL_MODE_ARGB8888_PREMUL
+        : (BJ_PIXEL_GET_BPP(src->mode) == 32 ? src->mode : BJ_PIXEL_MODE_XRGB8888);
+    plan->row_op = composite ? BJ_BLIT_OP_PREMUL_OVER : op;
+    return BJ_TRUE;
+}
+
+const uint32_t* bj_load_filter_row(
+    const struct bj_bitmap* src, size_t x, size_t y, size_t n,
+    unsigned flags, uint32_t* scratch)
+{
+    const size_t   bpp    = BJ_PIXEL_GET_BPP(src->mode);
+    const uint8_t* native = bj_row_ptr(src, y) + x * (bpp >> 3);
+
+    const uint32_t* row = (const uint32_t*)native;
+    if (bpp != 32) {
+        bj_get_row_converter(src->mode, BJ_PIXEL_MODE_XRGB8888)(native, (uint8_t*)scratch, n);
+        row = scratch;
+    }
+
+    if (flags) {
+        const bj_bool use_key = (flags & BJ_FILTER_LOAD_KEY) != 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t v = row[i];
+            if (use_key && bj_get_pixel_by_bpp(native, i, bpp) == src->colorkey) {
+                v = 0u;
+            } else if (flags & BJ_FILTER_LOAD_OPAQUE) {
+                v |= 0xFF000000u;
+            } else if (flags & BJ_FILTER_LOAD_PREMULTIPLY) {
+                v = premultiply_px(v);
+            }
+            scratch[i] = v;
+        }
+        row = scratch;
+    }
+    return row;
+}
+
+// ----------------------------------------------------------------------------
+// Public API
+// ----------------------------------------------------------------------------
+
+bj_bool bj_blit_stretched_filtered(
+    const struct bj_bitmap* src, const struct bj_rect* src_area,
+    struct bj_bitmap* dst, const struct bj_rect* dst_area,
+    enum bj_blit_op op, enum bj_blit_filter filter)
+{
+    bj_check_or_0(src && dst);
+
+    // Same rectangle setup as bj_blit_stretched
+    struct bj_rect s = {0,0,(uint16_t)src->width,(uint16_t)src->height};
+    struct bj_rect d = {0,0,(uint16_t)dst->width,(uint16_t)dst->height};
+    if (src_area) s = *src_area;
+    if (dst_area) d.x = dst_area->x, d.y = dst_area->y, d.w = dst_area->w, d.h = dst_area->h;
+    if (!s.w || !s.h || !d.w || !d.h) return BJ_FALSE;
+
+    struct bj_rect sbounds = (struct bj_rect){0,0,(uint16_t)src->width,(uint16_t)src->height};
+    struct bj_rect dbounds = (struct bj_rect){0,0,(uint16_t)dst->width,(uint16_t)dst->height};
+    if (bj_rect_intersection(&s, &sbounds, &s) == 0) return BJ_FALSE;
+    if (bj_rect_intersection(&d, &dbounds, &d) == 0) return BJ_FALSE;
+
+    struct bj_filter_plan plan;
+    if (filter == BJ_BLIT_FILTER_NEAREST
+        || (s.w == d.w && s.h == d.h)
+        || !bj_plan_filtered_blit(src, dst, op, &plan)) {
+        return bj_blit_stretched(src, &s, dst, &d, op);
+    }
+
+    struct filter_ctx ctx = {
+        .src        = src,
+        .s          = s,
+        .width      = d.w,
+        .filter     = filter,
+        .load_flags = plan.load_flags,
+        .rows_y     = {NO_ROW, NO_ROW},
+    };
+
+    // Single allocation for tables and rows, carved below
+    const bj_bool box = (filter == BJ_BLIT_FILTER_BOX);
+    const size_t widest = s.w > d.w ? s.w : d.w;
+    const size_t taps_x = box ? box_taps(s.w, d.w) : 0u;
+    const size_t taps_y = box ? box_taps(s.h, d.h) : 0u;
+    const size_t words =
+        (box ? 2u * widest : 0u)                          // acc
+        + 3u * (size_t)s.w                                // load[2], blended
+        + 3u * (size_t)d.w                                // rows[2], scratch
+        + (box ? (2u + taps_x) * d.w : 2u * (size_t)d.w)  // x axis
+        + (box ? (2u + taps_y) * d.h : 2u * (size_t)d.h); // y axis
+    uint32_t* block = bj_malloc(words * sizeof(uint32_t));
+    if (block == 0) {
+        return bj_blit_stretched(src, &s, dst, &d, op);
+    }
+
+    uint32_t* cursor = block;
+    if (box) {
+        ctx.acc = cursor; cursor += 2u * widest;
+    }
+    ctx.load[0] = cursor; cursor += s.w;
+    ctx.load[1] = cursor; cursor += s.w;
+    uint32_t* blended = cursor; cursor += s.w;
+    ctx.rows[0] = cursor; cursor += d.w;
+    ctx.rows[1] = cursor; cursor += d.w;
+    uint32_t* scratch = cursor; cursor += d.w;
+
+    struct filter_axis* axes[2] = {&ctx.x_axis, &ctx.y_axis};
+    const size_t lens[2][2] = {{s.w, d.w}, {s.h, d.h}};
+    for (size_t a = 0; a < 2; ++a) {
+        struct filter_axis* axis = axes[a];
+        const size_t dst_len = lens[a][1];
+        axis->first = cursor; cursor += dst_len;
+        if (box) {
+            axis->taps    = a == 0 ? taps_x : taps_y;
+            axis->count   = cursor; cursor += dst_len;
+            axis->weights = cursor; cursor += axis->taps * dst_len;
+            setup_box_axis(axis, lens[a][0], dst_len);
+        } else {
+            axis->frac = cursor; cursor += dst_len;
+            setup_bilinear_axis(axis, lens[a][0], dst_len);
+        }
+    }
+    ctx.vertical_first = s.h > d.h;
+
+    // Each filtered row is blitted as a one-row bitmap
+    struct bj_bitmap view = {
+        .width  = d.w,
+        .height = 1,
+        .stride = (size_t)d.w * sizeof(uint32_t),
+        .mode   = plan.row_mode,
+        .weak   = 1,
+    };
+    const enum bj_blit_op view_op = plan.row_op;
+
+    // Filtered rows are written straight into the destination when that is
+    // what the blit would do anyway
+    const bj_bool in_place = (view_op == BJ_BLIT_OP_COPY && view.mode == dst->mode);
+
+    for (uint16_t dy = 0; dy < d.h; ++dy) {
+        uint32_t* out = in_place
+            ? (uint32_t*)(void*)bj_row_ptr(dst, (size_t)d.y + dy) + d.x
+            : scratch;
+
+        const uint32_t* row;
+        if (ctx.vertical_first) {
+            resample_row(&ctx, blend_rows(&ctx, dy, s.w, blended), out);
+            row = out;
+        } else {
+            row = blend_rows(&ctx, dy, d.w, out);
+        }
+        if (row == out && in_place) continue;
+
+        view.buffer = (void*)row;
+        const struct bj_rect drow = {.x = d.x, .y = (int16_t)(d.y + dy), .w = d.w, .h = 1};
+        bj_blit(&view, 0, dst, &drow, view_op);
+    }
+
+    bj_free(block);
+    return BJ_TRUE;
+}
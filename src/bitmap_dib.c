@@ -13,17 +13,21 @@
 #define ERR_MSG_BAD_RASTER_OFFSET       "incorrect raster offset"
 #define ERR_MSG_BAD_SIGNATURE           "incorrect signature"
 #define ERR_MSG_BITFIELDS_BAD_BPP       "bitfields only allowed for 16bpp and 32bpp bitmaps"
+#define ERR_MSG_CANNOT_ALLOC_ROW        "cannot allocate row buffer"
+#define ERR_MSG_CANNOT_WRITE            "cannot write to stream"
 #define ERR_MSG_CANNOT_ALLOC_PALETTE    "cannot allocated palette"
 #define ERR_MSG_EOS                     "unexpected end of file"
 #define ERR_MSG_OVERLAPPING_BITFIELDS   "overlapping bitfields"
 #define ERR_MSG_RLE4_BAD_BPP            "rle4 encoding only supported for 4bpp bitmaps"
 #define ERR_MSG_RLE8_BAD_BPP            "rle8 encoding only supported for 8bpp bitmaps"
 #define ERR_MSG_UNSUPPORTED_COMPRESSION "unsupported compression"
+#define ERR_MSG_UNSUPPORTED_MODE        "unsupported pixel mode"
 #define ERR_MSG_WRITE_OUTSIDE           "rle decoding writes outside of frame"
 
 #define _ABS(x) ((x) < 0 ? (uint32_t)(-(x)) : (uint32_t)(x))
 
 #define DIB_SIGNATURE 0x4D42
+#define DIB_FILE_HEADER_SIZE 14
 #define DIB_INFO_HEADER_SIZE 40
 
 #define DIB_BIT_COUNT_1 (0x01)  //!< Monochrome, 1bit per pixel.
@@ -44,75 +48,73 @@ typedef struct {
     uint8_t blue;
 } dib_table_rgb;
 
+// Expands a row of palette indices to BGR24 pixels
+static void dib_expand_indexed_row(
+    const uint8_t*       p_src_row,
+    uint8_t*             p_dest_byte,
+    size_t               width,
+    enum bj_pixel_mode   mode,
+    const dib_table_rgb* p_color_table,
+    size_t               color_table_size
+) {
+    for(size_t w = 0 ; w < width ; ++w) {
+        size_t index = 0;
+        switch(mode) {
+            case BJ_PIXEL_MODE_INDEXED_1:
+                index = (p_src_row[w / 8] >> (7 - (w % 8))) & 0x01;
+                break;
+            case BJ_PIXEL_MODE_INDEXED_4:
+                index = (p_src_row[w / 2] >> (w % 2 == 0 ? 4 : 0)) & 0x0F;
+                break;
+            case BJ_PIXEL_MODE_INDEXED_8:
+                index = p_src_row[w];
+                break;
+            default:
+                break;
+        }
+        if (index >= color_table_size) {
+            bj_warn("Invalid color table index %zu >= %zu, clamping to 0", index, color_table_size);
+            index = 0;
+        }
+        *p_dest_byte++ = p_color_table[index].blue;
+        *p_dest_byte++ = p_color_table[index].green;
+        *p_dest_byte++ = p_color_table[index].red;
+    }
+}
+
+static bj_bool dib_is_indexed(enum bj_pixel_mode mode) {
+    return mode == BJ_PIXEL_MODE_INDEXED_1 || mode == BJ_PIXEL_MODE_INDEXED_4 || mode == BJ_PIXEL_MODE_INDEXED_8;
+}
+
 static struct bj_bitmap* unpalletized(struct bj_bitmap* p_original, dib_table_rgb* p_color_table, size_t color_table_size) {
-    (void)color_table_size;
     enum bj_pixel_mode mode = (enum bj_pixel_mode)bj_bitmap_mode(p_original);
 
-    switch(mode) {
-        case BJ_PIXEL_MODE_INDEXED_1:
-        case BJ_PIXEL_MODE_INDEXED_4:
-        case BJ_PIXEL_MODE_INDEXED_8:
-            {
-                // bj_debug("Bitmap using 0x%08X encoding converted to BGR24", mode);
+    if (!dib_is_indexed(mode)) {
+        return p_original;
+    }
 
-                const size_t width = bj_bitmap_width(p_original);
-                const size_t height = bj_bitmap_height(p_original);
+    // bj_debug("Bitmap using 0x%08X encoding converted to BGR24", mode);
 
-                struct bj_bitmap* p_bitmap = bj_create_bitmap(
-                    width, height, BJ_PIXEL_MODE_BGR24, 0
-                );
+    const size_t width = bj_bitmap_width(p_original);
+    const size_t height = bj_bitmap_height(p_original);
 
-                uint8_t* p_src_row         = bj_bitmap_pixels(p_original);
-                uint8_t* p_dest_row        = bj_bitmap_pixels(p_bitmap);
-                const size_t src_stride  = bj_bitmap_stride(p_original);
-                const size_t dest_stride = bj_bitmap_stride(p_bitmap);
-
-                for(size_t h = 0 ; h < height ; ++h) {
-                    
-                    uint8_t* p_dest_byte = p_dest_row;
-
-                    for(size_t w = 0 ; w < width ; ++w) {
-                        size_t index = 0;
-                        switch(mode) {
-                            case BJ_PIXEL_MODE_INDEXED_1:
-                                index = (p_src_row[w / 8] >> (7 - (w % 8))) & 0x01;
-                                break;
-                            case BJ_PIXEL_MODE_INDEXED_4:
-                                index = (p_src_row[w / 2] >> (w % 2 == 0 ? 4 : 0)) & 0x0F;
-                                break;
-                            case BJ_PIXEL_MODE_INDEXED_8:
-                                index = p_src_row[w];
-                                break;
-                            default:
-                                break;
-                        }
-                        if (index >= color_table_size) {
-                            bj_warn("Invalid color table index %zu >= %zu, clamping to 0", index, color_table_size);
-                            index = 0;
-                        }
-                        *p_dest_byte++ = p_color_table[index].blue;
-                        *p_dest_byte++ = p_color_table[index].green;
-                        *p_dest_byte++ = p_color_table[index].red;
-
-                        // *p_dest_byte++ = p_color_table[index].blue;
-                        // *p_dest_byte++ = p_color_table[index].green;
-                        // *p_dest_byte++ = p_color_table[index].red;
-                    }
+    struct bj_bitmap* p_bitmap = bj_create_bitmap(
+        width, height, BJ_PIXEL_MODE_BGR24, 0
+    );
 
-                    p_src_row += src_stride;
-                    p_dest_row += dest_stride;
-                }
+    uint8_t* p_src_row         = bj_bitmap_pixels(p_original);
+    uint8_t* p_dest_row        = bj_bitmap_pixels(p_bitmap);
+    const size_t src_stride  = bj_bitmap_stride(p_original);
+    const size_t dest_stride = bj_bitmap_stride(p_bitmap);
 
-                bj_destroy_bitmap(p_original);
-                return p_bitmap;
-            }
-            break;
-        default:
-            break;
+    for(size_t h = 0 ; h < height ; ++h) {
+        dib_expand_indexed_row(p_src_row, p_dest_row, width, mode, p_color_table, color_table_size);
+        p_src_row += src_stride;
+        p_dest_row += dest_stride;
     }
 
-    return p_original;
-
+    bj_destroy_bitmap(p_original);
+    return p_bitmap;
 }
 
 static size_t dib_uncompressed_row_size(uint32_t width, uint16_t bit_count) {
@@ -163,8 +165,80 @@ static void dib_read_uncompressed_raster(
     }
 }
 
-static void dib_read_rle_raster(
-    struct bj_stream* p_stream, 
+// Uncompressed indexed rows are expanded from the stream memory straight
+// into the BGR24 destination, without an intermediate indexed bitmap
+static void dib_read_indexed_raster(
+    struct bj_stream*    p_stream,
+    uint8_t*             dst_pixels,
+    size_t               dst_stride,
+    uint32_t             width,
+    int32_t              height,
+    uint16_t             dib_bit_count,
+    enum bj_pixel_mode   src_mode,
+    const dib_table_rgb* p_color_table,
+    size_t               color_table_size,
+    struct bj_error**    p_error
+) {
+    const bj_bool is_top_down = height < 0;
+
+    uint8_t* const dst_end = dst_pixels + dst_stride * (size_t)_ABS(height);
+    bj_assert(dst_stride > 0);
+
+    uint8_t* p_dst_row        = is_top_down ? dst_pixels : dst_end - dst_stride;
+    const size_t src_stride = dib_uncompressed_row_size(width, dib_bit_count);
+    const size_t row_bytes  = ((size_t)width * dib_bit_count + 7) / 8;
+
+    while(p_dst_row >= dst_pixels && p_dst_row < dst_end) {
+        const void* p_src_row = 0;
+        const size_t available = bj_peek_stream(p_stream, src_stride, &p_src_row);
+        if(available < row_bytes) {
+            bj_set_error(p_error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_EOS);
+            return;
+        }
+        dib_expand_indexed_row(p_src_row, p_dst_row, width, src_mode, p_color_table, color_table_size);
+        bj_consume_stream(p_stream, available);
+
+        if(is_top_down) {
+            p_dst_row += dst_stride;
+        } else {
+            p_dst_row -= dst_stride;
+        }
+    }
+}
+
+// Bytes of a compressed raster, borrowed from the stream by spans
+#define DIB_READ_SPAN 4096
+
+struct dib_byte_reader {
+    struct bj_stream* stream;
+    const uint8_t*    start; // Of the bytes not consumed from the stream yet
+    const uint8_t*    at;
+    const uint8_t*    end;
+};
+
+// Moves the stream past the bytes read so far
+static void dib_release_span(struct dib_byte_reader* reader) {
+    bj_consume_stream(reader->stream, (size_t)(reader->at - reader->start));
+    reader->start = reader->at;
+}
+
+static bj_bool dib_read_byte(struct dib_byte_reader* reader, uint8_t* byte) {
+    if (reader->at == reader->end) {
+        dib_release_span(reader);
+        const void* span = 0;
+        const size_t available = bj_peek_stream(reader->stream, DIB_READ_SPAN, &span);
+        if (available == 0) {
+            return BJ_FALSE;
+        }
+        reader->start = reader->at = span;
+        reader->end   = reader->at + available;
+    }
+    *byte = *reader->at++;
+    return BJ_TRUE;
+}
+
+static void dib_decode_rle(
+    struct dib_byte_reader* p_reader,
     uint8_t*        p_dst_pixels,     
     size_t      dst_stride,
     uint32_t        width,
@@ -191,7 +265,7 @@ static void dib_read_rle_raster(
     uint32_t height = _ABS(i_height);
 
     while (BJ_TRUE) {
-        if (state != rle_fsm_keep_and_write_index && bj_stream_read_t(p_stream, uint8_t, &last_read_byte) == 0) {
+        if (state != rle_fsm_keep_and_write_index && !dib_read_byte(p_reader, &last_read_byte)) {
             bj_set_error(p_error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_EOS);
             return;
         }
@@ -287,6 +361,20 @@ static void dib_read_rle_raster(
 }
 
 
+static void dib_read_rle_raster(
+    struct bj_stream* p_stream,
+    uint8_t*          p_dst_pixels,
+    size_t            dst_stride,
+    uint32_t          width,
+    int32_t           i_height,
+    bj_bool           use_rle_4,
+    struct bj_error** p_error
+) {
+    struct dib_byte_reader reader = {.stream = p_stream};
+    dib_decode_rle(&reader, p_dst_pixels, dst_stride, width, i_height, use_rle_4, p_error);
+    dib_release_span(&reader);
+}
+
 struct bj_bitmap* dib_create_bitmap_from_stream(
     struct bj_stream*        p_stream, 
     struct bj_error**        p_error
@@ -505,16 +593,20 @@ struct bj_bitmap* dib_create_bitmap_from_stream(
             bj_free(color_table);
             return 0;
         } else {
-            for (size_t i = 0; i < color_table_len; ++i) {
-                if (bj_stream_read_t(p_stream, char, &color_table[i].blue) != sizeof(char) ||
-                    bj_stream_read_t(p_stream, char, &color_table[i].green) != sizeof(char) ||
-                    bj_stream_read_t(p_stream, char, &color_table[i].red) != sizeof(char) ||
-                    bj_stream_skip_t(p_stream, char) != sizeof(char)) {
-                    bj_set_error(p_error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_EOS);
-                    bj_free(color_table);
-                    return 0;
-                }
+            // Entries are BGRX quads
+            const void* p_quads = 0;
+            if (bj_peek_stream(p_stream, color_table_len * 4, &p_quads) < color_table_len * 4) {
+                bj_set_error(p_error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_EOS);
+                bj_free(color_table);
+                return 0;
+            }
+            const uint8_t* p_quad = p_quads;
+            for (size_t i = 0; i < color_table_len; ++i, p_quad += 4) {
+                color_table[i].blue  = p_quad[0];
+                color_table[i].green = p_quad[1];
+                color_table[i].red   = p_quad[2];
             }
+            bj_consume_stream(p_stream, color_table_len * 4);
         }
     }
 
@@ -526,11 +618,14 @@ struct bj_bitmap* dib_create_bitmap_from_stream(
     }
     bj_seek_stream(p_stream, dib_data_offset, BJ_SEEK_BEGIN);
 
+    // Uncompressed indexed rasters are expanded to BGR24 while reading
+    const bj_bool expand_indexed = dib_compression == DIB_BI_RGB && dib_is_indexed(src_mode);
+
     // Stride of the bitmap is either the computed dib size (if mode is unknown) or 0.
     // If 0, the bitmap initialized will set to the best choice for us.
     struct bj_bitmap* p_bitmap = bj_create_bitmap(
         dib_width, _ABS(dib_height),
-        src_mode,
+        expand_indexed ? BJ_PIXEL_MODE_BGR24 : src_mode,
         src_mode == BJ_PIXEL_MODE_UNKNOWN ? dib_uncompressed_row_size(dib_width, dib_bit_count) : 0
     );
 
@@ -542,8 +637,21 @@ struct bj_bitmap* dib_create_bitmap_from_stream(
 
     struct bj_error* p_inner_error = 0;
     switch(dib_compression) {
-        case DIB_BI_BITFIELD:
         case DIB_BI_RGB:
+            if (expand_indexed) {
+                dib_read_indexed_raster(
+                    p_stream,
+                    bj_bitmap_pixels(p_bitmap), // dst_pixels
+                    bj_bitmap_stride(p_bitmap), // dst_stride
+                    dib_width, dib_height,
+                    dib_bit_count, src_mode,
+                    color_table, color_table_len,
+                    &p_inner_error
+                );
+                break;
+            }
+            // fallthrough
+        case DIB_BI_BITFIELD:
             dib_read_uncompressed_raster(
                 p_stream,
                 bj_bitmap_pixels(p_bitmap), // dst_pixels
@@ -593,3 +701,251 @@ struct bj_bitmap* dib_create_bitmap_from_stream(
 
                 
 
+////////////////////////////////////////////////////////////////////////////////
+// Encoding
+
+// Stores `value` as `size` little-endian bytes and returns the next byte
+static uint8_t* dib_put_le(uint8_t* p_dst, uint32_t value, size_t size) {
+    for (size_t b = 0; b < size; ++b) {
+        *p_dst++ = (uint8_t)(value >> (8 * b));
+    }
+    return p_dst;
+}
+
+static bj_bool dib_write(struct bj_stream* p_stream, const void* p_data, size_t count, struct bj_error** p_error) {
+    if (bj_write_stream(p_stream, p_data, count) != count) {
+        bj_set_error(p_error, BJ_ERROR_CANNOT_WRITE, ERR_MSG_CANNOT_WRITE);
+        return BJ_FALSE;
+    }
+    return BJ_TRUE;
+}
+
+// Writes the file and info headers, followed by a grayscale palette of
+// `palette_len` entries. Sizes of RLE rasters are patched once known.
+static bj_bool dib_write_headers(
+    struct bj_stream* p_stream,
+    uint32_t          width,
+    int32_t           height,
+    uint16_t          bit_count,
+    uint32_t          compression,
+    uint32_t          image_size,
+    uint32_t          palette_len,
+    struct bj_error** p_error
+) {
+    uint8_t headers[DIB_FILE_HEADER_SIZE + DIB_INFO_HEADER_SIZE + 256 * 4];
+    const uint32_t data_offset = DIB_FILE_HEADER_SIZE + DIB_INFO_HEADER_SIZE + palette_len * 4;
+
+    uint8_t* p = headers;
+    p = dib_put_le(p, DIB_SIGNATURE, 2);
+    p = dib_put_le(p, data_offset + image_size, 4);
+    p = dib_put_le(p, 0, 4);
+    p = dib_put_le(p, data_offset, 4);
+
+    p = dib_put_le(p, DIB_INFO_HEADER_SIZE, 4);
+    p = dib_put_le(p, width, 4);
+    p = dib_put_le(p, (uint32_t)height, 4);
+    p = dib_put_le(p, 1, 2);                // Planes
+    p = dib_put_le(p, bit_count, 2);
+    p = dib_put_le(p, compression, 4);
+    p = dib_put_le(p, image_size, 4);
+    p = dib_put_le(p, 2835, 4);             // 72 DPI
+    p = dib_put_le(p, 2835, 4);
+    p = dib_put_le(p, palette_len, 4);
+    p = dib_put_le(p, 0, 4);
+
+    for (uint32_t i = 0; i < palette_len; ++i) {
+        const uint8_t level = (uint8_t)(palette_len > 1 ? i * 255 / (palette_len - 1) : 0);
+        *p++ = level;
+        *p++ = level;
+        *p++ = level;
+        *p++ = 0;
+    }
+
+    return dib_write(p_stream, headers, (size_t)(p - headers), p_error);
+}
+
+// Direct color rasters are written top-down, so that rows are dumped in
+// memory order. When the bitmap rows are already laid out like the BMP
+// rows, the whole buffer goes in a single write.
+static bj_bool dib_write_uncompressed_raster(
+    const struct bj_bitmap* p_bitmap,
+    struct bj_stream*       p_stream,
+    uint16_t                bit_count,
+    bj_row_converter_fn     convert_row,
+    struct bj_error**       p_error
+) {
+    const size_t width     = p_bitmap->width;
+    const size_t height    = p_bitmap->height;
+    const size_t row_size  = dib_uncompressed_row_size((uint32_t)width, bit_count);
+    const size_t row_bytes = width * bit_count / 8;
+
+    if (convert_row == 0 && p_bitmap->stride == row_size && row_size == row_bytes) {
+        return dib_write(p_stream, bj_row_ptr(p_bitmap, 0), row_size * height, p_error);
+    }
+
+    uint8_t* p_row = bj_calloc(row_size);
+    if (p_row == 0) {
+        bj_set_error(p_error, BJ_ERROR_CANNOT_ALLOCATE, ERR_MSG_CANNOT_ALLOC_ROW);
+        return BJ_FALSE;
+    }
+
+    bj_bool written = BJ_TRUE;
+    for (size_t y = 0; y < height && written; ++y) {
+        if (convert_row != 0) {
+            convert_row(bj_row_ptr(p_bitmap, y), p_row, width);
+        } else {
+            bj_memcpy(p_row, bj_row_ptr(p_bitmap, y), row_bytes);
+        }
+        written = dib_write(p_stream, p_row, row_size, p_error);
+    }
+
+    bj_free(p_row);
+    return written;
+}
+
+// Encodes a row of 8 bit indices. Repeated indices become encoded runs,
+// others absolute runs, or runs of 1 when shorter than 3 indices.
+// Writes at most `2 * width` bytes.
+static size_t dib_encode_rle8_row(const uint8_t* p_src, size_t width, uint8_t* p_dst) {
+    uint8_t* p = p_dst;
+    size_t x = 0;
+    while (x < width) {
+        size_t run = 1;
+        while (x + run < width && run < 255 && p_src[x + run] == p_src[x]) {
+            ++run;
+        }
+        if (run >= 2) {
+            *p++ = (uint8_t)run;
+            *p++ = p_src[x];
+            x += run;
+            continue;
+        }
+
+        // Literal indices, up to the next repeated pair
+        size_t literal = 1;
+        while (x + literal < width && literal < 255
+               && !(x + literal + 1 < width && p_src[x + literal] == p_src[x + literal + 1])) {
+            ++literal;
+        }
+        if (literal < 3) {
+            for (size_t i = 0; i < literal; ++i) {
+                *p++ = 1;
+                *p++ = p_src[x + i];
+            }
+        } else {
+            *p++ = 0;
+            *p++ = (uint8_t)literal;
+            bj_memcpy(p, p_src + x, literal);
+            p += literal;
+            if (literal % 2 == 1) {
+                *p++ = 0;
+            }
+        }
+        x += literal;
+    }
+    return (size_t)(p - p_dst);
+}
+
+// Indexed rasters are written as RLE8, bottom-up as the format requires.
+// 1 and 4bpp rows are unpacked to 8 bit indices first.
+static bj_bool dib_write_rle8_raster(
+    const struct bj_bitmap* p_bitmap,
+    struct bj_stream*       p_stream,
+    size_t*                 p_image_size,
+    struct bj_error**       p_error
+) {
+    const size_t width = p_bitmap->width;
+    const size_t bpp   = BJ_PIXEL_GET_BPP(p_bitmap->mode);
+
+    // Unpacked indices, followed by the encoded row and its end marker
+    uint8_t* p_indices = bj_malloc(width + 2 * width + 2);
+    if (p_indices == 0) {
+        bj_set_error(p_error, BJ_ERROR_CANNOT_ALLOCATE, ERR_MSG_CANNOT_ALLOC_ROW);
+        return BJ_FALSE;
+    }
+    uint8_t* p_encoded = p_indices + width;
+
+    bj_bool written = BJ_TRUE;
+    *p_image_size = 0;
+    for (size_t y = p_bitmap->height; y-- > 0 && written;) {
+        const uint8_t* p_row = bj_row_ptr(p_bitmap, y);
+        if (bpp != 8) {
+            for (size_t x = 0; x < width; ++x) {
+                p_indices[x] = bpp == 1
+                    ? (uint8_t)((p_row[x / 8] >> (7 - (x % 8))) & 0x01)
+                    : (uint8_t)((p_row[x / 2] >> (x % 2 == 0 ? 4 : 0)) & 0x0F);
+            }
+            p_row = p_indices;
+        }
+
+        size_t size = dib_encode_rle8_row(p_row, width, p_encoded);
+        p_encoded[size++] = 0;
+        p_encoded[size++] = y == 0 ? 1 : 0; // End of bitmap or end of line
+        written = dib_write(p_stream, p_encoded, size, p_error);
+        *p_image_size += size;
+    }
+
+    bj_free(p_indices);
+    return written;
+}
+
+// Patches a little-endian field written at `position`, then goes back to
+// the end of the stream
+static bj_bool dib_patch_field(struct bj_stream* p_stream, size_t position, uint32_t value, struct bj_error** p_error) {
+    uint8_t field[4];
+    dib_put_le(field, value, 4);
+    const size_t end = bj_tell_stream(p_stream);
+    bj_seek_stream(p_stream, (ptrdiff_t)position, BJ_SEEK_BEGIN);
+    const bj_bool written = dib_write(p_stream, field, 4, p_error);
+    bj_seek_stream(p_stream, (ptrdiff_t)end, BJ_SEEK_BEGIN);
+    return written;
+}
+
+bj_bool dib_write_bitmap_to_stream(
+    const struct bj_bitmap* p_bitmap,
+    struct bj_stream*       p_stream,
+    struct bj_error**       p_error
+) {
+    const uint32_t width  = (uint32_t)p_bitmap->width;
+    const int32_t  height = (int32_t)p_bitmap->height;
+    if (width == 0 || height == 0) {
+        bj_set_error(p_error, BJ_ERROR_INCORRECT_VALUE, ERR_MSG_BAD_BMP_SIZE);
+        return BJ_FALSE;
+    }
+
+    if (dib_is_indexed(p_bitmap->mode)) {
+        const size_t   start       = bj_tell_stream(p_stream);
+        const uint32_t palette_len = 1u << BJ_PIXEL_GET_BPP(p_bitmap->mode);
+        size_t image_size = 0;
+        if (!dib_write_headers(p_stream, width, height, DIB_BIT_COUNT_8, DIB_BI_RLE8, 0, palette_len, p_error)
+            || !dib_write_rle8_raster(p_bitmap, p_stream, &image_size, p_error)) {
+            return BJ_FALSE;
+        }
+        const uint32_t data_offset = DIB_FILE_HEADER_SIZE + DIB_INFO_HEADER_SIZE + palette_len * 4;
+        return dib_patch_field(p_stream, start + 2, data_offset + (uint32_t)image_size, p_error)
+            && dib_patch_field(p_stream, start + DIB_FILE_HEADER_SIZE + 20, (uint32_t)image_size, p_error);
+    }
+
+    uint16_t            bit_count   = DIB_BIT_COUNT_24;
+    bj_row_converter_fn convert_row = 0;
+    switch (BJ_PIXEL_GET_BPP(p_bitmap->mode)) {
+        case 32:
+            bit_count = DIB_BIT_COUNT_32;
+            break;
+        case 24:
+            break;
+        case 16:
+            convert_row = bj_get_row_converter(p_bitmap->mode, BJ_PIXEL_MODE_BGR24);
+            if (convert_row != 0) {
+                break;
+            }
+            // fallthrough
+        default:
+            bj_set_error(p_error, BJ_ERROR_UNSUPPORTED, ERR_MSG_UNSUPPORTED_MODE);
+            return BJ_FALSE;
+    }
+
+    const uint32_t image_size = (uint32_t)(dib_uncompressed_row_size(width, bit_count) * p_bitmap->height);
+    return dib_write_headers(p_stream, width, -height, bit_count, DIB_BI_RGB, image_size, 0, p_error)
+        && dib_write_uncompressed_raster(p_bitmap, p_stream, bit_count, convert_row, p_error);
+}
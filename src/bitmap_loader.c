@@ -0,0 +1,416 @@
+// bitmap_loader.c - Background loading of bitmap files.
+//
+// Requests move through three lists, all guarded by the loader mutex:
+// `queued` in submission order, `loading` while a worker decodes them and
+// `completed` in the order they finish, until polled.
+//
+// A worker opens the file, then reads the dimensions from the BMP header
+// to estimate the memory the decode will take. It waits on `wake` until the
+// estimate fits in the budget, unless nothing else is charged so that a
+// single large file still loads. Once decoded, the charge is replaced by the
+// actual size of the bitmap, and released when the bitmap is polled.
+//
+// Cancelled requests are flagged; workers check the flag between steps.
+
+#include <banjo/bitmap_loader.h>
+#include <banjo/memory.h>
+#include <banjo/stream.h>
+
+#include <bitmap.h>
+#include <check.h>
+#include <pool.h>
+#include <thread.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#define MAX_LOADER_THREADS 4
+
+struct loader_request {
+    struct loader_request*     next;
+    uint32_t                   id;
+    enum bj_bitmap_load_status status;
+    bj_bool                    cancelled; // Asked while loading
+    enum bj_pixel_mode         mode;
+    void*                      user_data;
+    size_t                     cost;      // Bytes charged to the budget
+    struct bj_bitmap*          bitmap;
+    struct bj_error*           error;
+    char                       path[];
+};
+
+struct request_list {
+    struct loader_request*  head;
+    struct loader_request** tail;
+};
+
+struct bj_bitmap_loader {
+    struct bj_mutex*     lock;
+    struct bj_condition* wake;     // Workers wait here for requests, budget or quit
+    struct bj_thread*    workers[MAX_LOADER_THREADS];
+    size_t               worker_count;
+    bj_bool              quit;
+    struct request_list  queued;
+    struct request_list  loading;
+    struct request_list  completed;
+    size_t               budget;
+    size_t               in_flight;
+    uint32_t             next_id;
+};
+
+// ----------------------------------------------------------------------------
+// Lists
+// ----------------------------------------------------------------------------
+
+static void list_init(struct request_list* list) {
+    list->head = 0;
+    list->tail = &list->head;
+}
+
+static void list_push(struct request_list* list, struct loader_request* request) {
+    request->next = 0;
+    *list->tail   = request;
+    list->tail    = &request->next;
+}
+
+static struct loader_request* list_pop(struct request_list* list) {
+    struct loader_request* request = list->head;
+    if (request != 0) {
+        list->head = request->next;
+        if (list->head == 0) {
+            list->tail = &list->head;
+        }
+    }
+    return request;
+}
+
+// Unlinks and returns the request with `id`, or 0
+static struct loader_request* list_remove(struct request_list* list, uint32_t id) {
+    for (struct loader_request** link = &list->head; *link != 0; link = &(*link)->next) {
+        struct loader_request* request = *link;
+        if (request->id == id) {
+            *link = request->next;
+            if (list->tail == &request->next) {
+                list->tail = link;
+            }
+            return request;
+        }
+    }
+    return 0;
+}
+
+static struct loader_request* list_find(const struct request_list* list, uint32_t id) {
+    for (struct loader_request* request = list->head; request != 0; request = request->next) {
+        if (request->id == id) {
+            return request;
+        }
+    }
+    return 0;
+}
+
+static void free_request(struct loader_request* request) {
+    bj_destroy_bitmap(request->bitmap);
+    bj_clear_error(&request->error);
+    bj_free(request);
+}
+
+static void free_list(struct request_list* list) {
+    struct loader_request* request = 0;
+    while ((request = list_pop(list)) != 0) {
+        free_request(request);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Loading
+// ----------------------------------------------------------------------------
+
+// Upper bound of the memory taken by decoding the BMP file in `stream` and
+// converting it to `mode`: decoded bitmaps are at most 32bpp. Files whose
+// header cannot be read are charged their size, the decode fails anyway.
+static size_t estimate_cost(struct bj_stream* stream, enum bj_pixel_mode mode) {
+    const void* header = 0;
+    if (bj_peek_stream(stream, 26, &header) < 26) {
+        return bj_get_stream_length(stream);
+    }
+    const uint8_t* bytes = header;
+    const uint32_t width  = (uint32_t)bytes[18] | (uint32_t)bytes[19] << 8 | (uint32_t)bytes[20] << 16 | (uint32_t)bytes[21] << 24;
+    const int32_t  height = (int32_t)((uint32_t)bytes[22] | (uint32_t)bytes[23] << 8 | (uint32_t)bytes[24] << 16 | (uint32_t)bytes[25] << 24);
+    const size_t   rows   = (size_t)(height < 0 ? -(int64_t)height : height);
+
+    const size_t bytes_per_pixel = 4 + (mode != BJ_PIXEL_MODE_UNKNOWN ? (BJ_PIXEL_GET_BPP(mode) + 7) / 8 : 0);
+    if (rows != 0 && width > SIZE_MAX / bytes_per_pixel / rows) {
+        return SIZE_MAX;
+    }
+    return (size_t)width * rows * bytes_per_pixel;
+}
+
+// Replaces the charge of `request`. The lock must be held.
+static void charge(struct bj_bitmap_loader* loader, struct loader_request* request, size_t cost) {
+    loader->in_flight -= request->cost;
+    loader->in_flight += cost;
+    if (cost < request->cost) {
+        bj_condition_broadcast(loader->wake);
+    }
+    request->cost = cost;
+}
+
+// Runs a request in the `loading` list without the lock, and sets its
+// status, bitmap and error.
+static void load_request(struct bj_bitmap_loader* loader, struct loader_request* request) {
+    struct bj_error*  error  = 0;
+    struct bj_bitmap* bitmap = 0;
+
+    struct bj_stream* stream = bj_open_stream_file(request->path, &error);
+    if (stream != 0) {
+        const size_t estimate = estimate_cost(stream, request->mode);
+        const size_t cost     = estimate < loader->budget ? estimate : loader->budget;
+
+        bj_mutex_lock(loader->lock);
+        while (!loader->quit && !request->cancelled
+               && loader->in_flight > 0 && loader->in_flight + cost > loader->budget) {
+            bj_condition_wait(loader->wake, loader->lock);
+        }
+        const bj_bool go = !loader->quit && !request->cancelled;
+        if (go) {
+            charge(loader, request, cost);
+        }
+        bj_mutex_unlock(loader->lock);
+
+        if (go) {
+            bitmap = dib_create_bitmap_from_stream(stream, &error);
+        }
+        bj_close_stream(stream);
+    }
+
+    if (bitmap != 0 && request->mode != BJ_PIXEL_MODE_UNKNOWN
+        && bj_bitmap_mode(bitmap) != (int)request->mode) {
+        bj_mutex_lock(loader->lock);
+        const bj_bool go = !loader->quit && !request->cancelled;
+        bj_mutex_unlock(loader->lock);
+
+        // A cancelled request skips the conversion: the bitmap is dropped
+        // below either way
+        struct bj_bitmap* converted = go ? bj_convert_bitmap(bitmap, request->mode) : 0;
+        bj_destroy_bitmap(bitmap);
+        bitmap = converted;
+        if (bitmap == 0 && go) {
+            bj_set_error_fmt(&error, BJ_ERROR_CANNOT_ALLOCATE,
+                "Cannot convert '%s' to pixel mode 0x%08X", request->path, (unsigned)request->mode);
+        }
+    }
+
+    bj_mutex_lock(loader->lock);
+    if (request->cancelled || loader->quit) {
+        request->status = BJ_BITMAP_LOAD_CANCELLED;
+        bj_destroy_bitmap(bitmap);
+        bj_clear_error(&error);
+        charge(loader, request, 0);
+    } else if (bitmap != 0) {
+        request->status = BJ_BITMAP_LOAD_DONE;
+        request->bitmap = bitmap;
+        charge(loader, request, bj_bitmap_stride(bitmap) * bj_bitmap_height(bitmap));
+    } else {
+        request->status = BJ_BITMAP_LOAD_FAILED;
+        request->error  = error;
+        charge(loader, request, 0);
+    }
+    bj_mutex_unlock(loader->lock);
+}
+
+// Takes the next queued request, loads it and moves it to `completed`. The
+// lock is held on entry and on return.
+static void run_next_request(struct bj_bitmap_loader* loader) {
+    struct loader_request* request = list_pop(&loader->queued);
+    request->status = BJ_BITMAP_LOAD_LOADING;
+    list_push(&loader->loading, request);
+    bj_mutex_unlock(loader->lock);
+
+    load_request(loader, request);
+
+    bj_mutex_lock(loader->lock);
+    list_remove(&loader->loading, request->id);
+    list_push(&loader->completed, request);
+}
+
+static void worker_main(void* data) {
+    struct bj_bitmap_loader* loader = data;
+    bj_mutex_lock(loader->lock);
+    for (;;) {
+        while (!loader->quit && loader->queued.head == 0) {
+            bj_condition_wait(loader->wake, loader->lock);
+        }
+        if (loader->quit) {
+            break;
+        }
+        run_next_request(loader);
+    }
+    bj_mutex_unlock(loader->lock);
+
+    // Blocks of bitmaps polled by the main thread are freed there
+    bj_flush_pool_cache();
+}
+
+// ----------------------------------------------------------------------------
+// API
+// ----------------------------------------------------------------------------
+
+struct bj_bitmap_loader* bj_create_bitmap_loader(
+    size_t threads,
+    size_t memory_budget
+) {
+    struct bj_bitmap_loader* loader = bj_calloc(sizeof(struct bj_bitmap_loader));
+    if (loader == 0) {
+        return 0;
+    }
+    loader->lock = bj_mutex_create();
+    loader->wake = bj_condition_create();
+    if (loader->lock == 0 || loader->wake == 0) {
+        bj_destroy_bitmap_loader(loader);
+        return 0;
+    }
+    list_init(&loader->queued);
+    list_init(&loader->loading);
+    list_init(&loader->completed);
+    loader->budget  = memory_budget > 0 ? memory_budget : BJ_BITMAP_LOADER_BUDGET;
+    loader->next_id = 1;
+
+    if (threads == 0) {
+        const size_t hardware = bj_hardware_thread_count();
+        threads = hardware > 1 ? hardware - 1 : 1;
+    }
+    if (threads > MAX_LOADER_THREADS) {
+        threads = MAX_LOADER_THREADS;
+    }
+    while (loader->worker_count < threads) {
+        struct bj_thread* thread = bj_thread_create(worker_main, loader);
+        if (thread == 0) {
+            break; // Fewer workers, or loads run when polling
+        }
+        loader->workers[loader->worker_count++] = thread;
+    }
+    return loader;
+}
+
+void bj_destroy_bitmap_loader(
+    struct bj_bitmap_loader* loader
+) {
+    if (loader == 0) {
+        return;
+    }
+    if (loader->lock != 0 && loader->wake != 0) {
+        bj_mutex_lock(loader->lock);
+        loader->quit = BJ_TRUE;
+        bj_condition_broadcast(loader->wake);
+        bj_mutex_unlock(loader->lock);
+
+        for (size_t i = 0; i < loader->worker_count; ++i) {
+            bj_thread_join(loader->workers[i]);
+        }
+        free_list(&loader->queued);
+        free_list(&loader->completed);
+    }
+    if (loader->wake) bj_condition_destroy(loader->wake);
+    if (loader->lock) bj_mutex_destroy(loader->lock);
+    bj_free(loader);
+}
+
+uint32_t bj_submit_bitmap_load(
+    struct bj_bitmap_loader* loader,
+    const char*              path,
+    enum bj_pixel_mode       mode,
+    void*                    user_data
+) {
+    bj_check_or_0(loader);
+    bj_check_or_0(path);
+
+    const size_t path_size = strlen(path) + 1;
+    struct loader_request* request = bj_calloc(sizeof(struct loader_request) + path_size);
+    if (request == 0) {
+        return 0;
+    }
+    bj_memcpy(request->path, path, path_size);
+    request->status    = BJ_BITMAP_LOAD_QUEUED;
+    request->mode      = mode;
+    request->user_data = user_data;
+
+    bj_mutex_lock(loader->lock);
+    request->id = loader->next_id++;
+    list_push(&loader->queued, request);
+    bj_condition_signal(loader->wake);
+    bj_mutex_unlock(loader->lock);
+    return request->id;
+}
+
+enum bj_bitmap_load_status bj_get_bitmap_load_status(
+    struct bj_bitmap_loader* loader,
+    uint32_t                 id
+) {
+    bj_check_or_return(loader, BJ_BITMAP_LOAD_UNKNOWN);
+
+    bj_mutex_lock(loader->lock);
+    struct loader_request* request = list_find(&loader->queued, id);
+    if (request == 0) request = list_find(&loader->loading, id);
+    if (request == 0) request = list_find(&loader->completed, id);
+    const enum bj_bitmap_load_status status = request ? request->status : BJ_BITMAP_LOAD_UNKNOWN;
+    bj_mutex_unlock(loader->lock);
+    return status;
+}
+
+bj_bool bj_cancel_bitmap_load(
+    struct bj_bitmap_loader* loader,
+    uint32_t                 id
+) {
+    bj_check_or_0(loader);
+
+    bj_mutex_lock(loader->lock);
+    struct loader_request* request = list_remove(&loader->queued, id);
+    if (request != 0) {
+        request->status = BJ_BITMAP_LOAD_CANCELLED;
+        list_push(&loader->completed, request);
+    } else if ((request = list_find(&loader->loading, id)) != 0) {
+        request->cancelled = BJ_TRUE;
+        bj_condition_broadcast(loader->wake); // Stop waiting for budget
+    }
+    bj_mutex_unlock(loader->lock);
+    return request != 0;
+}
+
+bj_bool bj_poll_bitmap_loader(
+    struct bj_bitmap_loader* loader,
+    struct bj_bitmap_load*   load
+) {
+    bj_check_or_0(loader);
+    bj_check_or_0(load);
+
+    bj_mutex_lock(loader->lock);
+    if (loader->worker_count == 0 && loader->completed.head == 0 && loader->queued.head != 0) {
+        run_next_request(loader);
+    }
+    struct loader_request* request = list_pop(&loader->completed);
+    if (request != 0) {
+        charge(loader, request, 0);
+    }
+    bj_mutex_unlock(loader->lock);
+
+    if (request == 0) {
+        return BJ_FALSE;
+    }
+    load->id        = request->id;
+    load->status    = request->status;
+    load->bitmap    = request->bitmap;
+    load->error     = request->error;
+    load->user_data = request->user_data;
+    bj_free(request);
+    return BJ_TRUE;
+}
+
+size_t bj_bitmap_loader_memory(
+    struct bj_bitmap_loader* loader
+) {
+    bj_check_or_0(loader);
+    bj_mutex_lock(loader->lock);
+    const size_t in_flight = loader->in_flight;
+    bj_mutex_unlock(loader->lock);
+    return in_flight;
+}
@@ -0,0 +1,419 @@
+// bitmap_simd.c - Vectorized row kernels for bj_blit.
+//
+// Each kernel processes the longest prefix of a row that fills whole vectors
+// and returns the number of elements it handled. bitmap_blit.c finishes the
+// remaining tail with its scalar kernels, which also remain the complete
+// fallback when no SIMD instruction set is available.
+//
+// Results are bit-exact with the scalar kernels:
+//   - XOR/OR/AND operate on the whole native value (X bits included)
+//   - ADD_SAT/SUB_SAT saturate per channel and clear the X bits, alpha
+//     saturates like the color channels in ARGB modes
+//   - Source pixels equal to the colorkey leave the destination untouched
+//
+// Instruction sets:
+//   - SSE2: x86-64 baseline, always selected on x86
+//   - AVX2: compiled with a target attribute, selected by runtime detection
+//   - NEON: AArch64 baseline
+
+#include <atomic.h>
+#include <bitmap.h>
+#include <cpu.h>
+
+#if defined(BJ_CPU_HAS_X86_SIMD)
+#   include <immintrin.h>
+#endif
+#if defined(BJ_CPU_HAS_NEON_SIMD)
+#   include <arm_neon.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// SSE2
+// ----------------------------------------------------------------------------
+
+#if defined(BJ_CPU_HAS_X86_SIMD)
+
+// Select `d` where `m` is set (colorkeyed source), `r` elsewhere.
+#define SSE2_SELECT(m, d, r) _mm_or_si128(_mm_and_si128((m), (d)), _mm_andnot_si128((m), (r)))
+
+#define SSE2_SPAN_32(EXPR)                                                     \
+    for (; i + 4 <= pixels; i += 4) {                                          \
+        const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));          \
+        const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));          \
+        __m128i r = (EXPR);                                                    \
+        if (use_key) r = SSE2_SELECT(_mm_cmpeq_epi32(s, k), d, r);             \
+        _mm_storeu_si128((__m128i*)(dst + i), r);                              \
+    }
+
+static size_t span_32_sse2(
+    const uint32_t* BJ_RESTRICT src, uint32_t* BJ_RESTRICT dst, size_t pixels,
+    bj_bool use_key, uint32_t key, enum bj_blit_op op, enum bj_pixel_mode mode
+) {
+    const __m128i k   = _mm_set1_epi32((int)key);
+    const __m128i channels = _mm_set1_epi32(bj_pixel_mode_has_alpha(mode) ? -1 : 0x00FFFFFF);
+    size_t i = 0;
+    switch (op) {
+        case BJ_BLIT_OP_COPY:    SSE2_SPAN_32(s); break;
+        case BJ_BLIT_OP_XOR:     SSE2_SPAN_32(_mm_xor_si128(d, s)); break;
+        case BJ_BLIT_OP_OR:      SSE2_SPAN_32(_mm_or_si128(d, s)); break;
+        case BJ_BLIT_OP_AND:     SSE2_SPAN_32(_mm_and_si128(d, s)); break;
+        case BJ_BLIT_OP_ADD_SAT: SSE2_SPAN_32(_mm_and_si128(_mm_adds_epu8(d, s), channels)); break;
+        case BJ_BLIT_OP_SUB_SAT: SSE2_SPAN_32(_mm_and_si128(_mm_subs_epu8(d, s), channels)); break;
+        default: break;
+    }
+    return i;
+}
+
+// 16bpp saturating ops: split channels into 16-bit lanes, operate, repack.
+// Channel values are at most 6 bits wide, so signed min is safe for clamping.
+#define SSE2_SAT_16(NAME, R_SHIFT, G_MASK, R_MAX, G_MAX, B_MAX, OP)            \
+    static inline __m128i NAME(__m128i d, __m128i s) {                         \
+        const __m128i rm = _mm_set1_epi16(R_MAX);                              \
+        const __m128i gm = _mm_set1_epi16(G_MASK);                             \
+        const __m128i bm = _mm_set1_epi16(0x1F);                               \
+        const __m128i r = OP(_mm_and_si128(_mm_srli_epi16(d, R_SHIFT), rm),    \
+                             _mm_and_si128(_mm_srli_epi16(s, R_SHIFT), rm), R_MAX); \
+        const __m128i g = OP(_mm_and_si128(_mm_srli_epi16(d, 5), gm),          \
+                             _mm_and_si128(_mm_srli_epi16(s, 5), gm), G_MAX);  \
+        const __m128i b = OP(_mm_and_si128(d, bm), _mm_and_si128(s, bm), B_MAX); \
+        return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, R_SHIFT), _mm_slli_epi16(g, 5)), b); \
+    }
+#define SSE2_ADD_CLAMP(a, b, max) _mm_min_epi16(_mm_add_epi16((a), (b)), _mm_set1_epi16(max))
+#define SSE2_SUB_CLAMP(a, b, max) _mm_subs_epu16((a), (b))
+
+SSE2_SAT_16(sse2_add_sat_565,  11, 0x3F, 0x1F, 0x3F, 0x1F, SSE2_ADD_CLAMP)
+SSE2_SAT_16(sse2_sub_sat_565,  11, 0x3F, 0x1F, 0x3F, 0x1F, SSE2_SUB_CLAMP)
+SSE2_SAT_16(sse2_add_sat_1555, 10, 0x1F, 0x1F, 0x1F, 0x1F, SSE2_ADD_CLAMP)
+SSE2_SAT_16(sse2_sub_sat_1555, 10, 0x1F, 0x1F, 0x1F, 0x1F, SSE2_SUB_CLAMP)
+
+#define SSE2_SPAN_16(EXPR)                                                     \
+    for (; i + 8 <= pixels; i += 8) {                                          \
+        const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));          \
+        const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));          \
+        __m128i r = (EXPR);                                                    \
+        if (use_key) r = SSE2_SELECT(_mm_cmpeq_epi16(s, k), d, r);             \
+        _mm_storeu_si128((__m128i*)(dst + i), r);                              \
+    }
+
+static size_t span_16_sse2(
+    const uint16_t* BJ_RESTRICT src, uint16_t* BJ_RESTRICT dst, size_t pixels,
+    bj_bool use_key, uint16_t key, enum bj_blit_op op, enum bj_pixel_mode mode
+) {
+    const __m128i k = _mm_set1_epi16((short)key);
+    const bj_bool is_565 = (mode == BJ_PIXEL_MODE_RGB565);
+    size_t i = 0;
+    switch (op) {
+        case BJ_BLIT_OP_COPY: SSE2_SPAN_16(s); break;
+        case BJ_BLIT_OP_XOR:  SSE2_SPAN_16(_mm_xor_si128(d, s)); break;
+        case BJ_BLIT_OP_OR:   SSE2_SPAN_16(_mm_or_si128(d, s)); break;
+        case BJ_BLIT_OP_AND:  SSE2_SPAN_16(_mm_and_si128(d, s)); break;
+        case BJ_BLIT_OP_ADD_SAT:
+            if (is_565) { SSE2_SPAN_16(sse2_add_sat_565(d, s)); }
+            else        { SSE2_SPAN_16(sse2_add_sat_1555(d, s)); }
+            break;
+        case BJ_BLIT_OP_SUB_SAT:
+            if (is_565) { SSE2_SPAN_16(sse2_sub_sat_565(d, s)); }
+            else        { SSE2_SPAN_16(sse2_sub_sat_1555(d, s)); }
+            break;
+        default: break;
+    }
+    return i;
+}
+
+#define SSE2_SPAN_BYTES(EXPR)                                                  \
+    for (; i + 16 <= bytes; i += 16) {                                         \
+        const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));          \
+        const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));          \
+        _mm_storeu_si128((__m128i*)(dst + i), (EXPR));                         \
+    }
+
+static size_t span_bytes_sse2(
+    const uint8_t* BJ_RESTRICT src, uint8_t* BJ_RESTRICT dst, size_t bytes,
+    enum bj_blit_op op
+) {
+    size_t i = 0;
+    switch (op) {
+        case BJ_BLIT_OP_XOR:     SSE2_SPAN_BYTES(_mm_xor_si128(d, s)); break;
+        case BJ_BLIT_OP_OR:      SSE2_SPAN_BYTES(_mm_or_si128(d, s)); break;
+        case BJ_BLIT_OP_AND:     SSE2_SPAN_BYTES(_mm_and_si128(d, s)); break;
+        case BJ_BLIT_OP_ADD_SAT: SSE2_SPAN_BYTES(_mm_adds_epu8(d, s)); break;
+        case BJ_BLIT_OP_SUB_SAT: SSE2_SPAN_BYTES(_mm_subs_epu8(d, s)); break;
+        default: break;
+    }
+    return i;
+}
+
+// ----------------------------------------------------------------------------
+// AVX2
+// ----------------------------------------------------------------------------
+
+#define AVX2_SELECT(m, d, r) _mm256_blendv_epi8((r), (d), (m))
+
+#define AVX2_SPAN_32(EXPR)                                                     \
+    for (; i + 8 <= pixels; i += 8) {                                          \
+        const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));       \
+        const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));       \
+        __m256i r = (EXPR);                                                    \
+        if (use_key) r = AVX2_SELECT(_mm256_cmpeq_epi32(s, k), d, r);          \
+        _mm256_storeu_si256((__m256i*)(dst + i), r);                           \
+    }
+
+BJ_TARGET_AVX2 static size_t span_32_avx2(
+    const uint32_t* BJ_RESTRICT src, uint32_t* BJ_RESTRICT dst, size_t pixels,
+    bj_bool use_key, uint32_t key, enum bj_blit_op op, enum bj_pixel_mode mode
+) {
+    const __m256i k   = _mm256_set1_epi32((int)key);
+    const __m256i channels = _mm256_set1_epi32(bj_pixel_mode_has_alpha(mode) ? -1 : 0x00FFFFFF);
+    size_t i = 0;
+    switch (op) {
+        case BJ_BLIT_OP_COPY:    AVX2_SPAN_32(s); break;
+        case BJ_BLIT_OP_XOR:     AVX2_SPAN_32(_mm256_xor_si256(d, s)); break;
+        case BJ_BLIT_OP_OR:      AVX2_SPAN_32(_mm256_or_si256(d, s)); break;
+        case BJ_BLIT_OP_AND:     AVX2_SPAN_32(_mm256_and_si256(d, s)); break;
+        case BJ_BLIT_OP_ADD_SAT: AVX2_SPAN_32(_mm256_and_si256(_mm256_adds_epu8(d, s), channels)); break;
+        case BJ_BLIT_OP_SUB_SAT: AVX2_SPAN_32(_mm256_and_si256(_mm256_subs_epu8(d, s), channels)); break;
+        default: break;
+    }
+    return i + span_32_sse2(src + i, dst + i, pixels - i, use_key, key, op, mode);
+}
+
+#define AVX2_SAT_16(NAME, R_SHIFT, G_MASK, R_MAX, G_MAX, B_MAX, OP)            \
+    BJ_TARGET_AVX2 static inline __m256i NAME(__m256i d, __m256i s) {          \
+        const __m256i rm = _mm256_set1_epi16(R_MAX);                           \
+        const __m256i gm = _mm256_set1_epi16(G_MASK);                          \
+        const __m256i bm = _mm256_set1_epi16(0x1F);                            \
+        const __m256i r = OP(_mm256_and_si256(_mm256_srli_epi16(d, R_SHIFT), rm), \
+                             _mm256_and_si256(_mm256_srli_epi16(s, R_SHIFT), rm), R_MAX); \
+        const __m256i g = OP(_mm256_and_si256(_mm256_srli_epi16(d, 5), gm),    \
+                             _mm256_and_si256(_mm256_srli_epi16(s, 5), gm), G_MAX); \
+        const __m256i b = OP(_mm256_and_si256(d, bm), _mm256_and_si256(s, bm), B_MAX); \
+        return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, R_SHIFT), _mm256_slli_epi16(g, 5)), b); \
+    }
+#define AVX2_ADD_CLAMP(a, b, max) _mm256_min_epu16(_mm256_add_epi16((a), (b)), _mm256_set1_epi16(max))
+#define AVX2_SUB_CLAMP(a, b, max) _mm256_subs_epu16((a), (b))
+
+AVX2_SAT_16(avx2_add_sat_565,  11, 0x3F, 0x1F, 0x3F, 0x1F, AVX2_ADD_CLAMP)
+AVX2_SAT_16(avx2_sub_sat_565,  11, 0x3F, 0x1F, 0x3F, 0x1F, AVX2_SUB_CLAMP)
+AVX2_SAT_16(avx2_add_sat_1555, 10, 0x1F, 0x1F, 0x1F, 0x1F, AVX2_ADD_CLAMP)
+AVX2_SAT_16(avx2_sub_sat_1555, 10, 0x1F, 0x1F, 0x1F, 0x1F, AVX2_SUB_CLAMP)
+
+#define AVX2_SPAN_16(EXPR)                                                     \
+    for (; i + 16 <= pixels; i += 16) {                                        \
+        const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));       \
+        const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));       \
+        __m256i r = (EXPR);                                                    \
+        if (use_key) r = AVX2_SELECT(_mm256_cmpeq_epi16(s, k), d, r);          \
+        _mm256_storeu_si256((__m256i*)(dst + i), r);                           \
+    }
+
+BJ_TARGET_AVX2 static size_t span_16_avx2(
+    const uint16_t* BJ_RESTRICT src, uint16_t* BJ_RESTRICT dst, size_t pixels,
+    bj_bool use_key, uint16_t key, enum bj_blit_op op, enum bj_pixel_mode mode
+) {
+    const __m256i k = _mm256_set1_epi16((short)key);
+    const bj_bool is_565 = (mode == BJ_PIXEL_MODE_RGB565);
+    size_t i = 0;
+    switch (op) {
+        case BJ_BLIT_OP_COPY: AVX2_SPAN_16(s); break;
+        case BJ_BLIT_OP_XOR:  AVX2_SPAN_16(_mm256_xor_si256(d, s)); break;
+        case BJ_BLIT_OP_OR:   AVX2_SPAN_16(_mm256_or_si256(d, s)); break;
+        case BJ_BLIT_OP_AND:  AVX2_SPAN_16(_mm256_and_si256(d, s)); break;
+        case BJ_BLIT_OP_ADD_SAT:
+            if (is_565) { AVX2_SPAN_16(avx2_add_sat_565(d, s)); }
+            else        { AVX2_SPAN_16(avx2_add_sat_1555(d, s)); }
+            break;
+        case BJ_BLIT_OP_SUB_SAT:
+            if (is_565) { AVX2_SPAN_16(avx2_sub_sat_565(d, s)); }
+            else        { AVX2_SPAN_16(avx2_sub_sat_1555(d, s)); }
+            break;
+        default: break;
+    }
+    return i + span_16_sse2(src + i, dst + i, pixels - i, use_key, key, op, mode);
+}
+
+#define AVX2_SPAN_BYTES(EXPR)                                                  \
+    for (; i + 32 <= bytes; i += 32) {                                         \
+        const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));       \
+        const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));       \
+        _mm256_storeu_si256((__m256i*)(dst + i), (EXPR));                      \
+    }
+
+BJ_TARGET_AVX2 static size_t span_bytes_avx2(
+    const uint8_t* BJ_RESTRICT src, uint8_t* BJ_RESTRICT dst, size_t bytes,
+    enum bj_blit_op op
+) {
+    size_t i = 0;
+    switch (op) {
+        case BJ_BLIT_OP_XOR:     AVX2_SPAN_BYTES(_mm256_xor_si256(d, s)); break;
+        case BJ_BLIT_OP_OR:      AVX2_SPAN_BYTES(_mm256_or_si256(d, s)); break;
+        case BJ_BLIT_OP_AND:     AVX2_SPAN_BYTES(_mm256_and_si256(d, s)); break;
+        case BJ_BLIT_OP_ADD_SAT: AVX2_SPAN_BYTES(_mm256_adds_epu8(d, s)); break;
+        case BJ_BLIT_OP_SUB_SAT: AVX2_SPAN_BYTES(_mm256_subs_epu8(d, s)); break;
+        default: break;
+    }
+    return i + span_bytes_sse2(src + i, dst + i, bytes - i, op);
+}
+
+#endif // BJ_CPU_HAS_X86_SIMD
+
+// ----------------------------------------------------------------------------
+// NEON
+// ----------------------------------------------------------------------------
+
+#if defined(BJ_CPU_HAS_NEON_SIMD)
+
+#define NEON_SPAN_32(EXPR)                                                     \
+    for (; i + 4 <= pixels; i += 4) {                                          \
+        const uint32x4_t s = vld1q_u32(src + i);                               \
+        const uint32x4_t d = vld1q_u32(dst + i);                               \
+        uint32x4_t r = (EXPR);                                                 \
+        if (use_key) r = vbslq_u32(vceqq_u32(s, k), d, r);                     \
+        vst1q_u32(dst + i, r);                                                 \
+    }
+
+#define NEON_U8_32(FN, d, s) vreinterpretq_u32_u8(FN(vreinterpretq_u8_u32(d), vreinterpretq_u8_u32(s)))
+
+static size_t span_32_neon(
+    const uint32_t* BJ_RESTRICT src, uint32_t* BJ_RESTRICT dst, size_t pixels,
+    bj_bool use_key, uint32_t key, enum bj_blit_op op, enum bj_pixel_mode mode
+) {
+    const uint32x4_t k   = vdupq_n_u32(key);
+    const uint32x4_t channels = vdupq_n_u32(bj_pixel_mode_has_alpha(mode) ? 0xFFFFFFFFu : 0x00FFFFFFu);
+    size_t i = 0;
+    switch (op) {
+        case BJ_BLIT_OP_COPY:    NEON_SPAN_32(s); break;
+        case BJ_BLIT_OP_XOR:     NEON_SPAN_32(veorq_u32(d, s)); break;
+        case BJ_BLIT_OP_OR:      NEON_SPAN_32(vorrq_u32(d, s)); break;
+        case BJ_BLIT_OP_AND:     NEON_SPAN_32(vandq_u32(d, s)); break;
+        case BJ_BLIT_OP_ADD_SAT: NEON_SPAN_32(vandq_u32(NEON_U8_32(vqaddq_u8, d, s), channels)); break;
+        case BJ_BLIT_OP_SUB_SAT: NEON_SPAN_32(vandq_u32(NEON_U8_32(vqsubq_u8, d, s), channels)); break;
+        default: break;
+    }
+    return i;
+}
+
+#define NEON_SAT_16(NAME, R_SHIFT, G_MASK, R_MAX, G_MAX, B_MAX, OP)            \
+    static inline uint16x8_t NAME(uint16x8_t d, uint16x8_t s) {                \
+        const uint16x8_t rm = vdupq_n_u16(R_MAX);                              \
+        const uint16x8_t gm = vdupq_n_u16(G_MASK);                             \
+        const uint16x8_t bm = vdupq_n_u16(0x1F);                               \
+        const uint16x8_t r = OP(vandq_u16(vshrq_n_u16(d, R_SHIFT), rm),        \
+                                vandq_u16(vshrq_n_u16(s, R_SHIFT), rm), R_MAX); \
+        const uint16x8_t g = OP(vandq_u16(vshrq_n_u16(d, 5), gm),              \
+                                vandq_u16(vshrq_n_u16(s, 5), gm), G_MAX);      \
+        const uint16x8_t b = OP(vandq_u16(d, bm), vandq_u16(s, bm), B_MAX);    \
+        return vorrq_u16(vorrq_u16(vshlq_n_u16(r, R_SHIFT), vshlq_n_u16(g, 5)), b); \
+    }
+#define NEON_ADD_CLAMP(a, b, max) vminq_u16(vaddq_u16((a), (b)), vdupq_n_u16(max))
+#define NEON_SUB_CLAMP(a, b, max) vqsubq_u16((a), (b))
+
+NEON_SAT_16(neon_add_sat_565,  11, 0x3F, 0x1F, 0x3F, 0x1F, NEON_ADD_CLAMP)
+NEON_SAT_16(neon_sub_sat_565,  11, 0x3F, 0x1F, 0x3F, 0x1F, NEON_SUB_CLAMP)
+NEON_SAT_16(neon_add_sat_1555, 10, 0x1F, 0x1F, 0x1F, 0x1F, NEON_ADD_CLAMP)
+NEON_SAT_16(neon_sub_sat_1555, 10, 0x1F, 0x1F, 0x1F, 0x1F, NEON_SUB_CLAMP)
+
+#define NEON_SPAN_16(EXPR)                                                     \
+    for (; i + 8 <= pixels; i += 8) {                                          \
+        const uint16x8_t s = vld1q_u16(src + i);                               \
+        const uint16x8_t d = vld1q_u16(dst + i);                               \
+        uint16x8_t r = (EXPR);                                                 \
+        if (use_key) r = vbslq_u16(vceqq_u16(s, k), d, r);                     \
+        vst1q_u16(dst + i, r);                                                 \
+    }
+
+static size_t span_16_neon(
+    const uint16_t* BJ_RESTRICT src, uint16_t* BJ_RESTRICT dst, size_t pixels,
+    bj_bool use_key, uint16_t key, enum bj_blit_op op, enum bj_pixel_mode mode
+) {
+    const uint16x8_t k = vdupq_n_u16(key);
+    const bj_bool is_565 = (mode == BJ_PIXEL_MODE_RGB565);
+    size_t i = 0;
+    switch (op) {
+        case BJ_BLIT_OP_COPY: NEON_SPAN_16(s); break;
+        case BJ_BLIT_OP_XOR:  NEON_SPAN_16(veorq_u16(d, s)); break;
+        case BJ_BLIT_OP_OR:   NEON_SPAN_16(vorrq_u16(d, s)); break;
+        case BJ_BLIT_OP_AND:  NEON_SPAN_16(vandq_u16(d, s)); break;
+        case BJ_BLIT_OP_ADD_SAT:
+            if (is_565) { NEON_SPAN_16(neon_add_sat_565(d, s)); }
+            else        { NEON_SPAN_16(neon_add_sat_1555(d, s)); }
+            break;
+        case BJ_BLIT_OP_SUB_SAT:
+            if (is_565) { NEON_SPAN_16(neon_sub_sat_565(d, s)); }
+            else        { NEON_SPAN_16(neon_sub_sat_1555(d, s)); }
+            break;
+        default: break;
+    }
+    return i;
+}
+
+#define NEON_SPAN_BYTES(EXPR)                                                  \
+    for (; i + 16 <= bytes; i += 16) {                                         \
+        const uint8x16_t s = vld1q_u8(src + i);                                \
+        const uint8x16_t d = vld1q_u8(dst + i);                                \
+        vst1q_u8(dst + i, (EXPR));                                             \
+    }
+
+static size_t span_bytes_neon(
+    const uint8_t* BJ_RESTRICT src, uint8_t* BJ_RESTRICT dst, size_t bytes,
+    enum bj_blit_op op
+) {
+    size_t i = 0;
+    switch (op) {
+        case BJ_BLIT_OP_XOR:     NEON_SPAN_BYTES(veorq_u8(d, s)); break;
+        case BJ_BLIT_OP_OR:      NEON_SPAN_BYTES(vorrq_u8(d, s)); break;
+        case BJ_BLIT_OP_AND:     NEON_SPAN_BYTES(vandq_u8(d, s)); break;
+        case BJ_BLIT_OP_ADD_SAT: NEON_SPAN_BYTES(vqaddq_u8(d, s)); break;
+        case BJ_BLIT_OP_SUB_SAT: NEON_SPAN_BYTES(vqsubq_u8(d, s)); break;
+        default: break;
+    }
+    return i;
+}
+
+#endif // BJ_CPU_HAS_NEON_SIMD
+
+// ----------------------------------------------------------------------------
+// Runtime selection
+// ----------------------------------------------------------------------------
+
+// One constant table per instruction set. The active one is published with
+// an atomic store so that threads blitting concurrently (worker pool) see
+// either table whole.
+static const struct bj_blit_kernels s_scalar_kernels = {0};
+#if defined(BJ_CPU_HAS_X86_SIMD)
+static const struct bj_blit_kernels s_sse2_kernels = {span_32_sse2, span_16_sse2, span_bytes_sse2};
+static const struct bj_blit_kernels s_avx2_kernels = {span_32_avx2, span_16_avx2, span_bytes_avx2};
+#endif
+#if defined(BJ_CPU_HAS_NEON_SIMD)
+static const struct bj_blit_kernels s_neon_kernels = {span_32_neon, span_16_neon, span_bytes_neon};
+#endif
+
+static void* volatile s_kernels = 0;
+
+void bj_select_blit_kernels(uint32_t cpu_features) {
+    const struct bj_blit_kernels* kernels = &s_scalar_kernels;
+
+#if defined(BJ_CPU_HAS_X86_SIMD)
+    if (cpu_features & BJ_CPU_AVX2) {
+        kernels = &s_avx2_kernels;
+    } else if (cpu_features & BJ_CPU_SSE2) {
+        kernels = &s_sse2_kernels;
+    }
+#endif
+#if defined(BJ_CPU_HAS_NEON_SIMD)
+    if (cpu_features & BJ_CPU_NEON) {
+        kernels = &s_neon_kernels;
+    }
+#endif
+    (void)cpu_features;
+
+    bj_atomic_store_ptr(&s_kernels, (void*)kernels);
+}
+
+const struct bj_blit_kernels* bj_get_blit_kernels(void) {
+    const struct bj_blit_kernels* kernels = bj_atomic_load_ptr(&s_kernels);
+    if (kernels == 0) {
+        bj_select_blit_kernels(bj_cpu_features());
+        kernels = bj_atomic_load_ptr(&s_kernels);
+    }
+    return kernels;
+}
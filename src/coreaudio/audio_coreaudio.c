@@ -4,6 +4,7 @@
 #include <banjo/error.h>
 #include <banjo/log.h>
 #include <banjo/memory.h>
+#include <atomic.h>
 #include <audio.h>
 #include <audio_layer.h>
 #include <check.h>
@@ -130,7 +131,7 @@ static void coreaudio_output_callback(
     struct bj_audio_device* dev = &ca_dev->common;
 
     // Early exit if closing or not ready
-    if (dev->should_close || !ca_dev->initialized) {
+    if (bj_atomic_load_u32(&dev->should_close) || !ca_dev->initialized) {
         return;
     }
 
@@ -138,19 +139,17 @@ static void coreaudio_output_callback(
     pthread_mutex_lock(&ca_dev->lock);
 
     // Handle reset request
-    if (dev->should_reset) {
+    if (bj_atomic_exchange_u32(&dev->should_reset, BJ_FALSE)) {
         ca_dev->sample_index = 0;
-        dev->should_reset = BJ_FALSE;
     }
 
     // Fill buffer based on playing state
-    if (dev->playing) {
+    if (bj_atomic_load_u32(&dev->playing)) {
         // Generate audio via user callback
-        dev->callback(
+        bj_audio_device_fill(
+            dev,
             buffer->mAudioData,
             ca_dev->frames_per_buffer,
-            &dev->properties,
-            dev->callback_user_data,
             ca_dev->sample_index
         );
         ca_dev->sample_index += ca_dev->frames_per_buffer;
@@ -196,8 +195,12 @@ static struct bj_audio_device* coreaudio_open_device(
     ca_dev->common.playing = BJ_TRUE; // Start playing immediately
 
     // 3. Set buffer parameters 
-    ca_dev->buffer_count      = 3;
-    ca_dev->frames_per_buffer = 512;
+    ca_dev->buffer_count      = p_properties && p_properties->period_count >= 2
+                              ? p_properties->period_count : 3;
+    ca_dev->frames_per_buffer = p_properties && p_properties->period_frames
+                              ? p_properties->period_frames : 512;
+    ca_dev->common.properties.period_frames = ca_dev->frames_per_buffer;
+    ca_dev->common.properties.period_count  = ca_dev->buffer_count;
     ca_dev->bytes_per_sample  = BJ_AUDIO_FORMAT_WIDTH(ca_dev->common.properties.format) / 8;
     ca_dev->buffer_size_bytes = ca_dev->frames_per_buffer *
                                 ca_dev->common.properties.channels *
@@ -325,7 +328,7 @@ static void coreaudio_close_device(struct bj_audio_device* dev) {
     struct coreaudio_device* ca_dev = (struct coreaudio_device*)dev;
 
     // 1. Signal shutdown
-    dev->should_close = BJ_TRUE;
+    bj_atomic_store_u32(&dev->should_close, BJ_TRUE);
 
     // 2. Stop audio queue synchronously (waits for callbacks to finish)
     if (ca_dev->audio_queue) {
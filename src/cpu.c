@@ -0,0 +1,55 @@
+#include <atomic.h>
+#include <cpu.h>
+
+#if defined(BJ_CPU_HAS_X86_SIMD) && defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+static uint32_t detect_features(void) {
+    uint32_t features = 0;
+
+#if defined(BJ_CPU_HAS_X86_SIMD)
+    // SSE2 is part of the x86-64 baseline and of any build that defines it.
+    features |= BJ_CPU_SSE2;
+#   if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        features |= BJ_CPU_AVX2;
+    }
+#   elif defined(_MSC_VER)
+    int regs[4] = {0};
+    __cpuid(regs, 0);
+    if (regs[0] >= 7) {
+        __cpuid(regs, 1);
+        // OSXSAVE + AVX: the OS must save YMM registers on context switch.
+        const int osxsave_avx = (1 << 27) | (1 << 28);
+        if ((regs[2] & osxsave_avx) == osxsave_avx && (_xgetbv(0) & 0x6) == 0x6) {
+            __cpuidex(regs, 7, 0);
+            if (regs[1] & (1 << 5)) {
+                features |= BJ_CPU_AVX2;
+            }
+        }
+    }
+#   endif
+#endif
+
+#if defined(BJ_CPU_HAS_NEON_SIMD)
+    features |= BJ_CPU_NEON;
+#endif
+
+    return features;
+}
+
+// Detected features with BJ_CPU_DETECTED set, 0 until the first call.
+// Detection is idempotent: concurrent first calls store the same value.
+#define BJ_CPU_DETECTED 0x80000000u
+static volatile uint32_t s_features = 0;
+
+uint32_t bj_cpu_features(void) {
+    uint32_t features = bj_atomic_load_u32(&s_features);
+    if (features == 0) {
+        features = detect_features() | BJ_CPU_DETECTED;
+        bj_atomic_store_u32(&s_features, features);
+    }
+    return features & ~BJ_CPU_DETECTED;
+}
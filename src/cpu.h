@@ -0,0 +1,35 @@
+#pragma once
+
+#include <banjo/api.h>
+
+// ============================================================================
+// CPU FEATURE DETECTION - internal
+// ============================================================================
+// Vectorized kernels (blit rows, audio mixing, ...) are compiled for every
+// instruction set the toolchain can emit, then selected at runtime from the
+// features reported here. The scalar code always remains as the fallback.
+// ============================================================================
+
+// Architecture helpers, set when the toolchain can emit the given kernels.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define BJ_CPU_HAS_X86_SIMD
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64) || (defined(__ARM_NEON) && defined(__ARM_ARCH) && __ARM_ARCH >= 7)
+#   define BJ_CPU_HAS_NEON_SIMD
+#endif
+
+// Target attribute for functions using instructions beyond the compilation
+// baseline. MSVC does not need it: intrinsics are always available.
+#if defined(BJ_CPU_HAS_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#   define BJ_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#   define BJ_TARGET_AVX2
+#endif
+
+#define BJ_CPU_SSE2 0x01u
+#define BJ_CPU_AVX2 0x02u
+#define BJ_CPU_NEON 0x04u
+
+// Returns an OR combination of BJ_CPU_* flags supported by the running CPU.
+// Detection is performed once and cached.
+uint32_t bj_cpu_features(void);
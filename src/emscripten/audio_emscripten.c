@@ -94,7 +94,17 @@ static struct bj_audio_device* emscripten_open_device(
     dev->properties.channels    = p_properties ? p_properties->channels : 1;
     dev->properties.sample_rate = p_properties ? p_properties->sample_rate : 44100;
 
-    em_dev->frames_per_block = 512;
+    // ScriptProcessorNode only takes powers of two from 256 to 16384 frames,
+    // and double-buffers them
+    unsigned frames_per_block = 256;
+    const unsigned requested  = p_properties && p_properties->period_frames ? p_properties->period_frames : 512;
+    while (frames_per_block < requested && frames_per_block < 16384) {
+        frames_per_block *= 2;
+    }
+    dev->properties.period_frames = frames_per_block;
+    dev->properties.period_count  = 2;
+
+    em_dev->frames_per_block = frames_per_block;
     em_dev->channels         = dev->properties.channels;
     em_dev->sample_index     = 0;
     em_dev->silence_timer    = -1;
@@ -152,11 +162,10 @@ EMSCRIPTEN_KEEPALIVE void audio_emscripten_process(uintptr_t device_ptr) {
     memset(dev->p_buffer, 0, samples * sizeof(float));
 
     if (p_device->playing && p_device->callback) {
-        p_device->callback(
+        bj_audio_device_fill(
+            p_device,
             dev->p_buffer,
             dev->frames_per_block,
-            &p_device->properties,
-            p_device->callback_user_data,
             dev->sample_index
         );
         dev->sample_index += dev->frames_per_block;
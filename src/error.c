@@ -2,12 +2,13 @@
 #include <banjo/memory.h>
 
 #include <check.h>
+#include <pool.h>
 
 #include <stdarg.h>
 #include <stdio.h>
 
 ////////////////////////////////////////////////////////////////////////////////
-// Internal structure definition (separate pointer)
+// Internal structure definition (message stored after the structure)
 ////////////////////////////////////////////////////////////////////////////////
 
 struct bj_error {
@@ -28,33 +29,34 @@ static size_t str_len(const char* str) {
     return len;
 }
 
+/// Allocates an error with room for a message of `msg_len` characters,
+/// in a single pool block
+static struct bj_error* error_alloc(uint32_t code, size_t msg_len) {
+    struct bj_error* err = bj_pool_allocate(sizeof(struct bj_error) + msg_len + 1);
+    if (err == 0) {
+        return 0;
+    }
+    err->code    = code;
+    err->message = (char*)(err + 1);
+    return err;
+}
+
 /// Allocates and initializes a new error with exact message size
 static struct bj_error* error_new(uint32_t code, const char* message) {
     size_t msg_len = str_len(message);
 
-    struct bj_error* err = bj_malloc(sizeof(struct bj_error));
+    struct bj_error* err = error_alloc(code, msg_len);
     if (err == 0) {
         return 0;
     }
 
-    err->message = bj_malloc(msg_len + 1);
-    if (err->message == 0) {
-        bj_free(err);
-        return 0;
-    }
-
-    err->code = code;
     bj_memcpy(err->message, message, msg_len + 1);
     return err;
 }
 
 /// Frees an error and its message
 static void error_free(struct bj_error* err) {
-    if (err == 0) {
-        return;
-    }
-    bj_free(err->message);
-    bj_free(err);
+    bj_pool_free(err);
 }
 
 /// Logs an error (used when error is discarded)
@@ -145,19 +147,11 @@ void bj_set_error_fmt(
         return;
     }
 
-    // Allocate error struct and message separately
-    struct bj_error* err = bj_malloc(sizeof(struct bj_error));
+    struct bj_error* err = error_alloc(code, (size_t)len);
     if (err == 0) {
         return;
     }
 
-    err->message = bj_malloc((size_t)len + 1);
-    if (err->message == 0) {
-        bj_free(err);
-        return;
-    }
-
-    err->code = code;
     va_start(args, format);
     vsnprintf(err->message, (size_t)len + 1, format, args);
     va_end(args);
@@ -216,22 +210,13 @@ void bj_propagate_prefixed_error(
     size_t msg_len = str_len(src->message);
     size_t total_len = (size_t)prefix_len + msg_len;
 
-    struct bj_error* new_err = bj_malloc(sizeof(struct bj_error));
+    struct bj_error* new_err = error_alloc(src->code, total_len);
     if (new_err == 0) {
         // Propagate without prefix on allocation failure
         bj_propagate_error(dest, src);
         return;
     }
 
-    new_err->message = bj_malloc(total_len + 1);
-    if (new_err->message == 0) {
-        bj_free(new_err);
-        bj_propagate_error(dest, src);
-        return;
-    }
-
-    new_err->code = src->code;
-
     // Write prefix
     va_start(args, format);
     vsnprintf(new_err->message, (size_t)prefix_len + 1, format, args);
@@ -260,17 +245,17 @@ void bj_prefix_error(
     size_t msg_len = str_len(err->message);
     size_t total_len = prefix_len + msg_len;
 
-    char* new_message = bj_malloc(total_len + 1);
-    if (new_message == 0) {
+    struct bj_error* new_err = error_alloc(err->code, total_len);
+    if (new_err == 0) {
         // Keep original on allocation failure
         return;
     }
 
-    bj_memcpy(new_message, prefix, prefix_len);
-    bj_memcpy(new_message + prefix_len, err->message, msg_len + 1);
+    bj_memcpy(new_err->message, prefix, prefix_len);
+    bj_memcpy(new_err->message + prefix_len, err->message, msg_len + 1);
 
-    bj_free(err->message);
-    err->message = new_message;
+    error_free(err);
+    *error = new_err;
 }
 
 void bj_prefix_error_fmt(
@@ -296,21 +281,21 @@ void bj_prefix_error_fmt(
     size_t msg_len = str_len(err->message);
     size_t total_len = (size_t)prefix_len + msg_len;
 
-    char* new_message = bj_malloc(total_len + 1);
-    if (new_message == 0) {
+    struct bj_error* new_err = error_alloc(err->code, total_len);
+    if (new_err == 0) {
         return;
     }
 
     // Write prefix
     va_start(args, format);
-    vsnprintf(new_message, (size_t)prefix_len + 1, format, args);
+    vsnprintf(new_err->message, (size_t)prefix_len + 1, format, args);
     va_end(args);
 
     // Append original message
-    bj_memcpy(new_message + prefix_len, err->message, msg_len + 1);
+    bj_memcpy(new_err->message + prefix_len, err->message, msg_len + 1);
 
-    bj_free(err->message);
-    err->message = new_message;
+    error_free(err);
+    *error = new_err;
 }
 
 struct bj_error* bj_copy_error(
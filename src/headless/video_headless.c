@@ -0,0 +1,273 @@
+#include <banjo/bitmap.h>
+#include <banjo/event.h>
+#include <banjo/headless.h>
+#include <banjo/log.h>
+#include <banjo/memory.h>
+#include <banjo/renderer.h>
+#include <banjo/string.h>
+
+#include <bitmap.h>
+#include <check.h>
+#include <renderer.h>
+#include <video_layer.h>
+#include <window.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// Settings outlive the layer so they can be set before bj_begin()
+static struct {
+    bj_headless_event_fn inject;
+    void*                inject_data;
+    uint64_t             frame_count;   // Presents since the layer started
+    bj_bool              injected;      // The injector ran for this frame
+    char*                dump_prefix;
+    uint64_t             dump_count;
+} s_headless = {0};
+
+void bj_set_headless_event_injector(
+    bj_headless_event_fn injector,
+    void*                user_data
+) {
+    s_headless.inject      = injector;
+    s_headless.inject_data = user_data;
+    s_headless.injected    = BJ_FALSE;
+}
+
+void bj_set_headless_frame_dump(
+    const char* path_prefix
+) {
+    bj_free(s_headless.dump_prefix);
+    s_headless.dump_prefix = 0;
+    s_headless.dump_count  = 0;
+
+    if (path_prefix != 0) {
+        const size_t length = bj_strlen(path_prefix);
+        s_headless.dump_prefix = bj_malloc(length + 1);
+        if (s_headless.dump_prefix != 0) {
+            bj_memcpy(s_headless.dump_prefix, path_prefix, length + 1);
+        }
+    }
+}
+
+#ifdef BJ_CONFIG_HEADLESS_BACKEND
+
+struct bj_renderer_data {
+    struct bj_bitmap framebuffer;
+};
+
+typedef struct {
+    struct bj_window common;
+    int              width;
+    int              height;
+} headless_window;
+
+// Writes the XRGB8888 framebuffer as a binary PPM, which needs no encoder
+static void headless_dump_frame(
+    struct bj_bitmap* framebuffer
+) {
+    const size_t length = bj_strlen(s_headless.dump_prefix) + 32;
+    char* path = bj_malloc(length);
+    if (path == 0) {
+        return;
+    }
+    snprintf(path, length, "%s%06llu.ppm",
+        s_headless.dump_prefix, (unsigned long long)s_headless.dump_count++
+    );
+
+    FILE* file = fopen(path, "wb");
+    if (file == 0) {
+        bj_err("Cannot write frame '%s': %s", path, strerror(errno));
+        bj_free(path);
+        return;
+    }
+
+    const size_t   width  = bj_bitmap_width(framebuffer);
+    const size_t   height = bj_bitmap_height(framebuffer);
+    const size_t   stride = bj_bitmap_stride(framebuffer);
+    const uint8_t* pixels = bj_bitmap_pixels(framebuffer);
+    uint8_t*       row    = bj_malloc(width * 3 + 1);
+
+    fprintf(file, "P6\n%zu %zu\n255\n", width, height);
+    for (size_t y = 0; row != 0 && y < height; ++y) {
+        const uint32_t* src = (const uint32_t*)(pixels + y * stride);
+        for (size_t x = 0; x < width; ++x) {
+            row[x * 3 + 0] = (uint8_t)(src[x] >> 16);
+            row[x * 3 + 1] = (uint8_t)(src[x] >> 8);
+            row[x * 3 + 2] = (uint8_t)src[x];
+        }
+        fwrite(row, 1, width * 3, file);
+    }
+
+    bj_free(row);
+    fclose(file);
+    bj_free(path);
+}
+
+static struct bj_window* headless_create_window(
+    const char*       title,
+    uint16_t          x,
+    uint16_t          y,
+    uint16_t          width,
+    uint16_t          height,
+    uint8_t           flags,
+    struct bj_error** error
+) {
+    (void)title;
+    (void)x;
+    (void)y;
+
+    headless_window* window = bj_calloc(sizeof(headless_window));
+    if (window == 0) {
+        bj_set_error(error, BJ_ERROR_VIDEO, "Failed to allocate window");
+        return 0;
+    }
+    window->common.flags = flags;
+    window->width        = width;
+    window->height       = height;
+    return (struct bj_window*)window;
+}
+
+static void headless_delete_window(
+    struct bj_window* window
+) {
+    bj_free(window);
+}
+
+// bj_dispatch_events() polls until the queue is empty, so injecting on every
+// poll would never let it return: the injector runs once per frame.
+static void headless_poll_events(
+    void
+) {
+    if (s_headless.inject != 0 && !s_headless.injected) {
+        s_headless.injected = BJ_TRUE;
+        s_headless.inject(s_headless.frame_count, s_headless.inject_data);
+    }
+}
+
+static int headless_get_window_size(
+    const struct bj_window* abstract_window,
+    int*                    width,
+    int*                    height
+) {
+    bj_check_or_0(abstract_window);
+    bj_check_or_0(width || height);
+    const headless_window* window = (const headless_window*)abstract_window;
+    if (width) {
+        *width = window->width;
+    }
+    if (height) {
+        *height = window->height;
+    }
+    return 1;
+}
+
+static bj_bool headless_renderer_configure(
+    struct bj_renderer* renderer,
+    struct bj_window*   abstract_window,
+    struct bj_error**   error
+) {
+    bj_check_or_0(abstract_window);
+    const headless_window* window = (const headless_window*)abstract_window;
+
+    bj_assign_aligned_bitmap(
+        &renderer->data->framebuffer,
+        (size_t)window->width,
+        (size_t)window->height,
+        BJ_PIXEL_MODE_XRGB8888,
+        0
+    );
+
+    if (bj_bitmap_pixels(&renderer->data->framebuffer) == 0 && window->width > 0 && window->height > 0) {
+        bj_set_error(error, BJ_ERROR_VIDEO, "Failed to allocate framebuffer");
+        return BJ_FALSE;
+    }
+    return BJ_TRUE;
+}
+
+static struct bj_bitmap* headless_renderer_get_framebuffer(
+    struct bj_renderer* renderer
+) {
+    return &renderer->data->framebuffer;
+}
+
+// Nothing to copy: the framebuffer already is the window content
+static void headless_renderer_present(
+    struct bj_renderer* renderer,
+    struct bj_window*   window
+) {
+    (void)window;
+    ++s_headless.frame_count;
+    s_headless.injected = BJ_FALSE;
+    if (s_headless.dump_prefix != 0 && bj_bitmap_pixels(&renderer->data->framebuffer) != 0) {
+        headless_dump_frame(&renderer->data->framebuffer);
+    }
+}
+
+static struct bj_renderer* headless_create_renderer(
+    enum bj_renderer_type  type,
+    struct bj_error**      error
+) {
+    (void)type;
+    struct bj_renderer* renderer = bj_calloc(sizeof(struct bj_renderer));
+    if (renderer == 0) {
+        bj_set_error(error, BJ_ERROR_VIDEO, "Failed to allocate renderer");
+        return 0;
+    }
+    renderer->data = bj_calloc(sizeof(struct bj_renderer_data));
+    if (renderer->data == 0) {
+        bj_free(renderer);
+        bj_set_error(error, BJ_ERROR_VIDEO, "Failed to allocate renderer data");
+        return 0;
+    }
+
+    renderer->configure       = headless_renderer_configure;
+    renderer->get_framebuffer = headless_renderer_get_framebuffer;
+    renderer->present         = headless_renderer_present;
+    renderer->partial_present = BJ_TRUE;
+
+    return renderer;
+}
+
+static void headless_destroy_renderer(
+    struct bj_renderer* renderer
+) {
+    bj_check(renderer);
+    bj_reset_bitmap(&renderer->data->framebuffer);
+    bj_free(renderer->data);
+    bj_free(renderer);
+}
+
+static void headless_end_layer(
+    struct bj_error** error
+) {
+    (void)error;
+    bj_set_headless_frame_dump(0);
+}
+
+static bj_bool headless_init_layer(
+    struct bj_video_layer* layer,
+    struct bj_error**      error
+) {
+    (void)error;
+
+    layer->end              = headless_end_layer;
+    layer->create_window    = headless_create_window;
+    layer->delete_window    = headless_delete_window;
+    layer->poll_events      = headless_poll_events;
+    layer->get_window_size  = headless_get_window_size;
+    layer->create_renderer  = headless_create_renderer;
+    layer->destroy_renderer = headless_destroy_renderer;
+
+    s_headless.frame_count = 0;
+    s_headless.injected    = BJ_FALSE;
+    return BJ_TRUE;
+}
+
+struct bj_video_layer_create_info headless_video_layer_info = {
+    .name   = "headless",
+    .create = headless_init_layer,
+};
+
+#endif
@@ -1,6 +1,7 @@
 #define BJ_AUTOMAIN_CALLBACKS
 #define BJ_MAIN_NOIMPL
 #include <banjo/main.h>
+#include <banjo/memory.h>
 
 #if defined(BJ_OS_EMSCRIPTEN)
 #include <emscripten.h>
@@ -12,6 +13,7 @@ static bj_app_end_fn     call_app_end     = 0;
 
 static void emscripten_main_loop(void) {
     const enum bj_callback_result status = call_app_iterate(user_data);
+    bj_reset_frame_memory();
     if(status <= 0) {
         emscripten_cancel_main_loop();
         call_app_end(user_data, status);
@@ -48,6 +50,7 @@ int bj_call_main_callbacks(
     int status = app_begin(&user_data, argc, argv);
     while (status > 0) {
         status = app_iterate(user_data);
+        bj_reset_frame_memory();
     }
     return app_end(user_data, status);
 }
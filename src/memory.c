@@ -1,6 +1,16 @@
+#include <banjo/log.h>
 #include <banjo/memory.h>
 
+#include <atomic.h>
 #include <check.h>
+#include <memory_stats.h>
+#include <pool.h>
+#include <thread.h>
+
+// The functions behind the call site macros are defined here
+#undef bj_malloc
+#undef bj_calloc
+#undef bj_realloc
 
 #include <stdlib.h> // malloc, realloc, ...
 #include <string.h> // memset, memcpy, memmove
@@ -29,24 +39,306 @@ static struct bj_memory_callbacks s_default = {
     .fn_free         = fallback_free,
 };
 
-void* bj_malloc(size_t size) {
+////////////////////////////////////////////////////////////////////////////////
+// Statistics
+//
+// In instrumented builds, every block from bj_malloc is preceded by a 16
+// bytes header holding its size and call site. Call sites live in an open
+// addressing table keyed by file and line; site 0 gathers the calls without
+// location, and the overflow when the table is full.
+
+#ifdef BJ_CONFIG_MEMORY_STATS
+
+#define STATS_HEADER 16
+#define STATS_SITES  1024 // Power of two
+
+struct stats_header {
+    size_t size;
+    size_t site;
+};
+
+static struct {
+    volatile uint32_t          lock;
+    struct bj_memory_stats     totals;
+    struct bj_memory_call_site sites[STATS_SITES];
+} s_stats = {.totals.enabled = BJ_TRUE};
+
+static void stats_lock(void) {
+    while (bj_atomic_exchange_u32(&s_stats.lock, 1) != 0) {
+        // Spin
+    }
+}
+
+static void stats_unlock(void) {
+    bj_atomic_store_u32(&s_stats.lock, 0);
+}
+
+// Index of the site of `file` and `line`, called with the lock held.
+// Files are compared by address: __FILE__ is the same literal for a file.
+static size_t stats_site(const char* file, int line) {
+    if (file == 0) {
+        return 0;
+    }
+    size_t index = ((size_t)(uintptr_t)file ^ ((size_t)line * 2654435761u)) & (STATS_SITES - 1);
+    for (size_t probe = 0; probe < STATS_SITES; ++probe) {
+        struct bj_memory_call_site* site = &s_stats.sites[index];
+        if (index != 0) {
+            if (site->file == file && site->line == line) {
+                return index;
+            }
+            if (site->file == 0) {
+                site->file = file;
+                site->line = line;
+                return index;
+            }
+        }
+        index = (index + 1) & (STATS_SITES - 1);
+    }
+    return 0;
+}
+
+size_t bj_stats_allocated(const char* file, int line, size_t size) {
+    stats_lock();
+    const size_t site = stats_site(file, line);
+    s_stats.sites[site].allocations += 1;
+    s_stats.sites[site].bytes       += size;
+    s_stats.sites[site].live_bytes  += size;
+
+    struct bj_memory_stats* totals = &s_stats.totals;
+    totals->live_bytes        += size;
+    totals->live_allocations  += 1;
+    totals->allocations       += 1;
+    totals->frame_allocations += 1;
+    totals->frame_bytes       += size;
+    if (totals->live_bytes > totals->peak_bytes) {
+        totals->peak_bytes = totals->live_bytes;
+    }
+    stats_unlock();
+    return site;
+}
+
+void bj_stats_freed(size_t site, size_t size) {
+    stats_lock();
+    s_stats.sites[site].live_bytes    -= size;
+    s_stats.totals.live_bytes         -= size;
+    s_stats.totals.live_allocations   -= 1;
+    stats_unlock();
+}
+
+void* bj_malloc_at(size_t size, const char* file, int line) {
+    struct stats_header* header = s_default.fn_allocation(s_default.user_data, STATS_HEADER + size);
+    if (header == 0) {
+        return 0;
+    }
+    header->size = size;
+    header->site = bj_stats_allocated(file, line, size);
+    return (unsigned char*)header + STATS_HEADER;
+}
+
+void* bj_realloc_at(void* memory, size_t size, const char* file, int line) {
+    if (memory == 0) {
+        return bj_malloc_at(size, file, line);
+    }
+    struct stats_header* header = (struct stats_header*)((unsigned char*)memory - STATS_HEADER);
+    const struct stats_header previous = *header;
+
+    header = s_default.fn_reallocation(s_default.user_data, header, STATS_HEADER + size);
+    if (header == 0) {
+        return 0;
+    }
+    bj_stats_freed(previous.site, previous.size);
+    header->size = size;
+    header->site = bj_stats_allocated(file, line, size);
+    return (unsigned char*)header + STATS_HEADER;
+}
+
+void bj_free(void* memory) {
+    if (memory == 0) {
+        return;
+    }
+    struct stats_header* header = (struct stats_header*)((unsigned char*)memory - STATS_HEADER);
+    bj_stats_freed(header->site, header->size);
+    s_default.fn_free(s_default.user_data, header);
+}
+
+void bj_get_memory_stats(
+    struct bj_memory_stats* stats
+) {
+    bj_check(stats);
+    stats_lock();
+    *stats = s_stats.totals;
+    stats_unlock();
+}
+
+size_t bj_get_memory_call_sites(
+    struct bj_memory_call_site* sites,
+    size_t                      capacity
+) {
+    bj_check_or_0(sites);
+    size_t count = 0;
+    stats_lock();
+    for (size_t s = 0; s < STATS_SITES; ++s) {
+        const struct bj_memory_call_site* site = &s_stats.sites[s];
+        if (site->allocations == 0) {
+            continue;
+        }
+        // Insertion in the sorted output, dropping the smallest when full
+        size_t at = count < capacity ? count++ : capacity;
+        while (at > 0 && sites[at - 1].bytes < site->bytes) {
+            if (at < capacity) {
+                sites[at] = sites[at - 1];
+            }
+            --at;
+        }
+        if (at < capacity) {
+            sites[at] = *site;
+        }
+    }
+    stats_unlock();
+    return count;
+}
+
+void bj_end_memory_frame(void) {
+    stats_lock();
+    struct bj_memory_stats* totals = &s_stats.totals;
+    totals->last_frame_allocations = totals->frame_allocations;
+    totals->last_frame_bytes       = totals->frame_bytes;
+    totals->frame_allocations      = 0;
+    totals->frame_bytes            = 0;
+    stats_unlock();
+}
+
+#else
+
+size_t bj_stats_allocated(const char* file, int line, size_t size) {
+    (void)file;
+    (void)line;
+    (void)size;
+    return 0;
+}
+
+void bj_stats_freed(size_t site, size_t size) {
+    (void)site;
+    (void)size;
+}
+
+void* bj_malloc_at(size_t size, const char* file, int line) {
+    (void)file;
+    (void)line;
     return s_default.fn_allocation(s_default.user_data, size);
 }
 
-void* bj_calloc(size_t size) {
-    void* ptr = bj_malloc(size);
+void* bj_realloc_at(void* memory, size_t size, const char* file, int line) {
+    (void)file;
+    (void)line;
+    return s_default.fn_reallocation(s_default.user_data, memory, size);
+}
+
+void bj_free(void* memory) {
+    s_default.fn_free(s_default.user_data, memory);
+}
+
+void bj_get_memory_stats(
+    struct bj_memory_stats* stats
+) {
+    bj_check(stats);
+    bj_memzero(stats, sizeof(struct bj_memory_stats));
+}
+
+size_t bj_get_memory_call_sites(
+    struct bj_memory_call_site* sites,
+    size_t                      capacity
+) {
+    (void)sites;
+    (void)capacity;
+    return 0;
+}
+
+void bj_end_memory_frame(void) {
+}
+
+#endif
+
+void* bj_calloc_at(size_t size, const char* file, int line) {
+    void* ptr = bj_malloc_at(size, file, line);
     if (ptr) {
         bj_memzero(ptr, size);
     }
     return ptr;
 }
 
+void* bj_malloc(size_t size) {
+    return bj_malloc_at(size, 0, 0);
+}
+
+void* bj_calloc(size_t size) {
+    return bj_calloc_at(size, 0, 0);
+}
+
 void* bj_realloc(void* memory, size_t size) {
-    return s_default.fn_reallocation(s_default.user_data, memory, size);
+    return bj_realloc_at(memory, size, 0, 0);
 }
 
-void bj_free(void* memory) {
-    s_default.fn_free(s_default.user_data, memory);
+#define DUMP_SITES 10
+
+void bj_dump_memory_stats(void) {
+    struct bj_memory_stats stats;
+    bj_get_memory_stats(&stats);
+    if (!stats.enabled) {
+        bj_info("memory statistics are not collected by this build");
+        return;
+    }
+
+    bj_info("memory: %zu bytes in %zu blocks, peak %zu bytes, %llu allocations",
+        stats.live_bytes, stats.live_allocations, stats.peak_bytes,
+        (unsigned long long)stats.allocations
+    );
+    bj_info("memory: last frame %zu allocations, %zu bytes",
+        stats.last_frame_allocations, stats.last_frame_bytes
+    );
+
+    struct bj_memory_call_site sites[DUMP_SITES];
+    const size_t count = bj_get_memory_call_sites(sites, DUMP_SITES);
+    for (size_t s = 0; s < count && s < DUMP_SITES; ++s) {
+        bj_info("  %s:%d: %llu allocations, %llu bytes, %zu live",
+            sites[s].file ? sites[s].file : "(unknown)", sites[s].line,
+            (unsigned long long)sites[s].allocations,
+            (unsigned long long)sites[s].bytes, sites[s].live_bytes
+        );
+    }
+}
+
+
+void* bj_aligned_malloc(
+    size_t size,
+    size_t alignment
+) {
+    bj_check_or_0(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    if (alignment < sizeof(void*)) {
+        alignment = sizeof(void*);
+    }
+
+    if (size > SIZE_MAX - (alignment - 1) - sizeof(void*)) {
+        return 0;
+    }
+
+    // The original block is stored right before the aligned one
+    unsigned char* block = bj_malloc(size + alignment - 1 + sizeof(void*));
+    if (block == 0) {
+        return 0;
+    }
+    const uintptr_t start   = (uintptr_t)(block + sizeof(void*));
+    void**          aligned = (void**)((start + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    aligned[-1] = block;
+    return aligned;
+}
+
+void bj_aligned_free(
+    void* memory
+) {
+    if (memory != 0) {
+        bj_free(((void**)memory)[-1]);
+    }
 }
 
 
@@ -74,6 +366,13 @@ void bj_unset_memory_defaults(void) {
     bj_set_memory_defaults(0);
 }
 
+void bj_get_memory_defaults(
+    struct bj_memory_callbacks* allocator
+) {
+    bj_check(allocator);
+    *allocator = s_default;
+}
+
 void* bj_memcpy(
     void*       dest,
     const void* src,
@@ -112,3 +411,230 @@ void bj_memzero(
 ) {
     bj_memset(dest, 0, mem_size);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+// Pool
+//
+// Every block starts with a 16 bytes header pointing to its slab, or 0 for
+// blocks too large for a class. The header stays valid while the block is
+// free: free lists are linked through the block payload.
+//
+// Classes are locked with a spin lock. Each thread also keeps a small cache
+// of free blocks per class, refilled and drained by batches, so that most
+// allocations take no lock. A thread flushes its cache once it has freed as
+// many blocks as it allocated, which gives every slab back when no object is
+// alive, and on bj_flush_pool_cache().
+//
+// Slabs always come from the built-in allocator. A cached block can outlive
+// a call to bj_set_memory_defaults(), so slabs from another allocator (an
+// arena that gets reset, say) could be handed out after their memory went
+// back to it. While the defaults are not the built-in ones, the pool is
+// bypassed and every block goes to bj_malloc.
+
+#define POOL_HEADER    16
+#define POOL_SLAB_SIZE 8192
+#define POOL_CACHE     32 // Blocks per class and thread
+#define POOL_BATCH     (POOL_CACHE / 2)
+
+struct pool_class;
+
+struct pool_slab {
+    struct pool_slab*  next;      // In the list of slabs with free blocks
+    struct pool_slab*  previous;
+    struct pool_class* owner;
+    void*              free_list;
+    size_t             carved;    // Blocks taken from the slab so far
+    size_t             live;      // Blocks out of the slab, cached ones included
+    size_t             capacity;
+    size_t             site;      // Call site in the statistics
+};
+
+#define POOL_SLAB_HEADER ((sizeof(struct pool_slab) + POOL_HEADER - 1) & ~(size_t)(POOL_HEADER - 1))
+
+struct pool_class {
+    volatile uint32_t lock;
+    size_t            block_size; // Header included
+    struct pool_slab* available;
+};
+
+static struct pool_class s_pool[] = {
+    {.block_size = 32},  {.block_size = 48},  {.block_size = 64},
+    {.block_size = 96},  {.block_size = 128}, {.block_size = 192},
+    {.block_size = 256}, {.block_size = 384}, {.block_size = 512},
+};
+
+#define POOL_CLASS_COUNT (sizeof(s_pool) / sizeof(s_pool[0]))
+#define POOL_MAX_SIZE    (512 - POOL_HEADER)
+
+// Class of each payload size, by steps of 16 bytes
+static const uint8_t s_pool_class_of[POOL_MAX_SIZE / 16 + 1] = {
+    0, 0, 1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8,
+};
+
+struct pool_cache {
+    unsigned char* blocks[POOL_CACHE];
+    size_t         count;
+};
+
+static BJ_THREAD_LOCAL struct pool_cache s_pool_cache[POOL_CLASS_COUNT];
+static BJ_THREAD_LOCAL long              s_pool_balance; // Allocations minus frees on this thread
+
+static struct pool_slab* block_slab(unsigned char* block) {
+    return *(struct pool_slab**)block;
+}
+
+static void** block_link(unsigned char* block) {
+    return (void**)(block + POOL_HEADER);
+}
+
+static void pool_lock(struct pool_class* pool_class) {
+    while (bj_atomic_exchange_u32(&pool_class->lock, 1) != 0) {
+        // Spin
+    }
+}
+
+static void pool_unlock(struct pool_class* pool_class) {
+    bj_atomic_store_u32(&pool_class->lock, 0);
+}
+
+static void pool_link(struct pool_class* pool_class, struct pool_slab* slab) {
+    slab->previous = 0;
+    slab->next     = pool_class->available;
+    if (slab->next != 0) {
+        slab->next->previous = slab;
+    }
+    pool_class->available = slab;
+}
+
+static void pool_unlink(struct pool_class* pool_class, struct pool_slab* slab) {
+    if (slab->previous != 0) {
+        slab->previous->next = slab->next;
+    } else {
+        pool_class->available = slab->next;
+    }
+    if (slab->next != 0) {
+        slab->next->previous = slab->previous;
+    }
+}
+
+static struct pool_slab* pool_new_slab(struct pool_class* pool_class) {
+    struct pool_slab* slab = fallback_malloc(0, POOL_SLAB_SIZE);
+    if (slab == 0) {
+        return 0;
+    }
+    slab->site      = bj_stats_allocated(__FILE__, __LINE__, POOL_SLAB_SIZE);
+    slab->owner     = pool_class;
+    slab->free_list = 0;
+    slab->carved    = 0;
+    slab->live      = 0;
+    slab->capacity  = (POOL_SLAB_SIZE - POOL_SLAB_HEADER) / pool_class->block_size;
+    pool_link(pool_class, slab);
+    return slab;
+}
+
+// Moves up to POOL_BATCH blocks from the slabs of the class to the cache
+static void pool_refill(struct pool_class* pool_class, struct pool_cache* cache) {
+    pool_lock(pool_class);
+    while (cache->count < POOL_BATCH) {
+        struct pool_slab* slab = pool_class->available;
+        if (slab == 0 && (slab = pool_new_slab(pool_class)) == 0) {
+            break;
+        }
+
+        unsigned char* block = slab->free_list;
+        if (block != 0) {
+            slab->free_list = *block_link(block);
+        } else {
+            block = (unsigned char*)slab + POOL_SLAB_HEADER + slab->carved * pool_class->block_size;
+            *(struct pool_slab**)block = slab;
+            slab->carved += 1;
+        }
+        if (++slab->live == slab->capacity) {
+            pool_unlink(pool_class, slab);
+        }
+        cache->blocks[cache->count++] = block;
+    }
+    pool_unlock(pool_class);
+}
+
+// Gives the `count` last blocks of the cache back to their slabs
+static void pool_drain(struct pool_class* pool_class, struct pool_cache* cache, size_t count) {
+    pool_lock(pool_class);
+    while (count-- > 0) {
+        unsigned char*    block    = cache->blocks[--cache->count];
+        struct pool_slab* slab     = block_slab(block);
+        const bj_bool     was_full = slab->live == slab->capacity;
+
+        *block_link(block) = slab->free_list;
+        slab->free_list    = block;
+        slab->live        -= 1;
+
+        if (slab->live == 0) {
+            if (!was_full) {
+                pool_unlink(pool_class, slab);
+            }
+            bj_stats_freed(slab->site, POOL_SLAB_SIZE);
+            fallback_free(0, slab);
+        } else if (was_full) {
+            pool_link(pool_class, slab);
+        }
+    }
+    pool_unlock(pool_class);
+}
+
+void* bj_pool_allocate(size_t size) {
+    if (size > POOL_MAX_SIZE || s_default.fn_allocation != fallback_malloc) {
+        struct pool_slab** header = bj_malloc(POOL_HEADER + size);
+        if (header == 0) {
+            return 0;
+        }
+        *header = 0;
+        return (unsigned char*)header + POOL_HEADER;
+    }
+
+    const size_t       c     = s_pool_class_of[(size + 15) / 16];
+    struct pool_cache* cache = &s_pool_cache[c];
+    if (cache->count == 0) {
+        pool_refill(&s_pool[c], cache);
+        if (cache->count == 0) {
+            return 0;
+        }
+    }
+
+    s_pool_balance += 1;
+    return cache->blocks[--cache->count] + POOL_HEADER;
+}
+
+void bj_pool_free(void* memory) {
+    if (memory == 0) {
+        return;
+    }
+    unsigned char*    block = (unsigned char*)memory - POOL_HEADER;
+    struct pool_slab* slab  = block_slab(block);
+    if (slab == 0) {
+        bj_free(block);
+        return;
+    }
+
+    struct pool_class* pool_class = slab->owner;
+    struct pool_cache* cache      = &s_pool_cache[pool_class - s_pool];
+    if (cache->count == POOL_CACHE) {
+        pool_drain(pool_class, cache, POOL_BATCH);
+    }
+    cache->blocks[cache->count++] = block;
+
+    if (--s_pool_balance <= 0) {
+        bj_flush_pool_cache();
+    }
+}
+
+void bj_flush_pool_cache(void) {
+    for (size_t c = 0; c < POOL_CLASS_COUNT; ++c) {
+        if (s_pool_cache[c].count > 0) {
+            pool_drain(&s_pool[c], &s_pool_cache[c], s_pool_cache[c].count);
+        }
+    }
+    s_pool_balance = 0;
+}
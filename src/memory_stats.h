@@ -0,0 +1,21 @@
+#pragma once
+
+#include <banjo/api.h>
+
+// ============================================================================
+// MEMORY STATISTICS - internal
+// ============================================================================
+// Ends the current frame of the allocation statistics: the counters of the
+// frame become those of the last frame. Does nothing unless the build is
+// configured with BJ_CONFIG_MEMORY_STATS.
+//
+// bj_stats_allocated() and bj_stats_freed() record memory the library takes
+// from an allocator without going through bj_malloc (pool slabs, arena
+// blocks). The first returns the call site to pass to the second.
+// ============================================================================
+
+void bj_end_memory_frame(void);
+
+size_t bj_stats_allocated(const char* file, int line, size_t size);
+
+void bj_stats_freed(size_t site, size_t size);
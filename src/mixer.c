@@ -0,0 +1,605 @@
+// mixer.c - Multi-voice software mixer.
+//
+// Output is produced in blocks of MIX_BLOCK frames. For each block, every
+// active voice renders its source frames as floats into `scratch`, which is
+// then added to the float `accumulator` with the voice gains. Once all voices
+// are mixed, the accumulator is scaled by the master gain, clipped and
+// converted to the device format.
+//
+// The accumulate and convert loops have SSE2 and NEON kernels processing the
+// longest prefix that fills whole vectors. Scalar loops finish the tail and
+// remain the fallback.
+//
+// Control functions and bj_mix() serialize on a mutex. It is only held for
+// the duration of one bj_mix() call or one control call.
+
+#include <banjo/audio.h>
+#include <banjo/math.h>
+#include <banjo/memory.h>
+#include <banjo/mixer.h>
+
+#include <check.h>
+#include <cpu.h>
+#include <thread.h>
+
+#if defined(BJ_CPU_HAS_X86_SIMD)
+#   include <immintrin.h>
+#endif
+#if defined(BJ_CPU_HAS_NEON_SIMD)
+#   include <arm_neon.h>
+#endif
+
+#define MIX_BLOCK      256
+#define MAX_VOICES     0xFFFF
+#define FIXED_ONE      ((uint64_t)1 << 32)
+#define INT16_SCALE    32768.0f
+
+// Handles are (generation << 16) | (index + 1), so 0 is never valid and a
+// handle stops matching once its slot is reused.
+#define HANDLE_INDEX(h)     ((size_t)((h) & 0xFFFFu) - 1)
+#define HANDLE_GENERATION(h) ((h) >> 16)
+
+struct mixer_voice {
+    uint32_t              handle;        // 0 when the voice is free
+    struct bj_mixer_sound sound;
+    bj_mixer_generator_fn generator;
+    void*                 generator_data;
+    uint64_t              position;      // 32.32 fixed-point source frame
+    float                 gain;
+    float                 pan;
+    float                 pitch;
+};
+
+struct bj_mixer {
+    struct bj_mutex*    lock;
+    struct mixer_voice* voices;
+    size_t              voice_count;
+    uint32_t            generation;
+    float               master_gain;
+    float               accumulator[MIX_BLOCK * 2];
+    float               scratch[MIX_BLOCK * 2];
+};
+
+// ----------------------------------------------------------------------------
+// Kernels
+// ----------------------------------------------------------------------------
+
+// acc[i] += src[i] * gain[i % 2], for mono to mono and stereo to stereo
+static size_t mix_interleaved_simd(float* BJ_RESTRICT acc, const float* BJ_RESTRICT src, size_t count, float g0, float g1) {
+    size_t i = 0;
+#if defined(BJ_CPU_HAS_X86_SIMD)
+    if (bj_cpu_features() & BJ_CPU_SSE2) {
+        const __m128 g = _mm_setr_ps(g0, g1, g0, g1);
+        for (; i + 4 <= count; i += 4) {
+            const __m128 a = _mm_loadu_ps(acc + i);
+            _mm_storeu_ps(acc + i, _mm_add_ps(a, _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+        }
+    }
+#elif defined(BJ_CPU_HAS_NEON_SIMD)
+    const float gains[4] = {g0, g1, g0, g1};
+    const float32x4_t g = vld1q_f32(gains);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(acc + i, vmlaq_f32(vld1q_f32(acc + i), vld1q_f32(src + i), g));
+    }
+#else
+    (void)acc; (void)src; (void)count; (void)g0; (void)g1;
+#endif
+    return i;
+}
+
+// acc[2i] += src[i] * left, acc[2i+1] += src[i] * right
+static size_t mix_spread_simd(float* BJ_RESTRICT acc, const float* BJ_RESTRICT src, size_t frames, float left, float right) {
+    size_t i = 0;
+#if defined(BJ_CPU_HAS_X86_SIMD)
+    if (bj_cpu_features() & BJ_CPU_SSE2) {
+        const __m128 g = _mm_setr_ps(left, right, left, right);
+        for (; i + 4 <= frames; i += 4) {
+            const __m128 s  = _mm_loadu_ps(src + i);
+            const __m128 lo = _mm_unpacklo_ps(s, s);
+            const __m128 hi = _mm_unpackhi_ps(s, s);
+            _mm_storeu_ps(acc + 2 * i,     _mm_add_ps(_mm_loadu_ps(acc + 2 * i),     _mm_mul_ps(lo, g)));
+            _mm_storeu_ps(acc + 2 * i + 4, _mm_add_ps(_mm_loadu_ps(acc + 2 * i + 4), _mm_mul_ps(hi, g)));
+        }
+    }
+#elif defined(BJ_CPU_HAS_NEON_SIMD)
+    const float gains[4] = {left, right, left, right};
+    const float32x4_t g = vld1q_f32(gains);
+    for (; i + 4 <= frames; i += 4) {
+        const float32x4x2_t s = vzipq_f32(vld1q_f32(src + i), vld1q_f32(src + i));
+        vst1q_f32(acc + 2 * i,     vmlaq_f32(vld1q_f32(acc + 2 * i),     s.val[0], g));
+        vst1q_f32(acc + 2 * i + 4, vmlaq_f32(vld1q_f32(acc + 2 * i + 4), s.val[1], g));
+    }
+#else
+    (void)acc; (void)src; (void)frames; (void)left; (void)right;
+#endif
+    return i;
+}
+
+// Clip to [-1, 1] after the master gain, then convert to int16
+static size_t convert_int16_simd(int16_t* BJ_RESTRICT dst, const float* BJ_RESTRICT src, size_t count, float gain) {
+    size_t i = 0;
+#if defined(BJ_CPU_HAS_X86_SIMD)
+    if (bj_cpu_features() & BJ_CPU_SSE2) {
+        const __m128 g   = _mm_set1_ps(gain * INT16_SCALE);
+        const __m128 max = _mm_set1_ps(INT16_SCALE);
+        const __m128 min = _mm_set1_ps(-INT16_SCALE);
+        for (; i + 8 <= count; i += 8) {
+            const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i),     g), min), max);
+            const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), g), min), max);
+            // packs saturates 32768 to 32767
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+        }
+    }
+#else
+    (void)dst; (void)src; (void)count; (void)gain;
+#endif
+    return i;
+}
+
+static size_t convert_f32_simd(float* BJ_RESTRICT dst, const float* BJ_RESTRICT src, size_t count, float gain) {
+    size_t i = 0;
+#if defined(BJ_CPU_HAS_X86_SIMD)
+    if (bj_cpu_features() & BJ_CPU_SSE2) {
+        const __m128 g   = _mm_set1_ps(gain);
+        const __m128 max = _mm_set1_ps(1.0f);
+        const __m128 min = _mm_set1_ps(-1.0f);
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), g), min), max));
+        }
+    }
+#elif defined(BJ_CPU_HAS_NEON_SIMD)
+    const float32x4_t g   = vdupq_n_f32(gain);
+    const float32x4_t max = vdupq_n_f32(1.0f);
+    const float32x4_t min = vdupq_n_f32(-1.0f);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(src + i), g), min), max));
+    }
+#else
+    (void)dst; (void)src; (void)count; (void)gain;
+#endif
+    return i;
+}
+
+static void mix_interleaved(float* BJ_RESTRICT acc, const float* BJ_RESTRICT src, size_t count, float g0, float g1) {
+    for (size_t i = mix_interleaved_simd(acc, src, count, g0, g1); i < count; ++i) {
+        acc[i] += src[i] * ((i & 1) ? g1 : g0);
+    }
+}
+
+static void mix_spread(float* BJ_RESTRICT acc, const float* BJ_RESTRICT src, size_t frames, float left, float right) {
+    for (size_t i = mix_spread_simd(acc, src, frames, left, right); i < frames; ++i) {
+        acc[2 * i]     += src[i] * left;
+        acc[2 * i + 1] += src[i] * right;
+    }
+}
+
+static void mix_downmix(float* BJ_RESTRICT acc, const float* BJ_RESTRICT src, size_t frames, float gain) {
+    const float half = 0.5f * gain;
+    for (size_t i = 0; i < frames; ++i) {
+        acc[i] += (src[2 * i] + src[2 * i + 1]) * half;
+    }
+}
+
+static void convert_int16(int16_t* BJ_RESTRICT dst, const float* BJ_RESTRICT src, size_t count, float gain) {
+    const float g = gain * INT16_SCALE;
+    for (size_t i = convert_int16_simd(dst, src, count, gain); i < count; ++i) {
+        float s = src[i] * g;
+        s = s > INT16_SCALE - 1.0f ? INT16_SCALE - 1.0f : (s < -INT16_SCALE ? -INT16_SCALE : s);
+        // Round half to even like _mm_cvtps_epi32, so that a sample does
+        // not depend on whether it lands in the vector prefix or the tail
+        dst[i] = (int16_t)lrintf(s);
+    }
+}
+
+static void convert_f32(float* BJ_RESTRICT dst, const float* BJ_RESTRICT src, size_t count, float gain) {
+    for (size_t i = convert_f32_simd(dst, src, count, gain); i < count; ++i) {
+        const float s = src[i] * gain;
+        dst[i] = s > 1.0f ? 1.0f : (s < -1.0f ? -1.0f : s);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Voice rendering
+// ----------------------------------------------------------------------------
+
+static bj_bool sound_loops(const struct bj_mixer_sound* sound) {
+    return sound->loop_end > sound->loop_start;
+}
+
+// Last frame played before stopping or jumping back
+static size_t sound_end(const struct bj_mixer_sound* sound) {
+    return sound_loops(sound) ? sound->loop_end : sound->frames;
+}
+
+static void load_frame(const struct bj_mixer_sound* sound, size_t frame, float* out) {
+    const size_t channels = sound->channels;
+    if (sound->format == BJ_AUDIO_FORMAT_INT16) {
+        const int16_t* samples = (const int16_t*)sound->samples + frame * channels;
+        for (size_t c = 0; c < channels; ++c) {
+            out[c] = (float)samples[c] * (1.0f / INT16_SCALE);
+        }
+    } else {
+        const float* samples = (const float*)sound->samples + frame * channels;
+        for (size_t c = 0; c < channels; ++c) {
+            out[c] = samples[c];
+        }
+    }
+}
+
+// Copies whole frames from `frame` on: the pitch 1 path
+static void load_frames(const struct bj_mixer_sound* sound, size_t frame, size_t count, float* out) {
+    const size_t samples = count * sound->channels;
+    if (sound->format == BJ_AUDIO_FORMAT_INT16) {
+        const int16_t* src = (const int16_t*)sound->samples + frame * sound->channels;
+        for (size_t i = 0; i < samples; ++i) {
+            out[i] = (float)src[i] * (1.0f / INT16_SCALE);
+        }
+    } else {
+        bj_memcpy(out, (const float*)sound->samples + frame * sound->channels, samples * sizeof(float));
+    }
+}
+
+// Renders up to `frames` source frames into `out` (in the sound channel
+// count) and returns the number rendered, fewer when the sound ends.
+static size_t render_sound(struct mixer_voice* voice, float* out, size_t frames, unsigned int output_rate) {
+    const struct bj_mixer_sound* sound = &voice->sound;
+    const size_t   channels = sound->channels;
+    const size_t   end      = sound_end(sound);
+    const bj_bool  loops    = sound_loops(sound);
+    const uint64_t loop_length = (uint64_t)(sound->loop_end - sound->loop_start) << 32;
+
+    const double ratio = (double)voice->pitch * (double)sound->sample_rate / (double)output_rate;
+    const uint64_t step = (uint64_t)(ratio * (double)FIXED_ONE + 0.5);
+
+    size_t done = 0;
+    if (step == FIXED_ONE && (voice->position & (FIXED_ONE - 1)) == 0) {
+        while (done < frames) {
+            const size_t frame = (size_t)(voice->position >> 32);
+            size_t count = end - frame;
+            if (count > frames - done) {
+                count = frames - done;
+            }
+            load_frames(sound, frame, count, out + done * channels);
+            done += count;
+            voice->position += (uint64_t)count << 32;
+            if ((size_t)(voice->position >> 32) >= end) {
+                if (!loops) {
+                    return done;
+                }
+                voice->position -= loop_length;
+            }
+        }
+        return done;
+    }
+
+    float a[2];
+    float b[2];
+    for (; done < frames; ++done) {
+        const size_t frame = (size_t)(voice->position >> 32);
+        const float  t     = (float)(voice->position & (FIXED_ONE - 1)) * (1.0f / 4294967296.0f);
+        size_t next = frame + 1;
+        if (next >= end) {
+            next = loops ? sound->loop_start : frame;
+        }
+        load_frame(sound, frame, a);
+        load_frame(sound, next, b);
+        for (size_t c = 0; c < channels; ++c) {
+            out[done * channels + c] = a[c] + (b[c] - a[c]) * t;
+        }
+
+        voice->position += step;
+        while ((size_t)(voice->position >> 32) >= end) {
+            if (!loops) {
+                return done + 1;
+            }
+            voice->position -= loop_length;
+        }
+    }
+    return done;
+}
+
+static void release_voice(struct mixer_voice* voice) {
+    voice->handle    = 0;
+    voice->generator = 0;
+}
+
+static void mix_voice(struct bj_mixer* mixer, struct mixer_voice* voice, size_t frames, const struct bj_audio_properties* audio) {
+    size_t  rendered;
+    size_t  channels;
+    bj_bool keep = BJ_TRUE;
+
+    if (voice->generator != 0) {
+        channels = 1;
+        keep     = voice->generator(mixer->scratch, (unsigned)frames, audio->sample_rate, voice->generator_data);
+        rendered = frames;
+    } else {
+        channels = voice->sound.channels;
+        rendered = render_sound(voice, mixer->scratch, frames, audio->sample_rate);
+        keep     = rendered == frames;
+    }
+
+    // Constant power pan: left = cos(a), right = sin(a) with a in [0, pi/2]
+    const float angle = (voice->pan + 1.0f) * (float)BJ_PI * 0.25f;
+    const float left  = voice->gain * bj_cosf(angle);
+    const float right = voice->gain * bj_sinf(angle);
+
+    if (audio->channels == 1) {
+        if (channels == 1) {
+            mix_interleaved(mixer->accumulator, mixer->scratch, rendered, voice->gain, voice->gain);
+        } else {
+            mix_downmix(mixer->accumulator, mixer->scratch, rendered, voice->gain);
+        }
+    } else {
+        if (channels == 1) {
+            mix_spread(mixer->accumulator, mixer->scratch, rendered, left, right);
+        } else {
+            mix_interleaved(mixer->accumulator, mixer->scratch, rendered * 2, left, right);
+        }
+    }
+
+    if (!keep) {
+        release_voice(voice);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// API
+// ----------------------------------------------------------------------------
+
+struct bj_mixer* bj_create_mixer(
+    size_t voice_count
+) {
+    if (voice_count == 0 || voice_count > MAX_VOICES) {
+        return 0;
+    }
+
+    struct bj_mixer* mixer = bj_calloc(sizeof(struct bj_mixer));
+    if (mixer == 0) {
+        return 0;
+    }
+    mixer->voices = bj_calloc(voice_count * sizeof(struct mixer_voice));
+    mixer->lock   = bj_mutex_create();
+    if (mixer->voices == 0 || mixer->lock == 0) {
+        bj_destroy_mixer(mixer);
+        return 0;
+    }
+    mixer->voice_count = voice_count;
+    mixer->master_gain = 1.0f;
+    return mixer;
+}
+
+void bj_destroy_mixer(
+    struct bj_mixer* mixer
+) {
+    if (mixer == 0) {
+        return;
+    }
+    if (mixer->lock != 0) {
+        bj_mutex_destroy(mixer->lock);
+    }
+    bj_free(mixer->voices);
+    bj_free(mixer);
+}
+
+void bj_mix(
+    struct bj_mixer*                  mixer,
+    void*                             buffer,
+    unsigned                          frames,
+    const struct bj_audio_properties* audio
+) {
+    bj_check(mixer);
+    bj_check(buffer);
+    bj_check(audio);
+
+    const size_t channels = audio->channels;
+    const bj_bool supported = (channels == 1 || channels == 2) && audio->sample_rate > 0
+        && (audio->format == BJ_AUDIO_FORMAT_INT16 || audio->format == BJ_AUDIO_FORMAT_F32);
+    if (!supported) {
+        bj_memzero(buffer, (size_t)frames * channels * (BJ_AUDIO_FORMAT_WIDTH(audio->format) / 8));
+        return;
+    }
+
+    bj_mutex_lock(mixer->lock);
+    for (size_t offset = 0; offset < frames; offset += MIX_BLOCK) {
+        const size_t block = frames - offset < MIX_BLOCK ? frames - offset : MIX_BLOCK;
+        bj_memzero(mixer->accumulator, block * channels * sizeof(float));
+
+        for (size_t v = 0; v < mixer->voice_count; ++v) {
+            if (mixer->voices[v].handle != 0) {
+                mix_voice(mixer, &mixer->voices[v], block, audio);
+            }
+        }
+
+        if (audio->format == BJ_AUDIO_FORMAT_INT16) {
+            convert_int16((int16_t*)buffer + offset * channels, mixer->accumulator, block * channels, mixer->master_gain);
+        } else {
+            convert_f32((float*)buffer + offset * channels, mixer->accumulator, block * channels, mixer->master_gain);
+        }
+    }
+    bj_mutex_unlock(mixer->lock);
+}
+
+void bj_mixer_callback(
+    void*                             buffer,
+    unsigned                          frames,
+    const struct bj_audio_properties* audio,
+    void*                             user_data,
+    uint64_t                          base_sample_index
+) {
+    (void)base_sample_index;
+    bj_mix((struct bj_mixer*)user_data, buffer, frames, audio);
+}
+
+// Takes a free slot and gives it a new handle. The lock must be held.
+static struct mixer_voice* allocate_voice(struct bj_mixer* mixer) {
+    for (size_t v = 0; v < mixer->voice_count; ++v) {
+        struct mixer_voice* voice = &mixer->voices[v];
+        if (voice->handle == 0) {
+            mixer->generation = (mixer->generation + 1) & 0xFFFFu;
+            if (mixer->generation == 0) {
+                mixer->generation = 1;
+            }
+            bj_memzero(voice, sizeof(struct mixer_voice));
+            voice->handle = (mixer->generation << 16) | (uint32_t)(v + 1);
+            voice->pitch  = 1.0f;
+            return voice;
+        }
+    }
+    return 0;
+}
+
+// Voice matching a handle, or 0 if it stopped. The lock must be held.
+static struct mixer_voice* find_voice(struct bj_mixer* mixer, uint32_t handle) {
+    if (handle == 0 || HANDLE_INDEX(handle) >= mixer->voice_count) {
+        return 0;
+    }
+    struct mixer_voice* voice = &mixer->voices[HANDLE_INDEX(handle)];
+    return voice->handle == handle ? voice : 0;
+}
+
+static float clamp_pan(float pan) {
+    return pan < -1.0f ? -1.0f : (pan > 1.0f ? 1.0f : pan);
+}
+
+uint32_t bj_mixer_play_sound(
+    struct bj_mixer*             mixer,
+    const struct bj_mixer_sound* sound,
+    float                        gain,
+    float                        pan
+) {
+    bj_check_or_0(mixer);
+    bj_check_or_0(sound);
+
+    const bj_bool valid = sound->samples != 0 && sound->frames > 0 && sound->sample_rate > 0
+        && (sound->channels == 1 || sound->channels == 2)
+        && (sound->format == BJ_AUDIO_FORMAT_INT16 || sound->format == BJ_AUDIO_FORMAT_F32)
+        && sound->frames < ((size_t)1 << 31)
+        && (sound->loop_end <= sound->loop_start || sound->loop_end <= sound->frames);
+    if (!valid) {
+        return 0;
+    }
+
+    bj_mutex_lock(mixer->lock);
+    struct mixer_voice* voice = allocate_voice(mixer);
+    uint32_t handle = 0;
+    if (voice != 0) {
+        voice->sound = *sound;
+        voice->gain  = gain;
+        voice->pan   = clamp_pan(pan);
+        handle       = voice->handle;
+    }
+    bj_mutex_unlock(mixer->lock);
+    return handle;
+}
+
+uint32_t bj_mixer_play_generator(
+    struct bj_mixer*      mixer,
+    bj_mixer_generator_fn generator,
+    void*                 user_data,
+    float                 gain,
+    float                 pan
+) {
+    bj_check_or_0(mixer);
+    bj_check_or_0(generator);
+
+    bj_mutex_lock(mixer->lock);
+    struct mixer_voice* voice = allocate_voice(mixer);
+    uint32_t handle = 0;
+    if (voice != 0) {
+        voice->generator      = generator;
+        voice->generator_data = user_data;
+        voice->gain           = gain;
+        voice->pan            = clamp_pan(pan);
+        handle                = voice->handle;
+    }
+    bj_mutex_unlock(mixer->lock);
+    return handle;
+}
+
+void bj_mixer_stop(
+    struct bj_mixer* mixer,
+    uint32_t         voice
+) {
+    bj_check(mixer);
+    bj_mutex_lock(mixer->lock);
+    struct mixer_voice* found = find_voice(mixer, voice);
+    if (found != 0) {
+        release_voice(found);
+    }
+    bj_mutex_unlock(mixer->lock);
+}
+
+void bj_mixer_stop_all(
+    struct bj_mixer* mixer
+) {
+    bj_check(mixer);
+    bj_mutex_lock(mixer->lock);
+    for (size_t v = 0; v < mixer->voice_count; ++v) {
+        release_voice(&mixer->voices[v]);
+    }
+    bj_mutex_unlock(mixer->lock);
+}
+
+bj_bool bj_mixer_voice_playing(
+    struct bj_mixer* mixer,
+    uint32_t         voice
+) {
+    bj_check_or_0(mixer);
+    bj_mutex_lock(mixer->lock);
+    const bj_bool playing = find_voice(mixer, voice) != 0;
+    bj_mutex_unlock(mixer->lock);
+    return playing;
+}
+
+void bj_mixer_set_gain(
+    struct bj_mixer* mixer,
+    uint32_t         voice,
+    float            gain
+) {
+    bj_check(mixer);
+    bj_mutex_lock(mixer->lock);
+    struct mixer_voice* found = find_voice(mixer, voice);
+    if (found != 0) {
+        found->gain = gain;
+    }
+    bj_mutex_unlock(mixer->lock);
+}
+
+void bj_mixer_set_pan(
+    struct bj_mixer* mixer,
+    uint32_t         voice,
+    float            pan
+) {
+    bj_check(mixer);
+    bj_mutex_lock(mixer->lock);
+    struct mixer_voice* found = find_voice(mixer, voice);
+    if (found != 0) {
+        found->pan = clamp_pan(pan);
+    }
+    bj_mutex_unlock(mixer->lock);
+}
+
+void bj_mixer_set_pitch(
+    struct bj_mixer* mixer,
+    uint32_t         voice,
+    float            pitch
+) {
+    bj_check(mixer);
+    pitch = pitch < 1.0f / 256.0f ? 1.0f / 256.0f : (pitch > 256.0f ? 256.0f : pitch);
+    bj_mutex_lock(mixer->lock);
+    struct mixer_voice* found = find_voice(mixer, voice);
+    if (found != 0) {
+        found->pitch = pitch;
+    }
+    bj_mutex_unlock(mixer->lock);
+}
+
+void bj_mixer_set_master_gain(
+    struct bj_mixer* mixer,
+    float            gain
+) {
+    bj_check(mixer);
+    bj_mutex_lock(mixer->lock);
+    mixer->master_gain = gain;
+    bj_mutex_unlock(mixer->lock);
+}
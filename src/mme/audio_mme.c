@@ -6,6 +6,7 @@
 #include <banjo/memory.h>
 #include <banjo/system.h>
 
+#include <atomic.h>
 #include <audio.h>
 #include <check.h>
 #include <audio_layer.h>
@@ -29,6 +30,7 @@ struct mme_device {
     HANDLE                 thread;
     HANDLE                 event;
     unsigned               next_block;
+    unsigned               blocks_written;
     size_t                 bytes_per_sample;
 };
 
@@ -112,7 +114,7 @@ static void CALLBACK waveOutProcWrap(
 static void mme_close_device(struct bj_audio_device* dev) {
     struct mme_device* mme_dev= (struct mme_device*)dev;
 
-    dev->should_close = BJ_TRUE;
+    bj_atomic_store_u32(&dev->should_close, BJ_TRUE);
     if (mme_dev->thread) {
         WaitForSingleObject(mme_dev->thread, INFINITE);
         CloseHandle(mme_dev->thread);
@@ -138,10 +140,9 @@ static DWORD WINAPI mme_playback_thread(LPVOID param) {
     struct mme_device* mme_dev = (struct mme_device*)param;
     struct bj_audio_device* dev = (struct bj_audio_device*)param;
 
-    while (!dev->should_close) {
-        if (dev->should_reset) {
+    while (!bj_atomic_load_u32(&dev->should_close)) {
+        if (bj_atomic_exchange_u32(&dev->should_reset, BJ_FALSE)) {
             mme_dev->sample_index = 0;
-            dev->should_reset = BJ_FALSE;
         }
 
         WAVEHDR* hdr = &mme_dev->p_wave_headers[mme_dev->next_block];
@@ -150,12 +151,23 @@ static DWORD WINAPI mme_playback_thread(LPVOID param) {
             continue;
         }
 
-        if (dev->playing) {
-            dev->callback(
+        // Once the queue was filled, finding every block played means the
+        // device ran out of data
+        if (mme_dev->blocks_written >= mme_dev->block_count) {
+            unsigned queued = 0;
+            for (unsigned i = 0; i < mme_dev->block_count; ++i) {
+                queued += (mme_dev->p_wave_headers[i].dwFlags & WHDR_INQUEUE) != 0;
+            }
+            if (queued == 0) {
+                bj_atomic_add_u32(&dev->underruns, 1);
+            }
+        }
+
+        if (bj_atomic_load_u32(&dev->playing)) {
+            bj_audio_device_fill(
+                dev,
                 hdr->lpData,
                 mme_dev->frames_per_block,
-                &dev->properties,
-                dev->callback_user_data,
                 mme_dev->sample_index
             );
         }
@@ -178,6 +190,9 @@ static DWORD WINAPI mme_playback_thread(LPVOID param) {
         MME.waveOutWrite(mme_dev->hwDevice, hdr, sizeof(WAVEHDR));
         mme_dev->sample_index += mme_dev->frames_per_block;
         mme_dev->next_block = (mme_dev->next_block + 1) % mme_dev->block_count;
+        if (mme_dev->blocks_written < mme_dev->block_count) {
+            ++mme_dev->blocks_written;
+        }
     }
 
     return 0;
@@ -240,8 +255,11 @@ static struct bj_audio_device* mme_open_device(
     }
 
     mme_dev->hwDevice = hwDevice;
-    mme_dev->block_count = MME_BLOCK_COUNT;
-    mme_dev->frames_per_block = MME_SAMPLES_PER_BLOCK;
+    mme_dev->block_count = p_properties->period_count >= 2 ? p_properties->period_count : MME_BLOCK_COUNT;
+    mme_dev->frames_per_block = p_properties->period_frames ? p_properties->period_frames : MME_SAMPLES_PER_BLOCK;
+    mme_dev->blocks_written = 0;
+    mme_dev->common.properties.period_frames = mme_dev->frames_per_block;
+    mme_dev->common.properties.period_count = mme_dev->block_count;
     mme_dev->sample_index = 0;
     mme_dev->next_block = 0;
     mme_dev->event = CreateEvent(NULL, FALSE, FALSE, NULL);
@@ -0,0 +1,268 @@
+#include <banjo/audio.h>
+#include <banjo/log.h>
+#include <banjo/memory.h>
+#include <banjo/null_audio.h>
+#include <banjo/string.h>
+#include <banjo/time.h>
+
+#include <atomic.h>
+#include <audio.h>
+#include <audio_layer.h>
+#include <check.h>
+#include <thread.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// Settings outlive the layer so they can be set before bj_begin()
+static struct {
+    enum bj_null_audio_pacing pacing;
+    uint64_t                  frame_limit;
+    char*                     output_path;
+} s_null_audio = {0};
+
+void bj_set_null_audio_pacing(
+    enum bj_null_audio_pacing pacing,
+    uint64_t                  frame_limit
+) {
+    s_null_audio.pacing      = pacing;
+    s_null_audio.frame_limit = frame_limit;
+}
+
+void bj_set_null_audio_output(
+    const char* path
+) {
+    bj_free(s_null_audio.output_path);
+    s_null_audio.output_path = 0;
+
+    if (path != 0) {
+        const size_t length = bj_strlen(path);
+        s_null_audio.output_path = bj_malloc(length + 1);
+        if (s_null_audio.output_path != 0) {
+            bj_memcpy(s_null_audio.output_path, path, length + 1);
+        }
+    }
+}
+
+#ifdef BJ_CONFIG_NULL_AUDIO_BACKEND
+
+#define WAV_HEADER_SIZE 44
+
+struct null_device {
+    struct bj_audio_device    common;
+    struct bj_thread*         thread;
+    char*                     p_buffer;
+    size_t                    frame_size;
+    enum bj_null_audio_pacing pacing;
+    uint64_t                  frame_limit;
+    FILE*                     output;
+    uint64_t                  output_frames;
+};
+
+static void put_u16(uint8_t* dst, uint32_t value) {
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t* dst, uint32_t value) {
+    put_u16(dst, value);
+    put_u16(dst + 2, value >> 16);
+}
+
+// Canonical 44 bytes header. It is written with empty sizes at open and
+// rewritten with the final ones at close.
+static void write_wav_header(struct null_device* device) {
+    const struct bj_audio_properties* properties = &device->common.properties;
+    const uint32_t data_size = (uint32_t)(device->output_frames * device->frame_size);
+    uint8_t header[WAV_HEADER_SIZE];
+
+    bj_memcpy(header, "RIFF", 4);
+    put_u32(header + 4, data_size + WAV_HEADER_SIZE - 8);
+    bj_memcpy(header + 8, "WAVEfmt ", 8);
+    put_u32(header + 16, 16);
+    put_u16(header + 20, BJ_AUDIO_FORMAT_FLOAT(properties->format) ? 3 : 1);
+    put_u16(header + 22, properties->channels);
+    put_u32(header + 24, properties->sample_rate);
+    put_u32(header + 28, properties->sample_rate * (uint32_t)device->frame_size);
+    put_u16(header + 32, (uint32_t)device->frame_size);
+    put_u16(header + 34, BJ_AUDIO_FORMAT_WIDTH(properties->format));
+    bj_memcpy(header + 36, "data", 4);
+    put_u32(header + 40, data_size);
+
+    fseek(device->output, 0, SEEK_SET);
+    fwrite(header, 1, WAV_HEADER_SIZE, device->output);
+}
+
+// Waits until the period starting at `frame` is due, keeping the whole
+// buffer of periods ahead of the clock like a sound card queue
+static void wait_period(struct null_device* device, uint64_t start, uint64_t frame) {
+    const struct bj_audio_properties* properties = &device->common.properties;
+    const uint64_t ahead = (uint64_t)properties->period_frames * properties->period_count;
+    if (frame <= ahead) {
+        return;
+    }
+    const double due  = (double)(frame - ahead) / (double)properties->sample_rate;
+    const double now  = (double)(bj_time_counter() - start) / (double)bj_time_frequency();
+    if (due > now) {
+        bj_sleep((int)((due - now) * 1000.0) + 1);
+    }
+}
+
+static void null_playback_thread(void* data) {
+    struct null_device*     device = (struct null_device*)data;
+    struct bj_audio_device* common = &device->common;
+    const unsigned          period = common->properties.period_frames;
+
+    const uint64_t start       = bj_time_counter();
+    uint64_t       clock_frame = 0;
+    uint64_t       sample_index = 0;
+
+    while (bj_atomic_load_u32(&common->should_close) == BJ_FALSE) {
+        if (bj_atomic_exchange_u32(&common->should_reset, BJ_FALSE) == BJ_TRUE) {
+            sample_index = 0;
+        }
+
+        if (device->pacing == BJ_NULL_AUDIO_REALTIME) {
+            wait_period(device, start, clock_frame);
+        }
+        clock_frame += period;
+
+        if (bj_atomic_load_u32(&common->playing) == BJ_FALSE) {
+            // Nothing is recorded while paused: offline devices only wait
+            // to be played again
+            if (device->pacing == BJ_NULL_AUDIO_OFFLINE) {
+                bj_sleep(1);
+            }
+            continue;
+        }
+
+        unsigned frames = period;
+        if (device->frame_limit > 0 && device->output_frames + frames >= device->frame_limit) {
+            frames = (unsigned)(device->frame_limit - device->output_frames);
+        }
+
+        if (frames > 0) {
+            bj_audio_device_fill(common, device->p_buffer, frames, sample_index);
+            sample_index += frames;
+            if (device->output != 0) {
+                fwrite(device->p_buffer, device->frame_size, frames, device->output);
+            }
+            device->output_frames += frames;
+        }
+
+        if (device->frame_limit > 0 && device->output_frames >= device->frame_limit) {
+            bj_atomic_store_u32(&common->playing, BJ_FALSE);
+        }
+    }
+}
+
+static void null_close_device(
+    struct bj_audio_device* p_device
+) {
+    bj_check(p_device);
+    struct null_device* device = (struct null_device*)p_device;
+
+    if (device->thread != 0) {
+        bj_thread_join(device->thread);
+    }
+
+    if (device->output != 0) {
+        write_wav_header(device);
+        fclose(device->output);
+    }
+
+    bj_free(device->p_buffer);
+    bj_free(device);
+}
+
+static struct bj_audio_device* null_open_device(
+    const struct bj_audio_properties* p_properties,
+    bj_audio_callback_fn              p_callback,
+    void*                             p_callback_user_data,
+    struct bj_error**                 p_error
+) {
+    struct null_device* device = bj_calloc(sizeof(struct null_device));
+    if (device == 0) {
+        bj_set_error(p_error, BJ_ERROR_CANNOT_ALLOCATE, "cannot allocate audio device");
+        return 0;
+    }
+
+    struct bj_audio_properties* properties = &device->common.properties;
+    if (p_properties != 0) {
+        *properties = *p_properties;
+    }
+    if (properties->format != BJ_AUDIO_FORMAT_F32) {
+        properties->format = BJ_AUDIO_FORMAT_INT16;
+    }
+    if (properties->amplitude == 0) {
+        properties->amplitude = BJ_AUDIO_AMPLITUDE;
+    }
+    if (properties->channels == 0) {
+        properties->channels = BJ_AUDIO_CHANNELS;
+    }
+    if (properties->sample_rate == 0) {
+        properties->sample_rate = BJ_AUDIO_SAMPLE_RATE;
+    }
+    if (properties->period_frames == 0) {
+        properties->period_frames = BJ_AUDIO_PERIOD_FRAMES;
+    }
+    if (properties->period_count < 2) {
+        properties->period_count = BJ_AUDIO_PERIOD_COUNT;
+    }
+
+    device->common.callback           = p_callback;
+    device->common.callback_user_data = p_callback_user_data;
+    device->common.silence            = 0;
+    device->pacing      = s_null_audio.pacing;
+    device->frame_limit = s_null_audio.frame_limit;
+    device->frame_size  = properties->channels * BJ_AUDIO_FORMAT_WIDTH(properties->format) / 8;
+    device->p_buffer    = bj_calloc(device->frame_size * properties->period_frames);
+    if (device->p_buffer == 0) {
+        bj_set_error(p_error, BJ_ERROR_CANNOT_ALLOCATE, "cannot allocate audio buffer");
+        null_close_device(&device->common);
+        return 0;
+    }
+
+    if (s_null_audio.output_path != 0) {
+        device->output = fopen(s_null_audio.output_path, "wb");
+        if (device->output == 0) {
+            bj_set_error(p_error, BJ_ERROR_AUDIO, strerror(errno));
+            null_close_device(&device->common);
+            return 0;
+        }
+        write_wav_header(device);
+    }
+
+    device->thread = bj_thread_create(null_playback_thread, device);
+    if (device->thread == 0) {
+        bj_set_error(p_error, BJ_ERROR_AUDIO, "cannot start audio thread");
+        null_close_device(&device->common);
+        return 0;
+    }
+
+    return &device->common;
+}
+
+static void null_dispose_audio(struct bj_error** p_error) {
+    (void)p_error;
+    bj_set_null_audio_output(0);
+}
+
+static bj_bool null_init_audio(
+    struct bj_audio_layer* layer,
+    struct bj_error**      p_error
+) {
+    (void)p_error;
+    layer->end          = null_dispose_audio;
+    layer->open_device  = null_open_device;
+    layer->close_device = null_close_device;
+    return BJ_TRUE;
+}
+
+struct bj_audio_layer_create_info null_audio_layer_info = {
+    .name   = "null",
+    .create = null_init_audio,
+};
+
+#endif
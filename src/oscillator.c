@@ -0,0 +1,167 @@
+// oscillator.c - Phase accumulator oscillators.
+//
+// The phase is a 32-bit fixed-point fraction of the period that wraps on
+// its own, so it never drifts nor needs a modulo. Each shape has its own
+// loop, selected once per block.
+//
+// The sine is computed by rotating a (sin, cos) pair by the phase increment
+// at each sample. The pair is recomputed from the phase every SINE_SPAN
+// samples to keep rounding errors from accumulating.
+
+#include <banjo/math.h>
+#include <banjo/oscillator.h>
+
+#include <check.h>
+
+#define PHASE_SCALE   4294967296.0
+#define PHASE_TO_UNIT (1.0f / 4294967296.0f)
+#define SINE_SPAN     256
+
+static uint32_t phase_increment(float frequency, unsigned int sample_rate) {
+    if (sample_rate == 0 || frequency <= 0.0f) {
+        return 0;
+    }
+    double increment = (double)frequency / (double)sample_rate * PHASE_SCALE;
+    if (increment > PHASE_SCALE / 2.0) {
+        increment = PHASE_SCALE / 2.0; // Nyquist
+    }
+    return (uint32_t)increment;
+}
+
+void bj_init_oscillator(
+    struct bj_oscillator*    oscillator,
+    enum bj_oscillator_shape shape,
+    float                    frequency,
+    float                    amplitude,
+    unsigned int             sample_rate
+) {
+    bj_check(oscillator);
+    oscillator->shape       = shape;
+    oscillator->phase       = 0;
+    oscillator->frequency   = frequency;
+    oscillator->amplitude   = amplitude;
+    oscillator->sample_rate = sample_rate;
+    oscillator->increment   = phase_increment(frequency, sample_rate);
+}
+
+void bj_set_oscillator_frequency(
+    struct bj_oscillator* oscillator,
+    float                 frequency
+) {
+    bj_check(oscillator);
+    oscillator->frequency = frequency;
+    oscillator->increment = phase_increment(frequency, oscillator->sample_rate);
+}
+
+// Correction of a unit step at t = 0, spread over one sample on each side.
+// `dt` is the phase increment as a fraction of the period.
+static float poly_blep(float t, float dt) {
+    if (t < dt) {
+        t /= dt;
+        return t + t - t * t - 1.0f;
+    }
+    if (t > 1.0f - dt) {
+        t = (t - 1.0f) / dt;
+        return t * t + t + t + 1.0f;
+    }
+    return 0.0f;
+}
+
+static void render_sine(struct bj_oscillator* oscillator, float* samples, size_t frames) {
+    const float to_radians = (float)BJ_TAU_D * PHASE_TO_UNIT;
+    const float step       = (float)oscillator->increment * to_radians;
+    const float step_sin   = bj_sinf(step);
+    const float step_cos   = bj_cosf(step);
+    const float amplitude  = oscillator->amplitude;
+
+    for (size_t start = 0; start < frames; start += SINE_SPAN) {
+        const size_t end   = frames - start < SINE_SPAN ? frames : start + SINE_SPAN;
+        const float  angle = (float)oscillator->phase * to_radians;
+        float s = bj_sinf(angle);
+        float c = bj_cosf(angle);
+        for (size_t i = start; i < end; ++i) {
+            samples[i] = s * amplitude;
+            const float next = s * step_cos + c * step_sin;
+            c = c * step_cos - s * step_sin;
+            s = next;
+        }
+        oscillator->phase += oscillator->increment * (uint32_t)(end - start);
+    }
+}
+
+static void render_square(struct bj_oscillator* oscillator, float* samples, size_t frames) {
+    const float dt        = (float)oscillator->increment * PHASE_TO_UNIT;
+    const float amplitude = oscillator->amplitude;
+    uint32_t    phase     = oscillator->phase;
+
+    for (size_t i = 0; i < frames; ++i) {
+        const float t    = (float)phase * PHASE_TO_UNIT;
+        const float fall = (float)(uint32_t)(phase + 0x80000000u) * PHASE_TO_UNIT;
+        const float value = (phase < 0x80000000u ? 1.0f : -1.0f) + poly_blep(t, dt) - poly_blep(fall, dt);
+        samples[i] = value * amplitude;
+        phase += oscillator->increment;
+    }
+    oscillator->phase = phase;
+}
+
+static void render_triangle(struct bj_oscillator* oscillator, float* samples, size_t frames) {
+    const float amplitude = oscillator->amplitude;
+    uint32_t    phase     = oscillator->phase;
+
+    for (size_t i = 0; i < frames; ++i) {
+        const float t = (float)phase * PHASE_TO_UNIT;
+        samples[i] = (phase < 0x80000000u ? 4.0f * t - 1.0f : 3.0f - 4.0f * t) * amplitude;
+        phase += oscillator->increment;
+    }
+    oscillator->phase = phase;
+}
+
+// Starts at 0 and jumps from 1 to -1 in the middle of the period
+static void render_sawtooth(struct bj_oscillator* oscillator, float* samples, size_t frames) {
+    const float dt        = (float)oscillator->increment * PHASE_TO_UNIT;
+    const float amplitude = oscillator->amplitude;
+    uint32_t    phase     = oscillator->phase;
+
+    for (size_t i = 0; i < frames; ++i) {
+        const float t = (float)(uint32_t)(phase + 0x80000000u) * PHASE_TO_UNIT;
+        samples[i] = (2.0f * t - 1.0f - poly_blep(t, dt)) * amplitude;
+        phase += oscillator->increment;
+    }
+    oscillator->phase = phase;
+}
+
+void bj_render_oscillator(
+    struct bj_oscillator* oscillator,
+    float*                samples,
+    size_t                frames
+) {
+    bj_check(oscillator);
+    bj_check(samples || frames == 0);
+
+    switch (oscillator->shape) {
+        case BJ_OSCILLATOR_SINE:     render_sine(oscillator, samples, frames);     break;
+        case BJ_OSCILLATOR_SQUARE:   render_square(oscillator, samples, frames);   break;
+        case BJ_OSCILLATOR_TRIANGLE: render_triangle(oscillator, samples, frames); break;
+        case BJ_OSCILLATOR_SAWTOOTH: render_sawtooth(oscillator, samples, frames); break;
+        default:
+            for (size_t i = 0; i < frames; ++i) {
+                samples[i] = 0.0f;
+            }
+            break;
+    }
+}
+
+bj_bool bj_oscillator_generator(
+    float*       samples,
+    unsigned     frames,
+    unsigned int sample_rate,
+    void*        user_data
+) {
+    struct bj_oscillator* oscillator = (struct bj_oscillator*)user_data;
+    if (oscillator->sample_rate != sample_rate) {
+        oscillator->sample_rate = sample_rate;
+        oscillator->increment   = phase_increment(oscillator->frequency, sample_rate);
+    }
+    bj_render_oscillator(oscillator, samples, frames);
+    return BJ_TRUE;
+}
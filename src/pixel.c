@@ -1,6 +1,7 @@
 #include <banjo/assert.h>
 #include <banjo/pixel.h>
 
+#include <bitmap.h>
 #include <check.h>
 
 struct bitmask {
@@ -77,11 +78,12 @@ void bj_make_pixel_rgb(
     }
 }
 
-uint32_t bj_get_pixel_value(
-    enum bj_pixel_mode mode, 
+uint32_t bj_get_pixel_value_rgba(
+    enum bj_pixel_mode mode,
     uint8_t red,
     uint8_t green,
-    uint8_t blue
+    uint8_t blue,
+    uint8_t alpha
 ) {
     const uint8_t type = BJ_PIXEL_GET_TYPE(mode);
     switch(type) {
@@ -98,9 +100,14 @@ uint32_t bj_get_pixel_value(
         {
             const struct bitfield bf = bitfields[BJ_PIXEL_GET_LAYOUT(mode)];
 
+            const uint32_t a = bj_pixel_mode_has_alpha(mode)
+                ? ((uint32_t)(alpha >> (8 - bf.alpha.bits))) << bf.alpha.shift
+                : 0u;
+
             return    ((uint32_t)(red >> (8 - bf.red.bits))) << bf.red.shift
                     | ((uint32_t)(green >> (8 - bf.green.bits))) << bf.green.shift
-                    | ((uint32_t)(blue >> (8 - bf.blue.bits))) << bf.blue.shift;
+                    | ((uint32_t)(blue >> (8 - bf.blue.bits))) << bf.blue.shift
+                    | a;
         }
         break;
         default:
@@ -110,6 +117,27 @@ uint32_t bj_get_pixel_value(
     return 0;
 }
 
+uint32_t bj_get_pixel_value(
+    enum bj_pixel_mode mode, 
+    uint8_t red,
+    uint8_t green,
+    uint8_t blue
+) {
+    return bj_get_pixel_value_rgba(mode, red, green, blue, 0xFF);
+}
+
+void bj_make_pixel_rgba(
+    enum bj_pixel_mode mode,
+    uint32_t      value,
+    uint8_t*      p_red,
+    uint8_t*      p_green,
+    uint8_t*      p_blue,
+    uint8_t*      p_alpha
+) {
+    bj_make_pixel_rgb(mode, value, p_red, p_green, p_blue);
+    *p_alpha = bj_pixel_mode_has_alpha(mode) ? (uint8_t)(value >> 24) : 0xFF;
+}
+
 #define RETURN_IF_MATCH(r,g,b, fmt) if(red_mask == r && green_mask == g && blue_mask == b) {return fmt;}
 int bj_compute_pixel_mode(
     uint8_t bpp,
@@ -171,6 +199,8 @@ size_t bj_compute_bitmap_stride(
     case BJ_PIXEL_MODE_BGR24:
         return (width * 3 + 3) & ~(size_t)3;
     case BJ_PIXEL_MODE_XRGB8888:
+    case BJ_PIXEL_MODE_ARGB8888:
+    case BJ_PIXEL_MODE_ARGB8888_PREMUL:
         return width * 4;
     default: break;
 
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <banjo/api.h>
+
+// ============================================================================
+// POOL - internal
+// ============================================================================
+// Size-class allocator for the small structs owned by the library (errors,
+// bitmaps, streams). Blocks of a class are carved from slabs allocated with
+// the built-in allocator, and freed blocks go to the free list of their
+// slab. A slab is given back when its last block is freed, so the pool
+// holds no memory while no object is alive.
+//
+// Each thread caches a few free blocks per class so that most calls take
+// no lock. The cache is flushed when the thread has freed as many blocks as
+// it allocated; bj_flush_pool_cache() flushes it at any other time.
+//
+// Requests larger than the biggest class go to bj_malloc, as do all requests
+// while bj_set_memory_defaults() installs other allocators. Memory from
+// bj_pool_allocate must only be released with bj_pool_free. All functions
+// can be called from any thread.
+// ============================================================================
+
+void* bj_pool_allocate(size_t size);
+
+void bj_pool_free(void* memory);
+
+void bj_flush_pool_cache(void);
@@ -1,5 +1,7 @@
+#include <banjo/bitmap.h>
 #include <banjo/error.h>
 #include <banjo/log.h>
+#include <banjo/memory.h>
 #include <banjo/renderer.h>
 #include <banjo/version.h>
 
@@ -9,6 +11,82 @@
 
 extern struct bj_video_layer s_video;
 
+static int rect_right(const struct bj_rect* rect) {
+    return (int)rect->x + (int)rect->w;
+}
+
+static int rect_bottom(const struct bj_rect* rect) {
+    return (int)rect->y + (int)rect->h;
+}
+
+static size_t rect_area(const struct bj_rect* rect) {
+    return (size_t)rect->w * (size_t)rect->h;
+}
+
+// Overlapping or sharing an edge
+static bj_bool rects_touch(const struct bj_rect* a, const struct bj_rect* b) {
+    return a->x <= rect_right(b) && b->x <= rect_right(a)
+        && a->y <= rect_bottom(b) && b->y <= rect_bottom(a);
+}
+
+static struct bj_rect rect_union(const struct bj_rect* a, const struct bj_rect* b) {
+    const int x0 = a->x < b->x ? a->x : b->x;
+    const int y0 = a->y < b->y ? a->y : b->y;
+    const int x1 = rect_right(a) > rect_right(b) ? rect_right(a) : rect_right(b);
+    const int y1 = rect_bottom(a) > rect_bottom(b) ? rect_bottom(a) : rect_bottom(b);
+    return (struct bj_rect){
+        .x = (int16_t)x0, .y = (int16_t)y0,
+        .w = (uint16_t)(x1 - x0), .h = (uint16_t)(y1 - y0),
+    };
+}
+
+// Rectangle whose union with `area` adds the fewest pixels
+static size_t closest_rect(
+    const struct bj_dirty_region* region,
+    const struct bj_rect*         area
+) {
+    size_t closest = 0;
+    size_t best    = (size_t)-1;
+    for (size_t i = 0; i < region->count; ++i) {
+        const struct bj_rect merged = rect_union(&region->rects[i], area);
+        const size_t growth = rect_area(&merged) - rect_area(&region->rects[i]);
+        if (growth < best) {
+            best    = growth;
+            closest = i;
+        }
+    }
+    return closest;
+}
+
+void bj_dirty_region_add(
+    struct bj_dirty_region* region,
+    const struct bj_rect*   area
+) {
+    struct bj_rect merged = *area;
+
+    // Merging grows the rectangle, which may then reach others: loop until
+    // it stands alone and a slot is free.
+    for (;;) {
+        size_t target = region->count;
+        for (size_t i = 0; i < region->count; ++i) {
+            if (rects_touch(&region->rects[i], &merged)) {
+                target = i;
+                break;
+            }
+        }
+        if (target == region->count) {
+            if (region->count < BJ_MAX_DIRTY_RECTS) {
+                break;
+            }
+            target = closest_rect(region, &merged);
+        }
+        merged = rect_union(&region->rects[target], &merged);
+        region->rects[target] = region->rects[--region->count];
+    }
+
+    region->rects[region->count++] = merged;
+}
+
 struct bj_renderer* bj_create_renderer(
     enum bj_renderer_type type,
     struct bj_error**     error
@@ -43,6 +121,7 @@ bj_bool bj_renderer_configure(
     struct bj_error**   error
 ) {
     bj_check_or_0(renderer);
+    renderer->dirty.count = 0;
     return renderer->configure(renderer, window, error);
 }
 
@@ -58,6 +137,81 @@ void bj_present(
     struct bj_window*   window
 ) {
     bj_check(renderer);
+
+    struct bj_bitmap* framebuffer = bj_get_framebuffer(renderer);
+    if (framebuffer == 0) {
+        renderer->present(renderer, window);
+        return;
+    }
+
+    struct bj_dirty_region* dirty = &renderer->dirty;
+    if (dirty->count == 0 || !renderer->partial_present) {
+        dirty->rects[0] = (struct bj_rect){
+            .x = 0, .y = 0,
+            .w = (uint16_t)bj_bitmap_width(framebuffer),
+            .h = (uint16_t)bj_bitmap_height(framebuffer),
+        };
+        dirty->count = 1;
+    }
+
     renderer->present(renderer, window);
+
+    const size_t bpp = BJ_PIXEL_GET_BPP((size_t)bj_bitmap_mode(framebuffer));
+    size_t bytes = 0;
+    for (size_t i = 0; i < dirty->count; ++i) {
+        bytes += (size_t)dirty->rects[i].h * (((size_t)dirty->rects[i].w * bpp + 7) / 8);
+    }
+    renderer->stats.frame_count     += 1;
+    renderer->stats.total_bytes     += bytes;
+    renderer->stats.last_bytes       = bytes;
+    renderer->stats.last_rect_count  = dirty->count;
+    dirty->count = 0;
+}
+
+void bj_renderer_mark_dirty(
+    struct bj_renderer*   renderer,
+    const struct bj_rect* area
+) {
+    bj_check(renderer);
+
+    struct bj_bitmap* framebuffer = bj_get_framebuffer(renderer);
+    if (framebuffer == 0) {
+        return;
+    }
+
+    const int width  = (int)bj_bitmap_width(framebuffer);
+    const int height = (int)bj_bitmap_height(framebuffer);
+    int x0 = 0, y0 = 0, x1 = width, y1 = height;
+    if (area != 0) {
+        x0 = area->x > 0 ? area->x : 0;
+        y0 = area->y > 0 ? area->y : 0;
+        x1 = rect_right(area) < width ? rect_right(area) : width;
+        y1 = rect_bottom(area) < height ? rect_bottom(area) : height;
+    }
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    const struct bj_rect clipped = {
+        .x = (int16_t)x0, .y = (int16_t)y0,
+        .w = (uint16_t)(x1 - x0), .h = (uint16_t)(y1 - y0),
+    };
+    bj_dirty_region_add(&renderer->dirty, &clipped);
+}
+
+void bj_get_present_stats(
+    const struct bj_renderer* renderer,
+    struct bj_present_stats*  stats
+) {
+    bj_check(renderer);
+    bj_check(stats);
+    *stats = renderer->stats;
+}
+
+void bj_reset_present_stats(
+    struct bj_renderer* renderer
+) {
+    bj_check(renderer);
+    bj_memzero(&renderer->stats, sizeof(renderer->stats));
 }
 
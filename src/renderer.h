@@ -2,6 +2,8 @@
 #define BJ_RENDERER_T_H
 
 #include <banjo/error.h>
+#include <banjo/rect.h>
+#include <banjo/renderer.h>
 
 struct bj_bitmap;
 struct bj_renderer;
@@ -23,11 +25,34 @@ typedef void (*bj_renderer_present_fn)(
     struct bj_window* window
 );
 
+// Regions merged beyond this count are folded into their closest neighbour
+#define BJ_MAX_DIRTY_RECTS 8
+
+// Framebuffer areas changed since the last present, clipped to the
+// framebuffer. Overlapping and touching rectangles are merged on insertion.
+// An empty region means "nothing marked" and presents the whole frame.
+struct bj_dirty_region {
+    struct bj_rect rects[BJ_MAX_DIRTY_RECTS];
+    size_t         count;
+};
+
+// Adds a non-empty rectangle to the region.
+void bj_dirty_region_add(
+    struct bj_dirty_region* region,
+    const struct bj_rect*   area
+);
+
 struct bj_renderer {
     bj_renderer_configure_fn       configure;
     bj_renderer_get_framebuffer_fn get_framebuffer;
     bj_renderer_present_fn         present;
 
+    // Set by backends whose present function only pushes `dirty.rects`.
+    // Other backends always receive a single full-frame rectangle.
+    bj_bool                 partial_present;
+    struct bj_dirty_region  dirty;
+    struct bj_present_stats stats;
+
     struct bj_renderer_data* data;
 };
 
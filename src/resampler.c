@@ -0,0 +1,294 @@
+// resampler.c - Sample rate conversion.
+//
+// Both qualities run the same polyphase FIR: output frame n is centered on
+// input position n * input_rate / output_rate, kept in 32.32 fixed point.
+// The fractional part selects two neighboring rows of a coefficient table,
+// whose results are interpolated. Linear interpolation is the 2-tap case of
+// the table, windowed sinc uses SINC_TAPS taps.
+//
+// Input frames are deinterleaved into one work buffer per channel so each
+// dot product reads contiguous samples. The dot product has SSE2 and NEON
+// versions, selected once at creation.
+
+#include <banjo/audio.h>
+#include <banjo/math.h>
+#include <banjo/memory.h>
+
+#include <check.h>
+#include <cpu.h>
+
+#if defined(BJ_CPU_HAS_X86_SIMD)
+#   include <immintrin.h>
+#endif
+#if defined(BJ_CPU_HAS_NEON_SIMD)
+#   include <arm_neon.h>
+#endif
+
+#define SINC_TAPS    32
+#define PHASE_BITS   7
+#define PHASES       (1u << PHASE_BITS)
+#define WORK_FRAMES  512 // Input frames buffered per channel, besides taps
+
+#define FRACTION_BITS (32 - PHASE_BITS)
+#define FRACTION_MASK ((1u << FRACTION_BITS) - 1)
+
+struct bj_resampler {
+    unsigned int channels;
+    size_t       taps;
+    size_t       half;      // Taps at or before the center
+    uint64_t     step;      // Input frames per output frame, 32.32
+    uint64_t     position;  // Next output position in `work`, 32.32
+    size_t       filled;    // Frames in each work buffer
+    size_t       capacity;  // Frames each work buffer can hold
+    bj_bool      simd;
+    float*       table;     // (PHASES + 1) rows of `taps` coefficients
+    float*       work;      // `channels` buffers of `capacity` frames
+};
+
+// ----------------------------------------------------------------------------
+// Filter
+// ----------------------------------------------------------------------------
+
+static double blackman(double x) {
+    if (x <= -1.0 || x >= 1.0) {
+        return 0.0;
+    }
+    return 0.42 + 0.5 * bj_cosd(BJ_PI_D * x) + 0.08 * bj_cosd(2.0 * BJ_PI_D * x);
+}
+
+static double sinc(double x) {
+    return x == 0.0 ? 1.0 : bj_sind(BJ_PI_D * x) / (BJ_PI_D * x);
+}
+
+// Row p holds the taps for an output at fraction p / PHASES past an input
+// frame. Tap k weighs the input at distance `fraction + half - 1 - k`.
+static void build_table(struct bj_resampler* resampler, enum bj_resample_quality quality, double cutoff) {
+    const size_t taps = resampler->taps;
+    const double half = (double)resampler->half;
+
+    for (size_t p = 0; p <= PHASES; ++p) {
+        float* row = resampler->table + p * taps;
+        const double fraction = (double)p / PHASES;
+        double sum = 0.0;
+        double weights[SINC_TAPS];
+
+        for (size_t k = 0; k < taps; ++k) {
+            const double distance = fraction + half - 1.0 - (double)k;
+            if (quality == BJ_RESAMPLE_LINEAR) {
+                weights[k] = 1.0 - bj_absd(distance);
+            } else {
+                weights[k] = cutoff * sinc(cutoff * distance) * blackman(distance / half);
+            }
+            sum += weights[k];
+        }
+
+        // Unity gain at DC for every phase
+        for (size_t k = 0; k < taps; ++k) {
+            row[k] = (float)(weights[k] / sum);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Kernels
+// ----------------------------------------------------------------------------
+
+// Dot products of `x` with rows `a` and `b`, interpolated by `t`
+static float dot_scalar(const float* BJ_RESTRICT x, const float* BJ_RESTRICT a, const float* BJ_RESTRICT b, float t, size_t taps) {
+    float sa = 0.0f;
+    float sb = 0.0f;
+    for (size_t k = 0; k < taps; ++k) {
+        sa += x[k] * a[k];
+        sb += x[k] * b[k];
+    }
+    return sa + (sb - sa) * t;
+}
+
+// Same as dot_scalar, for a multiple of 4 taps
+static float dot_simd(const float* BJ_RESTRICT x, const float* BJ_RESTRICT a, const float* BJ_RESTRICT b, float t, size_t taps) {
+#if defined(BJ_CPU_HAS_X86_SIMD)
+    __m128 va = _mm_setzero_ps();
+    __m128 vb = _mm_setzero_ps();
+    for (size_t k = 0; k < taps; k += 4) {
+        const __m128 vx = _mm_loadu_ps(x + k);
+        va = _mm_add_ps(va, _mm_mul_ps(vx, _mm_loadu_ps(a + k)));
+        vb = _mm_add_ps(vb, _mm_mul_ps(vx, _mm_loadu_ps(b + k)));
+    }
+    const __m128 v = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), _mm_set1_ps(t)));
+    const __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+#elif defined(BJ_CPU_HAS_NEON_SIMD)
+    float32x4_t va = vdupq_n_f32(0.0f);
+    float32x4_t vb = vdupq_n_f32(0.0f);
+    for (size_t k = 0; k < taps; k += 4) {
+        const float32x4_t vx = vld1q_f32(x + k);
+        va = vmlaq_f32(va, vx, vld1q_f32(a + k));
+        vb = vmlaq_f32(vb, vx, vld1q_f32(b + k));
+    }
+    const float32x4_t v = vmlaq_n_f32(va, vsubq_f32(vb, va), t);
+    const float32x2_t pairs = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+#else
+    return dot_scalar(x, a, b, t, taps);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// API
+// ----------------------------------------------------------------------------
+
+struct bj_resampler* bj_create_resampler(
+    unsigned int             channels,
+    unsigned int             input_rate,
+    unsigned int             output_rate,
+    enum bj_resample_quality quality
+) {
+    if (channels == 0 || input_rate == 0 || output_rate == 0
+        || (quality != BJ_RESAMPLE_SINC && quality != BJ_RESAMPLE_LINEAR)) {
+        return 0;
+    }
+
+    struct bj_resampler* resampler = bj_calloc(sizeof(struct bj_resampler));
+    if (resampler == 0) {
+        return 0;
+    }
+    resampler->channels = channels;
+    resampler->taps     = quality == BJ_RESAMPLE_LINEAR ? 2 : SINC_TAPS;
+    resampler->half     = resampler->taps / 2;
+    resampler->capacity = WORK_FRAMES + resampler->taps;
+    resampler->step     = (((uint64_t)input_rate << 32) + output_rate / 2) / output_rate;
+
+#if defined(BJ_CPU_HAS_X86_SIMD)
+    resampler->simd = (bj_cpu_features() & BJ_CPU_SSE2) && resampler->taps % 4 == 0;
+#elif defined(BJ_CPU_HAS_NEON_SIMD)
+    resampler->simd = (bj_cpu_features() & BJ_CPU_NEON) && resampler->taps % 4 == 0;
+#endif
+
+    resampler->table = bj_malloc((PHASES + 1) * resampler->taps * sizeof(float));
+    resampler->work  = bj_malloc(channels * resampler->capacity * sizeof(float));
+    if (resampler->table == 0 || resampler->work == 0) {
+        bj_destroy_resampler(resampler);
+        return 0;
+    }
+
+    // Downsampling lowers the cutoff to the output Nyquist frequency
+    const double cutoff = output_rate < input_rate ? (double)output_rate / input_rate : 1.0;
+    build_table(resampler, quality, cutoff);
+    bj_reset_resampler(resampler);
+    return resampler;
+}
+
+void bj_destroy_resampler(
+    struct bj_resampler* resampler
+) {
+    if (resampler == 0) {
+        return;
+    }
+    bj_free(resampler->table);
+    bj_free(resampler->work);
+    bj_free(resampler);
+}
+
+void bj_reset_resampler(
+    struct bj_resampler* resampler
+) {
+    bj_check(resampler);
+
+    // Starts with silence before the first input frame, so the first output
+    // is centered on it.
+    resampler->filled   = resampler->half - 1;
+    resampler->position = (uint64_t)(resampler->half - 1) << 32;
+    bj_memzero(resampler->work, resampler->channels * resampler->capacity * sizeof(float));
+}
+
+// Drops the work frames no future output needs, then appends input frames.
+// Returns the number of input frames consumed.
+static size_t refill(struct bj_resampler* resampler, const float* input, size_t input_frames) {
+    const size_t channels = resampler->channels;
+    size_t drop = (size_t)(resampler->position >> 32) + 1 - resampler->half;
+    size_t used = 0;
+
+    if (drop > resampler->filled) {
+        // Large downsampling steps can skip input frames entirely
+        used = drop - resampler->filled;
+        if (used > input_frames) {
+            used = input_frames;
+        }
+        drop = resampler->filled;
+        resampler->position -= (uint64_t)used << 32;
+    }
+    if (drop > 0) {
+        const size_t keep = resampler->filled - drop;
+        for (size_t c = 0; c < channels; ++c) {
+            float* work = resampler->work + c * resampler->capacity;
+            bj_memmove(work, work + drop, keep * sizeof(float));
+        }
+        resampler->filled    = keep;
+        resampler->position -= (uint64_t)drop << 32;
+    }
+
+    size_t count = resampler->capacity - resampler->filled;
+    if (count > input_frames - used) {
+        count = input_frames - used;
+    }
+    const float* src = input + used * channels;
+    for (size_t c = 0; c < channels; ++c) {
+        float* work = resampler->work + c * resampler->capacity + resampler->filled;
+        for (size_t i = 0; i < count; ++i) {
+            work[i] = src[i * channels + c];
+        }
+    }
+    resampler->filled += count;
+    return used + count;
+}
+
+size_t bj_resample(
+    struct bj_resampler* resampler,
+    const float*         input,
+    size_t               input_frames,
+    size_t*              consumed,
+    float*               output,
+    size_t               output_frames
+) {
+    bj_check_or_0(resampler);
+    bj_check_or_0(input || input_frames == 0);
+    bj_check_or_0(output || output_frames == 0);
+
+    const size_t channels = resampler->channels;
+    const size_t taps     = resampler->taps;
+    size_t produced = 0;
+    size_t used     = 0;
+
+    for (;;) {
+        while (produced < output_frames) {
+            const size_t index = (size_t)(resampler->position >> 32);
+            if (index + resampler->half >= resampler->filled) {
+                break;
+            }
+            const uint32_t fraction = (uint32_t)resampler->position;
+            const float*   a        = resampler->table + (fraction >> FRACTION_BITS) * taps;
+            const float*   b        = a + taps;
+            const float    t        = (float)(fraction & FRACTION_MASK) * (1.0f / (float)(1u << FRACTION_BITS));
+            const float*   x        = resampler->work + index + 1 - resampler->half;
+
+            float* out = output + produced * channels;
+            for (size_t c = 0; c < channels; ++c) {
+                out[c] = resampler->simd
+                    ? dot_simd(x + c * resampler->capacity, a, b, t, taps)
+                    : dot_scalar(x + c * resampler->capacity, a, b, t, taps);
+            }
+            resampler->position += resampler->step;
+            ++produced;
+        }
+
+        if (produced == output_frames || used == input_frames) {
+            break;
+        }
+        used += refill(resampler, input + used * channels, input_frames - used);
+    }
+
+    if (consumed != 0) {
+        *consumed = used;
+    }
+    return produced;
+}
@@ -1,16 +1,238 @@
+#include <banjo/memory.h>
 #include <banjo/shader.h>
 #include <bitmap.h>
+#include <atomic.h>
 #include <check.h>
+#include <thread.h>
 
-void bj_shader_bitmap(
-    struct bj_bitmap*               p_bitmap,
-    bj_bitmap_shading_fn   p_shader,
-    void*                    p_data,
-    uint8_t                  flags
+// Rows per band are chosen so that each thread gets several bands, which
+// evens out shaders whose cost depends on the pixel position.
+#define BANDS_PER_THREAD 4
+
+// 0 picks one thread per hardware thread
+static size_t s_thread_count = 0;
+
+// Position and width of one channel in a pixel value, as read by
+// bj_make_pixel_rgb and written by bj_get_pixel_value.
+struct channel {
+    uint32_t mask;
+    uint8_t  shift;
+    uint8_t  loss;   // 8 - number of bits
+};
+
+struct shading {
+    struct bj_bitmap*         bitmap;
+    bj_bitmap_shading_fn      shader;
+    bj_bitmap_span_shading_fn span_shader;
+    void*                     data;
+    bj_real                   ax, bx, ay, by;
+    const bj_real*            x_coords;   // Span shaders only
+    int                       clamp_color;
+    size_t                    bpp;
+    struct channel            red, green, blue;
+    uint32_t                  fixed_bits; // Alpha of ARGB modes, set to opaque
+    size_t                    band_rows;
+    volatile uint32_t         failed;     // Set by bands that could not allocate
+};
+
+static struct channel make_channel(uint32_t mask) {
+    struct channel c = {.mask = mask, .shift = 0, .loss = 8};
+    if (mask == 0) {
+        return c;
+    }
+    while (((mask >> c.shift) & 1u) == 0) {
+        ++c.shift;
+    }
+    while (((mask >> c.shift) >> (8 - c.loss)) & 1u) {
+        --c.loss;
+    }
+    return c;
+}
+
+static inline uint8_t unpack_channel(uint32_t value, const struct channel* c) {
+    return (uint8_t)(((value & c->mask) >> c->shift) << c->loss);
+}
+
+static inline uint32_t pack_channel(uint8_t value, const struct channel* c) {
+    return ((uint32_t)value >> c->loss) << c->shift;
+}
+
+static inline uint32_t pack_rgb(const struct shading* s, uint8_t r, uint8_t g, uint8_t b) {
+    return pack_channel(r, &s->red)
+         | pack_channel(g, &s->green)
+         | pack_channel(b, &s->blue)
+         | s->fixed_bits;
+}
+
+static inline uint8_t to_u8(const struct shading* s, bj_real value) {
+    if (s->clamp_color) {
+        value = bj_clamp(value, BJ_FZERO, BJ_F(1.0));
+    }
+    return (uint8_t)(value * BJ_F(255.0) + BJ_F(0.5));
+}
+
+// Runs the shader on one pixel. Returns 0 when the shader discards it.
+static inline int shade_pixel(
+    const struct shading* s, size_t x, size_t y,
+    uint8_t* r, uint8_t* g, uint8_t* b
 ) {
-    bj_check(p_bitmap);
-    bj_check(p_shader);
+    const bj_real inv255 = BJ_FI(255.0);
+    struct bj_vec3 color = { (bj_real)*r * inv255, (bj_real)*g * inv255, (bj_real)*b * inv255 };
+    struct bj_vec2 frag_coords = { s->ax * (bj_real)x + s->bx, s->ay * (bj_real)y + s->by };
+
+    if (s->shader(&color, frag_coords, s->data) <= 0) {
+        return 0;
+    }
+
+    *r = to_u8(s, color.x);
+    *g = to_u8(s, color.y);
+    *b = to_u8(s, color.z);
+    return 1;
+}
+
+static void shade_rows(const struct shading* s, size_t y_begin, size_t y_end) {
+    struct bj_bitmap* bmp = s->bitmap;
+    const size_t W = bmp->width;
+
+    if (s->bpp < 8) {
+        // Indexed sub-byte formats go through the generic accessors
+        for (size_t y = y_begin; y < y_end; ++y) {
+            for (size_t x = 0; x < W; ++x) {
+                uint8_t r, g, b;
+                bj_make_bitmap_rgb(bmp, x, y, &r, &g, &b);
+                if (shade_pixel(s, x, y, &r, &g, &b)) {
+                    bj_put_pixel(bmp, x, y, bj_make_bitmap_pixel(bmp, r, g, b));
+                }
+            }
+        }
+        return;
+    }
+
+    for (size_t y = y_begin; y < y_end; ++y) {
+        uint8_t* row = bj_row_ptr(bmp, y);
+        for (size_t x = 0; x < W; ++x) {
+            const uint32_t value = bj_get_pixel_by_bpp(row, x, s->bpp);
+            uint8_t r = unpack_channel(value, &s->red);
+            uint8_t g = unpack_channel(value, &s->green);
+            uint8_t b = unpack_channel(value, &s->blue);
+            if (shade_pixel(s, x, y, &r, &g, &b)) {
+                bj_put_pixel_by_bpp(row, x, pack_rgb(s, r, g, b), s->bpp);
+            }
+        }
+    }
+}
+
+// Row conversions for span shaders. Called with a constant `bpp` so that
+// the pixel access is resolved at compile time and the loops vectorize.
+static inline void load_span_bpp(
+    const struct shading* s, const uint8_t* row, size_t bpp,
+    bj_real* BJ_RESTRICT red, bj_real* BJ_RESTRICT green, bj_real* BJ_RESTRICT blue, size_t count
+) {
+    const bj_real inv255 = BJ_FI(255.0);
+    for (size_t x = 0; x < count; ++x) {
+        const uint32_t value = bj_get_pixel_by_bpp(row, x, bpp);
+        red[x]   = (bj_real)unpack_channel(value, &s->red) * inv255;
+        green[x] = (bj_real)unpack_channel(value, &s->green) * inv255;
+        blue[x]  = (bj_real)unpack_channel(value, &s->blue) * inv255;
+    }
+}
+
+static inline void store_span_bpp(
+    const struct shading* s, uint8_t* row, size_t bpp,
+    const bj_real* BJ_RESTRICT red, const bj_real* BJ_RESTRICT green, const bj_real* BJ_RESTRICT blue, size_t count
+) {
+    for (size_t x = 0; x < count; ++x) {
+        const uint32_t pixel = pack_rgb(s, to_u8(s, red[x]), to_u8(s, green[x]), to_u8(s, blue[x]));
+        bj_put_pixel_by_bpp(row, x, pixel, bpp);
+    }
+}
+
+static void load_span(const struct shading* s, size_t y, struct bj_shader_span* span) {
+    const uint8_t* row = bj_row_ptr(s->bitmap, y);
+    switch (s->bpp) {
+        case 32: load_span_bpp(s, row, 32, span->red, span->green, span->blue, span->count); break;
+        case 24: load_span_bpp(s, row, 24, span->red, span->green, span->blue, span->count); break;
+        case 16: load_span_bpp(s, row, 16, span->red, span->green, span->blue, span->count); break;
+        case 8:  load_span_bpp(s, row, 8,  span->red, span->green, span->blue, span->count); break;
+        default: {
+            // Indexed sub-byte formats go through the generic accessors
+            const bj_real inv255 = BJ_FI(255.0);
+            for (size_t x = 0; x < span->count; ++x) {
+                uint8_t r, g, b;
+                bj_make_bitmap_rgb(s->bitmap, x, y, &r, &g, &b);
+                span->red[x]   = (bj_real)r * inv255;
+                span->green[x] = (bj_real)g * inv255;
+                span->blue[x]  = (bj_real)b * inv255;
+            }
+        } break;
+    }
+}
+
+static void store_span(const struct shading* s, size_t y, const struct bj_shader_span* span) {
+    uint8_t* row = bj_row_ptr(s->bitmap, y);
+    switch (s->bpp) {
+        case 32: store_span_bpp(s, row, 32, span->red, span->green, span->blue, span->count); break;
+        case 24: store_span_bpp(s, row, 24, span->red, span->green, span->blue, span->count); break;
+        case 16: store_span_bpp(s, row, 16, span->red, span->green, span->blue, span->count); break;
+        case 8:  store_span_bpp(s, row, 8,  span->red, span->green, span->blue, span->count); break;
+        default:
+            for (size_t x = 0; x < span->count; ++x) {
+                const uint8_t r = to_u8(s, span->red[x]);
+                const uint8_t g = to_u8(s, span->green[x]);
+                const uint8_t b = to_u8(s, span->blue[x]);
+                bj_put_pixel(s->bitmap, x, y, bj_make_bitmap_pixel(s->bitmap, r, g, b));
+            }
+            break;
+    }
+}
+
+// Returns BJ_FALSE, leaving the rows untouched, when the channel arrays
+// cannot be allocated.
+static bj_bool shade_span_rows(const struct shading* s, size_t y_begin, size_t y_end) {
+    const size_t W = s->bitmap->width;
+
+    // One set of channel arrays per band, so that bands can run concurrently
+    bj_real* channels = bj_malloc(W * 3 * sizeof(bj_real));
+    if (channels == 0) {
+        return BJ_FALSE;
+    }
+
+    struct bj_shader_span span = {
+        .count = W,
+        .x     = s->x_coords,
+        .red   = channels,
+        .green = channels + W,
+        .blue  = channels + 2 * W,
+    };
+
+    for (size_t y = y_begin; y < y_end; ++y) {
+        load_span(s, y, &span);
+        span.y = s->ay * (bj_real)y + s->by;
+        if (s->span_shader(&span, s->data) > 0) {
+            store_span(s, y, &span);
+        }
+    }
+
+    bj_free(channels);
+    return BJ_TRUE;
+}
+
+static void shade_band(void* data, size_t band) {
+    struct shading* s = (struct shading*)data;
+    const size_t y_begin = band * s->band_rows;
+    const size_t y_end   = y_begin + s->band_rows < s->bitmap->height
+                         ? y_begin + s->band_rows : s->bitmap->height;
+    if (s->span_shader) {
+        if (!shade_span_rows(s, y_begin, y_end)) {
+            bj_atomic_store_u32(&s->failed, 1);
+        }
+    } else {
+        shade_rows(s, y_begin, y_end);
+    }
+}
 
+// Fills the coordinate transform and pixel layout shared by both shader kinds.
+static void setup_shading(struct shading* s, struct bj_bitmap* p_bitmap, uint8_t flags) {
     const int invert_x         = (flags & BJ_SHADER_INVERT_X) != 0;
     const int invert_y         = (flags & BJ_SHADER_INVERT_Y) != 0;
     const int normalize_coords = (flags & BJ_SHADER_NORMALIZE_COORDS) != 0;
@@ -45,29 +267,95 @@ void bj_shader_bitmap(
         by = (ky * by) - (ky * sy); ay *= ky;
     }
 
-    const bj_real inv255 = BJ_FI(255.0);
+    // Channel layout is taken from the pixel API itself, so the fast path
+    // reads and writes exactly what bj_make_bitmap_rgb/bj_put_pixel would.
+    const enum bj_pixel_mode mode = p_bitmap->mode;
+    const uint32_t opaque_black = bj_get_pixel_value(mode, 0, 0, 0);
 
-    for (size_t y = 0; y < H; ++y) {
-        for (size_t x = 0; x < W; ++x) {
-            uint8_t r, g, b;
-            bj_make_bitmap_rgb(p_bitmap, x, y, &r, &g, &b);
+    s->bitmap      = p_bitmap;
+    s->ax          = ax;
+    s->bx          = bx;
+    s->ay          = ay;
+    s->by          = by;
+    s->clamp_color = clamp_color;
+    s->bpp         = BJ_PIXEL_GET_BPP(mode);
+    s->red         = make_channel(bj_get_pixel_value(mode, 0xFF, 0, 0) & ~opaque_black);
+    s->green       = make_channel(bj_get_pixel_value(mode, 0, 0xFF, 0) & ~opaque_black);
+    s->blue        = make_channel(bj_get_pixel_value(mode, 0, 0, 0xFF) & ~opaque_black);
+    s->fixed_bits  = opaque_black;
+    s->band_rows   = H;
+}
 
-            struct bj_vec3 color = { (bj_real)r * inv255, (bj_real)g * inv255, (bj_real)b * inv255 };
-            struct bj_vec2 frag_coords = { ax * (bj_real)x + bx, ay * (bj_real)y + by };
+// Shades the whole bitmap, in bands when BJ_SHADER_PARALLEL is set.
+static void run_shading(struct shading* s, uint8_t flags) {
+    const size_t H = s->bitmap->height;
+    const size_t threads = (flags & BJ_SHADER_PARALLEL) ? bj_shader_thread_count() : 1;
+    if (threads <= 1 || H < 2) {
+        shade_band(s, 0);
+        return;
+    }
 
-            if (p_shader(&color, frag_coords, p_data) > 0) {
-                if (clamp_color) {
-                    color.x = bj_clamp(color.x, BJ_FZERO, BJ_F(1.0));
-                    color.y = bj_clamp(color.y, BJ_FZERO, BJ_F(1.0));
-                    color.z = bj_clamp(color.z, BJ_FZERO, BJ_F(1.0));
-                }
+    size_t bands = threads * BANDS_PER_THREAD;
+    if (bands > H) {
+        bands = H;
+    }
+    s->band_rows = (H + bands - 1) / bands;
+    bands = (H + s->band_rows - 1) / s->band_rows;
+    bj_run_parallel(threads, bands, shade_band, s);
+}
 
-                r = (uint8_t)(color.x * BJ_F(255.0) + BJ_F(0.5));
-                g = (uint8_t)(color.y * BJ_F(255.0) + BJ_F(0.5));
-                b = (uint8_t)(color.z * BJ_F(255.0) + BJ_F(0.5));
+void bj_set_shader_thread_count(
+    size_t count
+) {
+    s_thread_count = count;
+}
 
-                bj_put_pixel(p_bitmap, x, y, bj_make_bitmap_pixel(p_bitmap, r, g, b));
-            }
-        }
+size_t bj_shader_thread_count(void) {
+    return s_thread_count > 0 ? s_thread_count : bj_hardware_thread_count();
+}
+
+void bj_shader_bitmap(
+    struct bj_bitmap*               p_bitmap,
+    bj_bitmap_shading_fn   p_shader,
+    void*                    p_data,
+    uint8_t                  flags
+) {
+    bj_check(p_bitmap);
+    bj_check(p_shader);
+
+    struct shading shading = {.shader = p_shader, .data = p_data};
+    setup_shading(&shading, p_bitmap, flags);
+    run_shading(&shading, flags);
+}
+
+bj_bool bj_shader_bitmap_span(
+    struct bj_bitmap*         p_bitmap,
+    bj_bitmap_span_shading_fn p_shader,
+    void*                     p_data,
+    uint8_t                   flags
+) {
+    bj_check_or_0(p_bitmap);
+    bj_check_or_0(p_shader);
+
+    const size_t W = p_bitmap->width;
+    if (W == 0 || p_bitmap->height == 0) {
+        return BJ_TRUE;
+    }
+
+    struct shading shading = {.span_shader = p_shader, .data = p_data};
+    setup_shading(&shading, p_bitmap, flags);
+
+    // X coordinates are the same on every row: computed once, shared by bands
+    bj_real* x_coords = bj_malloc(W * sizeof(bj_real));
+    if (x_coords == 0) {
+        return BJ_FALSE;
+    }
+    for (size_t x = 0; x < W; ++x) {
+        x_coords[x] = shading.ax * (bj_real)x + shading.bx;
     }
+    shading.x_coords = x_coords;
+
+    run_shading(&shading, flags);
+    bj_free(x_coords);
+    return bj_atomic_load_u32(&shading.failed) == 0;
 }
@@ -3,23 +3,26 @@
 #include <stream.h>
 
 #include <check.h>
+#include <pool.h>
 #include <errno.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 struct bj_stream* bj_allocate_stream(
     void
 ) {
-    return bj_malloc(sizeof(struct bj_stream));
+    return bj_calloc(sizeof(struct bj_stream));
 }
 
 struct bj_stream* bj_open_stream_read(
     const void*  p_data,
     size_t        length
 ){
-    struct bj_stream* p_stream = bj_allocate_stream();
+    struct bj_stream* p_stream = bj_pool_allocate(sizeof(struct bj_stream));
     if(p_stream != 0) {
         bj_memset(p_stream, 0, sizeof(struct bj_stream));
+        p_stream->pooled = BJ_TRUE;
         p_stream->data.r = p_data;
         p_stream->weak   = BJ_TRUE;
         p_stream->len    = length;
@@ -34,6 +37,23 @@ struct bj_stream* bj_open_stream_file(
 ) {
     bj_check_or_0(p_path);
 
+    // Mapped files are decoded straight from the page cache
+    size_t      mapped_size = 0;
+    const void* mapped      = bj_map_file(p_path, &mapped_size);
+    if (mapped != 0) {
+        struct bj_stream* p_stream = bj_open_stream_read(mapped, mapped_size);
+        if (p_stream == 0) {
+            bj_unmap_file(mapped, mapped_size);
+            bj_set_error_fmt(p_error, BJ_ERROR_CANNOT_ALLOCATE,
+                "Cannot allocate stream for '%s'", p_path);
+            return 0;
+        }
+        p_stream->weak   = BJ_FALSE;
+        p_stream->mapped = BJ_TRUE;
+        return p_stream;
+    }
+
+    // Otherwise, the content is read to memory
     FILE* fstream  = fopen(p_path, "rb");
 
     if (!fstream ) {
@@ -80,16 +100,217 @@ struct bj_stream* bj_open_stream_file(
     return bj_open_stream_read(0, 0);
 }
 
+struct bj_stream* bj_open_stream_file_buffered(
+    const char*       p_path,
+    size_t            buffer_size,
+    struct bj_error** p_error
+) {
+    bj_check_or_0(p_path);
+
+    FILE* fstream = fopen(p_path, "rb");
+    if (!fstream) {
+        bj_set_error_fmt(p_error, BJ_ERROR_FILE_NOT_FOUND,
+            "Cannot open '%s': %s", p_path, strerror(errno));
+        return 0;
+    }
+
+    fseek(fstream, 0, SEEK_END);
+    const long file_size = ftell(fstream);
+    if(file_size == -1L) {
+        bj_set_error_fmt(p_error, BJ_ERROR_IO,
+            "Cannot get size of '%s': %s", p_path, strerror(errno));
+        fclose(fstream);
+        return 0;
+    }
+    fseek(fstream, 0, SEEK_SET);
+
+    // The stream buffer replaces the one of the C library
+    setvbuf(fstream, 0, _IONBF, 0);
+
+    const size_t capacity = buffer_size > 0 ? buffer_size : BJ_STREAM_BUFFER_SIZE;
+    struct bj_stream* p_stream = bj_open_stream_read(0, (size_t)file_size);
+    uint8_t*          buffer   = bj_malloc(capacity);
+    if (p_stream == 0 || buffer == 0) {
+        bj_set_error_fmt(p_error, BJ_ERROR_CANNOT_ALLOCATE,
+            "Cannot allocate %zu bytes buffer for '%s'", capacity, p_path);
+        bj_free(buffer);
+        if (p_stream != 0) {
+            bj_close_stream(p_stream);
+        }
+        fclose(fstream);
+        return 0;
+    }
+
+    p_stream->weak          = BJ_FALSE;
+    p_stream->file.handle   = fstream;
+    p_stream->file.buffer   = buffer;
+    p_stream->file.capacity = capacity;
+    return p_stream;
+}
+
+struct bj_stream* bj_open_stream_write(
+    void*  p_data,
+    size_t capacity
+) {
+    uint8_t* buffer = p_data;
+    if (buffer == 0 && capacity > 0) {
+        buffer = bj_malloc(capacity);
+        if (buffer == 0) {
+            return 0;
+        }
+    }
+
+    struct bj_stream* p_stream = bj_open_stream_read(buffer, 0);
+    if (p_stream == 0) {
+        if (p_data == 0) {
+            bj_free(buffer);
+        }
+        return 0;
+    }
+    p_stream->weak     = p_data != 0;
+    p_stream->writable = BJ_TRUE;
+    p_stream->capacity = capacity;
+    return p_stream;
+}
+
+struct bj_stream* bj_open_stream_file_write(
+    const char*       p_path,
+    struct bj_error** p_error
+) {
+    bj_check_or_0(p_path);
+
+    FILE* fstream = fopen(p_path, "wb");
+    if (!fstream) {
+        bj_set_error_fmt(p_error, BJ_ERROR_CANNOT_WRITE,
+            "Cannot create '%s': %s", p_path, strerror(errno));
+        return 0;
+    }
+    setvbuf(fstream, 0, _IOFBF, BJ_STREAM_BUFFER_SIZE);
+
+    struct bj_stream* p_stream = bj_open_stream_read(0, 0);
+    if (p_stream == 0) {
+        bj_set_error_fmt(p_error, BJ_ERROR_CANNOT_ALLOCATE,
+            "Cannot allocate stream for '%s'", p_path);
+        fclose(fstream);
+        return 0;
+    }
+    p_stream->weak        = BJ_FALSE;
+    p_stream->writable    = BJ_TRUE;
+    p_stream->file.handle = fstream;
+    return p_stream;
+}
+
+// Reads `count` bytes of the file at `position` to `p_dest`
+static size_t read_file_at(
+    struct bj_stream* p_stream,
+    size_t            position,
+    void*             p_dest,
+    size_t            count
+) {
+    if (p_stream->file.offset != position
+        && fseek(p_stream->file.handle, (long)position, SEEK_SET) != 0) {
+        p_stream->file.offset = SIZE_MAX; // Unknown, seek again next time
+        return 0;
+    }
+    const size_t read = fread(p_dest, 1, count, p_stream->file.handle);
+    p_stream->file.offset = position + read;
+    return read;
+}
+
+// Makes up to `count` bytes from the stream position resident in the
+// buffer, and returns how many are. Bytes already buffered are kept, moved
+// to the front of the buffer, and the rest is read after them.
+static size_t buffer_file(
+    struct bj_stream* p_stream,
+    size_t            count
+) {
+    const size_t position  = p_stream->position;
+    const size_t remaining = position < p_stream->len ? p_stream->len - position : 0;
+    if (count > remaining) {
+        count = remaining;
+    }
+
+    const size_t start = p_stream->file.start;
+    const size_t end   = start + p_stream->file.length;
+    if (position >= start && position + count <= end) {
+        return count;
+    }
+
+    if (count > p_stream->file.capacity) {
+        uint8_t* buffer = bj_realloc(p_stream->file.buffer, count);
+        if (buffer == 0) {
+            return 0;
+        }
+        p_stream->file.buffer   = buffer;
+        p_stream->file.capacity = count;
+    }
+
+    size_t kept = 0;
+    if (position >= start && position < end) {
+        kept = end - position;
+        bj_memmove(p_stream->file.buffer, p_stream->file.buffer + (position - start), kept);
+    }
+
+    const size_t wanted = remaining < p_stream->file.capacity ? remaining : p_stream->file.capacity;
+    const size_t read   = read_file_at(p_stream, position + kept, p_stream->file.buffer + kept, wanted - kept);
+    p_stream->file.start  = position;
+    p_stream->file.length = kept + read;
+    return p_stream->file.length < count ? p_stream->file.length : count;
+}
+
+static size_t read_buffered_file(
+    struct bj_stream* p_stream,
+    uint8_t*          p_buffer,
+    size_t            count
+) {
+    size_t done = 0;
+    while (done < count) {
+        const size_t left     = count - done;
+        const size_t position = p_stream->position;
+        const bj_bool buffered = position >= p_stream->file.start
+            && position < p_stream->file.start + p_stream->file.length;
+
+        size_t copied = 0;
+        if (!buffered && left >= p_stream->file.capacity) {
+            // Large reads skip the buffer
+            copied = read_file_at(p_stream, position, p_buffer + done, left);
+        } else {
+            const size_t chunk = left < p_stream->file.capacity ? left : p_stream->file.capacity;
+            copied = buffer_file(p_stream, chunk);
+            bj_memcpy(p_buffer + done, p_stream->file.buffer + (position - p_stream->file.start), copied);
+        }
+        if (copied == 0) {
+            break;
+        }
+        p_stream->position += copied;
+        done += copied;
+    }
+    return done;
+}
+
 void bj_close_stream(
     struct bj_stream* p_stream
 ) {
     bj_check(p_stream != 0);
 
+    if (p_stream->file.handle != 0) {
+        fclose(p_stream->file.handle);
+        bj_free(p_stream->file.buffer);
+    }
     if(!p_stream->weak && p_stream->data.r != 0) {
-        bj_free((void*)p_stream->data.r);
+        if (p_stream->mapped) {
+            bj_unmap_file(p_stream->data.r, p_stream->len);
+        } else {
+            bj_free((void*)p_stream->data.r);
+        }
     }
+    const bj_bool pooled = p_stream->pooled;
     bj_memset(p_stream, 0, sizeof(struct bj_stream));
-    bj_free(p_stream);
+    if (pooled) {
+        bj_pool_free(p_stream);
+    } else {
+        bj_free(p_stream);
+    }
 }
 
 size_t bj_read_stream(
@@ -102,6 +323,13 @@ size_t bj_read_stream(
    size_t remaining = (position < len) ? (len - position) : 0;
    size_t bytes_to_read = (remaining < count) ? remaining : count;
 
+   if(p_stream->file.handle != 0 && p_stream->writable) {
+       return 0;
+   }
+   if(p_stream->file.handle != 0 && p_buffer != 0) {
+       return read_buffered_file(p_stream, p_buffer, bytes_to_read);
+   }
+
    if(bytes_to_read > 0 && p_buffer != 0) {
        bj_memcpy(p_buffer, p_stream->data.r + p_stream->position, bytes_to_read);
    }
@@ -110,6 +338,101 @@ size_t bj_read_stream(
    return bytes_to_read;
 }
 
+// Grows the owned buffer of a memory stream to hold `size` bytes
+static bj_bool reserve_stream(
+    struct bj_stream* p_stream,
+    size_t            size
+) {
+    if (size <= p_stream->capacity) {
+        return BJ_TRUE;
+    }
+    if (p_stream->weak) {
+        return BJ_FALSE;
+    }
+    size_t capacity = p_stream->capacity > 0 ? p_stream->capacity : 256;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+    uint8_t* buffer = p_stream->data.w != 0 ? bj_realloc(p_stream->data.w, capacity) : bj_malloc(capacity);
+    if (buffer == 0) {
+        return BJ_FALSE;
+    }
+    p_stream->data.w   = buffer;
+    p_stream->capacity = capacity;
+    return BJ_TRUE;
+}
+
+size_t bj_write_stream(
+    struct bj_stream* p_stream,
+    const void*       p_src,
+    size_t            count
+) {
+    bj_check_or_0(p_stream);
+    bj_check_or_0(p_src);
+    if (!p_stream->writable || count == 0) {
+        return 0;
+    }
+
+    const size_t position = p_stream->position;
+    size_t written = 0;
+    if (p_stream->file.handle != 0) {
+        if (p_stream->file.offset == position
+            || fseek(p_stream->file.handle, (long)position, SEEK_SET) == 0) {
+            written = fwrite(p_src, 1, count, p_stream->file.handle);
+        }
+        p_stream->file.offset = position + written;
+    } else {
+        if (!reserve_stream(p_stream, position + count)) {
+            count = position < p_stream->capacity ? p_stream->capacity - position : 0;
+        }
+        if (count > 0) {
+            bj_memcpy(p_stream->data.w + position, p_src, count);
+        }
+        written = count;
+    }
+
+    p_stream->position += written;
+    if (p_stream->position > p_stream->len) {
+        p_stream->len = p_stream->position;
+    }
+    return written;
+}
+
+bj_bool bj_flush_stream(
+    struct bj_stream* p_stream
+) {
+    bj_check_or_0(p_stream);
+    if (!p_stream->writable || p_stream->file.handle == 0) {
+        return BJ_TRUE;
+    }
+    return fflush(p_stream->file.handle) == 0 && !ferror(p_stream->file.handle);
+}
+
+size_t bj_peek_stream(
+    struct bj_stream* p_stream,
+    size_t            count,
+    const void**      p_data
+) {
+    bj_check_or_0(p_stream);
+    bj_check_or_0(p_data);
+    if (p_stream->file.handle != 0) {
+        const size_t available = p_stream->writable ? 0 : buffer_file(p_stream, count);
+        *p_data = available > 0 ? p_stream->file.buffer + (p_stream->position - p_stream->file.start) : 0;
+        return available;
+    }
+    const size_t remaining = p_stream->position < p_stream->len ? p_stream->len - p_stream->position : 0;
+    *p_data = p_stream->data.r ? p_stream->data.r + p_stream->position : 0;
+    return remaining < count ? remaining : count;
+}
+
+size_t bj_consume_stream(
+    struct bj_stream* p_stream,
+    size_t            count
+) {
+    bj_check_or_0(p_stream);
+    return bj_read_stream(p_stream, 0, count);
+}
+
 BANJO_EXPORT size_t bj_get_stream_length(
     struct bj_stream* p_stream
 ) {
@@ -117,6 +440,13 @@ BANJO_EXPORT size_t bj_get_stream_length(
     return p_stream->len;
 }
 
+const void* bj_get_stream_data(
+    const struct bj_stream* p_stream
+) {
+    bj_check_or_0(p_stream);
+    return p_stream->data.r;
+}
+
 
 size_t bj_seek_stream(
     struct bj_stream*     p_stream,
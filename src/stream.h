@@ -2,13 +2,43 @@
 
 #include <banjo/stream.h>
 
+#include <stdio.h>
+
 struct bj_stream {
     size_t   len;        //!< Size of the stream (in bytes)
     size_t   position;   //!< Current position within the stream
     /// Array of stream data
     union {
         const uint8_t* r;    //!< Read-only access
+        uint8_t*       w;    //!< Write access, for writable streams
     } data;
+    size_t     capacity;   //!< Size of the buffer of writable memory streams
     bj_bool    weak;       //!< True if memory buffer is not managed by the object
+    bj_bool    pooled;     //!< True if the object comes from the pool
+    bj_bool    mapped;     //!< True if the owned buffer is a file mapping
+    bj_bool    writable;   //!< True if opened for writing
+    /// Read-ahead window of streams opened with bj_open_stream_file_buffered()
+    struct {
+        FILE*    handle;     //!< Open file, 0 for memory streams
+        uint8_t* buffer;     //!< Bytes of the file from `start`
+        size_t   capacity;   //!< Size of `buffer`
+        size_t   start;      //!< Stream position of the first buffered byte
+        size_t   length;     //!< Number of valid bytes in `buffer`
+        size_t   offset;     //!< Position of `handle` in the file
+    } file;
 };
 
+// Maps the whole file at `path` read-only and stores its size in `size`.
+// Returns 0 when the file cannot be mapped: missing, empty, not a regular
+// file, or no mapping support on the platform. Implemented per platform.
+const void* bj_map_file(
+    const char* path,
+    size_t*     size
+);
+
+// Releases a mapping returned by bj_map_file().
+void bj_unmap_file(
+    const void* data,
+    size_t      size
+);
+
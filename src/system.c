@@ -1,8 +1,11 @@
 #include <banjo/assert.h>
 #include <banjo/audio.h>
+#include <banjo/memory.h>
 #include <banjo/system.h>
 
 #include "audio_layer.h"
+#include "pool.h"
+#include "thread.h"
 #include "video_layer.h"
 
 struct bj_audio_layer s_audio = {0};
@@ -128,6 +131,10 @@ bj_bool bj_begin(
 }
 
 void bj_end(void) {
+    bj_end_worker_pool();
+    bj_release_frame_memory();
+    bj_flush_pool_cache();
+
     if(syscount.audio > 0) {
         bj_assert(s_audio.end);
         s_audio.end(0);
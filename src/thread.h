@@ -0,0 +1,68 @@
+#pragma once
+
+#include <banjo/api.h>
+
+// ============================================================================
+// THREADS - internal
+// ============================================================================
+// Thin wrappers over the platform threads (src/unix/thread_unix.c and
+// src/win32/thread_win32.c). Creation functions return 0 when the platform
+// cannot provide the object, and callers are expected to fall back to
+// running on the calling thread.
+// ============================================================================
+
+// Storage class of variables with one instance per thread.
+#if defined(_MSC_VER)
+#   define BJ_THREAD_LOCAL __declspec(thread)
+#else
+#   define BJ_THREAD_LOCAL __thread
+#endif
+
+struct bj_thread;
+struct bj_mutex;
+struct bj_condition;
+
+typedef void (*bj_thread_fn)(void* data);
+
+// Starts `fn(data)` on a new thread.
+struct bj_thread* bj_thread_create(bj_thread_fn fn, void* data);
+
+// Waits for the thread to return and releases it.
+void bj_thread_join(struct bj_thread* thread);
+
+struct bj_mutex* bj_mutex_create(void);
+void bj_mutex_destroy(struct bj_mutex* mutex);
+void bj_mutex_lock(struct bj_mutex* mutex);
+void bj_mutex_unlock(struct bj_mutex* mutex);
+
+struct bj_condition* bj_condition_create(void);
+void bj_condition_destroy(struct bj_condition* condition);
+
+// Atomically unlocks `mutex` and waits. The mutex is locked again on return.
+// Spurious wake-ups are possible: always wait in a loop.
+void bj_condition_wait(struct bj_condition* condition, struct bj_mutex* mutex);
+void bj_condition_signal(struct bj_condition* condition);
+void bj_condition_broadcast(struct bj_condition* condition);
+
+// Number of hardware threads available to the process, at least 1.
+size_t bj_hardware_thread_count(void);
+
+// ============================================================================
+// WORKER POOL - worker_pool.c
+// ============================================================================
+// A lazily started set of threads used to split data-parallel work (shader
+// bands, ...). The calling thread always takes part in the work.
+// ============================================================================
+
+typedef void (*bj_parallel_job_fn)(void* data, size_t index);
+
+// Calls `job(data, i)` for every i in [0, count), using up to `threads`
+// threads including the caller, and returns once all calls are done.
+//
+// The pool is (re)started whenever `threads` differs from its current size.
+// Calls made while another batch is running, for example from inside a job,
+// run serially on the calling thread.
+void bj_run_parallel(size_t threads, size_t count, bj_parallel_job_fn job, void* data);
+
+// Stops and joins all worker threads. Called by bj_end().
+void bj_end_worker_pool(void);
@@ -0,0 +1,66 @@
+#include "posix.h"
+
+#include <banjo/api.h>
+
+#include <stream.h>
+
+#if defined(BJ_OS_UNIX) && !defined(BJ_OS_EMSCRIPTEN)
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const void* bj_map_file(
+    const char* path,
+    size_t*     size
+) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    // Only regular files have a reliable size; pipes and devices are read
+    struct stat info;
+    void*       data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0
+        && (uint64_t)info.st_size <= SIZE_MAX) {
+        data = mmap(0, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return 0;
+    }
+    *size = (size_t)info.st_size;
+    return data;
+}
+
+void bj_unmap_file(
+    const void* data,
+    size_t      size
+) {
+    munmap((void*)data, size);
+}
+
+#else
+
+const void* bj_map_file(
+    const char* path,
+    size_t*     size
+) {
+    (void)path;
+    (void)size;
+    return 0;
+}
+
+void bj_unmap_file(
+    const void* data,
+    size_t      size
+) {
+    (void)data;
+    (void)size;
+}
+
+#endif
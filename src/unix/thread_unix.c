@@ -0,0 +1,106 @@
+#include "posix.h"
+
+#include <banjo/api.h>
+
+#ifdef BJ_OS_UNIX
+
+#include <banjo/memory.h>
+
+#include <thread.h>
+
+#include <pthread.h>
+#include <unistd.h>
+
+struct bj_thread {
+    pthread_t    handle;
+    bj_thread_fn fn;
+    void*        data;
+};
+
+struct bj_mutex {
+    pthread_mutex_t handle;
+};
+
+struct bj_condition {
+    pthread_cond_t handle;
+};
+
+static void* thread_main(void* arg) {
+    struct bj_thread* thread = (struct bj_thread*)arg;
+    thread->fn(thread->data);
+    return 0;
+}
+
+struct bj_thread* bj_thread_create(bj_thread_fn fn, void* data) {
+    struct bj_thread* thread = bj_malloc(sizeof(struct bj_thread));
+    if (thread == 0) {
+        return 0;
+    }
+    thread->fn   = fn;
+    thread->data = data;
+    if (pthread_create(&thread->handle, 0, thread_main, thread) != 0) {
+        bj_free(thread);
+        return 0;
+    }
+    return thread;
+}
+
+void bj_thread_join(struct bj_thread* thread) {
+    pthread_join(thread->handle, 0);
+    bj_free(thread);
+}
+
+struct bj_mutex* bj_mutex_create(void) {
+    struct bj_mutex* mutex = bj_malloc(sizeof(struct bj_mutex));
+    if (mutex != 0 && pthread_mutex_init(&mutex->handle, 0) != 0) {
+        bj_free(mutex);
+        return 0;
+    }
+    return mutex;
+}
+
+void bj_mutex_destroy(struct bj_mutex* mutex) {
+    pthread_mutex_destroy(&mutex->handle);
+    bj_free(mutex);
+}
+
+void bj_mutex_lock(struct bj_mutex* mutex) {
+    pthread_mutex_lock(&mutex->handle);
+}
+
+void bj_mutex_unlock(struct bj_mutex* mutex) {
+    pthread_mutex_unlock(&mutex->handle);
+}
+
+struct bj_condition* bj_condition_create(void) {
+    struct bj_condition* condition = bj_malloc(sizeof(struct bj_condition));
+    if (condition != 0 && pthread_cond_init(&condition->handle, 0) != 0) {
+        bj_free(condition);
+        return 0;
+    }
+    return condition;
+}
+
+void bj_condition_destroy(struct bj_condition* condition) {
+    pthread_cond_destroy(&condition->handle);
+    bj_free(condition);
+}
+
+void bj_condition_wait(struct bj_condition* condition, struct bj_mutex* mutex) {
+    pthread_cond_wait(&condition->handle, &mutex->handle);
+}
+
+void bj_condition_signal(struct bj_condition* condition) {
+    pthread_cond_signal(&condition->handle);
+}
+
+void bj_condition_broadcast(struct bj_condition* condition) {
+    pthread_cond_broadcast(&condition->handle);
+}
+
+size_t bj_hardware_thread_count(void) {
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+}
+
+#endif
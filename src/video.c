@@ -1,4 +1,6 @@
 #include <banjo/log.h>
+#include <banjo/string.h>
+#include <banjo/system.h>
 
 #include "video_layer.h"
 
@@ -6,6 +8,15 @@ extern struct bj_video_layer_create_info emscripten_video_layer_info;
 extern struct bj_video_layer_create_info win32_video_layer_info;
 extern struct bj_video_layer_create_info x11_video_layer_info;
 extern struct bj_video_layer_create_info cocoa_video_layer_info;
+extern struct bj_video_layer_create_info headless_video_layer_info;
+
+static const char* s_video_layer_name = 0;
+
+void bj_set_video_layer(
+    const char* name
+) {
+    s_video_layer_name = name;
+}
 
 bj_bool bj_begin_video(
     struct bj_video_layer* vt,
@@ -23,6 +34,9 @@ bj_bool bj_begin_video(
 #endif
 #ifdef BJ_CONFIG_X11_BACKEND
         &x11_video_layer_info,
+#endif
+#ifdef BJ_CONFIG_HEADLESS_BACKEND
+        &headless_video_layer_info,
 #endif
     };
 
@@ -33,6 +47,10 @@ bj_bool bj_begin_video(
         struct bj_error* sub_err = 0;
 
         const struct bj_video_layer_create_info* p_create_info = layer_infos[b];
+        if(s_video_layer_name != 0 && bj_strcmp(s_video_layer_name, p_create_info->name) != 0) {
+            continue;
+        }
+
         const bj_bool success = p_create_info->create(vt, &sub_err);
 
         if(sub_err) {
@@ -0,0 +1,451 @@
+// wav.c - Streaming WAVE decoder.
+//
+// Only the RIFF header is parsed up front. Audio data is then read from the
+// stream on demand: PCM and float frames go straight from the stream into
+// the caller buffer, IMA ADPCM is decoded one block at a time. Memory use is
+// fixed when the decoder opens and does not depend on the track length.
+
+#include <banjo/memory.h>
+#include <banjo/wav.h>
+
+#include <check.h>
+
+#define ERR_MSG_EOS               "unexpected end of stream"
+#define ERR_MSG_BAD_SIGNATURE     "incorrect signature"
+#define ERR_MSG_BAD_FMT           "incorrect format chunk"
+#define ERR_MSG_BAD_ENCODING      "unsupported encoding"
+#define ERR_MSG_BAD_CHANNELS      "unsupported channel count"
+#define ERR_MSG_BAD_BLOCK_ALIGN   "incorrect block alignment"
+#define ERR_MSG_NO_DATA           "missing data chunk"
+
+#define WAV_TAG_PCM        0x0001
+#define WAV_TAG_FLOAT      0x0003
+#define WAV_TAG_IMA_ADPCM  0x0011
+#define WAV_TAG_EXTENSIBLE 0xFFFE
+
+#define WAV_MAX_CHANNELS   8
+#define WAV_FMT_MAX        40  // WAVEFORMATEXTENSIBLE
+#define WAV_CHUNK_FRAMES   256 // Frames per ring write
+
+enum wav_encoding {
+    WAV_PCM16,
+    WAV_F32,
+    WAV_IMA_ADPCM,
+};
+
+struct bj_wav {
+    struct bj_stream*          stream;
+    struct bj_audio_properties properties;
+    enum wav_encoding          encoding;
+    size_t                     frame_size;   // Decoded bytes per frame
+    size_t                     data_offset;  // Stream position of the first frame
+    size_t                     data_size;    // Bytes of audio data
+    size_t                     frames;
+    size_t                     position;     // Next frame returned
+
+    // IMA ADPCM only
+    size_t                     block_align;  // Bytes per block
+    size_t                     block_frames; // Frames in a full block
+    uint8_t*                   block;        // Encoded block
+    int16_t*                   decoded;      // Decoded block, interleaved
+    size_t                     decoded_frames;
+    size_t                     decoded_cursor;
+
+    uint8_t*                   scratch;      // WAV_CHUNK_FRAMES frames
+};
+
+static uint16_t read_le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bj_bool read_exact(struct bj_stream* stream, void* buffer, size_t count) {
+    return bj_read_stream(stream, buffer, count) == count;
+}
+
+static bj_bool chunk_is(const uint8_t* id, const char* name) {
+    return id[0] == (uint8_t)name[0] && id[1] == (uint8_t)name[1]
+        && id[2] == (uint8_t)name[2] && id[3] == (uint8_t)name[3];
+}
+
+// Skips a chunk body and its padding byte
+static void skip_chunk(struct bj_stream* stream, uint32_t size) {
+    const size_t padded = (size_t)size + (size & 1u);
+    bj_seek_stream(stream, (ptrdiff_t)padded, BJ_SEEK_CURRENT);
+}
+
+// Reads the "fmt " chunk into `wav`. Returns BJ_FALSE and sets `error`
+// when the format is invalid or unsupported.
+static bj_bool parse_fmt(
+    struct bj_wav*    wav,
+    const uint8_t*    fmt,
+    size_t            size,
+    struct bj_error** error
+) {
+    if (size < 16) {
+        bj_set_error(error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_BAD_FMT);
+        return BJ_FALSE;
+    }
+
+    uint16_t     tag         = read_le16(fmt);
+    const size_t channels    = read_le16(fmt + 2);
+    const size_t block_align = read_le16(fmt + 12);
+    const size_t bits        = read_le16(fmt + 14);
+    if (tag == WAV_TAG_EXTENSIBLE && size >= 26) {
+        tag = read_le16(fmt + 24); // First bytes of the sub-format GUID
+    }
+
+    if (channels == 0 || channels > WAV_MAX_CHANNELS) {
+        bj_set_error(error, BJ_ERROR_UNSUPPORTED, ERR_MSG_BAD_CHANNELS);
+        return BJ_FALSE;
+    }
+
+    wav->properties.channels    = (unsigned int)channels;
+    wav->properties.sample_rate = read_le32(fmt + 4);
+
+    if (tag == WAV_TAG_PCM && bits == 16) {
+        wav->encoding          = WAV_PCM16;
+        wav->properties.format = BJ_AUDIO_FORMAT_INT16;
+    } else if (tag == WAV_TAG_FLOAT && bits == 32) {
+        wav->encoding          = WAV_F32;
+        wav->properties.format = BJ_AUDIO_FORMAT_F32;
+    } else if (tag == WAV_TAG_IMA_ADPCM && bits == 4) {
+        wav->encoding          = WAV_IMA_ADPCM;
+        wav->properties.format = BJ_AUDIO_FORMAT_INT16;
+    } else {
+        bj_set_error(error, BJ_ERROR_UNSUPPORTED, ERR_MSG_BAD_ENCODING);
+        return BJ_FALSE;
+    }
+    wav->properties.amplitude = INT16_MAX;
+    wav->frame_size = channels * (BJ_AUDIO_FORMAT_WIDTH(wav->properties.format) / 8);
+
+    if (wav->encoding == WAV_IMA_ADPCM) {
+        // Each block starts with a 4-byte header per channel, followed by
+        // groups of 4 bytes (8 samples) per channel.
+        const size_t header = 4 * channels;
+        if (block_align <= header || (block_align - header) % header != 0) {
+            bj_set_error(error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_BAD_BLOCK_ALIGN);
+            return BJ_FALSE;
+        }
+        wav->block_align  = block_align;
+        wav->block_frames = (block_align - header) / header * 8 + 1;
+    } else if (block_align != wav->frame_size) {
+        bj_set_error(error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_BAD_BLOCK_ALIGN);
+        return BJ_FALSE;
+    }
+    return BJ_TRUE;
+}
+
+// Frames held in an ADPCM block of `bytes` bytes, the last one being shorter
+static size_t adpcm_block_frames(const struct bj_wav* wav, size_t bytes) {
+    const size_t header = 4 * (size_t)wav->properties.channels;
+    if (bytes < header) {
+        return 0;
+    }
+    return (bytes - header) / header * 8 + 1;
+}
+
+static size_t adpcm_total_frames(const struct bj_wav* wav) {
+    const size_t full = wav->data_size / wav->block_align;
+    return full * wav->block_frames + adpcm_block_frames(wav, wav->data_size % wav->block_align);
+}
+
+struct bj_wav* bj_open_wav(
+    struct bj_stream* stream,
+    struct bj_error** error
+) {
+    bj_check_or_0(stream);
+
+    uint8_t header[12];
+    if (!read_exact(stream, header, sizeof(header))) {
+        bj_set_error(error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_EOS);
+        return 0;
+    }
+    if (!chunk_is(header, "RIFF") || !chunk_is(header + 8, "WAVE")) {
+        bj_set_error(error, BJ_ERROR_INCORRECT_VALUE, ERR_MSG_BAD_SIGNATURE);
+        return 0;
+    }
+
+    struct bj_wav wav = {.stream = stream};
+    bj_bool has_fmt    = BJ_FALSE;
+    size_t  fact_frames = 0;
+
+    for (;;) {
+        uint8_t chunk[8];
+        if (!read_exact(stream, chunk, sizeof(chunk))) {
+            bj_set_error(error, BJ_ERROR_INVALID_FORMAT, has_fmt ? ERR_MSG_NO_DATA : ERR_MSG_BAD_FMT);
+            return 0;
+        }
+        const uint32_t size = read_le32(chunk + 4);
+
+        if (chunk_is(chunk, "fmt ")) {
+            uint8_t fmt[WAV_FMT_MAX] = {0};
+            const size_t fmt_size = size < WAV_FMT_MAX ? size : WAV_FMT_MAX;
+            if (!read_exact(stream, fmt, fmt_size)) {
+                bj_set_error(error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_EOS);
+                return 0;
+            }
+            if (!parse_fmt(&wav, fmt, fmt_size, error)) {
+                return 0;
+            }
+            skip_chunk(stream, size - (uint32_t)fmt_size);
+            has_fmt = BJ_TRUE;
+        } else if (chunk_is(chunk, "fact") && size >= 4) {
+            uint8_t fact[4];
+            if (!read_exact(stream, fact, sizeof(fact))) {
+                bj_set_error(error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_EOS);
+                return 0;
+            }
+            fact_frames = read_le32(fact);
+            skip_chunk(stream, size - 4);
+        } else if (chunk_is(chunk, "data")) {
+            if (!has_fmt) {
+                bj_set_error(error, BJ_ERROR_INVALID_FORMAT, ERR_MSG_BAD_FMT);
+                return 0;
+            }
+            wav.data_offset = bj_tell_stream(stream);
+            const size_t available = bj_get_stream_length(stream) - wav.data_offset;
+            wav.data_size = size < available ? size : available;
+            break;
+        } else {
+            skip_chunk(stream, size);
+        }
+    }
+
+    if (wav.encoding == WAV_IMA_ADPCM) {
+        wav.frames = adpcm_total_frames(&wav);
+        if (fact_frames > 0 && fact_frames < wav.frames) {
+            wav.frames = fact_frames; // Excludes the padding of the last block
+        }
+    } else {
+        wav.frames = wav.data_size / wav.frame_size;
+    }
+
+    struct bj_wav* result = bj_calloc(sizeof(struct bj_wav));
+    if (result == 0) {
+        bj_set_error(error, BJ_ERROR_CANNOT_ALLOCATE, "cannot allocate decoder");
+        return 0;
+    }
+    *result = wav;
+    result->scratch = bj_malloc(WAV_CHUNK_FRAMES * wav.frame_size);
+    if (wav.encoding == WAV_IMA_ADPCM) {
+        result->block   = bj_malloc(wav.block_align);
+        result->decoded = bj_malloc(wav.block_frames * wav.frame_size);
+    }
+    if (result->scratch == 0 || (wav.encoding == WAV_IMA_ADPCM && (result->block == 0 || result->decoded == 0))) {
+        bj_set_error(error, BJ_ERROR_CANNOT_ALLOCATE, "cannot allocate decoder");
+        bj_close_wav(result);
+        return 0;
+    }
+    return result;
+}
+
+void bj_close_wav(
+    struct bj_wav* wav
+) {
+    if (wav == 0) {
+        return;
+    }
+    bj_free(wav->scratch);
+    bj_free(wav->block);
+    bj_free(wav->decoded);
+    bj_free(wav);
+}
+
+const struct bj_audio_properties* bj_wav_properties(
+    const struct bj_wav* wav
+) {
+    bj_check_or_0(wav);
+    return &wav->properties;
+}
+
+size_t bj_wav_frames(
+    const struct bj_wav* wav
+) {
+    bj_check_or_0(wav);
+    return wav->frames;
+}
+
+size_t bj_tell_wav(
+    const struct bj_wav* wav
+) {
+    bj_check_or_0(wav);
+    return wav->position;
+}
+
+// ----------------------------------------------------------------------------
+// IMA ADPCM
+// ----------------------------------------------------------------------------
+
+static const int16_t ima_steps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+};
+
+static const int8_t ima_index_deltas[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+static int16_t ima_decode_nibble(unsigned nibble, int* predictor, int* index) {
+    const int step = ima_steps[*index];
+    int diff = step >> 3;
+    if (nibble & 1) diff += step >> 2;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 4) diff += step;
+    if (nibble & 8) diff = -diff;
+
+    int value = *predictor + diff;
+    value = value < -32768 ? -32768 : (value > 32767 ? 32767 : value);
+    *predictor = value;
+
+    int next = *index + ima_index_deltas[nibble];
+    *index = next < 0 ? 0 : (next > 88 ? 88 : next);
+    return (int16_t)value;
+}
+
+// Decodes the `bytes` bytes of `wav->block` into `wav->decoded`
+static size_t ima_decode_block(struct bj_wav* wav, size_t bytes) {
+    const size_t   channels = wav->properties.channels;
+    const size_t   frames   = adpcm_block_frames(wav, bytes);
+    const uint8_t* in       = wav->block;
+    int16_t*       out      = wav->decoded;
+    int predictor[WAV_MAX_CHANNELS];
+    int index[WAV_MAX_CHANNELS];
+
+    for (size_t c = 0; c < channels; ++c) {
+        predictor[c] = (int16_t)read_le16(in);
+        index[c]     = in[2] > 88 ? 88 : in[2];
+        out[c]       = (int16_t)predictor[c];
+        in += 4;
+    }
+
+    // Groups of 8 frames: 4 bytes for each channel in turn
+    for (size_t frame = 1; frame < frames; frame += 8) {
+        for (size_t c = 0; c < channels; ++c) {
+            for (size_t i = 0; i < 4; ++i) {
+                const uint8_t byte = *in++;
+                int16_t* dst = out + (frame + 2 * i) * channels + c;
+                dst[0]        = ima_decode_nibble(byte & 0x0Fu, &predictor[c], &index[c]);
+                dst[channels] = ima_decode_nibble(byte >> 4, &predictor[c], &index[c]);
+            }
+        }
+    }
+    return frames;
+}
+
+// Reads and decodes the next block, returns BJ_FALSE at the end of the data
+static bj_bool ima_next_block(struct bj_wav* wav) {
+    const size_t offset    = bj_tell_stream(wav->stream) - wav->data_offset;
+    const size_t remaining = offset < wav->data_size ? wav->data_size - offset : 0;
+    const size_t bytes     = remaining < wav->block_align ? remaining : wav->block_align;
+
+    const size_t read = bj_read_stream(wav->stream, wav->block, bytes);
+    wav->decoded_frames = adpcm_block_frames(wav, read) > 0 ? ima_decode_block(wav, read) : 0;
+    wav->decoded_cursor = 0;
+    return wav->decoded_frames > 0;
+}
+
+static size_t ima_read(struct bj_wav* wav, int16_t* out, size_t frames) {
+    const size_t channels = wav->properties.channels;
+    size_t done = 0;
+    while (done < frames) {
+        if (wav->decoded_cursor == wav->decoded_frames && !ima_next_block(wav)) {
+            break;
+        }
+        size_t count = wav->decoded_frames - wav->decoded_cursor;
+        if (count > frames - done) {
+            count = frames - done;
+        }
+        bj_memcpy(out + done * channels, wav->decoded + wav->decoded_cursor * channels, count * wav->frame_size);
+        wav->decoded_cursor += count;
+        done += count;
+    }
+    return done;
+}
+
+// ----------------------------------------------------------------------------
+// Reading
+// ----------------------------------------------------------------------------
+
+size_t bj_read_wav(
+    struct bj_wav* wav,
+    void*          buffer,
+    size_t         frames
+) {
+    bj_check_or_0(wav);
+    bj_check_or_0(buffer || frames == 0);
+
+    const size_t remaining = wav->frames - wav->position;
+    if (frames > remaining) {
+        frames = remaining;
+    }
+
+    size_t done;
+    if (wav->encoding == WAV_IMA_ADPCM) {
+        done = ima_read(wav, buffer, frames);
+    } else {
+        done = bj_read_stream(wav->stream, buffer, frames * wav->frame_size) / wav->frame_size;
+    }
+    wav->position += done;
+    return done;
+}
+
+size_t bj_seek_wav(
+    struct bj_wav* wav,
+    size_t         frame
+) {
+    bj_check_or_0(wav);
+    if (frame > wav->frames) {
+        frame = wav->frames;
+    }
+
+    if (wav->encoding == WAV_IMA_ADPCM) {
+        const size_t block = frame / wav->block_frames;
+        bj_seek_stream(wav->stream, (ptrdiff_t)(wav->data_offset + block * wav->block_align), BJ_SEEK_BEGIN);
+        wav->decoded_frames = 0;
+        wav->decoded_cursor = 0;
+        if (frame % wav->block_frames != 0 && ima_next_block(wav)) {
+            wav->decoded_cursor = frame % wav->block_frames;
+        }
+    } else {
+        bj_seek_stream(wav->stream, (ptrdiff_t)(wav->data_offset + frame * wav->frame_size), BJ_SEEK_BEGIN);
+    }
+    wav->position = frame;
+    return frame;
+}
+
+size_t bj_read_wav_to_ring(
+    struct bj_wav*        wav,
+    struct bj_audio_ring* ring,
+    bj_bool               loop
+) {
+    bj_check_or_0(wav);
+    bj_check_or_0(ring);
+
+    size_t written = 0;
+    size_t space   = bj_audio_ring_writable(ring);
+    while (space > 0) {
+        const size_t count = space < WAV_CHUNK_FRAMES ? space : WAV_CHUNK_FRAMES;
+        const size_t read  = bj_read_wav(wav, wav->scratch, count);
+        if (read == 0) {
+            if (!loop || wav->frames == 0 || wav->position == 0) {
+                break;
+            }
+            bj_seek_wav(wav, 0);
+            continue;
+        }
+        // This thread is the only writer, so the space cannot shrink
+        bj_audio_ring_write(ring, wav->scratch, read);
+        written += read;
+        space   -= read;
+    }
+    return written;
+}
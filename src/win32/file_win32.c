@@ -0,0 +1,51 @@
+#include <banjo/api.h>
+
+#include <stream.h>
+
+#ifdef BJ_OS_WINDOWS
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+
+#include <stdint.h>
+
+const void* bj_map_file(
+    const char* path,
+    size_t*     size
+) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+
+    LARGE_INTEGER file_size;
+    const void*   data = 0;
+    if (GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &file_size)
+        && file_size.QuadPart > 0 && (uint64_t)file_size.QuadPart <= SIZE_MAX) {
+        // The view keeps the mapping alive once both handles are closed
+        HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+        if (mapping != 0) {
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+
+    if (data != 0) {
+        *size = (size_t)file_size.QuadPart;
+    }
+    return data;
+}
+
+void bj_unmap_file(
+    const void* data,
+    size_t      size
+) {
+    (void)size;
+    UnmapViewOfFile(data);
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include <banjo/api.h>
+
+#ifdef BJ_OS_WINDOWS
+
+#include <banjo/memory.h>
+
+#include <thread.h>
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+
+struct bj_thread {
+    HANDLE       handle;
+    bj_thread_fn fn;
+    void*        data;
+};
+
+struct bj_mutex {
+    SRWLOCK lock;
+};
+
+struct bj_condition {
+    CONDITION_VARIABLE variable;
+};
+
+static DWORD WINAPI thread_main(LPVOID arg) {
+    struct bj_thread* thread = (struct bj_thread*)arg;
+    thread->fn(thread->data);
+    return 0;
+}
+
+struct bj_thread* bj_thread_create(bj_thread_fn fn, void* data) {
+    struct bj_thread* thread = bj_malloc(sizeof(struct bj_thread));
+    if (thread == 0) {
+        return 0;
+    }
+    thread->fn     = fn;
+    thread->data   = data;
+    thread->handle = CreateThread(NULL, 0, thread_main, thread, 0, NULL);
+    if (thread->handle == NULL) {
+        bj_free(thread);
+        return 0;
+    }
+    return thread;
+}
+
+void bj_thread_join(struct bj_thread* thread) {
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    bj_free(thread);
+}
+
+struct bj_mutex* bj_mutex_create(void) {
+    struct bj_mutex* mutex = bj_malloc(sizeof(struct bj_mutex));
+    if (mutex != 0) {
+        InitializeSRWLock(&mutex->lock);
+    }
+    return mutex;
+}
+
+void bj_mutex_destroy(struct bj_mutex* mutex) {
+    bj_free(mutex);
+}
+
+void bj_mutex_lock(struct bj_mutex* mutex) {
+    AcquireSRWLockExclusive(&mutex->lock);
+}
+
+void bj_mutex_unlock(struct bj_mutex* mutex) {
+    ReleaseSRWLockExclusive(&mutex->lock);
+}
+
+struct bj_condition* bj_condition_create(void) {
+    struct bj_condition* condition = bj_malloc(sizeof(struct bj_condition));
+    if (condition != 0) {
+        InitializeConditionVariable(&condition->variable);
+    }
+    return condition;
+}
+
+void bj_condition_destroy(struct bj_condition* condition) {
+    bj_free(condition);
+}
+
+void bj_condition_wait(struct bj_condition* condition, struct bj_mutex* mutex) {
+    SleepConditionVariableSRW(&condition->variable, &mutex->lock, INFINITE, 0);
+}
+
+void bj_condition_signal(struct bj_condition* condition) {
+    WakeConditionVariable(&condition->variable);
+}
+
+void bj_condition_broadcast(struct bj_condition* condition) {
+    WakeAllConditionVariable(&condition->variable);
+}
+
+size_t bj_hardware_thread_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+}
+
+#endif
@@ -0,0 +1,180 @@
+#include <banjo/api.h>
+
+#include <atomic.h>
+#include <thread.h>
+
+// Workers beyond this are never started, the caller still takes part
+#define MAX_WORKERS 63
+
+static struct {
+    struct bj_mutex*     lock;
+    struct bj_condition* wake;    // Workers wait here for jobs or for quit
+    struct bj_condition* done;    // The caller waits here for the last job
+    struct bj_thread*    workers[MAX_WORKERS];
+    size_t               worker_count;
+    size_t               requested; // Worker count asked for, may exceed worker_count
+    bj_bool              running; // A batch (or a resize) is in progress
+    bj_bool              quit;
+    bj_parallel_job_fn   job;
+    void*                data;
+    size_t               next;
+    size_t               count;
+    size_t               pending;
+} s_pool = {0};
+
+// The sync objects are created by the first parallel call. Two threads can
+// make that call at once: creation is serialized by `s_sync_guard` and
+// published through `s_sync_ready`.
+static volatile uint32_t s_sync_guard = 0;
+static volatile uint32_t s_sync_ready = 0;
+
+static void run_serially(size_t count, bj_parallel_job_fn job, void* data) {
+    for (size_t i = 0; i < count; ++i) {
+        job(data, i);
+    }
+}
+
+// Takes and runs the next job. The lock is held on entry and on return.
+static void run_next_job(void) {
+    const bj_parallel_job_fn job  = s_pool.job;
+    void* const              data = s_pool.data;
+    const size_t             index = s_pool.next++;
+
+    bj_mutex_unlock(s_pool.lock);
+    job(data, index);
+    bj_mutex_lock(s_pool.lock);
+
+    if (--s_pool.pending == 0) {
+        bj_condition_broadcast(s_pool.done);
+    }
+}
+
+static void worker_main(void* data) {
+    (void)data;
+    bj_mutex_lock(s_pool.lock);
+    for (;;) {
+        while (!s_pool.quit && s_pool.next >= s_pool.count) {
+            bj_condition_wait(s_pool.wake, s_pool.lock);
+        }
+        if (s_pool.quit) {
+            break;
+        }
+        run_next_job();
+    }
+    bj_mutex_unlock(s_pool.lock);
+}
+
+static void destroy_sync(void) {
+    bj_atomic_store_u32(&s_sync_ready, 0);
+    if (s_pool.lock) bj_mutex_destroy(s_pool.lock);
+    if (s_pool.wake) bj_condition_destroy(s_pool.wake);
+    if (s_pool.done) bj_condition_destroy(s_pool.done);
+    s_pool.lock = 0;
+    s_pool.wake = 0;
+    s_pool.done = 0;
+}
+
+static bj_bool ensure_sync(void) {
+    if (bj_atomic_load_u32(&s_sync_ready)) {
+        return BJ_TRUE;
+    }
+    while (bj_atomic_exchange_u32(&s_sync_guard, 1) != 0) {
+        // Spin, another thread is creating them
+    }
+    if (!s_pool.lock) {
+        s_pool.lock = bj_mutex_create();
+        s_pool.wake = bj_condition_create();
+        s_pool.done = bj_condition_create();
+        if (!s_pool.lock || !s_pool.wake || !s_pool.done) {
+            destroy_sync();
+        } else {
+            bj_atomic_store_u32(&s_sync_ready, 1);
+        }
+    }
+    const bj_bool ready = s_pool.lock != 0;
+    bj_atomic_store_u32(&s_sync_guard, 0);
+    return ready;
+}
+
+// Joins all workers. No batch may be running.
+static void stop_workers(void) {
+    bj_mutex_lock(s_pool.lock);
+    s_pool.quit = BJ_TRUE;
+    bj_condition_broadcast(s_pool.wake);
+    bj_mutex_unlock(s_pool.lock);
+
+    for (size_t i = 0; i < s_pool.worker_count; ++i) {
+        bj_thread_join(s_pool.workers[i]);
+        s_pool.workers[i] = 0;
+    }
+    s_pool.worker_count = 0;
+    s_pool.requested    = 0;
+    s_pool.quit         = BJ_FALSE;
+}
+
+static void start_workers(size_t count) {
+    while (s_pool.worker_count < count) {
+        struct bj_thread* thread = bj_thread_create(worker_main, 0);
+        if (thread == 0) {
+            break; // Fewer workers: the caller picks up the remaining jobs
+        }
+        s_pool.workers[s_pool.worker_count++] = thread;
+    }
+}
+
+void bj_run_parallel(size_t threads, size_t count, bj_parallel_job_fn job, void* data) {
+    if (count == 0) {
+        return;
+    }
+    if (threads <= 1 || count == 1 || !ensure_sync()) {
+        run_serially(count, job, data);
+        return;
+    }
+
+    const size_t workers = threads - 1 < MAX_WORKERS ? threads - 1 : MAX_WORKERS;
+
+    bj_mutex_lock(s_pool.lock);
+    if (s_pool.running) {
+        bj_mutex_unlock(s_pool.lock);
+        run_serially(count, job, data);
+        return;
+    }
+    s_pool.running = BJ_TRUE;
+
+    if (s_pool.requested != workers) {
+        bj_mutex_unlock(s_pool.lock);
+        stop_workers();
+        start_workers(workers);
+        s_pool.requested = workers;
+        bj_mutex_lock(s_pool.lock);
+    }
+
+    s_pool.job     = job;
+    s_pool.data    = data;
+    s_pool.next    = 0;
+    s_pool.count   = count;
+    s_pool.pending = count;
+    bj_condition_broadcast(s_pool.wake);
+
+    while (s_pool.next < s_pool.count) {
+        run_next_job();
+    }
+    while (s_pool.pending > 0) {
+        bj_condition_wait(s_pool.done, s_pool.lock);
+    }
+
+    s_pool.job     = 0;
+    s_pool.data    = 0;
+    s_pool.next    = 0;
+    s_pool.count   = 0;
+    s_pool.running = BJ_FALSE;
+    bj_mutex_unlock(s_pool.lock);
+}
+
+void bj_end_worker_pool(void) {
+    if (s_pool.lock == 0) {
+        return;
+    }
+    stop_workers();
+    destroy_sync();
+}
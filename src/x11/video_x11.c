@@ -1,3 +1,5 @@
+#include "posix.h"
+
 #ifdef BJ_CONFIG_X11_BACKEND
 
 #include <banjo/assert.h>
@@ -19,6 +21,13 @@
 #include <X11/Xresource.h>
 #include <X11/Xutil.h>
 
+#ifdef BJ_CONFIG_X11_XSHM
+#include <X11/extensions/XShm.h>
+#include <poll.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
 #include <string.h> /* memcpy for C99-safe void*-to-function-pointer loading */
 
 /* C99-safe dlsym wrapper: avoids void*-to-function-pointer cast (ISO C forbids it). */
@@ -56,6 +65,7 @@ typedef int                 (* pfn_XPending)(Display*);
 typedef int                 (* pfn_XPutImage)(Display*,Drawable,GC,XImage*,int,int,int,int,unsigned int,unsigned int);
 typedef int                 (* pfn_XQLength)(Display*);
 typedef int                 (* pfn_XSaveContext)(Display*,XID,XContext,const char*);
+typedef XErrorHandler       (* pfn_XSetErrorHandler)(XErrorHandler);
 typedef void                (* pfn_XSetWMNormalHints)(Display*,Window,XSizeHints*);
 typedef Status              (* pfn_XSetWMProtocols)(Display*,Window,Atom*,int);
 typedef void                (* pfn_XStoreName)(Display*, Window, char*);
@@ -63,8 +73,21 @@ typedef int                 (* pfn_XSync)(Display*,Bool);
 typedef int                 (* pfn_XUnmapWindow)(Display*,Window);
 typedef XrmQuark            (* pfn_XrmUniqueQuark)(void);
 
+#ifdef BJ_CONFIG_X11_XSHM
+typedef Bool                (* pfn_XShmAttach)(Display*,XShmSegmentInfo*);
+typedef XImage*             (* pfn_XShmCreateImage)(Display*,Visual*,unsigned int,int,char*,XShmSegmentInfo*,unsigned int,unsigned int);
+typedef Bool                (* pfn_XShmDetach)(Display*,XShmSegmentInfo*);
+typedef int                 (* pfn_XShmGetEventBase)(Display*);
+typedef Bool                (* pfn_XShmPutImage)(Display*,Drawable,GC,XImage*,int,int,int,int,unsigned int,unsigned int,Bool);
+typedef Bool                (* pfn_XShmQueryExtension)(Display*);
+#endif
+
 #define N_KEYCODES 256
 
+// Longest wait for a ShmCompletion event. It can be lost when the target
+// window is destroyed while the image is being copied.
+#define SHM_WAIT_TIMEOUT_MS 100
+
 
 struct {
     void*             handle;
@@ -79,6 +102,12 @@ struct {
 
     enum bj_key*           keymap;
 
+    // MIT-SHM, from libXext. xext_handle is 0 when the extension is unusable.
+    void*             xext_handle;
+    int               shm_completion_type;
+    int               shm_in_flight;  // XShmPutImage without ShmCompletion yet
+    bj_bool           shm_error;      // Set by the error trap while attaching
+
     pfn_XAllocSizeHints      XAllocSizeHints;
     pfn_XCreateGC            XCreateGC;
     pfn_XCreateImage         XCreateImage;
@@ -98,17 +127,30 @@ struct {
     pfn_XPutImage            XPutImage;
     pfn_XQLength             XQLength;
     pfn_XSaveContext         XSaveContext;
+    pfn_XSetErrorHandler     XSetErrorHandler;
     pfn_XSetWMNormalHints    XSetWMNormalHints;
     pfn_XSetWMProtocols      XSetWMProtocols;
     pfn_XStoreName           XStoreName;
     pfn_XSync                XSync;
     pfn_XUnmapWindow         XUnmapWindow;
+
+#ifdef BJ_CONFIG_X11_XSHM
+    pfn_XShmAttach           XShmAttach;
+    pfn_XShmCreateImage      XShmCreateImage;
+    pfn_XShmDetach           XShmDetach;
+    pfn_XShmPutImage         XShmPutImage;
+#endif
 } x11;
 
 struct bj_renderer_data {
     XImage*                     framebuffer_image;
     void*                       framebuffer_pixels;
     struct bj_bitmap            framebuffer;
+    GC                          gc;       // Created on first present
+    bj_bool                     shm;      // Pixels live in shm_info
+#ifdef BJ_CONFIG_X11_XSHM
+    XShmSegmentInfo             shm_info;
+#endif
 };
 
 typedef struct {
@@ -245,6 +287,13 @@ static void x11_dispatch_callback(
     (void)ignore;
     // Here switch events that do not need window
 
+    if (x11.shm_completion_type != 0 && event->type == x11.shm_completion_type) {
+        if (x11.shm_in_flight > 0) {
+            --x11.shm_in_flight;
+        }
+        return;
+    }
+
     x11_window* window = 0;
     const int context_res = x11.XFindContext(
         x11.display,
@@ -338,6 +387,29 @@ static void x11_dispatch_callback(
 
 }
 
+// Dispatches events until the server is done reading every shared
+// framebuffer sent with XShmPutImage.
+static void x11_shm_wait(void) {
+#ifdef BJ_CONFIG_X11_XSHM
+    while (x11.shm_in_flight > 0) {
+        if (x11.XPending(x11.display) == 0) {
+            struct pollfd connection = {
+                .fd     = ConnectionNumber(x11.display),
+                .events = POLLIN,
+            };
+            if (poll(&connection, 1, SHM_WAIT_TIMEOUT_MS) <= 0) {
+                bj_warn("MIT-SHM completion lost");
+                x11.shm_in_flight = 0;
+            }
+            continue;
+        }
+        XEvent event;
+        x11.XNextEvent(x11.display, &event);
+        x11_dispatch_callback(0, &event);
+    }
+#endif
+}
+
 static void x11_poll_events(
     void
 ) {
@@ -348,6 +420,10 @@ static void x11_poll_events(
         x11.XNextEvent(x11.display, &event);
         x11_dispatch_callback(0, &event);
     }
+
+    // Events are polled at the start of a frame: the previous one must be
+    // out of the shared framebuffer before drawing starts.
+    x11_shm_wait();
     x11.XFlush(x11.display);
 }
 
@@ -624,6 +700,188 @@ static void x11_end_video(
     LOAD_SYM(fn_XCloseDisplay, x11.handle, "XCloseDisplay");
     fn_XCloseDisplay(x11.display);
     bj_free(x11.keymap);
+
+    if (x11.xext_handle) {
+        bj_unload_library(x11.xext_handle);
+        x11.xext_handle         = 0;
+        x11.shm_completion_type = 0;
+        x11.shm_in_flight       = 0;
+    }
+}
+
+#ifdef BJ_CONFIG_X11_XSHM
+
+static int x11_shm_error_trap(Display* display, XErrorEvent* event) {
+    (void)display;
+    (void)event;
+    x11.shm_error = BJ_TRUE;
+    return 0;
+}
+
+// Creates the framebuffer image in a shared memory segment.
+// Returns BJ_FALSE, with nothing left allocated, if MIT-SHM cannot be used.
+static bj_bool x11_create_shm_image(
+    struct bj_renderer_data* data,
+    const XWindowAttributes* attributes,
+    enum bj_pixel_mode       mode
+) {
+    if (x11.xext_handle == 0) {
+        return BJ_FALSE;
+    }
+
+    XShmSegmentInfo* info = &data->shm_info;
+    XImage* image = x11.XShmCreateImage(
+        x11.display, attributes->visual, (unsigned int)attributes->depth, ZPixmap, 0, info,
+        (unsigned int)attributes->width, (unsigned int)attributes->height
+    );
+    if (image == 0) {
+        return BJ_FALSE;
+    }
+    // The server decides on the image layout: it must match the bitmap mode
+    if ((size_t)image->bits_per_pixel != BJ_PIXEL_GET_BPP(mode)) {
+        x11.XFree(image);
+        return BJ_FALSE;
+    }
+
+    info->shmid = shmget(IPC_PRIVATE, (size_t)image->bytes_per_line * (size_t)image->height, IPC_CREAT | 0600);
+    if (info->shmid < 0) {
+        x11.XFree(image);
+        return BJ_FALSE;
+    }
+    info->shmaddr = shmat(info->shmid, 0, 0);
+    if (info->shmaddr == (char*)-1) {
+        shmctl(info->shmid, IPC_RMID, 0);
+        x11.XFree(image);
+        return BJ_FALSE;
+    }
+    info->readOnly = False;
+    image->data    = info->shmaddr;
+
+    // Attaching fails asynchronously for remote displays: trap the error
+    x11.shm_error = BJ_FALSE;
+    XErrorHandler previous_handler = x11.XSetErrorHandler(x11_shm_error_trap);
+    const Bool attached = x11.XShmAttach(x11.display, info);
+    x11.XSync(x11.display, False);
+    x11.XSetErrorHandler(previous_handler);
+
+    // The segment is freed once both sides have detached
+    shmctl(info->shmid, IPC_RMID, 0);
+
+    if (!attached || x11.shm_error) {
+        shmdt(info->shmaddr);
+        x11.XFree(image);
+        return BJ_FALSE;
+    }
+
+    data->framebuffer_image  = image;
+    data->framebuffer_pixels = info->shmaddr;
+    data->shm                = BJ_TRUE;
+    return BJ_TRUE;
+}
+
+static void x11_release_shm_image(
+    struct bj_renderer_data* data
+) {
+    x11_shm_wait();
+    x11.XShmDetach(x11.display, &data->shm_info);
+    x11.XSync(x11.display, False);
+    x11.XFree(data->framebuffer_image);
+    shmdt(data->shm_info.shmaddr);
+}
+
+static void x11_put_shm_image(
+    struct bj_renderer_data*      data,
+    Window                        window,
+    const struct bj_dirty_region* region
+) {
+    // The server reads the pixels in place and reports with ShmCompletion.
+    // Requests are processed in order, so only the last one asks for it.
+    x11_shm_wait();
+    for (size_t i = 0; i < region->count; ++i) {
+        const struct bj_rect* rect = &region->rects[i];
+        x11.XShmPutImage(
+            x11.display, window, data->gc, data->framebuffer_image,
+            rect->x, rect->y, rect->x, rect->y, rect->w, rect->h,
+            i + 1 == region->count ? True : False
+        );
+    }
+    ++x11.shm_in_flight;
+}
+
+// Loads MIT-SHM from libXext. The renderers fall back to XPutImage when it
+// is missing or when the display does not support it (remote X servers).
+static void x11_init_shm(void) {
+    void* handle = bj_load_library("libXext.so.6", 0);
+    if (handle == 0) {
+        return;
+    }
+
+    pfn_XShmGetEventBase   x11_XShmGetEventBase;
+    pfn_XShmQueryExtension x11_XShmQueryExtension;
+    LOAD_SYM(x11_XShmGetEventBase,   handle, "XShmGetEventBase");
+    LOAD_SYM(x11_XShmQueryExtension, handle, "XShmQueryExtension");
+    LOAD_SYM(x11.XShmAttach,         handle, "XShmAttach");
+    LOAD_SYM(x11.XShmCreateImage,    handle, "XShmCreateImage");
+    LOAD_SYM(x11.XShmDetach,         handle, "XShmDetach");
+    LOAD_SYM(x11.XShmPutImage,       handle, "XShmPutImage");
+
+    if (x11_XShmGetEventBase == 0 || x11_XShmQueryExtension == 0
+        || x11.XShmAttach == 0 || x11.XShmCreateImage == 0
+        || x11.XShmDetach == 0 || x11.XShmPutImage == 0
+        || x11.XSetErrorHandler == 0
+        || !x11_XShmQueryExtension(x11.display)) {
+        bj_unload_library(handle);
+        return;
+    }
+
+    x11.xext_handle         = handle;
+    x11.shm_completion_type = x11_XShmGetEventBase(x11.display) + ShmCompletion;
+    bj_info("X11 presentation through MIT-SHM");
+}
+
+#else
+
+static bj_bool x11_create_shm_image(
+    struct bj_renderer_data* data,
+    const XWindowAttributes* attributes,
+    enum bj_pixel_mode       mode
+) {
+    (void)data;
+    (void)attributes;
+    (void)mode;
+    return BJ_FALSE;
+}
+
+static void x11_release_shm_image(struct bj_renderer_data* data) {
+    (void)data;
+}
+
+static void x11_put_shm_image(struct bj_renderer_data* data, Window window, const struct bj_dirty_region* region) {
+    (void)data;
+    (void)window;
+    (void)region;
+}
+
+static void x11_init_shm(void) {
+}
+
+#endif
+
+static void x11_release_framebuffer_image(
+    struct bj_renderer_data* data
+) {
+    if (data->framebuffer_image == 0) {
+        return;
+    }
+    // Note: don't use XDestroyImage to delete this structure, use XFree.
+    // Otherwise, XLib will XFree the pixels buffer as well.
+    if (data->shm) {
+        x11_release_shm_image(data);
+        data->shm = BJ_FALSE;
+    } else {
+        x11.XFree(data->framebuffer_image);
+    }
+    data->framebuffer_image = 0;
 }
 
 static bj_bool x11_renderer_configure(
@@ -649,27 +907,31 @@ static bj_bool x11_renderer_configure(
     }
 
     // Clean up old XImage if it exists
-    if (renderer->data->framebuffer_image) {
-        x11.XFree(renderer->data->framebuffer_image);
-        renderer->data->framebuffer_image = 0;
+    x11_release_framebuffer_image(renderer->data);
+
+    if (x11_create_shm_image(renderer->data, &attributes, mode)) {
+        bj_assign_bitmap(
+            &renderer->data->framebuffer,
+            renderer->data->framebuffer_pixels,
+            (size_t)attributes.width,
+            (size_t)attributes.height,
+            mode,
+            (size_t)renderer->data->framebuffer_image->bytes_per_line
+        );
+        return BJ_TRUE;
     }
 
     // Reassign the bitmap internals instead of creating a new one
-    bj_assign_bitmap(
+    bj_assign_aligned_bitmap(
         &renderer->data->framebuffer,
-        0,  // Let it allocate its own buffer
         (size_t)attributes.width,
         (size_t)attributes.height,
         mode,
-        0  // Auto-compute stride
+        0
     );
 
-
     renderer->data->framebuffer_pixels = bj_bitmap_pixels(&renderer->data->framebuffer);
-    renderer->data->framebuffer.weak = 1;
 
-    // Note: don't use XDestroyImage to delete this structure, use XFree.
-    // Otherwise, XLib will XFree the pixels buffer as well.
     renderer->data->framebuffer_image = x11.XCreateImage(
         x11.display,              // X Display
         attributes.visual,           // Window Visual
@@ -693,6 +955,9 @@ static bj_bool x11_renderer_configure(
 static struct bj_bitmap* x11_renderer_get_framebuffer(
     struct bj_renderer* renderer
 ) {
+    if (renderer->data->shm) {
+        x11_shm_wait();
+    }
     return &renderer->data->framebuffer;
 }
 
@@ -700,22 +965,34 @@ static void x11_renderer_present(
     struct bj_renderer* renderer,
     struct bj_window* abstract_window
 ) {
+    struct bj_renderer_data* data = renderer->data;
+    if (data->framebuffer_image == 0) {
+        return;
+    }
+
     Display* display = x11.display;
     x11_window* window = (x11_window*)abstract_window;
     Window window_handle = window->handle;
 
-    int width = 0;
-    int height = 0;
-    bj_get_window_size(abstract_window, &width, &height);
+    if (data->gc == 0) {
+        data->gc = x11.XCreateGC(display, window_handle, 0, 0);
+    }
 
-    GC gc = x11.XCreateGC(display, window_handle, 0, 0);
-    x11.XPutImage(
-        display, window_handle, gc,
-        renderer->data->framebuffer_image,
-        0, 0, 0, 0, (unsigned int)width, (unsigned int)height
-    );
-    x11.XFreeGC(display, gc);
-    x11.XSync(display, False);
+    // bj_present() fills the region, with the whole frame if nothing is marked
+    const struct bj_dirty_region* region = &renderer->dirty;
+
+    if (data->shm) {
+        x11_put_shm_image(data, window_handle, region);
+    } else {
+        for (size_t i = 0; i < region->count; ++i) {
+            const struct bj_rect* rect = &region->rects[i];
+            x11.XPutImage(
+                display, window_handle, data->gc, data->framebuffer_image,
+                rect->x, rect->y, rect->x, rect->y, rect->w, rect->h
+            );
+        }
+    }
+    x11.XFlush(display);
 }
 
 static struct bj_renderer* x11_create_renderer(
@@ -738,6 +1015,7 @@ static struct bj_renderer* x11_create_renderer(
     renderer->configure       = x11_renderer_configure;
     renderer->get_framebuffer = x11_renderer_get_framebuffer;
     renderer->present         = x11_renderer_present;
+    renderer->partial_present = BJ_TRUE;
 
     return renderer;
 }
@@ -747,12 +1025,14 @@ static void x11_destroy_renderer(
 ) {
     bj_check(renderer);
 
+    // Clean up XImage if it exists
+    x11_release_framebuffer_image(renderer->data);
+
     // Clean up the framebuffer bitmap internals
     bj_reset_bitmap(&renderer->data->framebuffer);
 
-    // Clean up XImage if it exists
-    if (renderer->data->framebuffer_image) {
-        x11.XFree(renderer->data->framebuffer_image);
+    if (renderer->data->gc) {
+        x11.XFreeGC(x11.display, renderer->data->gc);
     }
 
     bj_free(renderer->data);
@@ -789,6 +1069,7 @@ static bj_bool x11_init_video(
     LOAD_SYM(x11.XCreateGC,            handle, "XCreateGC");
     LOAD_SYM(x11.XPutImage,            handle, "XPutImage");
     LOAD_SYM(x11.XSaveContext,         handle, "XSaveContext");
+    LOAD_SYM(x11.XSetErrorHandler,     handle, "XSetErrorHandler");
     LOAD_SYM(x11.XSetWMNormalHints,    handle, "XSetWMNormalHints");
     LOAD_SYM(x11.XSetWMProtocols,      handle, "XSetWMProtocols");
     LOAD_SYM(x11.XStoreName,           handle, "XStoreName");
@@ -827,6 +1108,7 @@ static bj_bool x11_init_video(
     x11.window_context   = x11_XrmUniqueQuark();
 
     x11_init_keycodes(0);
+    x11_init_shm();
 
     layer->create_renderer           = x11_create_renderer;
     layer->create_window             = x11_create_window;
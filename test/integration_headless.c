@@ -0,0 +1,177 @@
+#include "test.h"
+#include <banjo/bitmap.h>
+#include <banjo/event.h>
+#include <banjo/headless.h>
+#include <banjo/renderer.h>
+#include <banjo/system.h>
+#include <banjo/window.h>
+
+#include <stdio.h>
+
+struct script {
+  struct bj_window *window;
+  uint64_t calls;
+  uint64_t last_frame;
+};
+
+// Presses space on frame 1 and releases it on frame 2
+static void space_script(uint64_t frame_index, void *user_data) {
+  struct script *script = user_data;
+  script->calls += 1;
+  script->last_frame = frame_index;
+  if (frame_index == 1) {
+    bj_push_key_event(script->window, BJ_PRESS, BJ_KEY_SPACE, 0);
+    bj_push_cursor_event(script->window, 3, 4);
+  } else if (frame_index == 2) {
+    bj_push_key_event(script->window, BJ_RELEASE, BJ_KEY_SPACE, 0);
+  }
+}
+
+TEST_CASE(headless_frame_pipeline) {
+  bj_set_video_layer("headless");
+  REQUIRE(bj_begin(BJ_VIDEO_SYSTEM, 0));
+
+  struct bj_window *window = bj_bind_window("headless", 0, 0, 64, 32, 0, 0);
+  REQUIRE_VALUE(window);
+
+  int width = 0;
+  int height = 0;
+  CHECK(bj_get_window_size(window, &width, &height));
+  CHECK_EQ(width, 64);
+  CHECK_EQ(height, 32);
+
+  struct bj_renderer *renderer =
+      bj_create_renderer(BJ_RENDERER_TYPE_SOFTWARE, 0);
+  REQUIRE_VALUE(renderer);
+  REQUIRE(bj_renderer_configure(renderer, window, 0));
+
+  struct bj_bitmap *framebuffer = bj_get_framebuffer(renderer);
+  REQUIRE_VALUE(framebuffer);
+  CHECK_EQ(bj_bitmap_width(framebuffer), 64);
+  CHECK_EQ(bj_bitmap_height(framebuffer), 32);
+
+  // Nothing marked: the whole frame is presented
+  bj_clear_bitmap(framebuffer);
+  bj_present(renderer, window);
+
+  struct bj_present_stats stats;
+  bj_get_present_stats(renderer, &stats);
+  CHECK_EQ(stats.frame_count, 1);
+  CHECK_EQ(stats.last_bytes, 64 * 32 * 4);
+  CHECK_EQ(stats.last_rect_count, 1);
+
+  // Marked areas only, the second one partly outside the framebuffer
+  bj_renderer_mark_dirty(renderer, &(struct bj_rect){2, 2, 4, 4});
+  bj_renderer_mark_dirty(renderer, &(struct bj_rect){60, 30, 10, 10});
+  bj_present(renderer, window);
+
+  bj_get_present_stats(renderer, &stats);
+  CHECK_EQ(stats.frame_count, 2);
+  CHECK_EQ(stats.last_bytes, (16 + 8) * 4);
+  CHECK_EQ(stats.last_rect_count, 2);
+  CHECK_EQ(stats.total_bytes, 64 * 32 * 4 + (16 + 8) * 4);
+
+  bj_reset_present_stats(renderer);
+  bj_get_present_stats(renderer, &stats);
+  CHECK_EQ(stats.frame_count, 0);
+  CHECK_EQ(stats.total_bytes, 0);
+
+  bj_destroy_renderer(renderer);
+  bj_unbind_window(window);
+  bj_end();
+  bj_set_video_layer(0);
+}
+
+TEST_CASE(headless_injects_events_per_frame) {
+  bj_set_video_layer("headless");
+  REQUIRE(bj_begin(BJ_VIDEO_SYSTEM, 0));
+
+  struct bj_window *window = bj_bind_window("headless", 0, 0, 8, 8, 0, 0);
+  REQUIRE_VALUE(window);
+  struct bj_renderer *renderer =
+      bj_create_renderer(BJ_RENDERER_TYPE_SOFTWARE, 0);
+  REQUIRE_VALUE(renderer);
+  REQUIRE(bj_renderer_configure(renderer, window, 0));
+
+  struct script script = {.window = window};
+  bj_set_headless_event_injector(space_script, &script);
+
+  int pressed[3] = {0};
+  for (int frame = 0; frame < 3; ++frame) {
+    bj_dispatch_events();
+    bj_dispatch_events(); // A second dispatch in the same frame injects nothing
+    pressed[frame] = bj_get_key(window, BJ_KEY_SPACE);
+    bj_present(renderer, window);
+  }
+
+  CHECK_EQ(script.calls, 3);
+  CHECK_EQ(script.last_frame, 2);
+  CHECK_EQ(pressed[0], BJ_RELEASE);
+  CHECK_EQ(pressed[1], BJ_PRESS);
+  CHECK_EQ(pressed[2], BJ_RELEASE);
+
+  bj_set_headless_event_injector(0, 0);
+  bj_destroy_renderer(renderer);
+  bj_unbind_window(window);
+  bj_end();
+  bj_set_video_layer(0);
+}
+
+TEST_CASE(headless_dumps_frames) {
+  bj_set_video_layer("headless");
+  REQUIRE(bj_begin(BJ_VIDEO_SYSTEM, 0));
+
+  struct bj_window *window = bj_bind_window("headless", 0, 0, 3, 2, 0, 0);
+  REQUIRE_VALUE(window);
+  struct bj_renderer *renderer =
+      bj_create_renderer(BJ_RENDERER_TYPE_SOFTWARE, 0);
+  REQUIRE_VALUE(renderer);
+  REQUIRE(bj_renderer_configure(renderer, window, 0));
+
+  struct bj_bitmap *framebuffer = bj_get_framebuffer(renderer);
+  bj_clear_bitmap(framebuffer);
+  bj_put_pixel(framebuffer, 1, 0, 0x00112233);
+
+  bj_set_headless_frame_dump("headless_dump_");
+  bj_present(renderer, window);
+  bj_set_headless_frame_dump(0);
+
+  FILE *file = fopen("headless_dump_000000.ppm", "rb");
+  REQUIRE_VALUE(file);
+  unsigned char content[64] = {0};
+  const size_t size = fread(content, 1, sizeof(content), file);
+  fclose(file);
+  remove("headless_dump_000000.ppm");
+
+  static const char header[] = "P6\n3 2\n255\n";
+  const size_t header_size = sizeof(header) - 1;
+  REQUIRE_EQ(size, header_size + 3 * 2 * 3);
+  CHECK(memcmp(content, header, header_size) == 0);
+  CHECK_EQ(content[header_size + 3], 0x11);
+  CHECK_EQ(content[header_size + 4], 0x22);
+  CHECK_EQ(content[header_size + 5], 0x33);
+  CHECK_EQ(content[header_size], 0);
+
+  bj_destroy_renderer(renderer);
+  bj_unbind_window(window);
+  bj_end();
+  bj_set_video_layer(0);
+}
+
+TEST_CASE(unknown_video_layer_fails) {
+  bj_set_video_layer("no such layer");
+  CHECK_FALSE(bj_begin(BJ_VIDEO_SYSTEM, 0));
+  bj_set_video_layer(0);
+  bj_end();
+}
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(headless_frame_pipeline);
+  RUN_TEST(headless_injects_events_per_frame);
+  RUN_TEST(headless_dumps_frames);
+  RUN_TEST(unknown_video_layer_fails);
+
+  END_TESTS();
+}
@@ -0,0 +1,115 @@
+#include "test.h"
+#include <banjo/audio.h>
+#include <banjo/null_audio.h>
+#include <banjo/stream.h>
+#include <banjo/system.h>
+#include <banjo/time.h>
+#include <banjo/wav.h>
+
+#include <stdio.h>
+
+#define RATE 48000
+#define NOTE_FRAMES 3000
+
+static struct bj_audio_play_note_data note = {.function = BJ_AUDIO_PLAY_SQUARE, .frequency = 440.0};
+
+static const struct bj_audio_properties mono = {
+    .format = BJ_AUDIO_FORMAT_INT16,
+    .amplitude = 12000,
+    .channels = 1,
+    .sample_rate = RATE,
+    .period_frames = 128,
+    .period_count = 2,
+};
+
+// Plays until the device pauses itself at the frame limit
+static bj_bool play_to_limit(struct bj_audio_device *device) {
+  bj_play_audio_device(device);
+  for (int waited = 0; bj_audio_playing(device); ++waited) {
+    if (waited > 5000) {
+      return BJ_FALSE;
+    }
+    bj_sleep(1);
+  }
+  return BJ_TRUE;
+}
+
+TEST_CASE(null_audio_renders_to_wav) {
+  bj_set_audio_layer("null");
+  bj_set_null_audio_pacing(BJ_NULL_AUDIO_OFFLINE, NOTE_FRAMES);
+  bj_set_null_audio_output("null_audio_note.wav");
+  REQUIRE(bj_begin(BJ_AUDIO_SYSTEM, 0));
+
+  struct bj_audio_device *device = bj_open_audio_device(&mono, bj_play_audio_note, &note, 0);
+  REQUIRE_VALUE(device);
+
+  const struct bj_audio_properties *properties = bj_audio_device_properties(device);
+  CHECK_EQ(properties->sample_rate, RATE);
+  CHECK_EQ(properties->period_frames, 128);
+  CHECK_EQ(properties->period_count, 2);
+  CHECK(bj_audio_latency(device) * RATE > 255.9 && bj_audio_latency(device) * RATE < 256.1);
+
+  CHECK(play_to_limit(device));
+  CHECK_EQ(bj_audio_underruns(device), 0);
+  bj_close_audio_device(device);
+  bj_set_null_audio_output(0);
+  bj_set_null_audio_pacing(BJ_NULL_AUDIO_REALTIME, 0);
+  bj_end();
+  bj_set_audio_layer(0);
+
+  // The file holds the same samples as the callback called directly, one
+  // period at a time
+  static int16_t expected[NOTE_FRAMES];
+  static int16_t written[NOTE_FRAMES + 1];
+  for (unsigned at = 0; at < NOTE_FRAMES; at += 128) {
+    const unsigned frames = NOTE_FRAMES - at < 128 ? NOTE_FRAMES - at : 128;
+    bj_play_audio_note(expected + at, frames, &mono, &note, at);
+  }
+
+  struct bj_stream *stream = bj_open_stream_file("null_audio_note.wav", 0);
+  REQUIRE_VALUE(stream);
+  struct bj_wav *wav = bj_open_wav(stream, 0);
+  REQUIRE_VALUE(wav);
+  CHECK_EQ(bj_wav_properties(wav)->sample_rate, RATE);
+  CHECK_EQ(bj_wav_frames(wav), NOTE_FRAMES);
+  CHECK_EQ(bj_read_wav(wav, written, NOTE_FRAMES + 1), NOTE_FRAMES);
+
+  int same = 1;
+  for (size_t i = 0; i < NOTE_FRAMES; ++i) {
+    same &= expected[i] == written[i];
+  }
+  CHECK(same);
+
+  bj_close_wav(wav);
+  bj_close_stream(stream);
+  remove("null_audio_note.wav");
+}
+
+TEST_CASE(null_audio_realtime_follows_the_clock) {
+  bj_set_audio_layer("null");
+  bj_set_null_audio_pacing(BJ_NULL_AUDIO_REALTIME, RATE / 10);
+  REQUIRE(bj_begin(BJ_AUDIO_SYSTEM, 0));
+
+  struct bj_audio_device *device = bj_open_audio_device(&mono, bj_play_audio_note, &note, 0);
+  REQUIRE_VALUE(device);
+
+  // 100 ms of audio, of which the 256 frames of latency are produced ahead
+  struct bj_stopwatch sw = {0};
+  bj_reset_stopwatch(&sw);
+  CHECK(play_to_limit(device));
+  CHECK(bj_stopwatch_elapsed(&sw) > 0.08);
+
+  bj_close_audio_device(device);
+  bj_set_null_audio_pacing(BJ_NULL_AUDIO_REALTIME, 0);
+  bj_end();
+  bj_set_audio_layer(0);
+}
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(null_audio_renders_to_wav);
+  RUN_TEST(null_audio_realtime_follows_the_clock);
+
+  END_TESTS();
+}
@@ -0,0 +1,88 @@
+#include "test.h"
+#include <banjo/bitmap.h>
+#include <banjo/stream.h>
+#include <banjo/system.h>
+#include <banjo/time.h>
+
+// Frame capture throughput: 720p frames written as BMP to a memory stream,
+// in frames per second, for each encoding path of bj_write_bitmap_to_stream.
+// The baseline encodes XRGB8888 frames one pixel at a time through the
+// public pixel API, which is what capture code had to do before.
+
+#define BENCH_W      1280
+#define BENCH_H      720
+#define BENCH_FRAMES 30
+
+static void fill_frame(struct bj_bitmap* bmp) {
+    uint8_t* pixels = bj_bitmap_pixels(bmp);
+    const size_t size = bj_bitmap_stride(bmp) * bj_bitmap_height(bmp);
+    for (size_t i = 0; i < size; ++i) {
+        pixels[i] = (uint8_t)((i / 97) * 13); // Runs, for RLE
+    }
+}
+
+static void write_per_pixel(const struct bj_bitmap* bmp, struct bj_stream* stream) {
+    uint8_t header[54] = {'B', 'M'};
+    bj_write_stream(stream, header, sizeof(header));
+    for (size_t y = bj_bitmap_height(bmp); y-- > 0;) {
+        for (size_t x = 0; x < bj_bitmap_width(bmp); ++x) {
+            uint8_t bgrx[4] = {0};
+            bj_make_bitmap_rgb(bmp, x, y, &bgrx[2], &bgrx[1], &bgrx[0]);
+            bj_write_stream(stream, bgrx, sizeof(bgrx));
+        }
+    }
+}
+
+static void bench_capture(Context* ctx, const char* name, enum bj_pixel_mode mode, size_t width, bj_bool per_pixel) {
+    struct bj_bitmap* bmp = bj_create_bitmap(width, BENCH_H, mode, 0);
+    struct bj_stream* stream = bj_open_stream_write(0, 0);
+    if (bmp == 0 || stream == 0) {
+        bj_destroy_bitmap(bmp);
+        if (stream != 0) {
+            bj_close_stream(stream);
+        }
+        return;
+    }
+    fill_frame(bmp);
+
+    struct bj_stopwatch sw = {0};
+    bj_reset_stopwatch(&sw);
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        bj_seek_stream(stream, 0, BJ_SEEK_BEGIN);
+        if (per_pixel) {
+            write_per_pixel(bmp, stream);
+        } else {
+            bj_write_bitmap_to_stream(bmp, stream, 0);
+        }
+    }
+    const double elapsed = bj_stopwatch_elapsed(&sw);
+    const size_t bytes = bj_get_stream_length(stream);
+
+    PRINT(ctx, "  %-22s %10.1f %12.1f %10zu\n", name,
+        elapsed > 0.0 ? BENCH_FRAMES / elapsed : 0.0,
+        elapsed > 0.0 ? (double)(width * BENCH_H * BENCH_FRAMES) / elapsed / 1e6 : 0.0,
+        bytes / 1024);
+
+    bj_close_stream(stream);
+    bj_destroy_bitmap(bmp);
+}
+
+TEST_CASE(bitmap_write_throughput) {
+    PRINT(SM_CTX(), "  %-22s %10s %12s %10s\n", "path", "frames/s", "Mpixels/s", "KiB");
+    bench_capture(SM_CTX(), "XRGB8888 per pixel", BJ_PIXEL_MODE_XRGB8888, BENCH_W, BJ_TRUE);
+    bench_capture(SM_CTX(), "XRGB8888", BJ_PIXEL_MODE_XRGB8888, BENCH_W, BJ_FALSE);
+    bench_capture(SM_CTX(), "BGR24", BJ_PIXEL_MODE_BGR24, BENCH_W, BJ_FALSE);
+    bench_capture(SM_CTX(), "BGR24, padded rows", BJ_PIXEL_MODE_BGR24, BENCH_W + 1, BJ_FALSE);
+    bench_capture(SM_CTX(), "RGB565, converted", BJ_PIXEL_MODE_RGB565, BENCH_W, BJ_FALSE);
+    bench_capture(SM_CTX(), "INDEXED_8, RLE8", BJ_PIXEL_MODE_INDEXED_8, BENCH_W, BJ_FALSE);
+}
+
+int main(int argc, char* argv[]) {
+    bj_begin(0, NULL);
+    BEGIN_TESTS(argc, argv);
+
+    RUN_TEST(bitmap_write_throughput);
+
+    END_TESTS();
+    bj_end();
+}
@@ -0,0 +1,230 @@
+#include "test.h"
+#include <banjo/bitmap.h>
+#include <banjo/system.h>
+#include <banjo/time.h>
+
+#include "bitmap.h"
+#include "cpu.h"
+
+// Blit throughput, in megapixels per second, for each op and format.
+// Every measurement is taken twice: with the scalar kernels forced and with
+// the kernels selected for the running CPU.
+
+#define BENCH_W    256
+#define BENCH_H    256
+#define BENCH_REPS 10
+
+static const enum bj_pixel_mode bench_modes[] = {
+    BJ_PIXEL_MODE_XRGB8888,
+    BJ_PIXEL_MODE_BGR24,
+    BJ_PIXEL_MODE_RGB565,
+    BJ_PIXEL_MODE_XRGB1555,
+};
+#define N_MODES (sizeof(bench_modes) / sizeof(bench_modes[0]))
+
+static const enum bj_blit_op bench_ops[] = {
+    BJ_BLIT_OP_COPY,
+    BJ_BLIT_OP_XOR,
+    BJ_BLIT_OP_OR,
+    BJ_BLIT_OP_AND,
+    BJ_BLIT_OP_ADD_SAT,
+    BJ_BLIT_OP_SUB_SAT,
+};
+#define N_OPS (sizeof(bench_ops) / sizeof(bench_ops[0]))
+
+static const char* mode_name(enum bj_pixel_mode mode) {
+    switch (mode) {
+        case BJ_PIXEL_MODE_XRGB8888: return "XRGB8888";
+        case BJ_PIXEL_MODE_BGR24:    return "BGR24";
+        case BJ_PIXEL_MODE_RGB565:   return "RGB565";
+        case BJ_PIXEL_MODE_XRGB1555: return "XRGB1555";
+        default:                     return "?";
+    }
+}
+
+static const char* op_name(enum bj_blit_op op) {
+    switch (op) {
+        case BJ_BLIT_OP_COPY:    return "COPY";
+        case BJ_BLIT_OP_XOR:     return "XOR";
+        case BJ_BLIT_OP_OR:      return "OR";
+        case BJ_BLIT_OP_AND:     return "AND";
+        case BJ_BLIT_OP_ADD_SAT: return "ADD_SAT";
+        case BJ_BLIT_OP_SUB_SAT: return "SUB_SAT";
+        default:                 return "?";
+    }
+}
+
+static void fill_pattern(struct bj_bitmap* bmp, uint32_t seed) {
+    uint8_t* pixels = bj_bitmap_pixels(bmp);
+    const size_t size = bj_bitmap_stride(bmp) * bj_bitmap_height(bmp);
+    for (size_t i = 0; i < size; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        pixels[i] = (uint8_t)(seed >> 24);
+    }
+}
+
+static double measure_mpps(
+    const struct bj_bitmap* src, struct bj_bitmap* dst,
+    enum bj_blit_op op, uint32_t cpu_features
+) {
+    bj_select_blit_kernels(cpu_features);
+    bj_blit(src, 0, dst, 0, op); // Warm up caches
+
+    struct bj_stopwatch sw = {0};
+    bj_reset_stopwatch(&sw);
+    for (int i = 0; i < BENCH_REPS; ++i) {
+        bj_blit(src, 0, dst, 0, op);
+    }
+    const double elapsed = bj_stopwatch_elapsed(&sw);
+    const double pixels = (double)BENCH_W * BENCH_H * BENCH_REPS;
+    return elapsed > 0.0 ? pixels / elapsed / 1e6 : 0.0;
+}
+
+static int bench_pair(
+    Context* ctx, enum bj_pixel_mode smode, enum bj_pixel_mode dmode,
+    enum bj_blit_op op, bj_bool keyed
+) {
+    struct bj_bitmap* src = bj_create_bitmap(BENCH_W, BENCH_H, smode, 0);
+    struct bj_bitmap* dst = bj_create_bitmap(BENCH_W, BENCH_H, dmode, 0);
+    if (!src || !dst) {
+        bj_destroy_bitmap(src);
+        bj_destroy_bitmap(dst);
+        return 0;
+    }
+
+    fill_pattern(src, 1u);
+    fill_pattern(dst, 2u);
+    if (keyed) {
+        bj_set_bitmap_color(src, bj_bitmap_pixel(src, 0, 0), BJ_BITMAP_COLORKEY);
+    }
+
+    const double scalar = measure_mpps(src, dst, op, 0);
+    const double vector = measure_mpps(src, dst, op, bj_cpu_features());
+    PRINT(ctx, "  %-8s -> %-8s %-7s %-5s %9.1f %9.1f  x%.2f\n",
+        mode_name(smode), mode_name(dmode), op_name(op), keyed ? "key" : "",
+        scalar, vector, scalar > 0.0 ? vector / scalar : 0.0
+    );
+
+    bj_destroy_bitmap(src);
+    bj_destroy_bitmap(dst);
+    return 1;
+}
+
+TEST_CASE(blit_throughput_same_format) {
+    PRINT(SM_CTX(), "  %-8s    %-8s %-7s %-5s %9s %9s\n", "src", "dst", "op", "", "scalar", "selected");
+    for (size_t m = 0; m < N_MODES; ++m) {
+        for (size_t o = 0; o < N_OPS; ++o) {
+            REQUIRE(bench_pair(SM_CTX(), bench_modes[m], bench_modes[m], bench_ops[o], BJ_FALSE));
+            REQUIRE(bench_pair(SM_CTX(), bench_modes[m], bench_modes[m], bench_ops[o], BJ_TRUE));
+        }
+    }
+}
+
+TEST_CASE(blit_throughput_cross_format) {
+    for (size_t m = 1; m < N_MODES; ++m) {
+        for (size_t o = 0; o < N_OPS; ++o) {
+            REQUIRE(bench_pair(SM_CTX(), bench_modes[m], BJ_PIXEL_MODE_XRGB8888, bench_ops[o], BJ_FALSE));
+            REQUIRE(bench_pair(SM_CTX(), BJ_PIXEL_MODE_XRGB8888, bench_modes[m], bench_ops[o], BJ_FALSE));
+        }
+    }
+}
+
+static double measure_stretch_mpps(
+    const struct bj_bitmap* src, struct bj_bitmap* dst, enum bj_blit_filter filter
+) {
+    bj_blit_stretched_filtered(src, 0, dst, 0, BJ_BLIT_OP_COPY, filter);
+
+    struct bj_stopwatch sw = {0};
+    bj_reset_stopwatch(&sw);
+    for (int i = 0; i < BENCH_REPS; ++i) {
+        bj_blit_stretched_filtered(src, 0, dst, 0, BJ_BLIT_OP_COPY, filter);
+    }
+    const double elapsed = bj_stopwatch_elapsed(&sw);
+    const double pixels = (double)bj_bitmap_width(dst) * (double)bj_bitmap_height(dst) * BENCH_REPS;
+    return elapsed > 0.0 ? pixels / elapsed / 1e6 : 0.0;
+}
+
+// Destination megapixels per second, for nearest, bilinear and box filters
+TEST_CASE(blit_stretched_filter_throughput) {
+    const size_t scales[][2] = {{BENCH_W * 2, BENCH_H * 2}, {BENCH_W / 2, BENCH_H / 2}};
+    PRINT(SM_CTX(), "  %-8s %-9s %9s %9s %9s\n", "mode", "size", "nearest", "bilinear", "box");
+    for (size_t m = 0; m < N_MODES; ++m) {
+        for (size_t z = 0; z < 2; ++z) {
+            struct bj_bitmap* src = bj_create_bitmap(BENCH_W, BENCH_H, bench_modes[m], 0);
+            struct bj_bitmap* dst = bj_create_bitmap(scales[z][0], scales[z][1], bench_modes[m], 0);
+            REQUIRE_VALUE(src);
+            REQUIRE_VALUE(dst);
+            fill_pattern(src, 3u);
+
+            const double nearest  = measure_stretch_mpps(src, dst, BJ_BLIT_FILTER_NEAREST);
+            const double bilinear = measure_stretch_mpps(src, dst, BJ_BLIT_FILTER_BILINEAR);
+            const double box      = measure_stretch_mpps(src, dst, BJ_BLIT_FILTER_BOX);
+            PRINT(SM_CTX(), "  %-8s %4zux%-4zu %9.1f %9.1f %9.1f\n", mode_name(bench_modes[m]),
+                scales[z][0], scales[z][1], nearest, bilinear, box);
+
+            bj_destroy_bitmap(src);
+            bj_destroy_bitmap(dst);
+        }
+    }
+}
+
+static double measure_transform_mpps(
+    const struct bj_bitmap* src, struct bj_bitmap* dst,
+    const struct bj_mat3x2* transform, enum bj_blit_filter filter
+) {
+    bj_blit_transformed(src, 0, dst, transform, BJ_BLIT_OP_COPY, filter);
+
+    struct bj_stopwatch sw = {0};
+    bj_reset_stopwatch(&sw);
+    for (int i = 0; i < BENCH_REPS; ++i) {
+        bj_blit_transformed(src, 0, dst, transform, BJ_BLIT_OP_COPY, filter);
+    }
+    const double elapsed = bj_stopwatch_elapsed(&sw);
+    const double pixels = (double)BENCH_W * BENCH_H * BENCH_REPS;
+    return elapsed > 0.0 ? pixels / elapsed / 1e6 : 0.0;
+}
+
+// Source megapixels per second for a blit rotated about its center
+TEST_CASE(blit_transformed_throughput) {
+    const bj_real angles[] = {BJ_FZERO, BJ_PI / BJ_F(6.0), BJ_PI / BJ_F(2.0)};
+    PRINT(SM_CTX(), "  %-8s %6s %9s %9s\n", "mode", "angle", "nearest", "bilinear");
+    for (size_t m = 0; m < N_MODES; ++m) {
+        for (size_t a = 0; a < 3; ++a) {
+            struct bj_bitmap* src = bj_create_bitmap(BENCH_W, BENCH_H, bench_modes[m], 0);
+            struct bj_bitmap* dst = bj_create_bitmap(BENCH_W * 2, BENCH_H * 2, bench_modes[m], 0);
+            REQUIRE_VALUE(src);
+            REQUIRE_VALUE(dst);
+            fill_pattern(src, 5u);
+
+            struct bj_mat3x2 center, rotation, place, tmp, t;
+            bj_mat3x2_set_translation(&center, -(bj_real)BENCH_W / BJ_F(2.0), -(bj_real)BENCH_H / BJ_F(2.0));
+            bj_mat3x2_set_rotation_z(&rotation, angles[a]);
+            bj_mat3x2_set_translation(&place, (bj_real)BENCH_W, (bj_real)BENCH_H);
+            bj_mat3x2_mul(&tmp, &rotation, &center);
+            bj_mat3x2_mul(&t, &place, &tmp);
+
+            const double nearest  = measure_transform_mpps(src, dst, &t, BJ_BLIT_FILTER_NEAREST);
+            const double bilinear = measure_transform_mpps(src, dst, &t, BJ_BLIT_FILTER_BILINEAR);
+            PRINT(SM_CTX(), "  %-8s %6.0f %9.1f %9.1f\n", mode_name(bench_modes[m]),
+                (double)angles[a] * 180.0 / 3.14159265358979, nearest, bilinear);
+
+            bj_destroy_bitmap(src);
+            bj_destroy_bitmap(dst);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bj_begin(0, NULL);
+    BEGIN_TESTS(argc, argv);
+
+    RUN_TEST(blit_throughput_same_format);
+    RUN_TEST(blit_throughput_cross_format);
+    RUN_TEST(blit_stretched_filter_throughput);
+    RUN_TEST(blit_transformed_throughput);
+
+    bj_select_blit_kernels(bj_cpu_features());
+
+    END_TESTS();
+    bj_end();
+}
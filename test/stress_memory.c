@@ -1,9 +1,14 @@
 #include "test.h"
+#include <banjo/error.h>
 #include <banjo/memory.h>
+#include <banjo/system.h>
+#include <banjo/time.h>
+#include <pool.h>
 #include <stdlib.h>
 #include <time.h>
 
 #define COUNT (2000)
+#define BENCH_ROUNDS (200)
 
 TEST_CASE(memory_massive_fragmented_allocation) {
   void *pointers[COUNT];
@@ -62,17 +67,80 @@ TEST_CASE(memory_large_allocation) {
   }
 }
 
+// Allocates COUNT blocks of `size` bytes, then frees them in shuffled order,
+// BENCH_ROUNDS times. Returns the nanoseconds per allocation and free pair.
+static double churn_ns(size_t size, bj_bool pool) {
+  static void *pointers[COUNT];
+  static size_t order[COUNT];
+  srand(7);
+  for (size_t i = 0; i < COUNT; ++i) {
+    order[i] = i;
+  }
+  for (size_t i = 0; i < COUNT; ++i) {
+    const size_t target = (size_t)rand() % COUNT;
+    const size_t tmp = order[i];
+    order[i] = order[target];
+    order[target] = tmp;
+  }
+
+  struct bj_stopwatch sw = {0};
+  bj_reset_stopwatch(&sw);
+  for (int round = 0; round < BENCH_ROUNDS; ++round) {
+    for (size_t i = 0; i < COUNT; ++i) {
+      pointers[i] = pool ? bj_pool_allocate(size) : malloc(size);
+    }
+    for (size_t i = 0; i < COUNT; ++i) {
+      if (pool) {
+        bj_pool_free(pointers[order[i]]);
+      } else {
+        free(pointers[order[i]]);
+      }
+    }
+  }
+  return bj_stopwatch_elapsed(&sw) * 1e9 / (COUNT * BENCH_ROUNDS);
+}
+
+// Pool allocator against the system allocator for the sizes of the
+// library structs
+TEST_CASE(memory_pool_versus_system) {
+  PRINT(SM_CTX(), "  %-8s %10s %10s\n", "size", "malloc ns", "pool ns");
+  const size_t sizes[] = {24, 40, 96, 200};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    const double system = churn_ns(sizes[s], BJ_FALSE);
+    const double pool = churn_ns(sizes[s], BJ_TRUE);
+    PRINT(SM_CTX(), "  %-8zu %10.1f %10.1f\n", sizes[s], system, pool);
+  }
+}
+
+// Errors are allocated in one pool block
+TEST_CASE(memory_error_churn) {
+  struct bj_stopwatch sw = {0};
+  bj_reset_stopwatch(&sw);
+  for (int i = 0; i < COUNT * 10; ++i) {
+    struct bj_error *error = 0;
+    bj_set_error_fmt(&error, BJ_ERROR_IO, "cannot read item %d", i);
+    bj_prefix_error(&error, "while loading: ");
+    REQUIRE_VALUE(error);
+    bj_clear_error(&error);
+  }
+  PRINT(SM_CTX(), "  error set/prefix/clear: %.1f ns\n", bj_stopwatch_elapsed(&sw) * 1e9 / (COUNT * 10));
+}
+
 int main(int argc, char *argv[]) {
   // Note: We don't use BEGIN_TESTS/END_TESTS here if we want to bypass
   // the mock memory leak check for the ENTIRE program, OR we use them
   // to confirm our bj_malloc calls are tracked.
   // We want them tracked.
 
+  bj_begin(0, NULL);
   BEGIN_TESTS(argc, argv);
 
   RUN_TEST(memory_massive_fragmented_allocation);
   RUN_TEST(memory_realloc_churn);
   RUN_TEST(memory_large_allocation);
+  RUN_TEST(memory_pool_versus_system);
+  RUN_TEST(memory_error_churn);
 
   END_TESTS();
+  bj_end();
 }
@@ -0,0 +1,126 @@
+#include "test.h"
+#include <banjo/mixer.h>
+#include <banjo/oscillator.h>
+#include <banjo/system.h>
+#include <banjo/time.h>
+
+// Time spent mixing 64 voices into one 512-frame period, compared with the
+// duration of that period at 48 kHz.
+
+#define BENCH_VOICES  64
+#define BENCH_FRAMES  512
+#define BENCH_RATE    48000
+#define BENCH_REPS    200
+#define SOUND_FRAMES  4096
+
+static int16_t sound_samples[SOUND_FRAMES * 2];
+
+static void fill_sound(void) {
+    uint32_t seed = 1u;
+    for (size_t i = 0; i < SOUND_FRAMES * 2; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        sound_samples[i] = (int16_t)(seed >> 16);
+    }
+}
+
+static double measure_period_us(enum bj_audio_format format, unsigned int channels, float pitch) {
+    struct bj_mixer* mixer = bj_create_mixer(BENCH_VOICES);
+    if (mixer == 0) {
+        return -1.0;
+    }
+
+    const struct bj_mixer_sound sound = {
+        .samples     = sound_samples,
+        .frames      = SOUND_FRAMES,
+        .format      = BJ_AUDIO_FORMAT_INT16,
+        .channels    = channels,
+        .sample_rate = BENCH_RATE,
+        .loop_start  = 0,
+        .loop_end    = SOUND_FRAMES,
+    };
+    for (int v = 0; v < BENCH_VOICES; ++v) {
+        const uint32_t voice = bj_mixer_play_sound(mixer, &sound, 0.05f, (float)v / BENCH_VOICES * 2.0f - 1.0f);
+        bj_mixer_set_pitch(mixer, voice, pitch);
+    }
+
+    const struct bj_audio_properties audio = {
+        .format      = format,
+        .channels    = 2,
+        .sample_rate = BENCH_RATE,
+    };
+    static float buffer[BENCH_FRAMES * 2];
+    bj_mix(mixer, buffer, BENCH_FRAMES, &audio);
+
+    struct bj_stopwatch sw = {0};
+    bj_reset_stopwatch(&sw);
+    for (int i = 0; i < BENCH_REPS; ++i) {
+        bj_mix(mixer, buffer, BENCH_FRAMES, &audio);
+    }
+    const double elapsed = bj_stopwatch_elapsed(&sw);
+
+    bj_destroy_mixer(mixer);
+    return elapsed / BENCH_REPS * 1e6;
+}
+
+TEST_CASE(mixer_period_cost) {
+    fill_sound();
+    const double period_us = (double)BENCH_FRAMES / BENCH_RATE * 1e6;
+    PRINT(SM_CTX(), "  %d voices, %d frames (%.0f us period)\n", BENCH_VOICES, BENCH_FRAMES, period_us);
+    PRINT(SM_CTX(), "  %-6s %-7s %-6s %9s %7s\n", "output", "source", "pitch", "us", "load");
+
+    const enum bj_audio_format formats[] = {BJ_AUDIO_FORMAT_INT16, BJ_AUDIO_FORMAT_F32};
+    const float pitches[] = {1.0f, 1.5f};
+    for (size_t f = 0; f < 2; ++f) {
+        for (unsigned int channels = 1; channels <= 2; ++channels) {
+            for (size_t p = 0; p < 2; ++p) {
+                const double us = measure_period_us(formats[f], channels, pitches[p]);
+                REQUIRE(us >= 0.0);
+                PRINT(SM_CTX(), "  %-6s %-7s %6.2f %9.1f %6.1f%%\n",
+                    formats[f] == BJ_AUDIO_FORMAT_INT16 ? "int16" : "f32",
+                    channels == 1 ? "mono" : "stereo", (double)pitches[p], us, us / period_us * 100.0
+                );
+            }
+        }
+    }
+}
+
+// Synthesized notes: one oscillator per voice, all shapes
+TEST_CASE(mixer_oscillator_period_cost) {
+    struct bj_mixer* mixer = bj_create_mixer(BENCH_VOICES);
+    REQUIRE_VALUE(mixer);
+
+    static struct bj_oscillator notes[BENCH_VOICES];
+    for (int v = 0; v < BENCH_VOICES; ++v) {
+        bj_init_oscillator(&notes[v], (enum bj_oscillator_shape)(v % 4), 110.0f + 40.0f * (float)v, 0.05f, BENCH_RATE);
+        REQUIRE(bj_mixer_play_generator(mixer, bj_oscillator_generator, &notes[v], 1.0f, 0.0f) != 0);
+    }
+
+    const struct bj_audio_properties audio = {
+        .format      = BJ_AUDIO_FORMAT_INT16,
+        .channels    = 2,
+        .sample_rate = BENCH_RATE,
+    };
+    static int16_t buffer[BENCH_FRAMES * 2];
+
+    struct bj_stopwatch sw = {0};
+    bj_reset_stopwatch(&sw);
+    for (int i = 0; i < BENCH_REPS; ++i) {
+        bj_mix(mixer, buffer, BENCH_FRAMES, &audio);
+    }
+    const double us = bj_stopwatch_elapsed(&sw) / BENCH_REPS * 1e6;
+    const double period_us = (double)BENCH_FRAMES / BENCH_RATE * 1e6;
+    PRINT(SM_CTX(), "  %d oscillators: %.1f us (%.1f%%)\n", BENCH_VOICES, us, us / period_us * 100.0);
+
+    bj_destroy_mixer(mixer);
+}
+
+int main(int argc, char* argv[]) {
+    bj_begin(0, NULL);
+    BEGIN_TESTS(argc, argv);
+
+    RUN_TEST(mixer_period_cost);
+    RUN_TEST(mixer_oscillator_period_cost);
+
+    END_TESTS();
+    bj_end();
+}
@@ -0,0 +1,74 @@
+#include "test.h"
+#include <banjo/audio.h>
+#include <banjo/mixer.h>
+#include <banjo/null_audio.h>
+#include <banjo/oscillator.h>
+#include <banjo/system.h>
+#include <banjo/time.h>
+
+// Callback throughput through a complete device, audio thread included:
+// frames rendered per second by the offline null layer, and the share of
+// real time this work would take on a sound card.
+
+#define BENCH_RATE   48000
+#define BENCH_FRAMES (BENCH_RATE * 10)
+#define BENCH_VOICES 32
+
+static void bench_device(Context* ctx, const char* name, bj_audio_callback_fn callback, void* user_data) {
+    const struct bj_audio_properties properties = {
+        .format        = BJ_AUDIO_FORMAT_F32,
+        .amplitude     = 1,
+        .channels      = 2,
+        .sample_rate   = BENCH_RATE,
+        .period_frames = 256,
+    };
+    struct bj_audio_device* device = bj_open_audio_device(&properties, callback, user_data, 0);
+    if (device == 0) {
+        return;
+    }
+
+    struct bj_stopwatch sw = {0};
+    bj_reset_stopwatch(&sw);
+    bj_play_audio_device(device);
+    while (bj_audio_playing(device)) {
+        bj_sleep(1);
+    }
+    const double elapsed = bj_stopwatch_elapsed(&sw);
+    bj_close_audio_device(device);
+
+    const double rate = elapsed > 0.0 ? (double)BENCH_FRAMES / elapsed : 0.0;
+    PRINT(ctx, "  %-22s %12.0f %7.3f%%\n", name, rate, rate > 0.0 ? (double)BENCH_RATE / rate * 100.0 : 0.0);
+}
+
+TEST_CASE(null_audio_callback_throughput) {
+    bj_set_audio_layer("null");
+    bj_set_null_audio_pacing(BJ_NULL_AUDIO_OFFLINE, BENCH_FRAMES);
+    REQUIRE(bj_begin(BJ_AUDIO_SYSTEM, 0));
+
+    PRINT(SM_CTX(), "  %-22s %12s %8s\n", "callback", "frames/s", "load");
+
+    struct bj_audio_play_note_data note = {.function = BJ_AUDIO_PLAY_SINE, .frequency = 440.0};
+    bench_device(SM_CTX(), "note", bj_play_audio_note, &note);
+
+    struct bj_mixer* mixer = bj_create_mixer(BENCH_VOICES);
+    REQUIRE_VALUE(mixer);
+    static struct bj_oscillator oscillators[BENCH_VOICES];
+    for (int v = 0; v < BENCH_VOICES; ++v) {
+        bj_init_oscillator(&oscillators[v], BJ_OSCILLATOR_SAWTOOTH, 110.0f * (float)(v + 1), 0.02f, BENCH_RATE);
+        bj_mixer_play_generator(mixer, bj_oscillator_generator, &oscillators[v], 1.0f, 0.0f);
+    }
+    bench_device(SM_CTX(), "mixer, 32 oscillators", bj_mixer_callback, mixer);
+    bj_destroy_mixer(mixer);
+
+    bj_set_null_audio_pacing(BJ_NULL_AUDIO_REALTIME, 0);
+    bj_end();
+    bj_set_audio_layer(0);
+}
+
+int main(int argc, char* argv[]) {
+    BEGIN_TESTS(argc, argv);
+
+    RUN_TEST(null_audio_callback_throughput);
+
+    END_TESTS();
+}
@@ -0,0 +1,57 @@
+#include "test.h"
+#include <banjo/audio.h>
+#include <banjo/system.h>
+#include <banjo/time.h>
+
+// Resampling throughput for common conversions, in output frames per second
+// and as the share of real time spent converting a stereo stream.
+
+#define BENCH_FRAMES 4096
+#define BENCH_REPS   50
+
+static float input[BENCH_FRAMES * 2];
+static float output[BENCH_FRAMES * 2 * 3];
+
+static void bench_conversion(Context* ctx, unsigned int from, unsigned int to, enum bj_resample_quality quality) {
+    struct bj_resampler* resampler = bj_create_resampler(2, from, to, quality);
+    if (resampler == 0) {
+        return;
+    }
+
+    size_t produced = 0;
+    struct bj_stopwatch sw = {0};
+    bj_reset_stopwatch(&sw);
+    for (int i = 0; i < BENCH_REPS; ++i) {
+        size_t consumed = 0;
+        produced += bj_resample(resampler, input, BENCH_FRAMES, &consumed, output, BENCH_FRAMES * 3);
+    }
+    const double elapsed = bj_stopwatch_elapsed(&sw);
+
+    const double rate = elapsed > 0.0 ? (double)produced / elapsed : 0.0;
+    PRINT(ctx, "  %6u -> %-6u %-6s %12.0f %7.3f%%\n", from, to,
+        quality == BJ_RESAMPLE_SINC ? "sinc" : "linear", rate, rate > 0.0 ? (double)to / rate * 100.0 : 0.0);
+    bj_destroy_resampler(resampler);
+}
+
+TEST_CASE(resampler_throughput) {
+    for (size_t i = 0; i < BENCH_FRAMES * 2; ++i) {
+        input[i] = (float)(i % 97) / 97.0f - 0.5f;
+    }
+
+    PRINT(SM_CTX(), "  %-16s %-6s %12s %8s\n", "rates", "filter", "frames/s", "load");
+    const unsigned int conversions[][2] = {{22050, 48000}, {44100, 48000}, {48000, 44100}};
+    for (size_t c = 0; c < 3; ++c) {
+        bench_conversion(SM_CTX(), conversions[c][0], conversions[c][1], BJ_RESAMPLE_LINEAR);
+        bench_conversion(SM_CTX(), conversions[c][0], conversions[c][1], BJ_RESAMPLE_SINC);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bj_begin(0, NULL);
+    BEGIN_TESTS(argc, argv);
+
+    RUN_TEST(resampler_throughput);
+
+    END_TESTS();
+    bj_end();
+}
@@ -0,0 +1,110 @@
+#include "test.h"
+#include <banjo/memory.h>
+#include <banjo/stream.h>
+#include <banjo/system.h>
+#include <banjo/time.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Load cost of a large file: opening it and reading every byte once, like
+// a decoder would, with the file mapped by bj_open_stream_file, with the
+// whole content copied to the heap first and with the file read by chunks
+// by bj_open_stream_file_buffered. Private resident memory is the resident
+// size minus file-backed pages (Linux only).
+
+#define BENCH_FILE "stress_stream_file.bin"
+#define BENCH_SIZE (32 * 1024 * 1024)
+
+static long private_kib(void) {
+#ifdef __linux__
+  long size = 0, resident = 0, shared = 0;
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (statm != 0) {
+    if (fscanf(statm, "%ld %ld %ld", &size, &resident, &shared) != 3) {
+      resident = shared = 0;
+    }
+    fclose(statm);
+  }
+  return (resident - shared) * 4;
+#else
+  return 0;
+#endif
+}
+
+// The previous implementation of bj_open_stream_file, with the system
+// allocator: the test allocators would clear the buffer
+static struct bj_stream *open_copied(void) {
+  FILE *file = fopen(BENCH_FILE, "rb");
+  if (file == 0) {
+    return 0;
+  }
+  void *buffer = malloc(BENCH_SIZE);
+  const size_t read = buffer ? fread(buffer, 1, BENCH_SIZE, file) : 0;
+  fclose(file);
+  return bj_open_stream_read(buffer, read);
+}
+
+enum load_path { LOAD_COPIED, LOAD_MAPPED, LOAD_BUFFERED };
+
+static void bench_load(Context *ctx, const char *name, enum load_path path) {
+  const long before = private_kib();
+  struct bj_stopwatch sw = {0};
+  bj_reset_stopwatch(&sw);
+
+  struct bj_stream *stream = path == LOAD_COPIED   ? open_copied()
+                             : path == LOAD_MAPPED ? bj_open_stream_file(BENCH_FILE, 0)
+                                                   : bj_open_stream_file_buffered(BENCH_FILE, 0, 0);
+  if (stream == 0) {
+    return;
+  }
+  const void *copy = bj_get_stream_data(stream);
+  unsigned checksum = 0;
+  const void *span = 0;
+  size_t available = 0;
+  while ((available = bj_peek_stream(stream, 4096, &span)) > 0) {
+    for (size_t i = 0; i < available; i += 64) {
+      checksum += ((const uint8_t *)span)[i];
+    }
+    bj_consume_stream(stream, available);
+  }
+  const double elapsed = bj_stopwatch_elapsed(&sw);
+  const long growth = private_kib() - before;
+
+  if (path == LOAD_COPIED) {
+    free((void *)copy);
+  }
+  bj_close_stream(stream);
+  PRINT(ctx, "  %-8s %10.2f %14ld   (checksum %u)\n", name, elapsed * 1000.0, growth, checksum);
+}
+
+TEST_CASE(stream_file_load) {
+  FILE *file = fopen(BENCH_FILE, "wb");
+  REQUIRE_VALUE(file);
+  static uint8_t chunk[64 * 1024];
+  for (size_t i = 0; i < sizeof(chunk); ++i) {
+    chunk[i] = (uint8_t)(i * 7);
+  }
+  for (size_t written = 0; written < BENCH_SIZE; written += sizeof(chunk)) {
+    fwrite(chunk, 1, sizeof(chunk), file);
+  }
+  fclose(file);
+
+  PRINT(SM_CTX(), "  %-8s %10s %14s\n", "path", "ms", "private KiB");
+  for (int run = 0; run < 2; ++run) {
+    bench_load(SM_CTX(), "copied", LOAD_COPIED);
+    bench_load(SM_CTX(), "mapped", LOAD_MAPPED);
+    bench_load(SM_CTX(), "buffered", LOAD_BUFFERED);
+  }
+  remove(BENCH_FILE);
+}
+
+int main(int argc, char *argv[]) {
+  bj_begin(0, NULL);
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(stream_file_load);
+
+  END_TESTS();
+  bj_end();
+}
@@ -0,0 +1,98 @@
+#include "test.h"
+#include <banjo/memory.h>
+#include <banjo/system.h>
+#include <banjo/time.h>
+#include <banjo/wav.h>
+
+// Decoding cost of one 512-frame period for each supported encoding, on a
+// stereo track held in memory, compared with the duration of that period.
+
+#define BENCH_FRAMES  512
+#define BENCH_RATE    44100
+#define TRACK_BYTES   (1024 * 1024)
+#define HEADER_BYTES  44
+
+static void put16(uint8_t* at, uint16_t value) {
+    at[0] = (uint8_t)value;
+    at[1] = (uint8_t)(value >> 8);
+}
+
+static void put32(uint8_t* at, uint32_t value) {
+    put16(at, (uint16_t)value);
+    put16(at + 2, (uint16_t)(value >> 16));
+}
+
+// Canonical 44-byte header followed by TRACK_BYTES of noise. Any byte
+// sequence is valid sample data for these encodings.
+static uint8_t* make_track(uint16_t tag, uint16_t block_align, uint16_t bits) {
+    uint8_t* file = bj_malloc(HEADER_BYTES + TRACK_BYTES);
+    if (file == 0) {
+        return 0;
+    }
+    bj_memcpy(file, "RIFF", 4);
+    put32(file + 4, HEADER_BYTES - 8 + TRACK_BYTES);
+    bj_memcpy(file + 8, "WAVEfmt ", 8);
+    put32(file + 16, 16);
+    put16(file + 20, tag);
+    put16(file + 22, 2);
+    put32(file + 24, BENCH_RATE);
+    put32(file + 28, BENCH_RATE * 4u);
+    put16(file + 32, block_align);
+    put16(file + 34, bits);
+    bj_memcpy(file + 36, "data", 4);
+    put32(file + 40, TRACK_BYTES);
+
+    uint32_t seed = 1u;
+    for (size_t i = 0; i < TRACK_BYTES; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        file[HEADER_BYTES + i] = (uint8_t)(seed >> 24);
+    }
+    if (tag == 3) {
+        // Keeps the floats finite
+        for (size_t i = 3; i < TRACK_BYTES; i += 4) {
+            file[HEADER_BYTES + i] &= 0x3F;
+        }
+    }
+    return file;
+}
+
+static void bench_encoding(Context* ctx, const char* name, uint16_t tag, uint16_t block_align, uint16_t bits) {
+    uint8_t* file = make_track(tag, block_align, bits);
+    struct bj_stream* stream = bj_open_stream_read(file, HEADER_BYTES + TRACK_BYTES);
+    struct bj_wav* wav = bj_open_wav(stream, 0);
+    static uint8_t period[BENCH_FRAMES * 2 * sizeof(float)];
+
+    if (wav != 0) {
+        size_t periods = 0;
+        struct bj_stopwatch sw = {0};
+        bj_reset_stopwatch(&sw);
+        while (bj_read_wav(wav, period, BENCH_FRAMES) == BENCH_FRAMES) {
+            ++periods;
+        }
+        const double elapsed = bj_stopwatch_elapsed(&sw);
+        const double period_us = (double)BENCH_FRAMES / BENCH_RATE * 1e6;
+        const double us = periods > 0 ? elapsed / (double)periods * 1e6 : 0.0;
+        PRINT(ctx, "  %-10s %8zu %9.2f %8.3f%%\n", name, periods, us, us / period_us * 100.0);
+    }
+
+    bj_close_wav(wav);
+    bj_close_stream(stream);
+    bj_free(file);
+}
+
+TEST_CASE(wav_decode_period_cost) {
+    PRINT(SM_CTX(), "  %-10s %8s %9s %9s\n", "encoding", "periods", "us", "load");
+    bench_encoding(SM_CTX(), "pcm16", 1, 4, 16);
+    bench_encoding(SM_CTX(), "f32", 3, 8, 32);
+    bench_encoding(SM_CTX(), "ima-adpcm", 0x11, 2048, 4);
+}
+
+int main(int argc, char* argv[]) {
+    bj_begin(0, NULL);
+    BEGIN_TESTS(argc, argv);
+
+    RUN_TEST(wav_decode_period_cost);
+
+    END_TESTS();
+    bj_end();
+}
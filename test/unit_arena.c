@@ -0,0 +1,159 @@
+#include "test.h"
+#include <banjo/bitmap.h>
+#include <banjo/memory.h>
+
+#include <stdint.h>
+
+TEST_CASE(arena_allocations_are_aligned_and_distinct) {
+  struct bj_arena *arena = bj_create_arena(256);
+  REQUIRE_VALUE(arena);
+
+  unsigned char *a = bj_arena_allocate(arena, 3);
+  unsigned char *b = bj_arena_allocate(arena, 17);
+  unsigned char *c = bj_arena_allocate(arena, 1000); // Own block
+  unsigned char *d = bj_arena_allocate(arena, 8);
+  REQUIRE(a && b && c && d);
+
+  CHECK_EQ((uintptr_t)a % 16, 0);
+  CHECK_EQ((uintptr_t)b % 16, 0);
+  CHECK_EQ((uintptr_t)c % 16, 0);
+  CHECK(b >= a + 3);
+  bj_memset(c, 0xAB, 1000);
+  bj_memset(d, 0xCD, 8);
+  CHECK_EQ(c[999], 0xAB);
+  CHECK_EQ(d[0], 0xCD);
+
+  bj_destroy_arena(arena);
+}
+
+TEST_CASE(arena_rejects_sizes_that_overflow) {
+  struct bj_arena *arena = bj_create_arena(256);
+  REQUIRE_VALUE(arena);
+  CHECK_NULL(bj_arena_allocate(arena, SIZE_MAX));
+  CHECK_NULL(bj_arena_allocate(arena, SIZE_MAX - 8));
+  CHECK_VALUE(bj_arena_allocate(arena, 8));
+  bj_destroy_arena(arena);
+}
+
+TEST_CASE(arena_rewinds_to_marks) {
+  struct bj_arena *arena = bj_create_arena(128);
+  REQUIRE_VALUE(arena);
+  CHECK_EQ(bj_arena_mark(arena), 0);
+
+  void *kept = bj_arena_allocate(arena, 32);
+  const size_t mark = bj_arena_mark(arena);
+  CHECK_EQ(mark, 32);
+
+  // Spans several blocks after the mark
+  void *first = bj_arena_allocate(arena, 64);
+  for (int i = 0; i < 10; ++i) {
+    bj_arena_allocate(arena, 100);
+  }
+  CHECK(bj_arena_mark(arena) > mark);
+
+  bj_rewind_arena(arena, mark);
+  CHECK_EQ(bj_arena_mark(arena), mark);
+  CHECK(bj_arena_allocate(arena, 64) == first);
+
+  // Reset keeps the blocks: the same addresses come back
+  bj_reset_arena(arena);
+  CHECK_EQ(bj_arena_mark(arena), 0);
+  CHECK(bj_arena_allocate(arena, 32) == kept);
+
+  bj_destroy_arena(arena);
+}
+
+TEST_CASE(arena_callbacks_serve_default_allocations) {
+  struct bj_arena *arena = bj_create_arena(1024);
+  REQUIRE_VALUE(arena);
+  struct bj_memory_callbacks callbacks;
+  bj_arena_callbacks(arena, &callbacks);
+  bj_set_memory_defaults(&callbacks);
+
+  char *text = bj_malloc(4);
+  REQUIRE_VALUE(text);
+  bj_memcpy(text, "abc", 4);
+
+  // The last allocation grows in place and keeps its content
+  char *grown = bj_realloc(text, 200);
+  CHECK(grown == text);
+  CHECK_EQ(bj_memcmp(grown, "abc", 4), 0);
+
+  // Other blocks are copied
+  char *other = bj_malloc(8);
+  char *moved = bj_realloc(grown, 300);
+  CHECK(moved != grown);
+  CHECK_EQ(bj_memcmp(moved, "abc", 4), 0);
+
+  // Freeing the last allocation gives its memory back
+  const size_t before = bj_arena_mark(arena);
+  bj_free(bj_malloc(40));
+  CHECK_EQ(bj_arena_mark(arena), before);
+  bj_free(other);
+
+  bj_unset_memory_defaults();
+  bj_destroy_arena(arena);
+}
+
+TEST_CASE(arena_defaults_do_not_leak_into_the_pool) {
+  // Keeps the pool cache of this thread alive across the arena phase
+  struct bj_bitmap *kept = bj_create_bitmap(1, 1, BJ_PIXEL_MODE_XRGB8888, 0);
+  REQUIRE_VALUE(kept);
+
+  struct bj_arena *arena = bj_create_arena(1 << 16);
+  REQUIRE_VALUE(arena);
+  struct bj_memory_callbacks callbacks;
+  bj_arena_callbacks(arena, &callbacks);
+  bj_set_memory_defaults(&callbacks);
+  struct bj_bitmap *temporary[400];
+  for (int i = 0; i < 400; ++i) {
+    temporary[i] = bj_create_bitmap(1, 1, BJ_PIXEL_MODE_XRGB8888, 0);
+  }
+  for (int i = 0; i < 400; ++i) {
+    bj_destroy_bitmap(temporary[i]);
+  }
+  bj_unset_memory_defaults();
+  bj_reset_arena(arena);
+
+  // The next bitmap must not live in memory the arena hands out again
+  struct bj_bitmap *bitmap = bj_create_bitmap(1, 1, BJ_PIXEL_MODE_XRGB8888, 0);
+  REQUIRE_VALUE(bitmap);
+  for (int i = 0; i < 256; ++i) {
+    unsigned char *reused = bj_arena_allocate(arena, 1024);
+    REQUIRE_VALUE(reused);
+    bj_memset(reused, 0xFF, 1024);
+  }
+  CHECK_EQ(bj_bitmap_width(bitmap), 1);
+  CHECK_EQ(bj_bitmap_mode(bitmap), BJ_PIXEL_MODE_XRGB8888);
+
+  bj_destroy_bitmap(bitmap);
+  bj_destroy_arena(arena);
+  bj_destroy_bitmap(kept);
+}
+
+TEST_CASE(frame_memory_is_reset_per_frame) {
+  void *first = bj_frame_allocate(100);
+  REQUIRE_VALUE(first);
+  REQUIRE_VALUE(bj_frame_allocate(100));
+  CHECK(bj_arena_mark(bj_frame_arena()) >= 200);
+
+  bj_reset_frame_memory();
+  CHECK_EQ(bj_arena_mark(bj_frame_arena()), 0);
+  CHECK(bj_frame_allocate(100) == first);
+
+  bj_release_frame_memory();
+  bj_reset_frame_memory(); // No arena: nothing to do
+}
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(arena_allocations_are_aligned_and_distinct);
+  RUN_TEST(arena_rejects_sizes_that_overflow);
+  RUN_TEST(arena_rewinds_to_marks);
+  RUN_TEST(arena_callbacks_serve_default_allocations);
+  RUN_TEST(arena_defaults_do_not_leak_into_the_pool);
+  RUN_TEST(frame_memory_is_reset_per_frame);
+
+  END_TESTS();
+}
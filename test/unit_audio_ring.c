@@ -0,0 +1,141 @@
+#include "test.h"
+#include <banjo/audio.h>
+
+#include "thread.h"
+
+static const struct bj_audio_properties stereo16 = {
+    .format = BJ_AUDIO_FORMAT_INT16,
+    .amplitude = 16000,
+    .channels = 2,
+    .sample_rate = 44100,
+};
+
+TEST_CASE(audio_ring_capacity_is_power_of_two) {
+  struct bj_audio_ring *ring = bj_create_audio_ring(&stereo16, 100);
+  REQUIRE_VALUE(ring);
+  CHECK_EQ(bj_audio_ring_writable(ring), 128);
+  CHECK_EQ(bj_audio_ring_readable(ring), 0);
+  bj_destroy_audio_ring(ring);
+
+  const struct bj_audio_properties unknown = {.channels = 2};
+  CHECK_NULL(bj_create_audio_ring(&unknown, 16));
+  CHECK_NULL(bj_create_audio_ring(&stereo16, 0));
+}
+
+TEST_CASE(audio_ring_wraps_around) {
+  struct bj_audio_ring *ring = bj_create_audio_ring(&stereo16, 8);
+  REQUIRE_VALUE(ring);
+
+  int16_t in[2 * 12];
+  int16_t out[2 * 12] = {0};
+  for (int i = 0; i < 2 * 12; ++i) {
+    in[i] = (int16_t)(i + 1);
+  }
+
+  // Moves the indices near the end, then writes across the boundary
+  CHECK_EQ(bj_audio_ring_write(ring, in, 6), 6);
+  CHECK_EQ(bj_audio_ring_read(ring, out, 6), 6);
+  CHECK_EQ(bj_audio_ring_write(ring, in, 12), 8);
+  CHECK_EQ(bj_audio_ring_writable(ring), 0);
+  CHECK_EQ(bj_audio_ring_read(ring, out, 12), 8);
+
+  int same = 1;
+  for (int i = 0; i < 2 * 8; ++i) {
+    same &= out[i] == in[i];
+  }
+  CHECK(same);
+  CHECK_EQ(bj_audio_ring_read(ring, out, 1), 0);
+
+  bj_destroy_audio_ring(ring);
+}
+
+TEST_CASE(audio_ring_callback_pads_with_silence) {
+  struct bj_audio_ring *ring = bj_create_audio_ring(&stereo16, 16);
+  REQUIRE_VALUE(ring);
+
+  const int16_t in[2 * 3] = {1, 2, 3, 4, 5, 6};
+  bj_audio_ring_write(ring, in, 3);
+
+  int16_t out[2 * 5];
+  for (int i = 0; i < 2 * 5; ++i) {
+    out[i] = -1;
+  }
+  bj_audio_ring_callback(out, 5, &stereo16, ring, 0);
+
+  CHECK_EQ(out[0], 1);
+  CHECK_EQ(out[5], 6);
+  CHECK_EQ(out[6], 0);
+  CHECK_EQ(out[9], 0);
+
+  // Mismatching format: silence, nothing consumed
+  const struct bj_audio_properties mono32 = {
+      .format = BJ_AUDIO_FORMAT_F32, .channels = 1, .sample_rate = 44100};
+  bj_audio_ring_write(ring, in, 2);
+  float silence[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  bj_audio_ring_callback(silence, 2, &mono32, ring, 0);
+  CHECK(silence[0] == 0.0f && silence[1] == 0.0f);
+  CHECK_EQ(bj_audio_ring_readable(ring), 2);
+
+  bj_destroy_audio_ring(ring);
+}
+
+#define STREAM_FRAMES 20000
+
+struct stream_check {
+  struct bj_audio_ring *ring;
+  bj_bool ordered;
+};
+
+// Reads the whole counter sequence in uneven chunks
+static void consumer(void *data) {
+  struct stream_check *check = data;
+  int16_t chunk[2 * 37];
+  uint32_t expected = 0;
+  while (expected < STREAM_FRAMES) {
+    const size_t count = bj_audio_ring_read(check->ring, chunk, 37);
+    for (size_t i = 0; i < count; ++i, ++expected) {
+      if (chunk[2 * i] != (int16_t)expected ||
+          chunk[2 * i + 1] != (int16_t)~expected) {
+        check->ordered = BJ_FALSE;
+      }
+    }
+  }
+}
+
+TEST_CASE(audio_ring_two_threads_keep_order) {
+  struct stream_check check = {
+      .ring = bj_create_audio_ring(&stereo16, 256),
+      .ordered = BJ_TRUE,
+  };
+  REQUIRE_VALUE(check.ring);
+
+  struct bj_thread *thread = bj_thread_create(consumer, &check);
+  REQUIRE_VALUE(thread);
+
+  int16_t chunk[2 * 29];
+  uint32_t next = 0;
+  while (next < STREAM_FRAMES) {
+    size_t count = STREAM_FRAMES - next < 29 ? STREAM_FRAMES - next : 29;
+    for (size_t i = 0; i < count; ++i) {
+      chunk[2 * i] = (int16_t)(next + i);
+      chunk[2 * i + 1] = (int16_t)~(next + i);
+    }
+    next += (uint32_t)bj_audio_ring_write(check.ring, chunk, count);
+  }
+
+  bj_thread_join(thread);
+  CHECK(check.ordered);
+  CHECK_EQ(bj_audio_ring_readable(check.ring), 0);
+  bj_destroy_audio_ring(check.ring);
+}
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(audio_ring_capacity_is_power_of_two);
+  RUN_TEST(audio_ring_wraps_around);
+  RUN_TEST(audio_ring_callback_pads_with_silence);
+  RUN_TEST(audio_ring_two_threads_keep_order);
+
+  END_TESTS();
+}
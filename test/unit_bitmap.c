@@ -2,6 +2,9 @@
 #include <banjo/bitmap.h>
 #include <banjo/memory.h>
 
+#include <stdio.h>
+#include <stdlib.h>
+
 ////////////////////////////////////////////////////////////////////////////////
 // Creation Tests
 ////////////////////////////////////////////////////////////////////////////////
@@ -255,6 +258,38 @@ TEST_CASE(bitmap_stride_custom_accepted) {
     bj_destroy_bitmap(bmp);
 }
 
+TEST_CASE(bitmap_aligned_rows) {
+    // 3 bytes per pixel: the packed stride (32) is not a multiple of 64
+    struct bj_bitmap* bmp = bj_create_aligned_bitmap(10, 7, BJ_PIXEL_MODE_BGR24, 0);
+    REQUIRE_VALUE(bmp);
+    REQUIRE_EQ(bj_bitmap_stride(bmp), BJ_BITMAP_ALIGNMENT);
+    REQUIRE_EQ((uintptr_t)bj_bitmap_pixels(bmp) % BJ_BITMAP_ALIGNMENT, 0);
+    REQUIRE(bj_bitmap_alignment(bmp) >= BJ_BITMAP_ALIGNMENT);
+
+    struct bj_bitmap* copy = bj_copy_bitmap(bmp);
+    REQUIRE_VALUE(copy);
+    REQUIRE(bj_bitmap_alignment(copy) >= BJ_BITMAP_ALIGNMENT);
+
+    struct bj_bitmap* wide = bj_create_aligned_bitmap(100, 2, BJ_PIXEL_MODE_XRGB8888, 256);
+    REQUIRE_VALUE(wide);
+    REQUIRE_EQ(bj_bitmap_stride(wide), 512);
+    REQUIRE(bj_bitmap_alignment(wide) >= 256);
+
+    REQUIRE_NULL(bj_create_aligned_bitmap(10, 10, BJ_PIXEL_MODE_XRGB8888, 48));
+
+    bj_destroy_bitmap(wide);
+    bj_destroy_bitmap(copy);
+    bj_destroy_bitmap(bmp);
+}
+
+TEST_CASE(bitmap_alignment_of_odd_stride) {
+    // Rows of 18 bytes are padded to 20: the guarantee is 4 bytes
+    struct bj_bitmap* bmp = bj_create_bitmap(6, 5, BJ_PIXEL_MODE_BGR24, 0);
+    REQUIRE_VALUE(bmp);
+    REQUIRE_EQ(bj_bitmap_alignment(bmp), 4);
+    bj_destroy_bitmap(bmp);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Blit Tests
 ////////////////////////////////////////////////////////////////////////////////
@@ -366,6 +401,193 @@ TEST_CASE(bitmap_from_file_null_error_is_safe) {
     REQUIRE_NULL(bmp);
 }
 
+// Writes a 3x2 8bpp bottom-up BMP whose palette holds red and blue
+static bj_bool write_indexed_bmp(const char* path, uint32_t compression, const uint8_t* raster, size_t raster_size) {
+    uint8_t bmp[256] = {0};
+    const size_t offset = 14 + 40 + 2 * 4;
+    const size_t size   = offset + raster_size;
+    const uint32_t fields[] = {
+        (uint32_t)size, 0, (uint32_t)offset,    // File header, after the signature
+        40, 3, 2, 1 | (8 << 16), compression,   // Info header
+        (uint32_t)raster_size, 0, 0, 2, 0,
+    };
+    bmp[0] = 'B';
+    bmp[1] = 'M';
+    for (size_t f = 0; f < sizeof(fields) / sizeof(fields[0]); ++f) {
+        for (size_t b = 0; b < 4; ++b) {
+            bmp[2 + f * 4 + b] = (uint8_t)(fields[f] >> (8 * b));
+        }
+    }
+    const uint8_t palette[] = {0, 0, 255, 0, 255, 0, 0, 0}; // BGRX
+    bj_memcpy(bmp + 54, palette, sizeof(palette));
+    bj_memcpy(bmp + offset, raster, raster_size);
+
+    FILE* file = fopen(path, "wb");
+    if (file == 0) {
+        return BJ_FALSE;
+    }
+    const bj_bool written = fwrite(bmp, 1, size, file) == size;
+    fclose(file);
+    return written;
+}
+
+// Whether the file loads as BGR24 with a red, blue, red top row over a
+// blue bottom row
+static bj_bool indexed_bmp_matches(const char* path) {
+    struct bj_bitmap* bmp = bj_create_bitmap_from_file(path, 0);
+    if (bmp == 0) {
+        return BJ_FALSE;
+    }
+
+    const uint8_t is_blue[2][3] = {{0, 1, 0}, {1, 1, 1}};
+    bj_bool matches = bj_bitmap_mode(bmp) == BJ_PIXEL_MODE_BGR24;
+    for (size_t y = 0; y < 2; ++y) {
+        for (size_t x = 0; x < 3; ++x) {
+            uint8_t r, g, b;
+            bj_make_pixel_rgb(bj_bitmap_mode(bmp), bj_bitmap_pixel(bmp, x, y), &r, &g, &b);
+            matches &= r == (is_blue[y][x] ? 0 : 255) && g == 0 && b == (is_blue[y][x] ? 255 : 0);
+        }
+    }
+    bj_destroy_bitmap(bmp);
+    return matches;
+}
+
+TEST_CASE(bitmap_from_indexed_file) {
+    const uint8_t raster[] = {
+        1, 1, 1, 0,
+        0, 1, 0, 0,
+    };
+    REQUIRE(write_indexed_bmp("unit_bitmap_indexed.bmp", 0, raster, sizeof(raster)));
+    CHECK(indexed_bmp_matches("unit_bitmap_indexed.bmp"));
+    remove("unit_bitmap_indexed.bmp");
+}
+
+TEST_CASE(bitmap_from_rle8_file) {
+    const uint8_t raster[] = {
+        3, 1, 0, 0,             // Run of blue, end of line
+        0, 3, 0, 1, 0, 0,       // Absolute red, blue, red and padding
+        0, 1,                   // End of bitmap
+    };
+    REQUIRE(write_indexed_bmp("unit_bitmap_rle8.bmp", 1, raster, sizeof(raster)));
+    CHECK(indexed_bmp_matches("unit_bitmap_rle8.bmp"));
+    remove("unit_bitmap_rle8.bmp");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// File Saving Tests
+////////////////////////////////////////////////////////////////////////////////
+
+// Writes a 5x3 gradient in `mode`, saves and loads it back, and returns
+// whether all colors are within `tolerance` of the original ones
+static bj_bool saved_bitmap_matches(enum bj_pixel_mode mode, int tolerance) {
+    struct bj_bitmap* original = bj_create_bitmap(5, 3, mode, 0);
+    if (original == 0) {
+        return BJ_FALSE;
+    }
+    for (size_t y = 0; y < 3; ++y) {
+        for (size_t x = 0; x < 5; ++x) {
+            bj_put_pixel(original, x, y, bj_make_bitmap_pixel(original,
+                (uint8_t)(x * 40), (uint8_t)(y * 60), (uint8_t)(200 - x * 10)));
+        }
+    }
+
+    const bj_bool saved = bj_write_bitmap_to_file(original, "unit_bitmap_saved.bmp", 0);
+    struct bj_bitmap* loaded = bj_create_bitmap_from_file("unit_bitmap_saved.bmp", 0);
+    remove("unit_bitmap_saved.bmp");
+
+    bj_bool matches = saved && loaded != 0
+        && bj_bitmap_width(loaded) == 5 && bj_bitmap_height(loaded) == 3;
+    for (size_t y = 0; y < 3 && matches; ++y) {
+        for (size_t x = 0; x < 5; ++x) {
+            uint8_t r0, g0, b0, r1, g1, b1;
+            bj_make_bitmap_rgb(original, x, y, &r0, &g0, &b0);
+            bj_make_bitmap_rgb(loaded, x, y, &r1, &g1, &b1);
+            matches &= abs(r0 - r1) <= tolerance && abs(g0 - g1) <= tolerance && abs(b0 - b1) <= tolerance;
+        }
+    }
+
+    bj_destroy_bitmap(loaded);
+    bj_destroy_bitmap(original);
+    return matches;
+}
+
+TEST_CASE(bitmap_save_direct_color_modes) {
+    CHECK(saved_bitmap_matches(BJ_PIXEL_MODE_XRGB8888, 0));
+    CHECK(saved_bitmap_matches(BJ_PIXEL_MODE_BGR24, 0));
+    CHECK(saved_bitmap_matches(BJ_PIXEL_MODE_RGB565, 7));
+    CHECK(saved_bitmap_matches(BJ_PIXEL_MODE_XRGB1555, 7));
+}
+
+#ifdef __linux__
+TEST_CASE(bitmap_save_reports_full_disk) {
+    struct bj_bitmap* bmp = bj_create_bitmap(5, 3, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(bmp);
+    struct bj_error* error = 0;
+    CHECK(!bj_write_bitmap_to_file(bmp, "/dev/full", &error));
+    CHECK_VALUE(error);
+    bj_clear_error(&error);
+    bj_destroy_bitmap(bmp);
+}
+#endif
+
+TEST_CASE(bitmap_save_indexed_as_rle8) {
+    // Long runs, short runs and literals
+    const uint8_t indices[2][12] = {
+        {7, 7, 7, 7, 7, 7, 1, 2, 3, 4, 5, 5},
+        {0, 9, 0, 9, 9, 200, 200, 200, 201, 202, 203, 255},
+    };
+    struct bj_bitmap* original = bj_create_bitmap(12, 2, BJ_PIXEL_MODE_INDEXED_8, 0);
+    REQUIRE_VALUE(original);
+    for (size_t y = 0; y < 2; ++y) {
+        bj_memcpy((uint8_t*)bj_bitmap_pixels(original) + y * bj_bitmap_stride(original), indices[y], 12);
+    }
+
+    struct bj_stream* stream = bj_open_stream_write(0, 0);
+    REQUIRE_VALUE(stream);
+    REQUIRE(bj_write_bitmap_to_stream(original, stream, 0));
+    const uint8_t* bmp = bj_get_stream_data(stream);
+    REQUIRE_EQ(bmp[0], 'B');
+    REQUIRE_EQ(bmp[1], 'M');
+    REQUIRE_EQ(bmp[2] | (bmp[3] << 8), bj_get_stream_length(stream));
+    REQUIRE_EQ(bmp[30], 1); // RLE8
+    bj_close_stream(stream);
+
+    REQUIRE(bj_write_bitmap_to_file(original, "unit_bitmap_saved.bmp", 0));
+    struct bj_bitmap* loaded = bj_create_bitmap_from_file("unit_bitmap_saved.bmp", 0);
+    remove("unit_bitmap_saved.bmp");
+    REQUIRE_VALUE(loaded);
+
+    // The palette is grayscale
+    bj_bool same = BJ_TRUE;
+    for (size_t y = 0; y < 2; ++y) {
+        for (size_t x = 0; x < 12; ++x) {
+            uint8_t r, g, b;
+            bj_make_bitmap_rgb(loaded, x, y, &r, &g, &b);
+            same &= r == indices[y][x] && g == indices[y][x] && b == indices[y][x];
+        }
+    }
+    CHECK(same);
+
+    bj_destroy_bitmap(loaded);
+    bj_destroy_bitmap(original);
+}
+
+TEST_CASE(bitmap_save_to_read_stream_fails) {
+    struct bj_bitmap* bmp = bj_create_bitmap(2, 2, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(bmp);
+    const uint8_t data[4] = {0};
+    struct bj_stream* stream = bj_open_stream_read(data, sizeof(data));
+    REQUIRE_VALUE(stream);
+
+    struct bj_error* err = 0;
+    REQUIRE(!bj_write_bitmap_to_stream(bmp, stream, &err));
+    REQUIRE_VALUE(err);
+
+    bj_clear_error(&err);
+    bj_close_stream(stream);
+    bj_destroy_bitmap(bmp);
+}
+
 int main(int argc, char* argv[]) {
     BEGIN_TESTS(argc, argv);
 
@@ -394,6 +616,8 @@ int main(int argc, char* argv[]) {
     // Stride
     RUN_TEST(bitmap_stride_minimum_computed);
     RUN_TEST(bitmap_stride_custom_accepted);
+    RUN_TEST(bitmap_aligned_rows);
+    RUN_TEST(bitmap_alignment_of_odd_stride);
 
     // Blit
     RUN_TEST(blit_same_size_copies);
@@ -407,6 +631,16 @@ int main(int argc, char* argv[]) {
     // File loading
     RUN_TEST(bitmap_from_invalid_file_returns_error);
     RUN_TEST(bitmap_from_file_null_error_is_safe);
+    RUN_TEST(bitmap_from_indexed_file);
+    RUN_TEST(bitmap_from_rle8_file);
+
+    // File saving
+    RUN_TEST(bitmap_save_direct_color_modes);
+#ifdef __linux__
+    RUN_TEST(bitmap_save_reports_full_disk);
+#endif
+    RUN_TEST(bitmap_save_indexed_as_rle8);
+    RUN_TEST(bitmap_save_to_read_stream_fails);
 
     END_TESTS();
 }
@@ -0,0 +1,235 @@
+#include "test.h"
+#include <banjo/bitmap.h>
+#include <banjo/bitmap_loader.h>
+#include <banjo/memory.h>
+#include <banjo/time.h>
+
+#include "atomic.h"
+
+#include <stdio.h>
+
+// The test allocators are not thread-safe: workers allocate while the main
+// thread submits and polls, so the allocators are serialized here.
+static struct bj_memory_callbacks s_unlocked;
+static volatile uint32_t          s_lock = 0;
+
+static void lock(void) {
+    while (bj_atomic_exchange_u32(&s_lock, 1) != 0) {
+    }
+}
+
+static void unlock(void) {
+    bj_atomic_store_u32(&s_lock, 0);
+}
+
+static void* locked_malloc(void* user_data, size_t size) {
+    (void)user_data;
+    lock();
+    void* memory = s_unlocked.fn_allocation(s_unlocked.user_data, size);
+    unlock();
+    return memory;
+}
+
+static void* locked_realloc(void* user_data, void* original, size_t size) {
+    (void)user_data;
+    lock();
+    void* memory = s_unlocked.fn_reallocation(s_unlocked.user_data, original, size);
+    unlock();
+    return memory;
+}
+
+static void locked_free(void* user_data, void* memory) {
+    (void)user_data;
+    lock();
+    s_unlocked.fn_free(s_unlocked.user_data, memory);
+    unlock();
+}
+
+// Writes a `width` x 2 XRGB8888 BMP whose pixels are all `red`
+static bj_bool write_bmp(const char* path, size_t width, uint8_t red) {
+    struct bj_bitmap* bmp = bj_create_bitmap(width, 2, BJ_PIXEL_MODE_XRGB8888, 0);
+    if (bmp == 0) {
+        return BJ_FALSE;
+    }
+    bj_set_bitmap_color(bmp, bj_make_bitmap_pixel(bmp, red, 0, 0), BJ_BITMAP_CLEAR_COLOR);
+    bj_clear_bitmap(bmp);
+    const bj_bool written = bj_write_bitmap_to_file(bmp, path, 0);
+    bj_destroy_bitmap(bmp);
+    return written;
+}
+
+// Waits until the load leaves the `from` status, at most 5 seconds
+static enum bj_bitmap_load_status wait_status(struct bj_bitmap_loader* loader, uint32_t id, enum bj_bitmap_load_status from) {
+    enum bj_bitmap_load_status status = bj_get_bitmap_load_status(loader, id);
+    for (int waited = 0; status == from && waited < 5000; ++waited) {
+        bj_sleep(1);
+        status = bj_get_bitmap_load_status(loader, id);
+    }
+    return status;
+}
+
+static enum bj_bitmap_load_status wait_finished(struct bj_bitmap_loader* loader, uint32_t id) {
+    const enum bj_bitmap_load_status status = wait_status(loader, id, BJ_BITMAP_LOAD_QUEUED);
+    return status == BJ_BITMAP_LOAD_LOADING ? wait_status(loader, id, BJ_BITMAP_LOAD_LOADING) : status;
+}
+
+TEST_CASE(loader_loads_and_converts) {
+    REQUIRE(write_bmp("unit_loader_a.bmp", 4, 200));
+
+    struct bj_bitmap_loader* loader = bj_create_bitmap_loader(2, 0);
+    REQUIRE_VALUE(loader);
+
+    int tag = 0;
+    const uint32_t id = bj_submit_bitmap_load(loader, "unit_loader_a.bmp", BJ_PIXEL_MODE_RGB565, &tag);
+    REQUIRE(id != 0);
+    REQUIRE_EQ(wait_finished(loader, id), BJ_BITMAP_LOAD_DONE);
+    CHECK(bj_bitmap_loader_memory(loader) > 0);
+
+    struct bj_bitmap_load load;
+    REQUIRE(bj_poll_bitmap_loader(loader, &load));
+    CHECK_EQ(load.id, id);
+    CHECK_EQ(load.status, BJ_BITMAP_LOAD_DONE);
+    CHECK(load.user_data == &tag);
+    CHECK_NULL(load.error);
+    REQUIRE_VALUE(load.bitmap);
+    CHECK_EQ(bj_bitmap_mode(load.bitmap), BJ_PIXEL_MODE_RGB565);
+    CHECK_EQ(bj_bitmap_width(load.bitmap), 4);
+
+    uint8_t r, g, b;
+    bj_make_bitmap_rgb(load.bitmap, 3, 1, &r, &g, &b);
+    CHECK(r >= 192 && r <= 207);
+    CHECK_EQ(g, 0);
+    bj_destroy_bitmap(load.bitmap);
+
+    // Polled loads are forgotten
+    CHECK_EQ(bj_get_bitmap_load_status(loader, id), BJ_BITMAP_LOAD_UNKNOWN);
+    CHECK_EQ(bj_bitmap_loader_memory(loader), 0);
+    CHECK(!bj_poll_bitmap_loader(loader, &load));
+
+    bj_destroy_bitmap_loader(loader);
+    remove("unit_loader_a.bmp");
+}
+
+TEST_CASE(loader_reports_failures) {
+    struct bj_bitmap_loader* loader = bj_create_bitmap_loader(1, 0);
+    REQUIRE_VALUE(loader);
+
+    const uint32_t id = bj_submit_bitmap_load(loader, "/nonexistent/image.bmp", BJ_PIXEL_MODE_UNKNOWN, 0);
+    REQUIRE_EQ(wait_finished(loader, id), BJ_BITMAP_LOAD_FAILED);
+
+    struct bj_bitmap_load load;
+    REQUIRE(bj_poll_bitmap_loader(loader, &load));
+    CHECK_EQ(load.status, BJ_BITMAP_LOAD_FAILED);
+    CHECK_NULL(load.bitmap);
+    CHECK_VALUE(load.error);
+    bj_clear_error(&load.error);
+
+    bj_destroy_bitmap_loader(loader);
+}
+
+TEST_CASE(loader_cancels_queued_loads) {
+    REQUIRE(write_bmp("unit_loader_a.bmp", 4, 10));
+
+    // A tiny budget keeps the first load waiting to be polled, which blocks
+    // the only worker on the second one
+    struct bj_bitmap_loader* loader = bj_create_bitmap_loader(1, 1);
+    REQUIRE_VALUE(loader);
+    const uint32_t first  = bj_submit_bitmap_load(loader, "unit_loader_a.bmp", BJ_PIXEL_MODE_UNKNOWN, 0);
+    const uint32_t second = bj_submit_bitmap_load(loader, "unit_loader_a.bmp", BJ_PIXEL_MODE_UNKNOWN, 0);
+    const uint32_t third  = bj_submit_bitmap_load(loader, "unit_loader_a.bmp", BJ_PIXEL_MODE_UNKNOWN, 0);
+    REQUIRE_EQ(wait_finished(loader, first), BJ_BITMAP_LOAD_DONE);
+    REQUIRE_EQ(wait_status(loader, second, BJ_BITMAP_LOAD_QUEUED), BJ_BITMAP_LOAD_LOADING);
+    CHECK_EQ(bj_get_bitmap_load_status(loader, third), BJ_BITMAP_LOAD_QUEUED);
+
+    CHECK(bj_cancel_bitmap_load(loader, third));
+    CHECK_EQ(bj_get_bitmap_load_status(loader, third), BJ_BITMAP_LOAD_CANCELLED);
+    CHECK(bj_cancel_bitmap_load(loader, second));
+    CHECK_EQ(wait_status(loader, second, BJ_BITMAP_LOAD_LOADING), BJ_BITMAP_LOAD_CANCELLED);
+    CHECK(!bj_cancel_bitmap_load(loader, first)); // Already done
+    CHECK(!bj_cancel_bitmap_load(loader, 1000));
+
+    // In the order they finished
+    struct bj_bitmap_load load;
+    REQUIRE(bj_poll_bitmap_loader(loader, &load));
+    CHECK_EQ(load.id, first);
+    CHECK_VALUE(load.bitmap);
+    bj_destroy_bitmap(load.bitmap);
+    REQUIRE(bj_poll_bitmap_loader(loader, &load));
+    CHECK_EQ(load.id, third);
+    CHECK_EQ(load.status, BJ_BITMAP_LOAD_CANCELLED);
+    REQUIRE(bj_poll_bitmap_loader(loader, &load));
+    CHECK_EQ(load.id, second);
+    CHECK_EQ(load.status, BJ_BITMAP_LOAD_CANCELLED);
+    CHECK_NULL(load.bitmap);
+    CHECK_EQ(bj_bitmap_loader_memory(loader), 0);
+
+    bj_destroy_bitmap_loader(loader);
+    remove("unit_loader_a.bmp");
+}
+
+TEST_CASE(loader_budget_bounds_memory_in_flight) {
+    REQUIRE(write_bmp("unit_loader_a.bmp", 64, 10));
+    REQUIRE(write_bmp("unit_loader_b.bmp", 64, 20));
+
+    // Room for one 64x2 XRGB8888 bitmap, with two workers
+    struct bj_bitmap_loader* loader = bj_create_bitmap_loader(2, 64 * 2 * 4);
+    REQUIRE_VALUE(loader);
+    const uint32_t a = bj_submit_bitmap_load(loader, "unit_loader_a.bmp", BJ_PIXEL_MODE_UNKNOWN, 0);
+    const uint32_t b = bj_submit_bitmap_load(loader, "unit_loader_b.bmp", BJ_PIXEL_MODE_UNKNOWN, 0);
+
+    // Whichever finishes first holds the budget until polled
+    uint32_t done = 0;
+    for (int waited = 0; done == 0 && waited < 5000; ++waited) {
+        done = bj_get_bitmap_load_status(loader, a) == BJ_BITMAP_LOAD_DONE ? a
+             : bj_get_bitmap_load_status(loader, b) == BJ_BITMAP_LOAD_DONE ? b : 0;
+        bj_sleep(1);
+    }
+    REQUIRE(done != 0);
+    const uint32_t other = done == a ? b : a;
+    bj_sleep(20);
+    CHECK_EQ(bj_get_bitmap_load_status(loader, other), BJ_BITMAP_LOAD_LOADING);
+    CHECK(bj_bitmap_loader_memory(loader) <= 64 * 2 * 4);
+
+    struct bj_bitmap_load load;
+    REQUIRE(bj_poll_bitmap_loader(loader, &load));
+    bj_destroy_bitmap(load.bitmap);
+    CHECK_EQ(wait_status(loader, other, BJ_BITMAP_LOAD_LOADING), BJ_BITMAP_LOAD_DONE);
+
+    // Unpolled bitmaps are destroyed with the loader
+    bj_destroy_bitmap_loader(loader);
+    remove("unit_loader_a.bmp");
+    remove("unit_loader_b.bmp");
+}
+
+TEST_CASE(loader_destroy_drops_pending_loads) {
+    REQUIRE(write_bmp("unit_loader_a.bmp", 16, 10));
+    struct bj_bitmap_loader* loader = bj_create_bitmap_loader(2, 1);
+    REQUIRE_VALUE(loader);
+    for (int i = 0; i < 20; ++i) {
+        bj_submit_bitmap_load(loader, "unit_loader_a.bmp", BJ_PIXEL_MODE_BGR24, 0);
+    }
+    bj_destroy_bitmap_loader(loader);
+    bj_destroy_bitmap_loader(0);
+    remove("unit_loader_a.bmp");
+}
+
+int main(int argc, char* argv[]) {
+    BEGIN_TESTS(argc, argv);
+
+    bj_get_memory_defaults(&s_unlocked);
+    const struct bj_memory_callbacks locked = {
+        .fn_allocation   = locked_malloc,
+        .fn_reallocation = locked_realloc,
+        .fn_free         = locked_free,
+    };
+    bj_set_memory_defaults(&locked);
+
+    RUN_TEST(loader_loads_and_converts);
+    RUN_TEST(loader_reports_failures);
+    RUN_TEST(loader_cancels_queued_loads);
+    RUN_TEST(loader_budget_bounds_memory_in_flight);
+    RUN_TEST(loader_destroy_drops_pending_loads);
+
+    bj_set_memory_defaults(&s_unlocked);
+    END_TESTS();
+}
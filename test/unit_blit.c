@@ -0,0 +1,783 @@
+#include "test.h"
+#include <banjo/bitmap.h>
+#include <banjo/memory.h>
+#include <banjo/pixel.h>
+
+#include "bitmap.h"
+#include "cpu.h"
+
+// Odd width so that every vector kernel leaves a scalar tail
+#define BLIT_W 67
+#define BLIT_H 4
+
+static const enum bj_pixel_mode direct_modes[] = {
+    BJ_PIXEL_MODE_XRGB8888,
+    BJ_PIXEL_MODE_BGR24,
+    BJ_PIXEL_MODE_RGB565,
+    BJ_PIXEL_MODE_XRGB1555,
+};
+#define N_MODES (sizeof(direct_modes) / sizeof(direct_modes[0]))
+
+static const enum bj_blit_op all_ops[] = {
+    BJ_BLIT_OP_COPY,
+    BJ_BLIT_OP_XOR,
+    BJ_BLIT_OP_OR,
+    BJ_BLIT_OP_AND,
+    BJ_BLIT_OP_ADD_SAT,
+    BJ_BLIT_OP_SUB_SAT,
+};
+#define N_OPS (sizeof(all_ops) / sizeof(all_ops[0]))
+
+static uint32_t next_random(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static void fill_random(struct bj_bitmap* bmp, uint32_t seed) {
+    uint8_t* pixels = bj_bitmap_pixels(bmp);
+    const size_t size = bj_bitmap_stride(bmp) * bj_bitmap_height(bmp);
+    for (size_t i = 0; i < size; ++i) {
+        pixels[i] = (uint8_t)next_random(&seed);
+    }
+}
+
+// Plants `key` on a regular pattern so that colorkey paths get exercised
+static void plant_key(struct bj_bitmap* bmp, uint32_t key) {
+    for (size_t y = 0; y < BLIT_H; ++y) {
+        for (size_t x = y; x < BLIT_W; x += 5) {
+            bj_put_pixel(bmp, x, y, key);
+        }
+    }
+    bj_set_bitmap_color(bmp, key, BJ_BITMAP_COLORKEY);
+}
+
+static int same_pixels(struct bj_bitmap* a, struct bj_bitmap* b) {
+    const size_t size = bj_bitmap_stride(a) * bj_bitmap_height(a);
+    const uint8_t* pa = bj_bitmap_pixels(a);
+    const uint8_t* pb = bj_bitmap_pixels(b);
+    for (size_t i = 0; i < size; ++i) {
+        if (pa[i] != pb[i]) return 0;
+    }
+    return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Vector kernels match the scalar ones
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE(blit_simd_matches_scalar_same_format) {
+    for (size_t m = 0; m < N_MODES; ++m) {
+        for (size_t o = 0; o < N_OPS; ++o) {
+            for (int keyed = 0; keyed < 2; ++keyed) {
+                const enum bj_pixel_mode mode = direct_modes[m];
+                struct bj_bitmap* src    = bj_create_bitmap(BLIT_W, BLIT_H, mode, 0);
+                struct bj_bitmap* scalar = bj_create_bitmap(BLIT_W, BLIT_H, mode, 0);
+                struct bj_bitmap* vector = bj_create_bitmap(BLIT_W, BLIT_H, mode, 0);
+                REQUIRE_VALUE(src);
+                REQUIRE_VALUE(scalar);
+                REQUIRE_VALUE(vector);
+
+                fill_random(src, 1u + (uint32_t)m);
+                fill_random(scalar, 100u + (uint32_t)o);
+                fill_random(vector, 100u + (uint32_t)o);
+                if (keyed) {
+                    plant_key(src, bj_bitmap_pixel(src, 1, 1));
+                }
+
+                bj_select_blit_kernels(0);
+                bj_blit(src, 0, scalar, 0, all_ops[o]);
+                bj_select_blit_kernels(bj_cpu_features());
+                bj_blit(src, 0, vector, 0, all_ops[o]);
+
+                CHECK(same_pixels(scalar, vector));
+
+                bj_destroy_bitmap(src);
+                bj_destroy_bitmap(scalar);
+                bj_destroy_bitmap(vector);
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Cross-format blits match a per-pixel reference
+////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t apply_op_u8(uint8_t d, uint8_t s, enum bj_blit_op op) {
+    switch (op) {
+        case BJ_BLIT_OP_XOR:     return (uint8_t)(d ^ s);
+        case BJ_BLIT_OP_OR:      return (uint8_t)(d | s);
+        case BJ_BLIT_OP_AND:     return (uint8_t)(d & s);
+        case BJ_BLIT_OP_ADD_SAT: return (uint8_t)(d + s > 255 ? 255 : d + s);
+        case BJ_BLIT_OP_SUB_SAT: return (uint8_t)(d < s ? 0 : d - s);
+        default:                 return s;
+    }
+}
+
+TEST_CASE(blit_cross_format_matches_reference) {
+    for (size_t ms = 0; ms < N_MODES; ++ms) {
+        for (size_t md = 0; md < N_MODES; ++md) {
+            if (ms == md) continue;
+            for (size_t o = 0; o < N_OPS; ++o) {
+                for (int keyed = 0; keyed < 2; ++keyed) {
+                    const enum bj_pixel_mode smode = direct_modes[ms];
+                    const enum bj_pixel_mode dmode = direct_modes[md];
+                    const enum bj_blit_op op = all_ops[o];
+                    struct bj_bitmap* src = bj_create_bitmap(BLIT_W, BLIT_H, smode, 0);
+                    struct bj_bitmap* dst = bj_create_bitmap(BLIT_W, BLIT_H, dmode, 0);
+                    struct bj_bitmap* ref = bj_create_bitmap(BLIT_W, BLIT_H, dmode, 0);
+                    REQUIRE_VALUE(src);
+                    REQUIRE_VALUE(dst);
+                    REQUIRE_VALUE(ref);
+
+                    fill_random(src, 7u + (uint32_t)ms);
+                    fill_random(dst, 300u + (uint32_t)o);
+                    fill_random(ref, 300u + (uint32_t)o);
+                    if (keyed) {
+                        plant_key(src, bj_bitmap_pixel(src, 1, 1));
+                    }
+
+                    for (size_t y = 0; y < BLIT_H; ++y) {
+                        for (size_t x = 0; x < BLIT_W; ++x) {
+                            const uint32_t sval = bj_bitmap_pixel(src, x, y);
+                            if (keyed && sval == bj_bitmap_pixel(src, 1, 1)) continue;
+                            uint8_t sr, sg, sb, dr, dg, db;
+                            bj_make_pixel_rgb(smode, sval, &sr, &sg, &sb);
+                            bj_make_pixel_rgb(dmode, bj_bitmap_pixel(ref, x, y), &dr, &dg, &db);
+                            bj_put_pixel(ref, x, y, bj_get_pixel_value(dmode,
+                                apply_op_u8(dr, sr, op),
+                                apply_op_u8(dg, sg, op),
+                                apply_op_u8(db, sb, op)
+                            ));
+                        }
+                    }
+
+                    bj_blit(src, 0, dst, 0, op);
+                    CHECK(same_pixels(dst, ref));
+
+                    bj_destroy_bitmap(src);
+                    bj_destroy_bitmap(dst);
+                    bj_destroy_bitmap(ref);
+                }
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Saturating ops stay within their channel
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE(blit_saturation_is_per_channel) {
+    struct bj_bitmap* src = bj_create_bitmap(1, 1, BJ_PIXEL_MODE_XRGB8888, 0);
+    struct bj_bitmap* dst = bj_create_bitmap(1, 1, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(src);
+    REQUIRE_VALUE(dst);
+
+    bj_select_blit_kernels(0);
+
+    // Red overflows, blue does not
+    bj_put_pixel(src, 0, 0, 0x00201010);
+    bj_put_pixel(dst, 0, 0, 0x00F01010);
+    bj_blit(src, 0, dst, 0, BJ_BLIT_OP_ADD_SAT);
+    CHECK_EQ(bj_bitmap_pixel(dst, 0, 0), 0x00FF2020);
+
+    // Red underflows, blue does not
+    bj_put_pixel(src, 0, 0, 0x00200010);
+    bj_put_pixel(dst, 0, 0, 0x00102080);
+    bj_blit(src, 0, dst, 0, BJ_BLIT_OP_SUB_SAT);
+    CHECK_EQ(bj_bitmap_pixel(dst, 0, 0), 0x00002070);
+
+    bj_select_blit_kernels(bj_cpu_features());
+
+    bj_destroy_bitmap(src);
+    bj_destroy_bitmap(dst);
+}
+
+TEST_CASE(blit_saturation_keeps_alpha) {
+    static const enum bj_pixel_mode modes[] = {BJ_PIXEL_MODE_ARGB8888, BJ_PIXEL_MODE_ARGB8888_PREMUL};
+    for (size_t m = 0; m < 2; ++m) {
+        for (int vector = 0; vector < 2; ++vector) {
+            // Wide enough for the vector kernels and a scalar tail
+            struct bj_bitmap* src = bj_create_bitmap(11, 1, modes[m], 0);
+            struct bj_bitmap* dst = bj_create_bitmap(11, 1, modes[m], 0);
+            REQUIRE_VALUE(src);
+            REQUIRE_VALUE(dst);
+            bj_select_blit_kernels(vector ? bj_cpu_features() : 0);
+
+            for (size_t x = 0; x < 11; ++x) {
+                bj_put_pixel(src, x, 0, 0x40201010);
+                bj_put_pixel(dst, x, 0, 0xF0F01010);
+            }
+            bj_blit(src, 0, dst, 0, BJ_BLIT_OP_ADD_SAT);
+            CHECK_EQ(bj_bitmap_pixel(dst, 0, 0), 0xFFFF2020);
+            CHECK_EQ(bj_bitmap_pixel(dst, 10, 0), 0xFFFF2020);
+
+            for (size_t x = 0; x < 11; ++x) {
+                bj_put_pixel(dst, x, 0, 0x80102080);
+            }
+            bj_blit(src, 0, dst, 0, BJ_BLIT_OP_SUB_SAT);
+            CHECK_EQ(bj_bitmap_pixel(dst, 0, 0), 0x40001070);
+            CHECK_EQ(bj_bitmap_pixel(dst, 10, 0), 0x40001070);
+
+            bj_destroy_bitmap(src);
+            bj_destroy_bitmap(dst);
+        }
+    }
+    bj_select_blit_kernels(bj_cpu_features());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 24bpp rows whose size is not a multiple of the vector width
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE(blit_24bpp_bytewise_ops_split_no_pixel) {
+    static const size_t widths[] = {6, 11, 21, 37};
+    static const enum bj_blit_op ops[] = {BJ_BLIT_OP_XOR, BJ_BLIT_OP_ADD_SAT, BJ_BLIT_OP_SUB_SAT};
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+        for (size_t o = 0; o < sizeof(ops) / sizeof(ops[0]); ++o) {
+            struct bj_bitmap* src = bj_create_bitmap(widths[w], 1, BJ_PIXEL_MODE_BGR24, 0);
+            struct bj_bitmap* dst = bj_create_bitmap(widths[w], 1, BJ_PIXEL_MODE_BGR24, 0);
+            REQUIRE_VALUE(src);
+            REQUIRE_VALUE(dst);
+
+            const size_t bytes = widths[w] * 3;
+            uint8_t* s = bj_bitmap_pixels(src);
+            uint8_t* d = bj_bitmap_pixels(dst);
+            for (size_t i = 0; i < bytes; ++i) {
+                s[i] = 0x0F;
+                d[i] = 0xF0;
+            }
+
+            bj_blit(src, 0, dst, 0, ops[o]);
+
+            const uint8_t expected = apply_op_u8(0xF0, 0x0F, ops[o]);
+            size_t wrong = 0;
+            for (size_t i = 0; i < bytes; ++i) {
+                wrong += d[i] != expected;
+            }
+            CHECK_EQ(wrong, 0);
+
+            bj_destroy_bitmap(src);
+            bj_destroy_bitmap(dst);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Alpha compositing matches a per-pixel reference
+////////////////////////////////////////////////////////////////////////////////
+
+static const enum bj_pixel_mode over_dst_modes[] = {
+    BJ_PIXEL_MODE_XRGB8888,
+    BJ_PIXEL_MODE_ARGB8888,
+    BJ_PIXEL_MODE_ARGB8888_PREMUL,
+    BJ_PIXEL_MODE_BGR24,
+    BJ_PIXEL_MODE_RGB565,
+};
+#define N_OVER_DST (sizeof(over_dst_modes) / sizeof(over_dst_modes[0]))
+
+static uint8_t add_sat(uint8_t a, uint8_t b) {
+    return (uint8_t)(a + b > 255 ? 255 : a + b);
+}
+
+static uint32_t reference_over(
+    enum bj_pixel_mode smode, uint32_t sval,
+    enum bj_pixel_mode dmode, uint32_t dval,
+    enum bj_blit_op op
+) {
+    uint8_t sr, sg, sb, sa, dr, dg, db, da;
+    bj_make_pixel_rgba(smode, sval, &sr, &sg, &sb, &sa);
+    bj_make_pixel_rgba(dmode, dval, &dr, &dg, &db, &da);
+    if (op == BJ_BLIT_OP_PREMUL_OVER) {
+        const uint8_t na = (uint8_t)(255 - sa);
+        return bj_get_pixel_value_rgba(dmode,
+            add_sat(sr, bj_mul_u8(dr, na)), add_sat(sg, bj_mul_u8(dg, na)),
+            add_sat(sb, bj_mul_u8(db, na)), add_sat(sa, bj_mul_u8(da, na))
+        );
+    }
+    return bj_get_pixel_value_rgba(dmode,
+        bj_mix_u8(sa, sr, dr), bj_mix_u8(sa, sg, dg),
+        bj_mix_u8(sa, sb, db), bj_mix_u8(sa, 255, da)
+    );
+}
+
+// Random alpha hits the transparent and opaque shortcuts too rarely
+static void force_alpha_extremes(struct bj_bitmap* bmp) {
+    for (size_t y = 0; y < BLIT_H; ++y) {
+        for (size_t x = 0; x < BLIT_W; x += 3) {
+            const uint32_t v = bj_bitmap_pixel(bmp, x, y);
+            bj_put_pixel(bmp, x, y, (x & 1) ? (v | 0xFF000000u) : (v & 0x00FFFFFFu));
+        }
+    }
+}
+
+// Skipped pixels keep whatever X bits the destination had
+static void clear_x_bits(struct bj_bitmap* bmp) {
+    if (bj_bitmap_mode(bmp) != BJ_PIXEL_MODE_XRGB8888) return;
+    for (size_t y = 0; y < BLIT_H; ++y) {
+        for (size_t x = 0; x < BLIT_W; ++x) {
+            bj_put_pixel(bmp, x, y, bj_bitmap_pixel(bmp, x, y) & 0x00FFFFFFu);
+        }
+    }
+}
+
+TEST_CASE(blit_over_matches_reference) {
+    const enum bj_pixel_mode src_modes[] = {
+        BJ_PIXEL_MODE_ARGB8888, BJ_PIXEL_MODE_ARGB8888_PREMUL,
+    };
+    const enum bj_blit_op ops[] = {
+        BJ_BLIT_OP_SRC_OVER, BJ_BLIT_OP_PREMUL_OVER,
+    };
+
+    for (size_t ms = 0; ms < 2; ++ms) {
+        for (size_t md = 0; md < N_OVER_DST; ++md) {
+            for (int keyed = 0; keyed < 2; ++keyed) {
+                const enum bj_pixel_mode smode = src_modes[ms];
+                const enum bj_pixel_mode dmode = over_dst_modes[md];
+                const enum bj_blit_op op = ops[ms];
+                struct bj_bitmap* src = bj_create_bitmap(BLIT_W, BLIT_H, smode, 0);
+                struct bj_bitmap* dst = bj_create_bitmap(BLIT_W, BLIT_H, dmode, 0);
+                struct bj_bitmap* ref = bj_create_bitmap(BLIT_W, BLIT_H, dmode, 0);
+                REQUIRE_VALUE(src);
+                REQUIRE_VALUE(dst);
+                REQUIRE_VALUE(ref);
+
+                fill_random(src, 11u + (uint32_t)ms);
+                fill_random(dst, 500u + (uint32_t)md);
+                fill_random(ref, 500u + (uint32_t)md);
+                clear_x_bits(dst);
+                clear_x_bits(ref);
+                force_alpha_extremes(src);
+                if (keyed) {
+                    plant_key(src, bj_bitmap_pixel(src, 1, 1));
+                }
+
+                for (size_t y = 0; y < BLIT_H; ++y) {
+                    for (size_t x = 0; x < BLIT_W; ++x) {
+                        const uint32_t sval = bj_bitmap_pixel(src, x, y);
+                        if (keyed && sval == bj_bitmap_pixel(src, 1, 1)) continue;
+                        bj_put_pixel(ref, x, y, reference_over(
+                            smode, sval, dmode, bj_bitmap_pixel(ref, x, y), op
+                        ));
+                    }
+                }
+
+                bj_blit(src, 0, dst, 0, op);
+                CHECK(same_pixels(dst, ref));
+
+                bj_destroy_bitmap(src);
+                bj_destroy_bitmap(dst);
+                bj_destroy_bitmap(ref);
+            }
+        }
+    }
+}
+
+TEST_CASE(blit_over_opaque_source_is_copy) {
+    struct bj_bitmap* src  = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_RGB565, 0);
+    struct bj_bitmap* over = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_XRGB8888, 0);
+    struct bj_bitmap* copy = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(src);
+    REQUIRE_VALUE(over);
+    REQUIRE_VALUE(copy);
+
+    fill_random(src, 21u);
+    fill_random(over, 22u);
+    fill_random(copy, 22u);
+
+    bj_blit(src, 0, over, 0, BJ_BLIT_OP_SRC_OVER);
+    bj_blit(src, 0, copy, 0, BJ_BLIT_OP_COPY);
+    CHECK(same_pixels(over, copy));
+
+    bj_destroy_bitmap(src);
+    bj_destroy_bitmap(over);
+    bj_destroy_bitmap(copy);
+}
+
+TEST_CASE(blit_over_stretched_matches_unstretched) {
+    struct bj_bitmap* src       = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_ARGB8888, 0);
+    struct bj_bitmap* stretched = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_XRGB8888, 0);
+    struct bj_bitmap* plain     = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(src);
+    REQUIRE_VALUE(stretched);
+    REQUIRE_VALUE(plain);
+
+    fill_random(src, 31u);
+    fill_random(stretched, 32u);
+    fill_random(plain, 32u);
+
+    // A 1:1 stretch takes the stretched sampling path with identity steps
+    const struct bj_rect area = {.x = 0, .y = 0, .w = BLIT_W, .h = BLIT_H};
+    bj_blit_stretched(src, &area, stretched, &area, BJ_BLIT_OP_SRC_OVER);
+    bj_blit(src, 0, plain, 0, BJ_BLIT_OP_SRC_OVER);
+    CHECK(same_pixels(stretched, plain));
+
+    bj_destroy_bitmap(src);
+    bj_destroy_bitmap(stretched);
+    bj_destroy_bitmap(plain);
+}
+
+TEST_CASE(pixel_rgba_round_trip) {
+    uint8_t r, g, b, a;
+    const uint32_t v = bj_get_pixel_value_rgba(BJ_PIXEL_MODE_ARGB8888, 0x12, 0x34, 0x56, 0x78);
+    CHECK_EQ(v, 0x78123456u);
+    bj_make_pixel_rgba(BJ_PIXEL_MODE_ARGB8888, v, &r, &g, &b, &a);
+    CHECK_EQ(r, 0x12);
+    CHECK_EQ(g, 0x34);
+    CHECK_EQ(b, 0x56);
+    CHECK_EQ(a, 0x78);
+
+    // Formats without alpha drop it on write and report opaque on read
+    CHECK_EQ(bj_get_pixel_value_rgba(BJ_PIXEL_MODE_XRGB8888, 0x12, 0x34, 0x56, 0x78), 0x00123456u);
+    bj_make_pixel_rgba(BJ_PIXEL_MODE_XRGB8888, 0x00123456u, &r, &g, &b, &a);
+    CHECK_EQ(a, 0xFF);
+    CHECK_EQ(bj_get_pixel_value(BJ_PIXEL_MODE_ARGB8888, 1, 2, 3), 0xFF010203u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Filtered stretching
+////////////////////////////////////////////////////////////////////////////////
+
+static const enum bj_blit_filter smooth_filters[] = {
+    BJ_BLIT_FILTER_BILINEAR,
+    BJ_BLIT_FILTER_BOX,
+};
+#define N_FILTERS (sizeof(smooth_filters) / sizeof(smooth_filters[0]))
+
+static void fill_color(struct bj_bitmap* bmp, uint32_t value) {
+    for (size_t y = 0; y < bj_bitmap_height(bmp); ++y) {
+        for (size_t x = 0; x < bj_bitmap_width(bmp); ++x) {
+            bj_put_pixel(bmp, x, y, value);
+        }
+    }
+}
+
+TEST_CASE(blit_filtered_keeps_flat_colors) {
+    const size_t sizes[][2] = {{13, 7}, {40, 29}, {5, 3}};
+    for (size_t m = 0; m < N_MODES; ++m) {
+        for (size_t f = 0; f < N_FILTERS; ++f) {
+            for (size_t z = 0; z < 3; ++z) {
+                const enum bj_pixel_mode mode = direct_modes[m];
+                struct bj_bitmap* src = bj_create_bitmap(BLIT_W, 11, mode, 0);
+                struct bj_bitmap* dst = bj_create_bitmap(sizes[z][0], sizes[z][1], mode, 0);
+                REQUIRE_VALUE(src);
+                REQUIRE_VALUE(dst);
+
+                const uint32_t color = bj_get_pixel_value(mode, 0xC8, 0x64, 0x20);
+                fill_color(src, color);
+                fill_color(dst, 0);
+
+                CHECK(bj_blit_stretched_filtered(src, 0, dst, 0, BJ_BLIT_OP_COPY, smooth_filters[f]));
+                bj_bool flat = BJ_TRUE;
+                for (size_t y = 0; y < sizes[z][1]; ++y) {
+                    for (size_t x = 0; x < sizes[z][0]; ++x) {
+                        flat = flat && bj_bitmap_pixel(dst, x, y) == color;
+                    }
+                }
+                CHECK(flat);
+
+                bj_destroy_bitmap(src);
+                bj_destroy_bitmap(dst);
+            }
+        }
+    }
+}
+
+TEST_CASE(blit_filtered_same_size_is_blit) {
+    for (size_t f = 0; f < N_FILTERS; ++f) {
+        struct bj_bitmap* src      = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_RGB565, 0);
+        struct bj_bitmap* filtered = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_XRGB8888, 0);
+        struct bj_bitmap* plain    = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_XRGB8888, 0);
+        REQUIRE_VALUE(src);
+        REQUIRE_VALUE(filtered);
+        REQUIRE_VALUE(plain);
+
+        fill_random(src, 41u);
+        bj_blit_stretched_filtered(src, 0, filtered, 0, BJ_BLIT_OP_COPY, smooth_filters[f]);
+        bj_blit(src, 0, plain, 0, BJ_BLIT_OP_COPY);
+        CHECK(same_pixels(filtered, plain));
+
+        bj_destroy_bitmap(src);
+        bj_destroy_bitmap(filtered);
+        bj_destroy_bitmap(plain);
+    }
+}
+
+TEST_CASE(blit_filtered_bilinear_interpolates) {
+    struct bj_bitmap* src = bj_create_bitmap(2, 1, BJ_PIXEL_MODE_XRGB8888, 0);
+    struct bj_bitmap* dst = bj_create_bitmap(4, 1, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(src);
+    REQUIRE_VALUE(dst);
+
+    bj_put_pixel(src, 0, 0, 0x00000000);
+    bj_put_pixel(src, 1, 0, 0x00FFFFFF);
+    bj_blit_stretched_filtered(src, 0, dst, 0, BJ_BLIT_OP_COPY, BJ_BLIT_FILTER_BILINEAR);
+
+    // Centers map to -0.25 (clamped), 0.25, 0.75 and 1.25 (clamped)
+    CHECK_EQ(bj_bitmap_pixel(dst, 0, 0), 0x00000000);
+    CHECK_EQ(bj_bitmap_pixel(dst, 1, 0), 0x003F3F3F);
+    CHECK_EQ(bj_bitmap_pixel(dst, 2, 0), 0x00BFBFBF);
+    CHECK_EQ(bj_bitmap_pixel(dst, 3, 0), 0x00FFFFFF);
+
+    bj_destroy_bitmap(src);
+    bj_destroy_bitmap(dst);
+}
+
+TEST_CASE(blit_filtered_box_averages) {
+    struct bj_bitmap* src = bj_create_bitmap(6, 2, BJ_PIXEL_MODE_XRGB8888, 0);
+    struct bj_bitmap* dst = bj_create_bitmap(2, 1, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(src);
+    REQUIRE_VALUE(dst);
+
+    // Left 3x2 block: red values 0, 30, 60, 90, 120, 150 -> 75
+    // Right 3x2 block: a single white pixel -> 255 / 6 rounds to 43
+    fill_color(src, 0);
+    for (size_t i = 0; i < 6; ++i) {
+        bj_put_pixel(src, i % 3, i / 3, (uint32_t)(30 * i) << 16);
+    }
+    bj_put_pixel(src, 4, 1, 0x00FFFFFF);
+
+    bj_blit_stretched_filtered(src, 0, dst, 0, BJ_BLIT_OP_COPY, BJ_BLIT_FILTER_BOX);
+    CHECK_EQ(bj_bitmap_pixel(dst, 0, 0), 0x004B0000);
+    CHECK_EQ(bj_bitmap_pixel(dst, 1, 0), 0x002B2B2B);
+
+    bj_destroy_bitmap(src);
+    bj_destroy_bitmap(dst);
+}
+
+TEST_CASE(blit_filtered_colorkey_does_not_bleed) {
+    for (size_t f = 0; f < N_FILTERS; ++f) {
+        struct bj_bitmap* src = bj_create_bitmap(8, 8, BJ_PIXEL_MODE_XRGB8888, 0);
+        struct bj_bitmap* dst = bj_create_bitmap(19, 5, BJ_PIXEL_MODE_XRGB8888, 0);
+        REQUIRE_VALUE(src);
+        REQUIRE_VALUE(dst);
+
+        // Red checkers on a green key, over a blue destination
+        for (size_t y = 0; y < 8; ++y) {
+            for (size_t x = 0; x < 8; ++x) {
+                bj_put_pixel(src, x, y, ((x ^ y) & 2) ? 0x00FF0000 : 0x0000FF00);
+            }
+        }
+        bj_set_bitmap_color(src, 0x0000FF00, BJ_BITMAP_COLORKEY);
+        fill_color(dst, 0x000000FF);
+
+        bj_blit_stretched_filtered(src, 0, dst, 0, BJ_BLIT_OP_COPY, smooth_filters[f]);
+
+        bj_bool green = BJ_FALSE;
+        bj_bool red   = BJ_FALSE;
+        for (size_t y = 0; y < 5; ++y) {
+            for (size_t x = 0; x < 19; ++x) {
+                const uint32_t p = bj_bitmap_pixel(dst, x, y);
+                green = green || (p & 0x0000FF00) != 0;
+                red   = red || (p & 0x00FF0000) != 0;
+            }
+        }
+        CHECK(!green);
+        CHECK(red);
+
+        bj_destroy_bitmap(src);
+        bj_destroy_bitmap(dst);
+    }
+}
+
+TEST_CASE(blit_filtered_transparent_source_is_noop) {
+    for (size_t f = 0; f < N_FILTERS; ++f) {
+        struct bj_bitmap* src = bj_create_bitmap(9, 6, BJ_PIXEL_MODE_ARGB8888, 0);
+        struct bj_bitmap* dst = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_XRGB8888, 0);
+        struct bj_bitmap* ref = bj_create_bitmap(BLIT_W, BLIT_H, BJ_PIXEL_MODE_XRGB8888, 0);
+        REQUIRE_VALUE(src);
+        REQUIRE_VALUE(dst);
+        REQUIRE_VALUE(ref);
+
+        // Colors of transparent pixels must not show up after filtering
+        fill_random(src, 51u);
+        for (size_t y = 0; y < 6; ++y) {
+            for (size_t x = 0; x < 9; ++x) {
+                bj_put_pixel(src, x, y, bj_bitmap_pixel(src, x, y) & 0x00FFFFFFu);
+            }
+        }
+        fill_random(dst, 52u);
+        fill_random(ref, 52u);
+
+        bj_blit_stretched_filtered(src, 0, dst, 0, BJ_BLIT_OP_SRC_OVER, smooth_filters[f]);
+        CHECK(same_pixels(dst, ref));
+
+        bj_destroy_bitmap(src);
+        bj_destroy_bitmap(dst);
+        bj_destroy_bitmap(ref);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Affine blits
+////////////////////////////////////////////////////////////////////////////////
+
+// Filtered blits only carry colors, not the padding bits of the source
+static void clear_padding(struct bj_bitmap* bmp) {
+    const enum bj_pixel_mode mode = bj_bitmap_mode(bmp);
+    for (size_t y = 0; y < bj_bitmap_height(bmp); ++y) {
+        for (size_t x = 0; x < bj_bitmap_width(bmp); ++x) {
+            uint8_t r, g, b;
+            bj_make_pixel_rgb(mode, bj_bitmap_pixel(bmp, x, y), &r, &g, &b);
+            bj_put_pixel(bmp, x, y, bj_get_pixel_value(mode, r, g, b));
+        }
+    }
+}
+
+TEST_CASE(blit_transformed_translation_is_blit) {
+    const int offsets[][2] = {{0, 0}, {5, 3}, {-3, -2}};
+    for (size_t m = 0; m < N_MODES; ++m) {
+        for (size_t o = 0; o < 3; ++o) {
+            for (int keyed = 0; keyed < 2; ++keyed) {
+                const enum bj_pixel_mode mode = direct_modes[m];
+                struct bj_bitmap* src   = bj_create_bitmap(BLIT_W, BLIT_H, mode, 0);
+                struct bj_bitmap* xform = bj_create_bitmap(BLIT_W, BLIT_H + 4, mode, 0);
+                struct bj_bitmap* plain = bj_create_bitmap(BLIT_W, BLIT_H + 4, mode, 0);
+                REQUIRE_VALUE(src);
+                REQUIRE_VALUE(xform);
+                REQUIRE_VALUE(plain);
+
+                fill_random(src, 61u + (uint32_t)m);
+                fill_random(xform, 62u);
+                fill_random(plain, 62u);
+                if (keyed) {
+                    plant_key(src, bj_bitmap_pixel(src, 1, 1));
+                }
+
+                struct bj_mat3x2 t;
+                bj_mat3x2_set_translation(&t, (bj_real)offsets[o][0], (bj_real)offsets[o][1]);
+                const struct bj_rect at = {.x = (int16_t)offsets[o][0], .y = (int16_t)offsets[o][1]};
+                bj_blit_transformed(src, 0, xform, &t, BJ_BLIT_OP_XOR, BJ_BLIT_FILTER_NEAREST);
+                bj_blit(src, 0, plain, &at, BJ_BLIT_OP_XOR);
+                CHECK(same_pixels(xform, plain));
+
+                // Keyed bilinear blits blend key edges instead of skipping them
+                if (!keyed) {
+                    clear_padding(src);
+                    bj_blit_transformed(src, 0, xform, &t, BJ_BLIT_OP_COPY, BJ_BLIT_FILTER_BILINEAR);
+                    bj_blit(src, 0, plain, &at, BJ_BLIT_OP_COPY);
+                    CHECK(same_pixels(xform, plain));
+                }
+
+                bj_destroy_bitmap(src);
+                bj_destroy_bitmap(xform);
+                bj_destroy_bitmap(plain);
+            }
+        }
+    }
+}
+
+TEST_CASE(blit_transformed_quarter_turn) {
+    const size_t w = 7, h = 5;
+    struct bj_bitmap* src = bj_create_bitmap(w, h, BJ_PIXEL_MODE_XRGB8888, 0);
+    struct bj_bitmap* dst = bj_create_bitmap(h, w, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(src);
+    REQUIRE_VALUE(dst);
+    fill_random(src, 71u);
+    fill_color(dst, 0);
+
+    // (u, v) -> (h - v, u): source pixel (i, j) lands on (h - 1 - j, i)
+    struct bj_mat3x2 rotation, shift, t;
+    bj_mat3x2_set_rotation_z(&rotation, BJ_PI / BJ_F(2.0));
+    bj_mat3x2_set_translation(&shift, (bj_real)h, BJ_FZERO);
+    bj_mat3x2_mul(&t, &shift, &rotation);
+
+    for (size_t f = 0; f < 2; ++f) {
+        CHECK(bj_blit_transformed(src, 0, dst, &t, BJ_BLIT_OP_COPY,
+            f ? BJ_BLIT_FILTER_BILINEAR : BJ_BLIT_FILTER_NEAREST));
+        bj_bool exact = BJ_TRUE;
+        for (size_t j = 0; j < h; ++j) {
+            for (size_t i = 0; i < w; ++i) {
+                exact = exact && bj_bitmap_pixel(dst, h - 1 - j, i) == bj_bitmap_pixel(src, i, j);
+            }
+        }
+        CHECK(exact);
+    }
+
+    bj_destroy_bitmap(src);
+    bj_destroy_bitmap(dst);
+}
+
+TEST_CASE(blit_transformed_rotation_stays_in_bounds) {
+    // A sub-area blit: pixels outside of it carry a marker that must never
+    // show up, whatever the angle and clipping.
+    struct bj_bitmap* src = bj_create_bitmap(32, 32, BJ_PIXEL_MODE_XRGB8888, 0);
+    struct bj_bitmap* dst = bj_create_bitmap(40, 30, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(src);
+    REQUIRE_VALUE(dst);
+    fill_color(src, 0x00FF00FF);
+    const struct bj_rect area = {.x = 8, .y = 8, .w = 16, .h = 16};
+    for (size_t y = 8; y < 24; ++y) {
+        for (size_t x = 8; x < 24; ++x) {
+            bj_put_pixel(src, x, y, 0x00404040u + (uint32_t)(x * 3 + y));
+        }
+    }
+
+    bj_bool clean = BJ_TRUE;
+    bj_bool drawn = BJ_FALSE;
+    for (int step = 0; step < 24; ++step) {
+        struct bj_mat3x2 center, rotation, place, tmp, t;
+        bj_mat3x2_set_translation(&center, BJ_F(-8.0), BJ_F(-8.0));
+        bj_mat3x2_set_rotation_z(&rotation, (bj_real)step * BJ_PI / BJ_F(12.0));
+        bj_mat3x2_set_translation(&place, (bj_real)(step % 5) * BJ_F(9.5), BJ_F(12.25));
+        bj_mat3x2_mul(&tmp, &rotation, &center);
+        bj_mat3x2_mul(&t, &place, &tmp);
+
+        for (size_t f = 0; f < 2; ++f) {
+            fill_color(dst, 0);
+            drawn = bj_blit_transformed(src, &area, dst, &t, BJ_BLIT_OP_COPY,
+                f ? BJ_BLIT_FILTER_BILINEAR : BJ_BLIT_FILTER_NEAREST) || drawn;
+            for (size_t y = 0; y < 30; ++y) {
+                for (size_t x = 0; x < 40; ++x) {
+                    clean = clean && (bj_bitmap_pixel(dst, x, y) & 0x00FF0000u) != 0x00FF0000u;
+                }
+            }
+        }
+    }
+    CHECK(clean);
+    CHECK(drawn);
+
+    bj_destroy_bitmap(src);
+    bj_destroy_bitmap(dst);
+}
+
+TEST_CASE(blit_transformed_singular_draws_nothing) {
+    struct bj_bitmap* src = bj_create_bitmap(4, 4, BJ_PIXEL_MODE_XRGB8888, 0);
+    struct bj_bitmap* dst = bj_create_bitmap(4, 4, BJ_PIXEL_MODE_XRGB8888, 0);
+    REQUIRE_VALUE(src);
+    REQUIRE_VALUE(dst);
+
+    struct bj_mat3x2 t;
+    bj_mat3x2_set_scaling_xy(&t, BJ_F(1.0), BJ_FZERO);
+    CHECK(!bj_blit_transformed(src, 0, dst, &t, BJ_BLIT_OP_COPY, BJ_BLIT_FILTER_NEAREST));
+
+    bj_destroy_bitmap(src);
+    bj_destroy_bitmap(dst);
+}
+
+int main(int argc, char* argv[]) {
+    BEGIN_TESTS(argc, argv);
+
+    RUN_TEST(blit_simd_matches_scalar_same_format);
+    RUN_TEST(blit_cross_format_matches_reference);
+    RUN_TEST(blit_saturation_is_per_channel);
+    RUN_TEST(blit_saturation_keeps_alpha);
+    RUN_TEST(blit_24bpp_bytewise_ops_split_no_pixel);
+    RUN_TEST(blit_over_matches_reference);
+    RUN_TEST(blit_over_opaque_source_is_copy);
+    RUN_TEST(blit_over_stretched_matches_unstretched);
+    RUN_TEST(pixel_rgba_round_trip);
+    RUN_TEST(blit_filtered_keeps_flat_colors);
+    RUN_TEST(blit_filtered_same_size_is_blit);
+    RUN_TEST(blit_filtered_bilinear_interpolates);
+    RUN_TEST(blit_filtered_box_averages);
+    RUN_TEST(blit_filtered_colorkey_does_not_bleed);
+    RUN_TEST(blit_filtered_transparent_source_is_noop);
+    RUN_TEST(blit_transformed_translation_is_blit);
+    RUN_TEST(blit_transformed_quarter_turn);
+    RUN_TEST(blit_transformed_rotation_stays_in_bounds);
+    RUN_TEST(blit_transformed_singular_draws_nothing);
+
+    END_TESTS();
+}
@@ -2,8 +2,17 @@
 #include "test.h"
 #include "mock_memory.h"
 
+#include <pool.h>
+
 static size_t s_mem_size = sizeof(int);
 
+// Instrumented builds prefix each block with its size and call site
+#ifdef BJ_CONFIG_MEMORY_STATS
+#   define BLOCK_OVERHEAD 16
+#else
+#   define BLOCK_OVERHEAD 0
+#endif
+
 TEST_CASE(fallback_allocator_works) {
     void* blocks = bj_malloc(s_mem_size);
     REQUIRE_VALUE(blocks);
@@ -62,8 +71,8 @@ TEST_CASE(test_custom_default_allocators) {
             expected.n_free += 1;
             expected.application_current_allocated -= size_fifo[(--size_fifo_len)];
         } else if(allocations[i] < 0) {
-            size_t size = -allocations[i];
-            ptrs_fifo[ptrs_fifo_len-1] = bj_realloc(ptrs_fifo[ptrs_fifo_len-1], size);
+            size_t size = -allocations[i] + BLOCK_OVERHEAD;
+            ptrs_fifo[ptrs_fifo_len-1] = bj_realloc(ptrs_fifo[ptrs_fifo_len-1], size - BLOCK_OVERHEAD);
             expected.n_reallocations += 1;
             expected.application_current_allocated += size;
             if(expected.application_current_allocated > expected.application_max_allocated) {
@@ -72,8 +81,8 @@ TEST_CASE(test_custom_default_allocators) {
             expected.application_current_allocated -= size_fifo[size_fifo_len-1];
             size_fifo[size_fifo_len-1] = size;
         } else {
-            size_t size = allocations[i];
-            ptrs_fifo[ptrs_fifo_len++] = bj_malloc(size);
+            size_t size = allocations[i] + BLOCK_OVERHEAD;
+            ptrs_fifo[ptrs_fifo_len++] = bj_malloc(size - BLOCK_OVERHEAD);
             expected.n_allocations += 1;
             expected.application_current_allocated += size;
             if(expected.application_current_allocated > expected.application_max_allocated) {
@@ -98,6 +107,68 @@ TEST_CASE(test_custom_default_allocators) {
     bj_unset_memory_defaults();
 }
 
+TEST_CASE(aligned_allocations) {
+    const size_t alignments[] = {1, 8, 16, 64, 4096};
+    for (size_t a = 0; a < sizeof(alignments) / sizeof(alignments[0]); ++a) {
+        unsigned char* block = bj_aligned_malloc(100, alignments[a]);
+        REQUIRE_VALUE(block);
+        CHECK_EQ((uintptr_t)block % alignments[a], 0);
+        bj_memset(block, 0xAA, 100);
+        bj_aligned_free(block);
+    }
+    REQUIRE_NULL(bj_aligned_malloc(100, 24));
+    REQUIRE_NULL(bj_aligned_malloc(SIZE_MAX - 8, 64));
+    bj_aligned_free(0);
+}
+
+TEST_CASE(pool_reuses_blocks) {
+    // Many small blocks share a few slabs
+    void* blocks[300];
+    for (size_t i = 0; i < 300; ++i) {
+        blocks[i] = bj_pool_allocate(40);
+        REQUIRE_VALUE(blocks[i]);
+        CHECK_EQ((uintptr_t)blocks[i] % 16, 0);
+        bj_memset(blocks[i], (uint8_t)i, 40);
+    }
+
+    // A freed block is handed out again
+    void* freed = blocks[123];
+    bj_pool_free(freed);
+    blocks[123] = bj_pool_allocate(33);
+    CHECK(blocks[123] == freed);
+    CHECK_EQ(((uint8_t*)blocks[200])[39], 200);
+
+    // Large requests bypass the classes
+    void* large = bj_pool_allocate(4000);
+    REQUIRE_VALUE(large);
+    bj_pool_free(large);
+    bj_pool_free(0);
+
+    for (size_t i = 0; i < 300; ++i) {
+        bj_pool_free(blocks[i]);
+    }
+}
+
+TEST_CASE(pool_bypassed_by_other_defaults) {
+    sAllocationData result = {.actual_current_allocated=0};
+    struct bj_memory_callbacks allocators = mock_allocators(&result);
+    bj_set_memory_defaults(&allocators);
+
+    // Every block goes to the defaults, and back to them when freed
+    void* blocks[40];
+    for (size_t i = 0; i < 40; ++i) {
+        blocks[i] = bj_pool_allocate(40);
+        REQUIRE_VALUE(blocks[i]);
+        CHECK_EQ((uintptr_t)blocks[i] % 16, 0);
+    }
+    CHECK_EQ(result.n_allocations, 40);
+    for (size_t i = 0; i < 40; ++i) {
+        bj_pool_free(blocks[i]);
+    }
+    REQUIRE_CLEAN_ALLOC(result);
+    bj_unset_memory_defaults();
+}
+
 int main(int argc, char* argv[]) {
     BEGIN_TESTS(argc, argv);
 
@@ -108,6 +179,9 @@ int main(int argc, char* argv[]) {
     RUN_TEST(fallback_allocator_works);
     RUN_TEST(forcing_default_allocators_is_possible);
     RUN_TEST(test_custom_default_allocators);
+    RUN_TEST(aligned_allocations);
+    RUN_TEST(pool_reuses_blocks);
+    RUN_TEST(pool_bypassed_by_other_defaults);
 
     END_TESTS();
 }
@@ -0,0 +1,109 @@
+#include "test.h"
+#include <banjo/api.h>
+#include <banjo/memory.h>
+
+#include <string.h>
+
+TEST_CASE(memory_stats_follow_build_config) {
+  struct bj_memory_stats stats;
+  bj_get_memory_stats(&stats);
+  CHECK_EQ(stats.enabled, bj_build_information()->memory_stats);
+  bj_dump_memory_stats();
+}
+
+#ifdef BJ_CONFIG_MEMORY_STATS
+
+TEST_CASE(memory_stats_count_live_and_peak_bytes) {
+  struct bj_memory_stats before, during, after;
+  bj_get_memory_stats(&before);
+
+  void *a = bj_malloc(100);
+  void *b = bj_calloc(50);
+  REQUIRE(a && b);
+  a = bj_realloc(a, 300);
+  REQUIRE_VALUE(a);
+  bj_get_memory_stats(&during);
+  CHECK_EQ(during.live_bytes - before.live_bytes, 350);
+  CHECK_EQ(during.live_allocations - before.live_allocations, 2);
+  CHECK_EQ(during.allocations - before.allocations, 3);
+  CHECK(during.peak_bytes >= before.live_bytes + 350);
+
+  bj_free(a);
+  bj_free(b);
+  bj_get_memory_stats(&after);
+  CHECK_EQ(after.live_bytes, before.live_bytes);
+  CHECK_EQ(after.live_allocations, before.live_allocations);
+  CHECK_EQ(after.peak_bytes, during.peak_bytes);
+}
+
+TEST_CASE(memory_stats_close_frames) {
+  bj_reset_frame_memory();
+  for (int i = 0; i < 3; ++i) {
+    bj_free(bj_malloc(10));
+  }
+  struct bj_memory_stats stats;
+  bj_get_memory_stats(&stats);
+  CHECK_EQ(stats.frame_allocations, 3);
+  CHECK_EQ(stats.frame_bytes, 30);
+
+  bj_reset_frame_memory();
+  bj_get_memory_stats(&stats);
+  CHECK_EQ(stats.frame_allocations, 0);
+  CHECK_EQ(stats.last_frame_allocations, 3);
+  CHECK_EQ(stats.last_frame_bytes, 30);
+  bj_release_frame_memory();
+}
+
+TEST_CASE(memory_stats_count_arena_blocks) {
+  struct bj_memory_stats before, during, after;
+  bj_get_memory_stats(&before);
+
+  struct bj_arena *arena = bj_create_arena(4096);
+  REQUIRE_VALUE(arena);
+  REQUIRE_VALUE(bj_arena_allocate(arena, 100));
+  REQUIRE_VALUE(bj_arena_allocate(arena, 8000)); // Own block
+  bj_get_memory_stats(&during);
+  CHECK(during.live_bytes - before.live_bytes >= 4096 + 8000);
+  CHECK_EQ(during.live_allocations - before.live_allocations, 3);
+  CHECK(during.frame_bytes - before.frame_bytes >= 4096 + 8000);
+
+  bj_destroy_arena(arena);
+  bj_get_memory_stats(&after);
+  CHECK_EQ(after.live_bytes, before.live_bytes);
+  CHECK_EQ(after.live_allocations, before.live_allocations);
+}
+
+TEST_CASE(memory_stats_record_call_sites) {
+  const int line = __LINE__ + 1;
+  void *hot = bj_malloc(1 << 20);
+  REQUIRE_VALUE(hot);
+
+  struct bj_memory_call_site sites[4];
+  const size_t count = bj_get_memory_call_sites(sites, 4);
+  REQUIRE(count >= 1);
+  CHECK(sites[0].file != 0 && strstr(sites[0].file, "unit_memory_stats.c") != 0);
+  CHECK_EQ(sites[0].line, line);
+  CHECK_EQ(sites[0].live_bytes, 1 << 20);
+  for (size_t s = 1; s < count && s < 4; ++s) {
+    CHECK(sites[s].bytes <= sites[s - 1].bytes);
+  }
+
+  bj_dump_memory_stats();
+  bj_free(hot);
+}
+
+#endif
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(memory_stats_follow_build_config);
+#ifdef BJ_CONFIG_MEMORY_STATS
+  RUN_TEST(memory_stats_count_live_and_peak_bytes);
+  RUN_TEST(memory_stats_close_frames);
+  RUN_TEST(memory_stats_count_arena_blocks);
+  RUN_TEST(memory_stats_record_call_sites);
+#endif
+
+  END_TESTS();
+}
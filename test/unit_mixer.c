@@ -0,0 +1,209 @@
+#include "test.h"
+#include <banjo/mixer.h>
+
+static const struct bj_audio_properties mono_f32 = {
+    .format = BJ_AUDIO_FORMAT_F32,
+    .channels = 1,
+    .sample_rate = 1000,
+};
+
+static const struct bj_audio_properties stereo_f32 = {
+    .format = BJ_AUDIO_FORMAT_F32,
+    .channels = 2,
+    .sample_rate = 1000,
+};
+
+static int near(float a, float b) {
+  const float d = a - b;
+  return d < 1e-4f && d > -1e-4f;
+}
+
+TEST_CASE(mixer_applies_gain_and_pan) {
+  struct bj_mixer *mixer = bj_create_mixer(4);
+  REQUIRE_VALUE(mixer);
+
+  float samples[8];
+  for (int i = 0; i < 8; ++i) {
+    samples[i] = 0.5f;
+  }
+  const struct bj_mixer_sound sound = {
+      .samples = samples,
+      .frames = 8,
+      .format = BJ_AUDIO_FORMAT_F32,
+      .channels = 1,
+      .sample_rate = 1000,
+  };
+
+  const uint32_t left = bj_mixer_play_sound(mixer, &sound, 1.0f, -1.0f);
+  const uint32_t center = bj_mixer_play_sound(mixer, &sound, 0.5f, 0.0f);
+  REQUIRE(left != 0 && center != 0 && left != center);
+
+  float out[2 * 4];
+  bj_mix(mixer, out, 4, &stereo_f32);
+  CHECK(near(out[0], 0.5f + 0.25f * 0.70710678f));
+  CHECK(near(out[1], 0.25f * 0.70710678f));
+
+  bj_mixer_set_gain(mixer, center, 0.0f);
+  bj_mixer_set_master_gain(mixer, 2.0f);
+  bj_mix(mixer, out, 4, &stereo_f32);
+  CHECK(near(out[6], 1.0f));
+  CHECK(near(out[7], 0.0f));
+
+  bj_destroy_mixer(mixer);
+}
+
+TEST_CASE(mixer_int16_rounding_is_position_independent) {
+  struct bj_mixer *mixer = bj_create_mixer(1);
+  REQUIRE_VALUE(mixer);
+
+  // 2.5 LSB: a tie, which half-away-from-zero and half-to-even round apart
+  float samples[11];
+  for (int i = 0; i < 11; ++i) {
+    samples[i] = 2.5f / 32768.0f;
+  }
+  const struct bj_mixer_sound sound = {
+      .samples = samples,
+      .frames = 11,
+      .format = BJ_AUDIO_FORMAT_F32,
+      .channels = 1,
+      .sample_rate = 1000,
+  };
+  const struct bj_audio_properties mono_int16 = {
+      .format = BJ_AUDIO_FORMAT_INT16,
+      .channels = 1,
+      .sample_rate = 1000,
+  };
+  REQUIRE(bj_mixer_play_sound(mixer, &sound, 1.0f, 0.0f) != 0);
+
+  // The first 8 samples go through the vector kernel, the rest are scalar
+  int16_t out[11];
+  bj_mix(mixer, out, 11, &mono_int16);
+  int same = 1;
+  for (int i = 0; i < 11; ++i) {
+    same = same && out[i] == out[0];
+  }
+  CHECK(same);
+  CHECK_EQ(out[10], 2);
+
+  bj_destroy_mixer(mixer);
+}
+
+TEST_CASE(mixer_loops_and_stops) {
+  struct bj_mixer *mixer = bj_create_mixer(1);
+  REQUIRE_VALUE(mixer);
+
+  const int16_t samples[4] = {0, 8192, 16384, -16384};
+  struct bj_mixer_sound sound = {
+      .samples = samples,
+      .frames = 4,
+      .format = BJ_AUDIO_FORMAT_INT16,
+      .channels = 1,
+      .sample_rate = 1000,
+  };
+
+  // Plays once, then the voice is released and the output is silent
+  uint32_t voice = bj_mixer_play_sound(mixer, &sound, 1.0f, 0.0f);
+  REQUIRE(voice != 0);
+  CHECK_EQ(bj_mixer_play_sound(mixer, &sound, 1.0f, 0.0f), 0);
+  float out[10];
+  bj_mix(mixer, out, 6, &mono_f32);
+  CHECK(near(out[1], 0.25f));
+  CHECK(near(out[3], -0.5f));
+  CHECK(near(out[4], 0.0f));
+  CHECK(!bj_mixer_voice_playing(mixer, voice));
+
+  // Loops over frames 1 and 2
+  sound.loop_start = 1;
+  sound.loop_end = 3;
+  const uint32_t looping = bj_mixer_play_sound(mixer, &sound, 1.0f, 0.0f);
+  REQUIRE(looping != 0);
+  CHECK(looping != voice);
+  bj_mix(mixer, out, 7, &mono_f32);
+  CHECK(near(out[3], 0.25f));
+  CHECK(near(out[6], 0.5f));
+  CHECK(bj_mixer_voice_playing(mixer, looping));
+
+  // The old handle must not stop the voice now using its slot
+  bj_mixer_stop(mixer, voice);
+  CHECK(bj_mixer_voice_playing(mixer, looping));
+  bj_mixer_stop(mixer, looping);
+  CHECK(!bj_mixer_voice_playing(mixer, looping));
+
+  bj_destroy_mixer(mixer);
+}
+
+TEST_CASE(mixer_pitch_resamples) {
+  struct bj_mixer *mixer = bj_create_mixer(1);
+  REQUIRE_VALUE(mixer);
+
+  float ramp[16];
+  for (int i = 0; i < 16; ++i) {
+    ramp[i] = (float)i / 16.0f;
+  }
+  const struct bj_mixer_sound sound = {
+      .samples = ramp,
+      .frames = 16,
+      .format = BJ_AUDIO_FORMAT_F32,
+      .channels = 1,
+      .sample_rate = 500,
+  };
+
+  // Half the output rate: every other output is between two source frames
+  const uint32_t voice = bj_mixer_play_sound(mixer, &sound, 1.0f, 0.0f);
+  float out[4];
+  bj_mix(mixer, out, 4, &mono_f32);
+  CHECK(near(out[1], 0.5f / 16.0f));
+  CHECK(near(out[2], 1.0f / 16.0f));
+
+  // Pitch 4 at half the rate: two source frames per output frame
+  bj_mixer_set_pitch(mixer, voice, 4.0f);
+  bj_mix(mixer, out, 2, &mono_f32);
+  CHECK(near(out[0], 2.0f / 16.0f));
+  CHECK(near(out[1], 4.0f / 16.0f));
+
+  bj_destroy_mixer(mixer);
+}
+
+static bj_bool countdown(float *samples, unsigned frames,
+                         unsigned int sample_rate, void *user_data) {
+  (void)sample_rate;
+  int *remaining = user_data;
+  for (unsigned i = 0; i < frames; ++i) {
+    samples[i] = 0.75f;
+  }
+  return --*remaining > 0;
+}
+
+TEST_CASE(mixer_runs_generators_and_clips) {
+  struct bj_mixer *mixer = bj_create_mixer(2);
+  REQUIRE_VALUE(mixer);
+
+  // Each generator stops after its first block of frames
+  int calls_a = 1;
+  int calls_b = 1;
+  const uint32_t a = bj_mixer_play_generator(mixer, countdown, &calls_a, 1.0f, 0.0f);
+  const uint32_t b = bj_mixer_play_generator(mixer, countdown, &calls_b, 1.0f, 0.0f);
+  REQUIRE(a != 0 && b != 0);
+
+  int16_t out[300];
+  bj_mix(mixer, out, 300, &(struct bj_audio_properties){
+      .format = BJ_AUDIO_FORMAT_INT16, .channels = 1, .sample_rate = 1000});
+  CHECK_EQ(out[0], 32767);
+  CHECK(!bj_mixer_voice_playing(mixer, a));
+  CHECK(!bj_mixer_voice_playing(mixer, b));
+  CHECK_EQ(out[299], 0);
+
+  bj_destroy_mixer(mixer);
+}
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(mixer_applies_gain_and_pan);
+  RUN_TEST(mixer_int16_rounding_is_position_independent);
+  RUN_TEST(mixer_loops_and_stops);
+  RUN_TEST(mixer_pitch_resamples);
+  RUN_TEST(mixer_runs_generators_and_clips);
+
+  END_TESTS();
+}
@@ -0,0 +1,117 @@
+#include "test.h"
+#include <banjo/audio.h>
+#include <banjo/math.h>
+#include <banjo/oscillator.h>
+
+#define RATE 48000
+
+static float samples[2048];
+
+TEST_CASE(oscillator_sine_matches_sin) {
+  struct bj_oscillator osc;
+  bj_init_oscillator(&osc, BJ_OSCILLATOR_SINE, 440.0f, 0.5f, RATE);
+
+  // Several blocks, to cross the points where the rotation restarts
+  bj_render_oscillator(&osc, samples, 700);
+  bj_render_oscillator(&osc, samples + 700, 1348);
+
+  float error = 0.0f;
+  for (size_t i = 0; i < 2048; ++i) {
+    const float ideal = 0.5f * (float)bj_sind(BJ_TAU_D * 440.0 * (double)i / RATE);
+    const float diff = bj_absf(samples[i] - ideal);
+    error = diff > error ? diff : error;
+  }
+  CHECK(error < 1e-4f);
+}
+
+TEST_CASE(oscillator_blocks_are_continuous) {
+  struct bj_oscillator whole;
+  struct bj_oscillator split;
+  bj_init_oscillator(&whole, BJ_OSCILLATOR_SAWTOOTH, 1234.5f, 1.0f, RATE);
+  bj_init_oscillator(&split, BJ_OSCILLATOR_SAWTOOTH, 1234.5f, 1.0f, RATE);
+
+  float parts[1000];
+  bj_render_oscillator(&whole, samples, 1000);
+  bj_render_oscillator(&split, parts, 333);
+  bj_render_oscillator(&split, parts + 333, 667);
+
+  int same = 1;
+  for (size_t i = 0; i < 1000; ++i) {
+    same &= samples[i] == parts[i];
+  }
+  CHECK(same);
+  CHECK_EQ(whole.phase, split.phase);
+}
+
+TEST_CASE(oscillator_polyblep_bounds_square) {
+  struct bj_oscillator osc;
+  bj_init_oscillator(&osc, BJ_OSCILLATOR_SQUARE, 3000.0f, 1.0f, RATE);
+  bj_render_oscillator(&osc, samples, 1600);
+
+  // 100 full periods: no overshoot, no DC offset, and the edges are
+  // smoothed instead of jumping from -1 to 1 in one sample
+  float sum = 0.0f;
+  float peak = 0.0f;
+  int softened = 0;
+  for (size_t i = 0; i < 1600; ++i) {
+    sum += samples[i];
+    peak = bj_absf(samples[i]) > peak ? bj_absf(samples[i]) : peak;
+    softened |= bj_absf(samples[i]) < 0.9f;
+  }
+  CHECK(peak <= 1.0f);
+  CHECK(bj_absf(sum / 1600.0f) < 1e-3f);
+  CHECK(softened);
+  CHECK(samples[4] == 1.0f);
+  CHECK(samples[12] == -1.0f);
+}
+
+TEST_CASE(oscillator_follows_frequency_changes) {
+  struct bj_oscillator osc;
+  bj_init_oscillator(&osc, BJ_OSCILLATOR_TRIANGLE, 1000.0f, 1.0f, RATE);
+  CHECK(bj_absf(osc.frequency - 1000.0f) < 1e-6f);
+  const uint32_t increment = osc.increment;
+
+  bj_set_oscillator_frequency(&osc, 2000.0f);
+  const int64_t twice = (int64_t)osc.increment - 2 * (int64_t)increment;
+  CHECK(twice >= -2 && twice <= 2);
+
+  // The mixer generator adapts to the output rate
+  bj_oscillator_generator(samples, 4, RATE / 2, &osc);
+  CHECK_EQ(osc.sample_rate, RATE / 2);
+  const int64_t four_times = (int64_t)osc.increment - 4 * (int64_t)increment;
+  CHECK(four_times >= -4 && four_times <= 4);
+}
+
+TEST_CASE(oscillator_play_note_fills_all_channels) {
+  struct bj_audio_play_note_data note = {.function = BJ_AUDIO_PLAY_SINE, .frequency = 1000.0};
+  const struct bj_audio_properties audio = {
+      .format = BJ_AUDIO_FORMAT_INT16, .amplitude = 16000, .channels = 2, .sample_rate = RATE};
+
+  int16_t frames[2 * 300];
+  bj_play_audio_note(frames, 300, &audio, &note, 0);
+
+  int stereo = 1;
+  for (size_t i = 0; i < 300; ++i) {
+    stereo &= frames[2 * i] == frames[2 * i + 1];
+  }
+  CHECK(stereo);
+  CHECK_EQ(frames[0], 0);
+  CHECK(frames[2 * 12] > 15990); // Quarter period at 1 kHz
+
+  // The phase continues from the sample index of the next period
+  int16_t next[2 * 12];
+  bj_play_audio_note(next, 12, &audio, &note, 288);
+  CHECK(next[0] - frames[2 * 288] < 2 && frames[2 * 288] - next[0] < 2);
+}
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(oscillator_sine_matches_sin);
+  RUN_TEST(oscillator_blocks_are_continuous);
+  RUN_TEST(oscillator_polyblep_bounds_square);
+  RUN_TEST(oscillator_follows_frequency_changes);
+  RUN_TEST(oscillator_play_note_fills_all_channels);
+
+  END_TESTS();
+}
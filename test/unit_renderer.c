@@ -0,0 +1,111 @@
+#include "test.h"
+#include <banjo/rect.h>
+#include <banjo/renderer.h>
+
+#include "renderer.h"
+
+static size_t region_area(const struct bj_dirty_region *region) {
+  size_t area = 0;
+  for (size_t i = 0; i < region->count; ++i) {
+    area += (size_t)region->rects[i].w * region->rects[i].h;
+  }
+  return area;
+}
+
+static bj_bool region_covers(const struct bj_dirty_region *region,
+                             const struct bj_rect *area) {
+  for (size_t i = 0; i < region->count; ++i) {
+    struct bj_rect common;
+    if (bj_rect_intersection(&region->rects[i], area, &common) &&
+        common.x == area->x && common.y == area->y && common.w == area->w &&
+        common.h == area->h) {
+      return BJ_TRUE;
+    }
+  }
+  return BJ_FALSE;
+}
+
+TEST_CASE(dirty_region_keeps_separate_rects) {
+  struct bj_dirty_region region = {0};
+  const struct bj_rect a = {0, 0, 10, 10};
+  const struct bj_rect b = {50, 50, 4, 4};
+
+  bj_dirty_region_add(&region, &a);
+  bj_dirty_region_add(&region, &b);
+
+  REQUIRE_EQ(region.count, 2);
+  CHECK(region_covers(&region, &a));
+  CHECK(region_covers(&region, &b));
+  CHECK_EQ(region_area(&region), 116);
+}
+
+TEST_CASE(dirty_region_merges_overlapping_and_touching) {
+  struct bj_dirty_region region = {0};
+  const struct bj_rect a = {0, 0, 10, 10};
+  const struct bj_rect b = {5, 5, 10, 10};
+  const struct bj_rect c = {15, 0, 5, 5}; // Touches the union of a and b
+
+  bj_dirty_region_add(&region, &a);
+  bj_dirty_region_add(&region, &b);
+  REQUIRE_EQ(region.count, 1);
+  CHECK_EQ(region.rects[0].w, 15);
+  CHECK_EQ(region.rects[0].h, 15);
+
+  bj_dirty_region_add(&region, &c);
+  REQUIRE_EQ(region.count, 1);
+  CHECK_EQ(region.rects[0].x, 0);
+  CHECK_EQ(region.rects[0].y, 0);
+  CHECK_EQ(region.rects[0].w, 20);
+  CHECK_EQ(region.rects[0].h, 15);
+}
+
+TEST_CASE(dirty_region_bridging_rect_merges_chain) {
+  struct bj_dirty_region region = {0};
+  const struct bj_rect left = {0, 0, 4, 4};
+  const struct bj_rect right = {20, 0, 4, 4};
+  const struct bj_rect bridge = {2, 1, 20, 2};
+
+  bj_dirty_region_add(&region, &left);
+  bj_dirty_region_add(&region, &right);
+  REQUIRE_EQ(region.count, 2);
+
+  bj_dirty_region_add(&region, &bridge);
+  REQUIRE_EQ(region.count, 1);
+  CHECK_EQ(region.rects[0].x, 0);
+  CHECK_EQ(region.rects[0].w, 24);
+  CHECK_EQ(region.rects[0].h, 4);
+}
+
+TEST_CASE(dirty_region_overflow_folds_closest) {
+  struct bj_dirty_region region = {0};
+  struct bj_rect cells[BJ_MAX_DIRTY_RECTS + 1];
+
+  // A row of isolated cells, then one more right next to the last cell
+  for (size_t i = 0; i < BJ_MAX_DIRTY_RECTS; ++i) {
+    cells[i] = (struct bj_rect){(int16_t)(i * 100), 0, 8, 8};
+    bj_dirty_region_add(&region, &cells[i]);
+  }
+  REQUIRE_EQ(region.count, BJ_MAX_DIRTY_RECTS);
+
+  cells[BJ_MAX_DIRTY_RECTS] =
+      (struct bj_rect){(int16_t)((BJ_MAX_DIRTY_RECTS - 1) * 100 + 10), 0, 8, 8};
+  bj_dirty_region_add(&region, &cells[BJ_MAX_DIRTY_RECTS]);
+
+  REQUIRE_EQ(region.count, BJ_MAX_DIRTY_RECTS);
+  for (size_t i = 0; i <= BJ_MAX_DIRTY_RECTS; ++i) {
+    CHECK(region_covers(&region, &cells[i]));
+  }
+  // Only the 2 pixel gap between the last two cells was added
+  CHECK_EQ(region_area(&region), (BJ_MAX_DIRTY_RECTS + 1) * 64 + 16);
+}
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(dirty_region_keeps_separate_rects);
+  RUN_TEST(dirty_region_merges_overlapping_and_touching);
+  RUN_TEST(dirty_region_bridging_rect_merges_chain);
+  RUN_TEST(dirty_region_overflow_folds_closest);
+
+  END_TESTS();
+}
@@ -0,0 +1,127 @@
+#include "test.h"
+#include <banjo/audio.h>
+#include <banjo/math.h>
+
+#define TONE_FRAMES 2048
+
+static float tone[TONE_FRAMES * 2];
+static float out[TONE_FRAMES * 6];
+
+// Stereo sine at `frequency`, both channels in phase
+static void make_tone(double frequency, double rate) {
+  for (size_t i = 0; i < TONE_FRAMES; ++i) {
+    const float value = (float)bj_sind(BJ_TAU_D * frequency * (double)i / rate);
+    tone[2 * i] = value;
+    tone[2 * i + 1] = -value;
+  }
+}
+
+// Largest difference with the ideal sine, skipping the edges where the
+// filter reads silence
+static float max_error(size_t frames, double frequency, double rate) {
+  float error = 0.0f;
+  for (size_t i = 64; i + 64 < frames; ++i) {
+    const float ideal = (float)bj_sind(BJ_TAU_D * frequency * (double)i / rate);
+    const float diff = bj_absf(out[2 * i] - ideal);
+    error = diff > error ? diff : error;
+  }
+  return error;
+}
+
+TEST_CASE(resampler_same_rate_is_identity) {
+  struct bj_resampler *resampler = bj_create_resampler(2, 48000, 48000, BJ_RESAMPLE_SINC);
+  REQUIRE_VALUE(resampler);
+  make_tone(1000.0, 48000.0);
+
+  size_t consumed = 0;
+  const size_t produced = bj_resample(resampler, tone, TONE_FRAMES, &consumed, out, TONE_FRAMES);
+  CHECK_EQ(consumed, TONE_FRAMES);
+  // The last frames wait for input after them
+  CHECK(produced + 16 >= TONE_FRAMES);
+
+  float error = 0.0f;
+  for (size_t i = 0; i < produced * 2; ++i) {
+    const float diff = bj_absf(out[i] - tone[i]);
+    error = diff > error ? diff : error;
+  }
+  CHECK(error < 1e-6f);
+  bj_destroy_resampler(resampler);
+}
+
+TEST_CASE(resampler_keeps_pitch) {
+  make_tone(1000.0, 22050.0);
+
+  const enum bj_resample_quality qualities[] = {BJ_RESAMPLE_SINC, BJ_RESAMPLE_LINEAR};
+  const float tolerances[] = {0.002f, 0.02f};
+  for (size_t q = 0; q < 2; ++q) {
+    struct bj_resampler *resampler = bj_create_resampler(2, 22050, 48000, qualities[q]);
+    REQUIRE_VALUE(resampler);
+    size_t consumed = 0;
+    const size_t produced = bj_resample(resampler, tone, TONE_FRAMES, &consumed, out, TONE_FRAMES * 3);
+    CHECK_EQ(consumed, TONE_FRAMES);
+    CHECK(produced > 4400 && produced < 4460);
+    CHECK(max_error(produced, 1000.0, 48000.0) < tolerances[q]);
+    CHECK(bj_absf(out[200] + out[201]) < 1e-6f);
+    bj_destroy_resampler(resampler);
+  }
+}
+
+TEST_CASE(resampler_chunks_match_single_call) {
+  make_tone(3000.0, 44100.0);
+  struct bj_resampler *whole = bj_create_resampler(2, 44100, 32000, BJ_RESAMPLE_SINC);
+  struct bj_resampler *chunked = bj_create_resampler(2, 44100, 32000, BJ_RESAMPLE_SINC);
+  REQUIRE_VALUE(whole);
+  REQUIRE_VALUE(chunked);
+
+  size_t consumed = 0;
+  const size_t expected = bj_resample(whole, tone, TONE_FRAMES, &consumed, out, TONE_FRAMES);
+
+  // Odd input and output chunk sizes
+  float piece[2 * 7];
+  size_t read = 0;
+  size_t produced = 0;
+  int same = 1;
+  while (read < TONE_FRAMES) {
+    const size_t count = TONE_FRAMES - read < 13 ? TONE_FRAMES - read : 13;
+    size_t used = 0;
+    const size_t n = bj_resample(chunked, tone + 2 * read, count, &used, piece, 7);
+    for (size_t i = 0; i < n * 2; ++i) {
+      same &= piece[i] == out[2 * produced + i];
+    }
+    produced += n;
+    read += used;
+  }
+  // Drains what the last output chunks had no room for
+  for (size_t n = 1; n > 0; produced += n) {
+    n = bj_resample(chunked, tone, 0, &consumed, piece, 7);
+    for (size_t i = 0; i < n * 2; ++i) {
+      same &= piece[i] == out[2 * produced + i];
+    }
+  }
+  CHECK(same);
+  CHECK_EQ(produced, expected);
+
+  bj_reset_resampler(chunked);
+  CHECK_EQ(bj_resample(chunked, tone, 100, &consumed, piece, 7), 7);
+  CHECK(piece[0] == out[0] && piece[13] == out[13]);
+
+  bj_destroy_resampler(whole);
+  bj_destroy_resampler(chunked);
+}
+
+TEST_CASE(resampler_rejects_invalid_parameters) {
+  CHECK_NULL(bj_create_resampler(0, 44100, 48000, BJ_RESAMPLE_SINC));
+  CHECK_NULL(bj_create_resampler(2, 0, 48000, BJ_RESAMPLE_SINC));
+  CHECK_NULL(bj_create_resampler(2, 44100, 48000, BJ_RESAMPLE_NONE));
+}
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(resampler_same_rate_is_identity);
+  RUN_TEST(resampler_keeps_pitch);
+  RUN_TEST(resampler_chunks_match_single_call);
+  RUN_TEST(resampler_rejects_invalid_parameters);
+
+  END_TESTS();
+}
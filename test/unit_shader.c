@@ -1,6 +1,8 @@
 #include "test.h"
 #include <banjo/bitmap.h>
+#include <banjo/memory.h>
 #include <banjo/shader.h>
+#include <banjo/system.h>
 #include <banjo/vec.h>
 
 // Note: Shader tests are simplified because full bitmap testing
@@ -24,10 +26,259 @@ TEST_CASE(shader_compiles_and_links) {
   REQUIRE(red_shader != NULL);
 }
 
+// Mixes the input color with the position and discards a checkerboard
+static int mixing_shader(struct bj_vec3 *out_color,
+                         const struct bj_vec2 pixel_coord, void *user_data) {
+  (void)user_data;
+  const int cx = (int)pixel_coord.x;
+  const int cy = (int)pixel_coord.y;
+  if (((cx / 3) + (cy / 2)) % 2 == 0) {
+    return 0;
+  }
+  const struct bj_vec3 in = *out_color;
+  out_color->x = in.z;
+  out_color->y = in.x * BJ_F(0.5) + pixel_coord.x * BJ_F(0.01);
+  out_color->z = in.y * BJ_F(0.25) + pixel_coord.y * BJ_F(0.02);
+  return 1;
+}
+
+static const enum bj_pixel_mode shaded_modes[] = {
+    BJ_PIXEL_MODE_XRGB8888, BJ_PIXEL_MODE_BGR24,    BJ_PIXEL_MODE_RGB565,
+    BJ_PIXEL_MODE_XRGB1555, BJ_PIXEL_MODE_ARGB8888, BJ_PIXEL_MODE_INDEXED_4,
+};
+#define N_SHADED_MODES (sizeof(shaded_modes) / sizeof(shaded_modes[0]))
+
+static void fill_pattern(struct bj_bitmap *bmp) {
+  uint32_t seed = 12345u;
+  for (size_t y = 0; y < bj_bitmap_height(bmp); ++y) {
+    for (size_t x = 0; x < bj_bitmap_width(bmp); ++x) {
+      seed = seed * 1664525u + 1013904223u;
+      bj_put_pixel(bmp, x, y, seed >> 8);
+    }
+  }
+}
+
+// Per-pixel shading through the public pixel API, without flags
+static void reference_shade(struct bj_bitmap *bmp) {
+  const bj_real inv255 = BJ_FI(255.0);
+  for (size_t y = 0; y < bj_bitmap_height(bmp); ++y) {
+    for (size_t x = 0; x < bj_bitmap_width(bmp); ++x) {
+      uint8_t r, g, b;
+      bj_make_bitmap_rgb(bmp, x, y, &r, &g, &b);
+      struct bj_vec3 color = {(bj_real)r * inv255, (bj_real)g * inv255, (bj_real)b * inv255};
+      const struct bj_vec2 coords = {(bj_real)x, (bj_real)y};
+      if (mixing_shader(&color, coords, 0) > 0) {
+        r = (uint8_t)(color.x * BJ_F(255.0) + BJ_F(0.5));
+        g = (uint8_t)(color.y * BJ_F(255.0) + BJ_F(0.5));
+        b = (uint8_t)(color.z * BJ_F(255.0) + BJ_F(0.5));
+        bj_put_pixel(bmp, x, y, bj_make_bitmap_pixel(bmp, r, g, b));
+      }
+    }
+  }
+}
+
+static int same_pixels(struct bj_bitmap *a, struct bj_bitmap *b) {
+  for (size_t y = 0; y < bj_bitmap_height(a); ++y) {
+    for (size_t x = 0; x < bj_bitmap_width(a); ++x) {
+      if (bj_bitmap_pixel(a, x, y) != bj_bitmap_pixel(b, x, y)) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+TEST_CASE(shader_matches_pixel_api) {
+  for (size_t m = 0; m < N_SHADED_MODES; ++m) {
+    struct bj_bitmap *shaded = bj_create_bitmap(37, 11, shaded_modes[m], 0);
+    struct bj_bitmap *expected = bj_create_bitmap(37, 11, shaded_modes[m], 0);
+    REQUIRE_VALUE(shaded);
+    REQUIRE_VALUE(expected);
+    fill_pattern(shaded);
+    fill_pattern(expected);
+
+    bj_shader_bitmap(shaded, mixing_shader, 0, 0);
+    reference_shade(expected);
+    CHECK(same_pixels(shaded, expected));
+
+    bj_destroy_bitmap(shaded);
+    bj_destroy_bitmap(expected);
+  }
+}
+
+TEST_CASE(shader_parallel_matches_serial) {
+  const size_t thread_counts[] = {2, 3, 8};
+  const size_t heights[] = {1, 2, 5, 64};
+  for (size_t m = 0; m < N_SHADED_MODES; ++m) {
+    for (size_t t = 0; t < 3; ++t) {
+      for (size_t h = 0; h < 4; ++h) {
+        struct bj_bitmap *serial = bj_create_bitmap(45, heights[h], shaded_modes[m], 0);
+        struct bj_bitmap *parallel = bj_create_bitmap(45, heights[h], shaded_modes[m], 0);
+        REQUIRE_VALUE(serial);
+        REQUIRE_VALUE(parallel);
+        fill_pattern(serial);
+        fill_pattern(parallel);
+
+        bj_set_shader_thread_count(thread_counts[t]);
+        bj_shader_bitmap(serial, mixing_shader, 0, BJ_SHADER_STANDARD_FLAGS);
+        bj_shader_bitmap(parallel, mixing_shader, 0, BJ_SHADER_STANDARD_FLAGS | BJ_SHADER_PARALLEL);
+        CHECK(same_pixels(serial, parallel));
+
+        bj_destroy_bitmap(serial);
+        bj_destroy_bitmap(parallel);
+      }
+    }
+  }
+  bj_set_shader_thread_count(0);
+}
+
+// The same effect as a per-pixel shader and as a span shader
+static int gradient_shader(struct bj_vec3 *out_color,
+                           const struct bj_vec2 pixel_coord, void *user_data) {
+  (void)user_data;
+  out_color->x = out_color->x * BJ_F(0.5) + pixel_coord.x;
+  out_color->y = pixel_coord.y * BJ_F(0.75);
+  out_color->z = out_color->z - pixel_coord.x * pixel_coord.y;
+  return 1;
+}
+
+static int gradient_span(struct bj_shader_span *span, void *user_data) {
+  (void)user_data;
+  for (size_t i = 0; i < span->count; ++i) {
+    span->red[i] = span->red[i] * BJ_F(0.5) + span->x[i];
+    span->green[i] = span->y * BJ_F(0.75);
+    span->blue[i] = span->blue[i] - span->x[i] * span->y;
+  }
+  return 1;
+}
+
+// Leaves every other row untouched
+static int odd_rows_span(struct bj_shader_span *span, void *user_data) {
+  size_t *row = (size_t *)user_data;
+  if ((*row)++ % 2 == 0) {
+    return 0;
+  }
+  for (size_t i = 0; i < span->count; ++i) {
+    span->red[i] = BJ_F(1.0);
+    span->green[i] = BJ_FZERO;
+    span->blue[i] = BJ_FZERO;
+  }
+  return 1;
+}
+
+TEST_CASE(shader_span_matches_shader) {
+  const uint8_t flag_sets[] = {
+      0, BJ_SHADER_STANDARD_FLAGS, BJ_SHADER_INVERT_X | BJ_SHADER_CENTER_COORDS,
+      BJ_SHADER_STANDARD_FLAGS | BJ_SHADER_PARALLEL};
+  bj_set_shader_thread_count(3);
+  for (size_t m = 0; m < N_SHADED_MODES; ++m) {
+    for (size_t f = 0; f < 4; ++f) {
+      struct bj_bitmap *per_pixel = bj_create_bitmap(29, 13, shaded_modes[m], 0);
+      struct bj_bitmap *per_span = bj_create_bitmap(29, 13, shaded_modes[m], 0);
+      REQUIRE_VALUE(per_pixel);
+      REQUIRE_VALUE(per_span);
+      fill_pattern(per_pixel);
+      fill_pattern(per_span);
+
+      bj_shader_bitmap(per_pixel, gradient_shader, 0, flag_sets[f] | BJ_SHADER_CLAMP_COLOR);
+      bj_shader_bitmap_span(per_span, gradient_span, 0, flag_sets[f] | BJ_SHADER_CLAMP_COLOR);
+      CHECK(same_pixels(per_pixel, per_span));
+
+      bj_destroy_bitmap(per_pixel);
+      bj_destroy_bitmap(per_span);
+    }
+  }
+  bj_set_shader_thread_count(0);
+}
+
+TEST_CASE(shader_span_discarded_rows_are_untouched) {
+  struct bj_bitmap *bmp = bj_create_bitmap(16, 6, BJ_PIXEL_MODE_XRGB8888, 0);
+  struct bj_bitmap *original = bj_create_bitmap(16, 6, BJ_PIXEL_MODE_XRGB8888, 0);
+  REQUIRE_VALUE(bmp);
+  REQUIRE_VALUE(original);
+  fill_pattern(bmp);
+  fill_pattern(original);
+
+  size_t row = 0;
+  bj_shader_bitmap_span(bmp, odd_rows_span, &row, 0);
+  CHECK_EQ(row, 6);
+
+  int kept = 1;
+  int shaded = 1;
+  for (size_t y = 0; y < 6; ++y) {
+    for (size_t x = 0; x < 16; ++x) {
+      if (y % 2 == 0) {
+        kept = kept && bj_bitmap_pixel(bmp, x, y) == bj_bitmap_pixel(original, x, y);
+      } else {
+        shaded = shaded && bj_bitmap_pixel(bmp, x, y) == 0x00FF0000u;
+      }
+    }
+  }
+  CHECK(kept);
+  CHECK(shaded);
+
+  bj_destroy_bitmap(bmp);
+  bj_destroy_bitmap(original);
+}
+
+static int red_span(struct bj_shader_span *span, void *user_data) {
+  (void)user_data;
+  for (size_t i = 0; i < span->count; ++i) {
+    span->red[i] = BJ_F(1.0);
+    span->green[i] = BJ_FZERO;
+    span->blue[i] = BJ_FZERO;
+  }
+  return 1;
+}
+
+static void *failing_malloc(void *user_data, size_t size) {
+  (void)user_data;
+  (void)size;
+  return 0;
+}
+
+TEST_CASE(shader_span_reports_allocation_failure) {
+  struct bj_bitmap *bmp = bj_create_bitmap(64, 4, BJ_PIXEL_MODE_XRGB8888, 0);
+  REQUIRE_VALUE(bmp);
+  fill_pattern(bmp);
+  const uint32_t before = bj_bitmap_pixel(bmp, 3, 2);
+
+  struct bj_memory_callbacks defaults;
+  bj_get_memory_defaults(&defaults);
+  struct bj_memory_callbacks failing = defaults;
+  failing.fn_allocation = failing_malloc;
+  bj_set_memory_defaults(&failing);
+  const bj_bool shaded = bj_shader_bitmap_span(bmp, red_span, 0, 0);
+  bj_set_memory_defaults(&defaults);
+
+  CHECK(!shaded);
+  CHECK_EQ(bj_bitmap_pixel(bmp, 3, 2), before);
+  CHECK(bj_shader_bitmap_span(bmp, red_span, 0, 0));
+  CHECK_EQ(bj_bitmap_pixel(bmp, 3, 2), 0x00FF0000u);
+
+  bj_destroy_bitmap(bmp);
+}
+
+TEST_CASE(shader_thread_count) {
+  bj_set_shader_thread_count(3);
+  CHECK_EQ(bj_shader_thread_count(), 3);
+  bj_set_shader_thread_count(0);
+  CHECK(bj_shader_thread_count() >= 1);
+}
+
 int main(int argc, char *argv[]) {
   BEGIN_TESTS(argc, argv);
 
   RUN_TEST(shader_compiles_and_links);
+  RUN_TEST(shader_matches_pixel_api);
+  RUN_TEST(shader_parallel_matches_serial);
+  RUN_TEST(shader_span_matches_shader);
+  RUN_TEST(shader_span_discarded_rows_are_untouched);
+  RUN_TEST(shader_span_reports_allocation_failure);
+  RUN_TEST(shader_thread_count);
+
+  // Stops the shader worker threads
+  bj_end();
 
   END_TESTS();
 }
@@ -1,6 +1,7 @@
 #include "test.h"
 #include <banjo/stream.h>
 #include <banjo/memory.h>
+#include <stdio.h>
 #include <string.h>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -244,6 +245,267 @@ TEST_CASE(stream_open_file_null_error_is_safe) {
     REQUIRE_NULL(s);
 }
 
+TEST_CASE(stream_open_file_exposes_content) {
+    const char content[] = "banjo stream file content";
+    FILE* file = fopen("unit_stream_file.bin", "wb");
+    REQUIRE_VALUE(file);
+    fwrite(content, 1, sizeof(content), file);
+    fclose(file);
+
+    struct bj_error* err = 0;
+    struct bj_stream* s = bj_open_stream_file("unit_stream_file.bin", &err);
+    REQUIRE_VALUE(s);
+    REQUIRE_NULL(err);
+    REQUIRE_EQ(bj_get_stream_length(s), sizeof(content));
+    REQUIRE_VALUE(bj_get_stream_data(s));
+    REQUIRE_EQ(memcmp(bj_get_stream_data(s), content, sizeof(content)), 0);
+
+    char buf[5] = {0};
+    bj_seek_stream(s, 6, BJ_SEEK_BEGIN);
+    REQUIRE_EQ(bj_read_stream(s, buf, 4), 4);
+    REQUIRE_EQ(memcmp(buf, "stre", 4), 0);
+    bj_close_stream(s);
+
+    // Empty files cannot be mapped and give an empty stream
+    file = fopen("unit_stream_file.bin", "wb");
+    REQUIRE_VALUE(file);
+    fclose(file);
+    s = bj_open_stream_file("unit_stream_file.bin", 0);
+    REQUIRE_VALUE(s);
+    REQUIRE_EQ(bj_get_stream_length(s), 0);
+    REQUIRE_NULL(bj_get_stream_data(s));
+    bj_close_stream(s);
+
+    remove("unit_stream_file.bin");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Buffered File Stream Tests
+////////////////////////////////////////////////////////////////////////////////
+
+#define BUFFERED_PATH    "unit_stream_buffered.bin"
+#define BUFFERED_CONTENT "0123456789ABCDEFGHIJ"
+
+static struct bj_stream* open_buffered(size_t buffer_size) {
+    FILE* f = fopen(BUFFERED_PATH, "wb");
+    if (f == 0) {
+        return 0;
+    }
+    fputs(BUFFERED_CONTENT, f);
+    fclose(f);
+    return bj_open_stream_file_buffered(BUFFERED_PATH, buffer_size, 0);
+}
+
+TEST_CASE(stream_buffered_reads_across_chunks) {
+    struct bj_stream* s = open_buffered(4);
+    REQUIRE_VALUE(s);
+    REQUIRE_EQ(bj_get_stream_length(s), 20);
+    REQUIRE_NULL(bj_get_stream_data(s));
+
+    char buf[32] = {0};
+    REQUIRE_EQ(bj_read_stream(s, buf, 3), 3);
+    REQUIRE_EQ(bj_read_stream(s, buf + 3, 6), 6);   // Crosses the buffer end
+    REQUIRE_EQ(bj_read_stream(s, buf + 9, 100), 11); // Partial at the end
+    REQUIRE(memcmp(buf, BUFFERED_CONTENT, 20) == 0);
+    REQUIRE_EQ(bj_tell_stream(s), 20);
+    REQUIRE_EQ(bj_read_stream(s, buf, 1), 0);
+
+    bj_close_stream(s);
+    remove(BUFFERED_PATH);
+}
+
+TEST_CASE(stream_buffered_seeks_lazily) {
+    struct bj_stream* s = open_buffered(4);
+    REQUIRE_VALUE(s);
+
+    char c = 0;
+    REQUIRE_EQ(bj_seek_stream(s, -3, BJ_SEEK_END), 17);
+    REQUIRE_EQ(bj_stream_read_t(s, char, &c), 1);
+    REQUIRE_EQ(c, 'H');
+
+    REQUIRE_EQ(bj_seek_stream(s, 5, BJ_SEEK_BEGIN), 5);
+    REQUIRE_EQ(bj_stream_skip_t(s, char), 1);
+    REQUIRE_EQ(bj_stream_read_t(s, char, &c), 1);
+    REQUIRE_EQ(c, '6');
+    REQUIRE_EQ(bj_tell_stream(s), 7);
+
+    REQUIRE_EQ(bj_seek_stream(s, 100, BJ_SEEK_CURRENT), 20);
+
+    bj_close_stream(s);
+    remove(BUFFERED_PATH);
+}
+
+TEST_CASE(stream_buffered_peek_beyond_buffer) {
+    struct bj_stream* s = open_buffered(4);
+    REQUIRE_VALUE(s);
+
+    const void* view = 0;
+    REQUIRE_EQ(bj_consume_stream(s, 2), 2);
+    REQUIRE_EQ(bj_peek_stream(s, 3, &view), 3);
+    REQUIRE(memcmp(view, "234", 3) == 0);
+
+    // Contiguous even when larger than the buffer
+    REQUIRE_EQ(bj_peek_stream(s, 10, &view), 10);
+    REQUIRE(memcmp(view, "23456789AB", 10) == 0);
+    REQUIRE_EQ(bj_tell_stream(s), 2);
+
+    REQUIRE_EQ(bj_consume_stream(s, 15), 15);
+    REQUIRE_EQ(bj_peek_stream(s, 10, &view), 3);
+    REQUIRE(memcmp(view, "HIJ", 3) == 0);
+
+    bj_close_stream(s);
+    remove(BUFFERED_PATH);
+}
+
+TEST_CASE(stream_buffered_nonexistent_file_returns_error) {
+    struct bj_error* err = 0;
+    REQUIRE_NULL(bj_open_stream_file_buffered("/nonexistent/file.bin", 0, &err));
+    REQUIRE_VALUE(err);
+    bj_clear_error(&err);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Write Tests
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE(stream_write_grows_owned_buffer) {
+    struct bj_stream* s = bj_open_stream_write(0, 2);
+    REQUIRE_VALUE(s);
+
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE_EQ(bj_write_stream(s, "0123456789", 10), 10);
+    }
+    REQUIRE_EQ(bj_get_stream_length(s), 1000);
+    REQUIRE(memcmp((const char*)bj_get_stream_data(s) + 990, "0123456789", 10) == 0);
+
+    // Overwrites after seeking, and reads back
+    bj_seek_stream(s, 5, BJ_SEEK_BEGIN);
+    REQUIRE_EQ(bj_write_stream(s, "ab", 2), 2);
+    REQUIRE_EQ(bj_get_stream_length(s), 1000);
+    char buf[4] = {0};
+    bj_seek_stream(s, 4, BJ_SEEK_BEGIN);
+    REQUIRE_EQ(bj_read_stream(s, buf, 4), 4);
+    REQUIRE(memcmp(buf, "4ab7", 4) == 0);
+
+    bj_close_stream(s);
+}
+
+TEST_CASE(stream_write_truncates_provided_buffer) {
+    char data[6] = {0};
+    struct bj_stream* s = bj_open_stream_write(data, sizeof(data));
+    REQUIRE_VALUE(s);
+
+    REQUIRE_EQ(bj_write_stream(s, "abcd", 4), 4);
+    REQUIRE_EQ(bj_write_stream(s, "efgh", 4), 2);
+    REQUIRE_EQ(bj_write_stream(s, "ij", 2), 0);
+    REQUIRE(memcmp(data, "abcdef", 6) == 0);
+    REQUIRE_EQ(bj_get_stream_length(s), 6);
+
+    bj_close_stream(s);
+}
+
+TEST_CASE(stream_write_to_file) {
+    const char* path = "unit_stream_write.bin";
+    struct bj_stream* s = bj_open_stream_file_write(path, 0);
+    REQUIRE_VALUE(s);
+    REQUIRE_EQ(bj_write_stream(s, "Hello, World", 12), 12);
+    bj_seek_stream(s, 0, BJ_SEEK_BEGIN);
+    REQUIRE_EQ(bj_write_stream(s, "J", 1), 1);
+    REQUIRE_EQ(bj_tell_stream(s), 1);
+    REQUIRE_EQ(bj_get_stream_length(s), 12);
+    char c = 0;
+    REQUIRE_EQ(bj_read_stream(s, &c, 1), 0);
+    REQUIRE_NULL(bj_get_stream_data(s));
+    bj_close_stream(s);
+
+    s = bj_open_stream_file(path, 0);
+    REQUIRE_VALUE(s);
+    REQUIRE_EQ(bj_get_stream_length(s), 12);
+    REQUIRE(memcmp(bj_get_stream_data(s), "Jello, World", 12) == 0);
+    bj_close_stream(s);
+    remove(path);
+}
+
+TEST_CASE(stream_flush_reports_write_errors) {
+    struct bj_stream* s = bj_open_stream_write(0, 0);
+    REQUIRE_VALUE(s);
+    REQUIRE_EQ(bj_write_stream(s, "abc", 3), 3);
+    CHECK(bj_flush_stream(s));
+    bj_close_stream(s);
+
+    const char* path = "unit_stream_flush.bin";
+    s = bj_open_stream_file_write(path, 0);
+    REQUIRE_VALUE(s);
+    REQUIRE_EQ(bj_write_stream(s, "abc", 3), 3);
+    CHECK(bj_flush_stream(s));
+    bj_close_stream(s);
+    remove(path);
+
+#ifdef __linux__
+    // Writes only fill the stdio buffer, the device refuses them on flush
+    s = bj_open_stream_file_write("/dev/full", 0);
+    if (s != 0) {
+        CHECK_EQ(bj_write_stream(s, "abc", 3), 3);
+        CHECK(!bj_flush_stream(s));
+        bj_close_stream(s);
+    }
+#endif
+}
+
+TEST_CASE(stream_write_to_read_stream_fails) {
+    char data[4] = "abc";
+    struct bj_stream* s = bj_open_stream_read(data, 3);
+    REQUIRE_VALUE(s);
+    REQUIRE_EQ(bj_write_stream(s, "x", 1), 0);
+    REQUIRE(data[0] == 'a');
+    bj_close_stream(s);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Peek Tests
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE(stream_peek_borrows_without_moving) {
+    const char data[] = "ABCDEF";
+    struct bj_stream* s = bj_open_stream_read(data, 6);
+    REQUIRE_VALUE(s);
+
+    const void* view = 0;
+    REQUIRE_EQ(bj_peek_stream(s, 4, &view), 4);
+    REQUIRE(view == data);
+    REQUIRE_EQ(bj_tell_stream(s), 0);
+
+    REQUIRE_EQ(bj_consume_stream(s, 4), 4);
+    REQUIRE_EQ(bj_tell_stream(s), 4);
+
+    // Only what remains is borrowed
+    REQUIRE_EQ(bj_peek_stream(s, 100, &view), 2);
+    REQUIRE(memcmp(view, "EF", 2) == 0);
+    REQUIRE_EQ(bj_consume_stream(s, 100), 2);
+    REQUIRE_EQ(bj_peek_stream(s, 1, &view), 0);
+
+    bj_close_stream(s);
+}
+
+TEST_CASE(stream_peek_file_content) {
+    const char* path = "unit_stream_peek.bin";
+    FILE* f = fopen(path, "wb");
+    REQUIRE_VALUE(f);
+    fputs("0123456789", f);
+    fclose(f);
+
+    struct bj_stream* s = bj_open_stream_file(path, 0);
+    REQUIRE_VALUE(s);
+    bj_seek_stream(s, 3, BJ_SEEK_BEGIN);
+
+    const void* view = 0;
+    REQUIRE_EQ(bj_peek_stream(s, 3, &view), 3);
+    REQUIRE(memcmp(view, "345", 3) == 0);
+
+    bj_close_stream(s);
+    remove(path);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Macro Tests
 ////////////////////////////////////////////////////////////////////////////////
@@ -291,6 +553,24 @@ int main(int argc, char* argv[]) {
     // File stream
     RUN_TEST(stream_open_nonexistent_file_returns_error);
     RUN_TEST(stream_open_file_null_error_is_safe);
+    RUN_TEST(stream_open_file_exposes_content);
+
+    // Buffered file stream
+    RUN_TEST(stream_buffered_reads_across_chunks);
+    RUN_TEST(stream_buffered_seeks_lazily);
+    RUN_TEST(stream_buffered_peek_beyond_buffer);
+    RUN_TEST(stream_buffered_nonexistent_file_returns_error);
+
+    // Write
+    RUN_TEST(stream_write_grows_owned_buffer);
+    RUN_TEST(stream_write_truncates_provided_buffer);
+    RUN_TEST(stream_write_to_file);
+    RUN_TEST(stream_flush_reports_write_errors);
+    RUN_TEST(stream_write_to_read_stream_fails);
+
+    // Peek
+    RUN_TEST(stream_peek_borrows_without_moving);
+    RUN_TEST(stream_peek_file_content);
 
     // Macros
     RUN_TEST(stream_read_t_macro);
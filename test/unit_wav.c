@@ -0,0 +1,165 @@
+#include "test.h"
+#include <banjo/memory.h>
+#include <banjo/wav.h>
+
+static uint8_t file[1024];
+
+static size_t put16(size_t at, uint16_t value) {
+  file[at] = (uint8_t)value;
+  file[at + 1] = (uint8_t)(value >> 8);
+  return at + 2;
+}
+
+static size_t put32(size_t at, uint32_t value) {
+  at = put16(at, (uint16_t)value);
+  return put16(at, (uint16_t)(value >> 16));
+}
+
+static size_t put_id(size_t at, const char *id) {
+  bj_memcpy(file + at, id, 4);
+  return at + 4;
+}
+
+// Writes a RIFF header with a "fmt " chunk, an unknown chunk to skip and a
+// "data" chunk. Returns the offset of the data.
+static size_t put_header(uint16_t tag, uint16_t channels, uint16_t block_align,
+                         uint16_t bits, uint32_t data_size) {
+  size_t at = put_id(0, "RIFF");
+  at = put32(at, 0);
+  at = put_id(at, "WAVE");
+  at = put_id(at, "fmt ");
+  at = put32(at, 16);
+  at = put16(at, tag);
+  at = put16(at, channels);
+  at = put32(at, 22050);
+  at = put32(at, 22050u * block_align);
+  at = put16(at, block_align);
+  at = put16(at, bits);
+  at = put_id(at, "LIST");
+  at = put32(at, 3);
+  at += 4; // 3 bytes and padding
+  at = put_id(at, "data");
+  return put32(at, data_size);
+}
+
+TEST_CASE(wav_reads_pcm16_in_chunks) {
+  const size_t data = put_header(1, 2, 4, 16, 10 * 4);
+  for (size_t i = 0; i < 20; ++i) {
+    put16(data + 2 * i, (uint16_t)(i * 100));
+  }
+
+  struct bj_stream *stream = bj_open_stream_read(file, data + 10 * 4);
+  struct bj_wav *wav = bj_open_wav(stream, 0);
+  REQUIRE_VALUE(wav);
+  CHECK_EQ(bj_wav_properties(wav)->format, BJ_AUDIO_FORMAT_INT16);
+  CHECK_EQ(bj_wav_properties(wav)->channels, 2);
+  CHECK_EQ(bj_wav_properties(wav)->sample_rate, 22050);
+  CHECK_EQ(bj_wav_frames(wav), 10);
+
+  int16_t out[2 * 8];
+  CHECK_EQ(bj_read_wav(wav, out, 4), 4);
+  CHECK_EQ(out[7], 700);
+  CHECK_EQ(bj_read_wav(wav, out, 8), 6);
+  CHECK_EQ(out[0], 800);
+  CHECK_EQ(out[11], 1900);
+  CHECK_EQ(bj_read_wav(wav, out, 8), 0);
+
+  CHECK_EQ(bj_seek_wav(wav, 9), 9);
+  CHECK_EQ(bj_read_wav(wav, out, 8), 1);
+  CHECK_EQ(out[0], 1800);
+
+  bj_close_wav(wav);
+  bj_close_stream(stream);
+}
+
+TEST_CASE(wav_decodes_ima_adpcm) {
+  // One mono block of 8 bytes: 4-byte header and 8 samples
+  const size_t data = put_header(0x11, 1, 8, 4, 8);
+  put16(data, 1000);
+  file[data + 2] = 0;
+  file[data + 3] = 0;
+  file[data + 4] = 0x44;
+  file[data + 5] = 0x0C;
+  file[data + 6] = 0x00;
+  file[data + 7] = 0x00;
+
+  struct bj_stream *stream = bj_open_stream_read(file, data + 8);
+  struct bj_wav *wav = bj_open_wav(stream, 0);
+  REQUIRE_VALUE(wav);
+  CHECK_EQ(bj_wav_frames(wav), 9);
+
+  int16_t out[9];
+  CHECK_EQ(bj_read_wav(wav, out, 9), 9);
+  CHECK_EQ(out[0], 1000);
+  CHECK_EQ(out[1], 1007);
+  CHECK_EQ(out[2], 1017);
+  CHECK_EQ(out[3], 1005);
+
+  // Seeking in the middle of a block decodes it again
+  bj_seek_wav(wav, 2);
+  CHECK_EQ(bj_read_wav(wav, out, 2), 2);
+  CHECK_EQ(out[0], 1017);
+  CHECK_EQ(out[1], 1005);
+
+  bj_close_wav(wav);
+  bj_close_stream(stream);
+}
+
+TEST_CASE(wav_rejects_invalid_files) {
+  struct bj_error *error = 0;
+
+  put_header(1, 1, 1, 8, 0);
+  struct bj_stream *stream = bj_open_stream_read(file, 64);
+  CHECK_NULL(bj_open_wav(stream, &error));
+  CHECK(bj_error_code(error) == BJ_ERROR_UNSUPPORTED);
+  bj_clear_error(&error);
+  bj_close_stream(stream);
+
+  const char junk[16] = "RIFX....WAVE";
+  stream = bj_open_stream_read(junk, sizeof(junk));
+  CHECK_NULL(bj_open_wav(stream, &error));
+  CHECK(bj_error_code(error) == BJ_ERROR_INCORRECT_VALUE);
+  bj_clear_error(&error);
+  bj_close_stream(stream);
+}
+
+TEST_CASE(wav_loops_into_ring) {
+  const size_t data = put_header(3, 1, 4, 32, 3 * 4);
+  const float samples[3] = {0.25f, 0.5f, 0.75f};
+  bj_memcpy(file + data, samples, sizeof(samples));
+
+  struct bj_stream *stream = bj_open_stream_read(file, data + sizeof(samples));
+  struct bj_wav *wav = bj_open_wav(stream, 0);
+  REQUIRE_VALUE(wav);
+  CHECK_EQ(bj_wav_properties(wav)->format, BJ_AUDIO_FORMAT_F32);
+
+  struct bj_audio_ring *ring = bj_create_audio_ring(bj_wav_properties(wav), 8);
+  REQUIRE_VALUE(ring);
+  CHECK_EQ(bj_read_wav_to_ring(wav, ring, BJ_TRUE), 8);
+  CHECK_EQ(bj_read_wav_to_ring(wav, ring, BJ_TRUE), 0);
+
+  float out[8];
+  bj_audio_ring_read(ring, out, 8);
+  CHECK(out[3] == 0.25f);
+  CHECK(out[7] == 0.5f);
+  CHECK_EQ(bj_tell_wav(wav), 2);
+
+  // Without looping, stops at the end of the track
+  bj_read_wav_to_ring(wav, ring, BJ_FALSE);
+  CHECK_EQ(bj_audio_ring_readable(ring), 1);
+
+  bj_destroy_audio_ring(ring);
+  bj_close_wav(wav);
+  bj_close_stream(stream);
+}
+
+int main(int argc, char *argv[]) {
+  BEGIN_TESTS(argc, argv);
+
+  RUN_TEST(wav_reads_pcm16_in_chunks);
+  RUN_TEST(wav_decodes_ima_adpcm);
+  RUN_TEST(wav_rejects_invalid_files);
+  RUN_TEST(wav_loops_into_ring);
+
+  END_TESTS();
+}